@@ -100,12 +100,12 @@ RandomIt __find_if(RandomIt first, RandomIt last,
 
 template <class InputIt, class T>
 inline InputIt find(InputIt first, InputIt last, const T& val) {
-  return __find(first, last, val, iterator_category_t<InputIt>());
+  return MiniSTL::__find(first, last, val, iterator_category_t<InputIt>());
 }
 
 template <class InputIt, class Predicate>
 inline InputIt find_if(InputIt first, InputIt last, Predicate pred) {
-  return __find_if(first, last, pred, iterator_category_t<InputIt>());
+  return MiniSTL::__find_if(first, last, pred, iterator_category_t<InputIt>());
 }
 
 // find_first_of
@@ -174,7 +174,7 @@ BiIt1 __find_end(BiIt1 first1, BiIt1 last1,
         return last1;
     else {
         BiIt1 result = rresult.base();
-        advance(result, -distance(first2, last2));
+        MiniSTL::advance(result, -MiniSTL::distance(first2, last2));
         return result;
     }
 }
@@ -187,7 +187,7 @@ inline ForwardIt1
 find_end(ForwardIt1 first1, ForwardIt1 last1, 
          ForwardIt2 first2, ForwardIt2 last2,
          BiPredicate comp) {
-  return find_end(first1, last1, first2, last2,
+  return MiniSTL::find_end(first1, last1, first2, last2,
                   iterator_category_t<ForwardIt1>(),
                   iterator_category_t<ForwardIt2>(),
                   comp);
@@ -238,8 +238,8 @@ template <class ForwardIt1, class ForwardIt2,
 ForwardIt1 search(ForwardIt1 first1, ForwardIt1 last1,
                   ForwardIt2 first2, ForwardIt2 last2,
                   BiPredicate pred = BiPredicate())  {
-    difference_type_t<ForwardIt1> d1 = distance(first1, last1);
-    difference_type_t<ForwardIt2> d2 = distance(first2, last2);
+    difference_type_t<ForwardIt1> d1 = MiniSTL::distance(first1, last1);
+    difference_type_t<ForwardIt2> d2 = MiniSTL::distance(first2, last2);
 
     if(d1 < d2 || d1 == difference_type_t<ForwardIt1>(0))
         return last1;
@@ -301,20 +301,30 @@ ForwardIt search_n(ForwardIt first, ForwardIt last,
 } 
 
 // Binary search (lower_bound, upper_bound, equal_range, binary_search).
+// Forward iterators halve the range with a branch on each comparison.
+// Random access iterators keep the base of the range and select the next
+// base with a conditional move: the loop runs a fixed log2(n) + 1 steps
+// and never mispredicts, and the two possible next midpoints are
+// prefetched when the iterator is a pointer.
 
-template <class ForwardIt, class T, 
-          class Compare = less<T> >
-inline ForwardIt lower_bound(ForwardIt first, ForwardIt last,
-                             const T& val,
-                             Compare comp = Compare()) {
-    difference_type_t<ForwardIt> len = distance(first, last);
+template <class T>
+inline void __prefetch_it(T* p) { __prefetch(p); }
+
+template <class It>
+inline void __prefetch_it(const It&) {}
+
+template <class ForwardIt, class T, class Compare>
+ForwardIt __lower_bound(ForwardIt first, ForwardIt last,
+                        const T& val, Compare comp,
+                        forward_iterator_tag) {
+    difference_type_t<ForwardIt> len = MiniSTL::distance(first, last);
     difference_type_t<ForwardIt> half;
     ForwardIt mid;
 
     while(len > 0) {
         half = len >> 1;
         mid = first;
-        advance(mid, half);
+        MiniSTL::advance(mid, half);
         if(comp(*mid, val)) {
             first = mid;
             ++first;
@@ -326,19 +336,44 @@ inline ForwardIt lower_bound(ForwardIt first, ForwardIt last,
     return first;
 }
 
-template <class ForwardIt, class T,
+template <class RandomIt, class T, class Compare>
+RandomIt __lower_bound(RandomIt first, RandomIt last,
+                       const T& val, Compare comp,
+                       random_access_iterator_tag) {
+    difference_type_t<RandomIt> len = last - first;
+    if(len == 0)
+        return first;
+    // the result is in [first, first + len]
+    while(len > 1) {
+        difference_type_t<RandomIt> half = len >> 1;
+        MiniSTL::__prefetch_it(first + ((len - half) >> 1));
+        MiniSTL::__prefetch_it(first + half + ((len - half) >> 1));
+        first = comp(first[half], val) ? first + half : first;
+        len -= half;
+    }
+    return first + comp(*first, val);
+}
+
+template <class ForwardIt, class T, 
           class Compare = less<T> >
-inline ForwardIt upper_bound(ForwardIt first, ForwardIt last,
+inline ForwardIt lower_bound(ForwardIt first, ForwardIt last,
                              const T& val,
                              Compare comp = Compare()) {
-    difference_type_t<ForwardIt> len = distance(first, last);
+    return MiniSTL::__lower_bound(first, last, val, comp, iterator_category_t<ForwardIt>());
+}
+
+template <class ForwardIt, class T, class Compare>
+ForwardIt __upper_bound(ForwardIt first, ForwardIt last,
+                        const T& val, Compare comp,
+                        forward_iterator_tag) {
+    difference_type_t<ForwardIt> len = MiniSTL::distance(first, last);
     difference_type_t<ForwardIt> half;
     ForwardIt mid;
 
     while(len > 0) {
         half = len >> 1;
         mid = first;
-        advance(mid, half);
+        MiniSTL::advance(mid, half);
         if(comp(val, *mid))
             len = half;
         else {
@@ -350,20 +385,44 @@ inline ForwardIt upper_bound(ForwardIt first, ForwardIt last,
     return first;
 }
 
+template <class RandomIt, class T, class Compare>
+RandomIt __upper_bound(RandomIt first, RandomIt last,
+                       const T& val, Compare comp,
+                       random_access_iterator_tag) {
+    difference_type_t<RandomIt> len = last - first;
+    if(len == 0)
+        return first;
+    while(len > 1) {
+        difference_type_t<RandomIt> half = len >> 1;
+        MiniSTL::__prefetch_it(first + ((len - half) >> 1));
+        MiniSTL::__prefetch_it(first + half + ((len - half) >> 1));
+        first = comp(val, first[half]) ? first : first + half;
+        len -= half;
+    }
+    return first + !comp(val, *first);
+}
 
-template <class ForwardIt, class T, 
+template <class ForwardIt, class T,
           class Compare = less<T> >
+inline ForwardIt upper_bound(ForwardIt first, ForwardIt last,
+                             const T& val,
+                             Compare comp = Compare()) {
+    return MiniSTL::__upper_bound(first, last, val, comp, iterator_category_t<ForwardIt>());
+}
+
+
+template <class ForwardIt, class T, class Compare>
 pair<ForwardIt, ForwardIt>
-equal_range(ForwardIt first, ForwardIt last, const T& val,
-            Compare comp = Compare()) {
-    difference_type_t<ForwardIt> len = distance(first, last);
+__equal_range(ForwardIt first, ForwardIt last, const T& val,
+              Compare comp, forward_iterator_tag) {
+    difference_type_t<ForwardIt> len = MiniSTL::distance(first, last);
     difference_type_t<ForwardIt> half;
     ForwardIt mid, left, right;
 
     while(len > 0) {
         half = len >> 1;
         mid = first;
-        advance(mid, half);
+        MiniSTL::advance(mid, half);
         if(comp(*mid, val)) {
             first = mid;
             ++first;
@@ -371,21 +430,40 @@ equal_range(ForwardIt first, ForwardIt last, const T& val,
         } else if(comp(val, *mid))
             len = half;
         else {
-            left = lower_bound(first, mid, val, comp);
-            advance(first, len);
-            right = upper_bound(++mid, first, val, comp);
+            left = MiniSTL::lower_bound(first, mid, val, comp);
+            MiniSTL::advance(first, len);
+            right = MiniSTL::upper_bound(++mid, first, val, comp);
             return pair<ForwardIt, ForwardIt>(left, right);
         }
     }
     return pair<ForwardIt, ForwardIt>(first, first);
 }           
 
+// two branchless searches, the second one from the lower bound
+template <class RandomIt, class T, class Compare>
+pair<RandomIt, RandomIt>
+__equal_range(RandomIt first, RandomIt last, const T& val,
+              Compare comp, random_access_iterator_tag) {
+    RandomIt left = MiniSTL::__lower_bound(first, last, val, comp,
+                                  random_access_iterator_tag());
+    return pair<RandomIt, RandomIt>(left, MiniSTL::__upper_bound(left, last, val, comp,
+                                                        random_access_iterator_tag()));
+}
+
+template <class ForwardIt, class T, 
+          class Compare = less<T> >
+inline pair<ForwardIt, ForwardIt>
+equal_range(ForwardIt first, ForwardIt last, const T& val,
+            Compare comp = Compare()) {
+    return MiniSTL::__equal_range(first, last, val, comp, iterator_category_t<ForwardIt>());
+}
+
 template <class ForwardIt, class T, 
           class Compare = less<T> >
 bool binary_search(ForwardIt first, ForwardIt last,
                    const T& val,
                    Compare comp = Compare()) {
-    ForwardIt i = lower_bound(first, last, val, comp);
+    ForwardIt i = MiniSTL::lower_bound(first, last, val, comp);
     return i != last && !comp(val, *i);
 }
 
@@ -430,7 +508,7 @@ OutputIt replace_copy_if(InputIt first, InputIt last,
 template <class ForwardIt, class T>
 ForwardIt remove(ForwardIt first, ForwardIt last,
                  const T& val) {
-    first = find(first, last, val);
+    first = MiniSTL::find(first, last, val);
     ForwardIt i = first;
     return first == last ? first 
                         : remove_copy(++i, last, first, val);
@@ -439,7 +517,7 @@ ForwardIt remove(ForwardIt first, ForwardIt last,
 template <class ForwardIt, class Predicate>
 ForwardIt remove_if(ForwardIt first, ForwardIt last,
                     Predicate pred) {
-    first = find_if(first, last, pred);
+    first = MiniSTL::find_if(first, last, pred);
     ForwardIt i = first;
     return first == last ? first 
                         : remove_copy_if(++i, last, first, pred);
@@ -491,7 +569,7 @@ inline OutputIt unique_copy(InputIt first, InputIt last,
                             OutputIt result,
                             BiPredicate pred,
                             output_iterator_tag) {
-    return unique_copy(first, last, result, pred);
+    return MiniSTL::unique_copy(first, last, result, pred);
 }
 
 template <class InputIt, class ForwardIt, class BiPredicate>
@@ -514,7 +592,7 @@ inline OutputIt unique_copy(InputIt first, InputIt last,
                             BiPredicate pred = BiPredicate()) {
     if(first == last)
         return result;
-    return unique_copy(first, last, result, pred,
+    return MiniSTL::unique_copy(first, last, result, pred,
                        iterator_category_t<InputIt>());
 }
 
@@ -522,8 +600,8 @@ template <class ForwardIt,
           class BiPredicate = equal_to<value_type_t<ForwardIt>> >
 ForwardIt unique(ForwardIt first, ForwardIt last,
                     BiPredicate pred) {
-    first = adjacent_find(first, last, pred);
-    return unique_copy(first, last, first, pred);
+    first = MiniSTL::adjacent_find(first, last, pred);
+    return MiniSTL::unique_copy(first, last, first, pred);
 }
 
 
@@ -536,7 +614,7 @@ void __reverse(BiIt first, BiIt last,
         if(first == last || first == --last)
             return;
         else
-            iter_swap(first++, last);
+            MiniSTL::iter_swap(first++, last);
     }
 }
 
@@ -544,12 +622,12 @@ template <class RandomIt>
 void __reverse(RandomIt first, RandomIt last,
                random_access_iterator_tag) {
     while(first < last)
-        iter_swap(first++, --last);
+        MiniSTL::iter_swap(first++, --last);
 }
 
 template <class BiIt>
 inline void reverse(BiIt first, BiIt last) {
-    reverse(first, last, iterator_category_t<BiIt>());
+    MiniSTL::__reverse(first, last, iterator_category_t<BiIt>());
 }
 
 template <class BiIt, class OutputIt>
@@ -563,6 +641,15 @@ OutputIt reverse_copy(BiIt first, BiIt last,
     return result;
 }
 
+// swap_ranges, used by rotate
+template <class ForwardIt1, class ForwardIt2>
+ForwardIt2 swap_ranges(ForwardIt1 first1, ForwardIt1 last1,
+                          ForwardIt2 first2) {
+    for(;first1 != last1;++first1, ++first2)
+        MiniSTL::iter_swap(first1, first2);
+    return first2;
+}
+
 //---------------------
 // rotate and rotate_copy
 
@@ -586,7 +673,7 @@ ForwardIt __rotate(ForwardIt first, ForwardIt mid,
 
     ForwardIt first2 = mid;
     do {
-        swap(*first++, *first2++);
+        MiniSTL::swap(*first++, *first2++);
         if(first == mid)
             mid = first2;
     } while(first2 != last);
@@ -595,7 +682,7 @@ ForwardIt __rotate(ForwardIt first, ForwardIt mid,
     first2 = mid;
 
     while(first2 != last) {
-        swap(*first++, *first2++);
+        MiniSTL::swap(*first++, *first2++);
         if(first == mid)
             mid = first2;
         else if(first2 == last)
@@ -613,17 +700,17 @@ BiIt __rotate(BiIt first, BiIt mid, BiIt last,
     if(last == mid)
         return first;
 
-    __reverse(first, mid, bidirectional_iterator_tag());
-    __reverse(mid, last, bidirectional_iterator_tag());
+    MiniSTL::__reverse(first, mid, bidirectional_iterator_tag());
+    MiniSTL::__reverse(mid, last, bidirectional_iterator_tag());
 
     while(first != mid && mid != last)
-        swap(*first++, *--last);
+        MiniSTL::swap(*first++, *--last);
 
     if(first == mid) {
-        __reverse(mid, last, bidirectional_iterator_tag());
+        MiniSTL::__reverse(mid, last, bidirectional_iterator_tag());
         return last;
     } else {
-        __reverse(first, mid, bidirectional_iterator_tag());
+        MiniSTL::__reverse(first, mid, bidirectional_iterator_tag());
         return first;
     }
 }
@@ -641,11 +728,11 @@ RandomIt __rotate(RandomIt first, RandomIt mid,
     if(k == 0)
         return last;
     else if(k == l) {
-        swap_ranges(first, mid, mid);
+        MiniSTL::swap_ranges(first, mid, mid);
         return result;
     }
 
-    Distance d = gcd(n, k);
+    Distance d = MiniSTL::__gcd(n, k);
 
     for(Distance i = 0; i < d; i++) {
         value_type_t<RandomIt> tmp = *first;
@@ -684,7 +771,7 @@ RandomIt __rotate(RandomIt first, RandomIt mid,
 template <class ForwardIt>
 inline ForwardIt rotate(ForwardIt first, ForwardIt mid,
                         ForwardIt last) {
-    return __rotate(first, mid, last,
+    return MiniSTL::__rotate(first, mid, last,
                     iterator_category_t<ForwardIt>());
 }
 
@@ -696,21 +783,21 @@ BiIt1 __rotate_adaptive(BiIt1 first, BiIt1 mid, BiIt1 last,
                         BiIt2 buf, Distance buf_size) {
     BiIt2 buf_end;
     if(len1 > len2 && len2 <= buf_size) {
-        buf_end = copy(mid, last, buf);
-        copy_backward(first, mid, last);
-        return copy(buf, buf_end, first);
+        buf_end = MiniSTL::copy(mid, last, buf);
+        MiniSTL::copy_backward(first, mid, last);
+        return MiniSTL::copy(buf, buf_end, first);
     } else if(len1 <= buf_size) {
-        buf_end = copy(first, mid, buf);
-        copy(mid, last, first);
-        return copy_backward(buf, buf_end, last);
+        buf_end = MiniSTL::copy(first, mid, buf);
+        MiniSTL::copy(mid, last, first);
+        return MiniSTL::copy_backward(buf, buf_end, last);
     } else
-        return rotate(first, mid, last);
+        return MiniSTL::rotate(first, mid, last);
 }
 
 template <class ForwardIt, class OutputIt>
 OutputIt rotate_copy(ForwardIt first, ForwardIt mid,
                      ForwardIt last, OutputIt result) {
-    return copy(first, mid, copy(mid, last, result));
+    return MiniSTL::copy(first, mid, MiniSTL::copy(mid, last, result));
 }
 
 //------------------------
@@ -736,12 +823,12 @@ bool next_permutation(BiIt first, BiIt last,
         if(comp(*i, *ii)) {
             BiIt j = last;
             while (!comp(*i, *--j));
-            iter_swap(i, j);
-            reverse(ii, last);
+            MiniSTL::iter_swap(i, j);
+            MiniSTL::reverse(ii, last);
             return true;
         }
         if(i == first) {
-            reverse(first, last);
+            MiniSTL::reverse(first, last);
             return false;
         }
     }
@@ -768,12 +855,12 @@ bool prev_permutation(BiIt first, BiIt last,
         if(comp(*ii, *i)) {
             BiIt j = last;
             while (!comp(*--j, *i));
-            iter_swap(i, j);
-            reverse(ii, last);
+            MiniSTL::iter_swap(i, j);
+            MiniSTL::reverse(ii, last);
             return true;
         }
         if(i == first) {
-            reverse(first, last);
+            MiniSTL::reverse(first, last);
             return false;
         }
     }
@@ -839,15 +926,6 @@ Function for_each(InputIt first, InputIt last, Function f) {
     return f;
 }
 
-// swap_ranges
-template <class ForwardIt1, class ForwardIt2>
-ForwardIt2 swap_ranges(ForwardIt1 first1, ForwardIt1 last1,
-                          ForwardIt2 first2) {
-    for(;first1 != last1;++first1, ++first2)
-        iter_swap(first1, first2);
-    return first2;
-}
-
 // transform
 template <class InputIt, class OutputIt, class UnaryOp>
 OutputIt transform(InputIt first, InputIt last,
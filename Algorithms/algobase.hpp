@@ -6,8 +6,6 @@
 #include "Traits/type_traits.hpp"
 #include "Util/pair.hpp"
 
-#include <iostream>
-
 
 namespace MiniSTL {
 
@@ -28,6 +26,18 @@ inline void swap(T& x, T& y) {
     y = tmp;
 }
 
+//--------------------------------------------------
+// __prefetch: hint that *p will be read soon, a no-op where the compiler
+// has no prefetch builtin
+
+inline void __prefetch(const void* p) {
+#ifdef __GNUC__
+    __builtin_prefetch(p);
+#else
+    (void)p;
+#endif
+}
+
 //--------------------------------------------------
 // min and max
 
@@ -62,23 +72,21 @@ inline const T& max(const T& x, const T& y, Compare comp) {
 //      a for loop with an explicit count n
 
 // for input iter, assign one by one, use first == last as end condition
-template <class InputIt, class OutputIt, class Distance>
+template <class InputIt, class OutputIt>
 inline OutputIt __copy(InputIt first, InputIt last,
                         OutputIt result,
                         input_iterator_tag) {
-    std::cout << "copy input iter" << std::endl;
     for ( ; first != last; ++result, ++first)
         *result = *first;
     return result;
 }
 
 // for random iter, assign one by one, use n == 0 as end condition
-template <class RandomIt, class OutputIt, class Distance>
+template <class RandomIt, class OutputIt>
 inline OutputIt
 __copy(RandomIt first, RandomIt last, OutputIt result, 
         random_access_iterator_tag) {
-    std::cout << "copy random iter" << std::endl;
-    for (Distance n = last - first; n > 0; --n) {
+    for (difference_type_t<RandomIt> n = last - first; n > 0; --n) {
         *result = *first;
         ++first;
         ++result;
@@ -90,16 +98,10 @@ __copy(RandomIt first, RandomIt last, OutputIt result,
 template <class T>
 inline T*
 __copy_trivial(const T* first, const T* last, T* result) {
-    std::cout << "copy trivial" << std::endl;
-    memmove(result, first, sizeof(T) * (last - first));
-    return result + (last - first);
-}
-
-template <class InputIt, class OutputIt>
-inline OutputIt copy(InputIt first, InputIt last,
-                        OutputIt result) {
-    using trivial = has_trivial_assignment_operator_t<value_type_t<InputIt> >;
-    return __copy_aux(first, last, result, trivial());
+    const ptrdiff_t length = last - first;
+    if(length > 0)
+        memmove(result, first, sizeof(T) * length);
+    return result + length;
 }
 
 template <class InputIt, class OutputIt>
@@ -123,6 +125,19 @@ inline T* __copy_aux(const T* first, const T* last, T* result,
     return __copy_trivial(first, last, result);
 }
 
+template <class T>
+inline T* __copy_aux(T* first, T* last, T* result,
+                        true_type) {
+    return __copy_trivial<T>(first, last, result);
+}
+
+template <class InputIt, class OutputIt>
+inline OutputIt copy(InputIt first, InputIt last,
+                        OutputIt result) {
+    using trivial = has_trivial_assignment_operator_t<value_type_t<InputIt> >;
+    return __copy_aux(first, last, result, trivial());
+}
+
 
 //--------------------------------------------------
 // copy_backward
@@ -131,12 +146,12 @@ template <class T>
 inline T* __copy_backward_trivial(const T* first, const T* last, 
                                 T* result){
     const ptrdiff_t length = last - first;
-    memmove(result - length, first, sizeof(T) * length);
+    if(length > 0)
+        memmove(result - length, first, sizeof(T) * length);
     return result - length;
 }
 
-template <class BiIt1, class BiIt2, 
-          class Distance>
+template <class BiIt1, class BiIt2>
 inline BiIt2 __copy_backward(BiIt1 first, BiIt1 last, 
                               BiIt2 result,
                               bidirectional_iterator_tag) {
@@ -145,21 +160,15 @@ inline BiIt2 __copy_backward(BiIt1 first, BiIt1 last,
     return result;
 }
 
-template <class RandomIt, class BiIt, class Distance>
+template <class RandomIt, class BiIt>
 inline BiIt __copy_backward(RandomIt first, RandomIt last, 
                              BiIt result,
                              random_access_iterator_tag) {
-    for (Distance n = last - first; n > 0; --n)
+    for (difference_type_t<RandomIt> n = last - first; n > 0; --n)
         *--result = *--last;
     return result;
 }
 
-template <class BiIt1, class BiIt2>
-inline BiIt2 copy_backward(BiIt1 first, BiIt1 last, BiIt2 result) {
-    using trivial = has_trivial_assignment_operator_t<value_type_t<BiIt1> >;
-    return __copy_backward_aux(first, last, result, trivial());
-}
-
 template <class BiIt1, class BiIt2>
 inline BiIt2 __copy_backward_aux(BiIt1 first, BiIt1 last, 
                                   BiIt2 result, true_type) {
@@ -180,6 +189,18 @@ inline T* __copy_backward_aux(const T* first, const T* last,
     return __copy_backward_trivial(first, last, result);
 }
 
+template <class T>
+inline T* __copy_backward_aux(T* first, T* last, 
+                                T* result, true_type) {
+    return __copy_backward_trivial<T>(first, last, result);
+}
+
+template <class BiIt1, class BiIt2>
+inline BiIt2 copy_backward(BiIt1 first, BiIt1 last, BiIt2 result) {
+    using trivial = has_trivial_assignment_operator_t<value_type_t<BiIt1> >;
+    return __copy_backward_aux(first, last, result, trivial());
+}
+
 
 //--------------------------------------------------
 // copy_n 
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Algorithms/algo.hpp"
+#include "Algorithms/eytzinger.hpp"
+#include "Algorithms/sort.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Algorithms/bench_search.cpp
+ *  run:   ./a.out [max_keys], max_keys defaults to 2^24
+ *
+ *  for n = 2^10, 2^12, ..., max_keys sorted random 32-bit keys (4KB, in
+ *  L1, up to 64MB, beyond the LLC), 2^20 lookups of random keys, half of
+ *  them in the array: the textbook branching lower_bound (the forward
+ *  iterator loop on a pointer range), the branchless lower_bound for
+ *  random access iterators, and eytzinger_index::lower_bound. Reports
+ *  ns per lookup.
+ */
+
+using namespace MiniSTL;
+
+const size_t LOOKUPS = 1 << 20;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_keys = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 1 << 24;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(12) << "keys" << std::setw(12) << "KB"
+              << std::setw(12) << "branchy" << std::setw(12) << "branchless"
+              << std::setw(12) << "eytzinger" << std::endl;
+    for(size_t n = 1 << 10;n <= max_keys;n *= 4) {
+        key_gen gen(n);
+        vector<uint32_t> keys;
+        keys.reserve(n);
+        for(size_t i = 0;i < n;++i)
+            keys.push_back(static_cast<uint32_t>(gen()));
+        MiniSTL::sort(keys.begin(), keys.end());
+        eytzinger_index<uint32_t> index(keys.begin(), keys.end());
+
+        vector<uint32_t> queries;
+        queries.reserve(LOOKUPS);
+        for(size_t i = 0;i < LOOKUPS;++i) {
+            const uint64_t r = gen();
+            queries.push_back(r & 1 ? keys[(r >> 1) % n] : static_cast<uint32_t>(r >> 32));
+        }
+
+        const uint32_t* first = keys.data();
+        const uint32_t* last = keys.data() + n;
+        less<uint32_t> comp;
+
+        // all three sum the lower bound values, they must agree
+        uint64_t branchy_sum = 0, branchless_sum = 0, eytzinger_sum = 0;
+        auto begin = bench_clock::now();
+        for(size_t i = 0;i < LOOKUPS;++i) {
+            const uint32_t* p = __lower_bound(first, last, queries[i], comp,
+                                              forward_iterator_tag());
+            branchy_sum += p != last ? *p : 0;
+        }
+        const double branchy_ns = ns_since(begin);
+
+        begin = bench_clock::now();
+        for(size_t i = 0;i < LOOKUPS;++i) {
+            const uint32_t* p = MiniSTL::lower_bound(first, last, queries[i], comp);
+            branchless_sum += p != last ? *p : 0;
+        }
+        const double branchless_ns = ns_since(begin);
+
+        begin = bench_clock::now();
+        for(size_t i = 0;i < LOOKUPS;++i) {
+            const uint32_t* p = index.lower_bound(queries[i]);
+            eytzinger_sum += p ? *p : 0;
+        }
+        const double eytzinger_ns = ns_since(begin);
+
+        if(branchy_sum != branchless_sum || branchy_sum != eytzinger_sum) {
+            std::cout << "results differ at " << n << " keys" << std::endl;
+            return 1;
+        }
+        sink = sink + branchy_sum;
+        std::cout << std::setw(12) << n << std::setw(12) << n * sizeof(uint32_t) / 1024
+                  << std::setw(12) << branchy_ns / LOOKUPS
+                  << std::setw(12) << branchless_ns / LOOKUPS
+                  << std::setw(12) << eytzinger_ns / LOOKUPS << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * eytzinger_index: static search index over a sorted range
+ *  Implementation properties:
+ *      1. The values are copied in Eytzinger (BFS) order: slot 1 is the
+ *      root and the children of slot k are 2k and 2k + 1. The first
+ *      levels of the implicit tree share a few cache lines, and the
+ *      descendants of a slot some levels down are adjacent, so they are
+ *      prefetched while the current level is compared.
+ *      2. A search walks k = 2k + (tree[k] < val) until k falls off the
+ *      tree, with no branch but the loop itself. The result slot is then
+ *      recovered from k: the bits after the last left turn are dropped.
+ *      3. Built once from a sorted range and never modified. Results are
+ *      pointers into the index, nullptr when no value qualifies.
+ *  For many lookups in a range too big for the caches, where lower_bound
+ *  waits on a cache miss at every level.
+ */
+
+#pragma once
+
+#include "Algorithms/algobase.hpp"
+#include "Container/Sequence/vector.hpp"
+#include "Function/function.hpp"
+#include "Iterator/iterator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MiniSTL {
+
+template <class T, class Compare = less<T>, class Alloc = simple_alloc<T>>
+class eytzinger_index {
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using const_pointer = const T*;
+    using allocator_type = Alloc;
+
+protected:
+    // slots in one cache line, the descendants of k this many levels
+    // down start at slot k * PREFETCH_SLOTS
+    static const size_type PREFETCH_SLOTS =
+        sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+
+    // slot 0 is unused, it keeps the root at 1
+    vector<T, Alloc> tree;
+    Compare comp;
+
+    template <class ForwardIt>
+    void fill(ForwardIt& it, size_type k) {
+        const size_type n = size();
+        if(k > n)
+            return;
+        fill(it, 2 * k);
+        tree[k] = *it;
+        ++it;
+        fill(it, 2 * k + 1);
+    }
+
+    void prefetch(size_type k) const {
+        // may point past the index, prefetch does not fault
+        __prefetch(reinterpret_cast<const void*>(
+            reinterpret_cast<uintptr_t>(tree.data()) + k * PREFETCH_SLOTS * sizeof(T)));
+    }
+
+    // drop the trailing right turns and the last left turn
+    static size_type unwind(size_type k) {
+#ifdef __GNUC__
+        return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+#else
+        while(k & 1)
+            k >>= 1;
+        return k >> 1;
+#endif
+    }
+
+    const_pointer slot(size_type k) const {
+        return k != 0 ? tree.data() + k : nullptr;
+    }
+
+public:
+    eytzinger_index() : tree(), comp() {}
+
+    explicit eytzinger_index(const Compare& c,
+                             const allocator_type& a = allocator_type())
+        : tree(a), comp(c) {}
+
+    // [first, last) must be sorted by Compare
+    template <class ForwardIt>
+    eytzinger_index(ForwardIt first, ForwardIt last,
+                    const Compare& c = Compare(),
+                    const allocator_type& a = allocator_type())
+        : tree(a), comp(c) { assign(first, last); }
+
+    template <class ForwardIt>
+    void assign(ForwardIt first, ForwardIt last) {
+        tree.clear();
+        if(first == last)
+            return;
+        tree.assign(MiniSTL::distance(first, last) + 1, *first);
+        fill(first, 1);
+    }
+
+    size_type size() const noexcept { return tree.empty() ? 0 : tree.size() - 1; }
+    bool empty() const noexcept { return tree.size() <= 1; }
+    allocator_type get_allocator() const { return tree.get_allocator(); }
+
+    void swap(eytzinger_index& x) {
+        tree.swap(x.tree);
+        MiniSTL::swap(comp, x.comp);
+    }
+
+    // the first value in sorted order not less than k
+    template <class K>
+    const_pointer lower_bound(const K& k) const {
+        const size_type n = size();
+        size_type i = 1;
+        while(i <= n) {
+            prefetch(i);
+            i = 2 * i + comp(tree[i], k);
+        }
+        return slot(unwind(i));
+    }
+
+    // the first value in sorted order greater than k
+    template <class K>
+    const_pointer upper_bound(const K& k) const {
+        const size_type n = size();
+        size_type i = 1;
+        while(i <= n) {
+            prefetch(i);
+            i = 2 * i + !comp(k, tree[i]);
+        }
+        return slot(unwind(i));
+    }
+
+    // a value equivalent to k, nullptr if none
+    template <class K>
+    const_pointer find(const K& k) const {
+        const_pointer p = lower_bound(k);
+        return p && !comp(k, *p) ? p : nullptr;
+    }
+
+    template <class K>
+    bool contains(const K& k) const { return find(k) != nullptr; }
+};
+
+template <class T, class Compare, class Alloc>
+inline void swap(eytzinger_index<T, Compare, Alloc>& x,
+                 eytzinger_index<T, Compare, Alloc>& y) {
+    x.swap(y);
+}
+
+} // MiniSTL
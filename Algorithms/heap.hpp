@@ -5,21 +5,11 @@
 
 namespace MiniSTL {
 
-// push a element in heap at [first, last - 1)
-// new element has been already positioned at last - 1
-template <class RandomIt, class Compare = less<value_type_t<RandomIt>> >
-void push_heap(RandomIt first, RandomIt last, 
-               Compare comp = Compare()) {
-    using Distance = difference_type_t<RandomIt>;
-    using T = value_type_t<RandomIt>;
-    __push_heap(first, Distance(last - first - 1), Distance(0), T(*(last - 1)), comp);
-}
-
 // push a element into heap 
 // [first + topIdx, first + holeIdx - 1)
 template <class RandomIt, class Distance, class T, class Compare>
 void __push_heap(RandomIt first, Distance holeIdx, Distance topIdx, 
-                 T v, Compare comp = Compare()) {
+                 T v, Compare comp) {
     Distance parent = (holeIdx - 1) / 2;
     while(holeIdx > topIdx && comp(*(first + parent), v)) {
         *(first + holeIdx) = *(first + parent);
@@ -29,33 +19,25 @@ void __push_heap(RandomIt first, Distance holeIdx, Distance topIdx,
     *(first + holeIdx) = v;
 }
 
-// pop the first element(max) from heap [first, last)
-// after return, max will be positioned at last - 1;
-template<class RandomIt, class Compare = less<value_type_t<RandomIt>> >
-void pop_heap(RandomIt first, RandomIt last, 
-              Compare comp = Compare()) {
-    using T = value_type_t<RandomIt>;
-    __pop_heap(first, last - 1, last - 1, T(*(last - 1)), comp);
-}
-
-template <class RandomIt, class T, class Compare>
-void __pop_heap(RandomIt first, RandomIt last, RandomIt result,
-                T v, Compare comp = Compare()) {
+// push a element in heap at [first, last - 1)
+// new element has been already positioned at last - 1
+template <class RandomIt, class Compare = less<value_type_t<RandomIt>> >
+void push_heap(RandomIt first, RandomIt last, 
+               Compare comp = Compare()) {
     using Distance = difference_type_t<RandomIt>;
-    // max is positioned at last - 1
-    // previous *(last - 1) is v;
-    *result = *first; 
-    adjust(first, Distance(0), Distance(last - first), v, comp);
+    using T = value_type_t<RandomIt>;
+    MiniSTL::__push_heap(first, Distance(last - first - 1), Distance(0), T(*(last - 1)), comp);
 }
 
-// fill the holeIdx with max(left, right) until len - 1
+// fill the holeIdx with max(left, right) until len - 1,
+// then push v up from the last hole
 template <class RandomIt, class Distance, class T, class Compare>
 void adjust_heap(RandomIt first, Distance holeIdx, Distance len, 
-                 T v, Compare comp = Compare()) {
+                 T v, Compare comp) {
     Distance topIdx = holeIdx;
     Distance child = 2 * holeIdx + 2;
     while(child < len) {
-        if(comp(*(first + child), *(first, child - 1))) 
+        if(comp(*(first + child), *(first + child - 1))) 
             child--;
         *(first + holeIdx) = *(first + child);
         holeIdx = child;
@@ -66,7 +48,26 @@ void adjust_heap(RandomIt first, Distance holeIdx, Distance len,
         *(first + holeIdx) = *(first + child - 1);
         holeIdx = child - 1;
     }
-    *(first + holeIdx) = v;
+    MiniSTL::__push_heap(first, holeIdx, topIdx, v, comp);
+}
+
+template <class RandomIt, class T, class Compare>
+void __pop_heap(RandomIt first, RandomIt last, RandomIt result,
+                T v, Compare comp) {
+    using Distance = difference_type_t<RandomIt>;
+    // max is positioned at last - 1
+    // previous *(last - 1) is v;
+    *result = *first; 
+    MiniSTL::adjust_heap(first, Distance(0), Distance(last - first), v, comp);
+}
+
+// pop the first element(max) from heap [first, last)
+// after return, max will be positioned at last - 1;
+template<class RandomIt, class Compare = less<value_type_t<RandomIt>> >
+void pop_heap(RandomIt first, RandomIt last, 
+              Compare comp = Compare()) {
+    using T = value_type_t<RandomIt>;
+    MiniSTL::__pop_heap(first, last - 1, last - 1, T(*(last - 1)), comp);
 }
 
 // turn [first, last) to a heap;
@@ -79,10 +80,12 @@ void make_heap(RandomIt first, RandomIt last,
     Distance len = last - first;
     // last node which has child
     Distance parent = (len - 2) / 2;
-    while(parent > 0) {
+    while(true) {
         // adjust the subtree with root parent
-        adjust_heap(first, parent, len, 
+        MiniSTL::adjust_heap(first, parent, len, 
                     T(*(first + parent)), comp);
+        if(parent == 0)
+            return;
         parent--;
     }
 }
@@ -93,7 +96,7 @@ template <class RandomIt, class Compare = less<value_type_t<RandomIt>> >
 void sort_heap(RandomIt first, RandomIt last, 
              Compare comp = Compare()) {
     while(last - first > 1)
-        pop_heap(first, last--, comp);
+        MiniSTL::pop_heap(first, last--, comp);
 }
 
 // check range [first, last - 1) is heap or not
@@ -3,6 +3,11 @@
 #include <new>
 #include <cstdlib>
 #include <cstring>
+#include <climits>
+#include "alloc_stats.hpp"
+#ifdef __GLIBC__
+#include <malloc.h> // malloc_trim
+#endif
 
 
 namespace MiniSTL {
@@ -40,6 +45,13 @@ public:
         return res;
     }
 
+    // same interface as default_alloc::reallocate. glibc grows a block
+    // in place when the next one is free, and by mremap when the block
+    // is above mmap threshold, so huge buffers are never copied
+    static void* reallocate(void* p, size_t old_sz, size_t new_sz) {
+        return realloc(p, old_sz, new_sz);
+    }
+
     static malloc_handler_t set_malloc_handler(malloc_handler_t f) {
         malloc_handler_t old = malloc_alloc_oom_handler;
         malloc_alloc_oom_handler = f;
@@ -96,19 +108,132 @@ inline bool operator!=(const malloc_alloc&,
   return false;
 }
 
+// Size class policies of default_alloc
+// A policy rounds requests of size in [1, MAX_BYTES] up to one of
+// NFREELISTS size classes. Every class size is a multiple of ALIGN.
+//      index(bytes): class of a request, 0 < bytes <= MAX_BYTES
+//      size(idx): bytes of an object of class idx
+//      floor_index(bytes): biggest class not bigger than bytes, bytes >= ALIGN
+
+// classes: ALIGN, 2 * ALIGN, ..., MAX_BYTES
+template <size_t Align = 8, size_t MaxBytes = 128>
+struct linear_size_class {
+    static_assert(Align >= sizeof(void*) && (Align & (Align - 1)) == 0,
+                  "Align must be a power of two which can hold a pointer");
+    static_assert(MaxBytes % Align == 0, "MaxBytes must be a multiple of Align");
+
+    enum {
+        ALIGN = Align,
+        MAX_BYTES = MaxBytes,
+        NFREELISTS = MaxBytes / Align
+    };
+
+    static size_t index(size_t bytes) {
+        return (bytes + Align - 1) / Align - 1;
+    }
+
+    static size_t size(size_t idx) {
+        return (idx + 1) * Align;
+    }
+
+    static size_t floor_index(size_t bytes) {
+        return bytes / Align - 1;
+    }
+};
+
+constexpr size_t static_log2(size_t n) {
+    return n <= 1 ? 0 : 1 + static_log2(n >> 1);
+}
+
+// classes: ALIGN, 2 * ALIGN, 3 * ALIGN, 4 * ALIGN, then 4 classes evenly
+// spaced in every (2^k, 2^(k+1)] up to MAX_BYTES. Rounding wastes less
+// than 25% of an object, while NFREELISTS only grows with log(MAX_BYTES):
+// 32 freelists cover 8 byte aligned objects up to 4 KiB.
+template <size_t Align = 8, size_t MaxBytes = 4096>
+struct geometric_size_class {
+    static_assert(Align >= sizeof(void*) && (Align & (Align - 1)) == 0,
+                  "Align must be a power of two which can hold a pointer");
+    static_assert(MaxBytes >= 4 * Align && (MaxBytes & (MaxBytes - 1)) == 0,
+                  "MaxBytes must be a power of two, at least 4 * Align");
+
+private:
+    // classes of size <= 2^LG_LINEAR are multiples of Align
+    enum { LG_LINEAR = static_log2(4 * Align) };
+
+    // floor(log2(n)), n > 0
+    static size_t log2(size_t n) {
+#ifdef __GNUC__
+        return sizeof(unsigned long long) * CHAR_BIT - 1 - __builtin_clzll(n);
+#else
+        size_t k = 0;
+        while(n >>= 1)
+            ++k;
+        return k;
+#endif
+    }
+
+public:
+    enum {
+        ALIGN = Align,
+        MAX_BYTES = MaxBytes,
+        NFREELISTS = 4 + 4 * (static_log2(MaxBytes) - LG_LINEAR)
+    };
+
+    static size_t index(size_t bytes) {
+        if(bytes <= 4 * Align)
+            return (bytes + Align - 1) / Align - 1;
+        // bytes in (2^k, 2^(k+1)], classes there are 2^(k-2) apart
+        const size_t k = log2(bytes - 1);
+        return 4 * (k - LG_LINEAR + 1) + ((bytes - 1 - (size_t(1) << k)) >> (k - 2));
+    }
+
+    static size_t size(size_t idx) {
+        if(idx < 4)
+            return (idx + 1) * Align;
+        const size_t k = idx / 4 - 1 + LG_LINEAR;
+        return (size_t(1) << k) + (idx % 4 + 1) * (size_t(1) << (k - 2));
+    }
+
+    static size_t floor_index(size_t bytes) {
+        const size_t idx = index(bytes);
+        return size(idx) > bytes ? idx - 1 : idx;
+    }
+};
+
+#ifdef USE_GEOMETRIC_SIZE_CLASS
+using default_size_class = geometric_size_class<>;
+#else
+using default_size_class = linear_size_class<>;
+#endif
+
+template <class SizeClass> class thread_alloc_template;
+
 // Default allocator
 // Implementation properties:
 //      1. If request an object of size > MAX_BYTES, then result object
 //      will be obtained directly from malloc alloc
-//      2. In all other cases, it allocates an object of size exactly
-//      roundUp(size).Then we can return the object to the proper free list
+//      2. In all other cases, it allocates an object of the size class
+//      of size.Then we can return the object to the proper free list
 //      due to size info without permanentyly losing part of the object.
-class default_alloc {
+//      3. Chunks got from malloc are tracked, trim() gives chunks whose
+//      objects are all back in freelists to OS. With a high water mark set,
+//      chunk_alloc trims before it grows the heap beyond the mark.
+//      4. Size classes are given by SizeClass policy. Objects got from
+//      freelists are aligned to SizeClass::ALIGN, even if it is stricter
+//      than the alignment of malloc.
+//      5. With USE_ALLOC_STATS, every call is counted, see stats().
+//      Objects moving between thread_alloc caches and freelists are not
+//      allocate/deallocate calls, so they are not counted.
+template <class SizeClass>
+class default_alloc_template {
+    // thread_alloc refills its per-thread cache from our freelists and chunks
+    template <class> friend class thread_alloc_template;
+
 private:
     enum freelist_setting{
-	    ALIGN = 8,
-        MAX_BYTES = 128, 
-        NFREELISTS = MAX_BYTES / ALIGN
+        ALIGN = SizeClass::ALIGN,
+        MAX_BYTES = SizeClass::MAX_BYTES,
+        NFREELISTS = SizeClass::NFREELISTS
     };
 
     static size_t roundUp(size_t bytes) {
@@ -124,8 +249,12 @@ private:
     static obj* volatile freelist[NFREELISTS];
 
     static size_t freelist_index(size_t bytes) {
-        return (((bytes) + static_cast<size_t>(ALIGN) - 1) / 
-                static_cast<size_t>(ALIGN) - 1);
+        return SizeClass::index(bytes);
+    }
+
+    // bytes really taken by an object of size bytes
+    static size_t class_size(size_t bytes) {
+        return SizeClass::size(SizeClass::index(bytes));
     }
 
     // return an obj of size sz, and optionally adds to size sz freelist
@@ -140,6 +269,105 @@ private:
     static char* end_free;
     static size_t heap_size;
 
+    // every chunk starts with a header, chunks are linked in address order
+    struct chunk {
+        chunk* next;
+        void* raw;      // got from malloc
+        size_t size;    // usable bytes after header
+    };
+
+    enum chunk_setting {
+        // header and padding to align usable space of a chunk
+        CHUNK_OVERHEAD = sizeof(chunk) + ALIGN
+    };
+
+    static chunk* chunk_list;
+    static size_t high_water;
+
+    // link a chunk of sz usable bytes got from malloc, return its usable space
+    static char* link_chunk(void* raw, size_t sz);
+
+    static char* chunk_space(chunk* c) {
+        return reinterpret_cast<char*>(c + 1);
+    }
+
+    // free bytes found in a chunk by trim()
+    struct chunk_usage {
+        char* first;
+        char* last;
+        size_t free_bytes;
+    };
+
+    static chunk_usage* find_chunk(chunk_usage* usage, size_t n, const void* p);
+
+#ifdef USE_ALLOC_STATS
+    struct counters {
+        size_t allocs[NFREELISTS];
+        size_t frees[NFREELISTS];
+        size_t refills[NFREELISTS];
+        size_t live_bytes;
+        size_t peak_bytes;
+        size_t chunk_allocs;
+        size_t leftover_pieces;
+        size_t leftover_bytes;
+        size_t trims;
+        size_t trimmed_bytes;
+        size_t large_allocs;
+        size_t large_frees;
+        size_t large_live_bytes;
+    };
+
+    static counters stat;
+
+    static void update_peak() {
+        if(stat.live_bytes + stat.large_live_bytes > stat.peak_bytes)
+            stat.peak_bytes = stat.live_bytes + stat.large_live_bytes;
+    }
+
+    static void count_alloc(size_t idx) {
+        ++stat.allocs[idx];
+        stat.live_bytes += SizeClass::size(idx);
+        update_peak();
+    }
+    static void count_free(size_t idx) {
+        ++stat.frees[idx];
+        stat.live_bytes -= SizeClass::size(idx);
+    }
+    static void count_large_alloc(size_t sz) {
+        ++stat.large_allocs;
+        stat.large_live_bytes += sz;
+        update_peak();
+    }
+    static void count_large_free(size_t sz) {
+        ++stat.large_frees;
+        stat.large_live_bytes -= sz;
+    }
+    static void count_large_realloc(size_t old_sz, size_t new_sz) {
+        stat.large_live_bytes += new_sz - old_sz;
+        update_peak();
+    }
+    static void count_refill(size_t idx) { ++stat.refills[idx]; }
+    static void count_chunk() { ++stat.chunk_allocs; }
+    static void count_leftover(size_t piece) {
+        ++stat.leftover_pieces;
+        stat.leftover_bytes += piece;
+    }
+    static void count_trim(size_t released) {
+        ++stat.trims;
+        stat.trimmed_bytes += released;
+    }
+#else
+    static void count_alloc(size_t) {}
+    static void count_free(size_t) {}
+    static void count_large_alloc(size_t) {}
+    static void count_large_free(size_t) {}
+    static void count_large_realloc(size_t, size_t) {}
+    static void count_refill(size_t) {}
+    static void count_chunk() {}
+    static void count_leftover(size_t) {}
+    static void count_trim(size_t) {}
+#endif
+
 public:
 
     static void* allocate(size_t sz);
@@ -147,20 +375,52 @@ public:
     static void deallocate(void* p, size_t sz);
 
     static void* reallocate(void* p, size_t old_sz, size_t new_sz);
-};
 
-char* default_alloc::start_free = nullptr;
-char* default_alloc::end_free = nullptr;
-size_t default_alloc::heap_size = 0;
-default_alloc::obj* volatile 
-default_alloc::freelist[NFREELISTS] = {
-    nullptr, nullptr, nullptr, nullptr,
-    nullptr, nullptr, nullptr, nullptr,
-    nullptr, nullptr, nullptr, nullptr,
-    nullptr, nullptr, nullptr, nullptr,
+    // give chunks whose objects are all free back to OS, while keeping
+    // at least pad bytes of chunks. return bytes released
+    static size_t trim(size_t pad = 0);
+
+    // 0 means never trim automatically
+    static void set_high_water(size_t bytes) { high_water = bytes; }
+
+    // bytes held in chunks
+    static size_t heap_bytes() { return heap_size; }
+
+    // counters and a walk over chunks and freelists, O(free objects),
+    // so take it from a metrics exporter, not from a hot path
+    static alloc_stats<NFREELISTS> stats();
 };
 
-char* default_alloc::chunk_alloc(size_t sz, int& nobjs) {
+using default_alloc = default_alloc_template<default_size_class>;
+
+template <class SizeClass>
+char* default_alloc_template<SizeClass>::start_free = nullptr;
+
+template <class SizeClass>
+char* default_alloc_template<SizeClass>::end_free = nullptr;
+
+template <class SizeClass>
+size_t default_alloc_template<SizeClass>::heap_size = 0;
+
+template <class SizeClass>
+typename default_alloc_template<SizeClass>::chunk* 
+default_alloc_template<SizeClass>::chunk_list = nullptr;
+
+template <class SizeClass>
+size_t default_alloc_template<SizeClass>::high_water = 0;
+
+template <class SizeClass>
+typename default_alloc_template<SizeClass>::obj* volatile 
+default_alloc_template<SizeClass>::freelist[NFREELISTS] = { nullptr };
+
+#ifdef USE_ALLOC_STATS
+template <class SizeClass>
+typename default_alloc_template<SizeClass>::counters 
+default_alloc_template<SizeClass>::stat = {};
+#endif
+
+template <class SizeClass>
+char* default_alloc_template<SizeClass>::chunk_alloc(size_t sz, int& nobjs) {
     char* res = nullptr;
     size_t total_bytes = sz * nobjs;
     size_t bytes_left = end_free - start_free;
@@ -172,42 +432,55 @@ char* default_alloc::chunk_alloc(size_t sz, int& nobjs) {
         return res;
     } else if(bytes_left >= sz) {
         //case2: enough space for k(k<sz) objs
-        nobjs = static_cast<int>(total_bytes / sz);
+        nobjs = static_cast<int>(bytes_left / sz);
         res = start_free;
         start_free += sz * nobjs;
         return res;
     } else {
         // case3: no enough space for just one obj
         size_t bytes_to_get = 2 * total_bytes + roundUp(heap_size>>4);
-        if(bytes_left > 0) {
-            //make use of left-over piece by add it into smaller freelist
-            obj* volatile* my_freelist = freelist + freelist_index(bytes_left);
+        //make use of left-over piece by cutting it into smaller classes
+        while(bytes_left >= static_cast<size_t>(ALIGN)) {
+            const size_t idx = SizeClass::floor_index(bytes_left);
+            const size_t piece = SizeClass::size(idx);
+            count_leftover(piece);
+            obj* volatile* my_freelist = freelist + idx;
             reinterpret_cast<obj*>(start_free)->freelist_link = *my_freelist;
             *my_freelist = reinterpret_cast<obj*>(start_free);
+            start_free += piece;
+            bytes_left -= piece;
+        }
+        if(high_water != 0 && heap_size + bytes_to_get > high_water) {
+            // left-over piece is in freelist now, don't count it twice
+            start_free = end_free = nullptr;
+            trim();
         }
-        start_free = reinterpret_cast<char*>(std::malloc(bytes_to_get));
+        void* raw = std::malloc(bytes_to_get + CHUNK_OVERHEAD);
+        start_free = raw ? link_chunk(raw, bytes_to_get) : nullptr;
         if(start_free == nullptr) {
             // not enough space in heap
             obj* volatile* my_freelist;
             obj* o;
             // find space in bigger freelist
-            for(size_t i = sz; i <= static_cast<size_t>(MAX_BYTES);i += static_cast<size_t>(ALIGN)) {
-                my_freelist = freelist + freelist_index(i);
+            for(size_t i = freelist_index(sz); i < static_cast<size_t>(NFREELISTS);++i) {
+                my_freelist = freelist + i;
                 o = *my_freelist;
                 if(o) {
                     // find and get the block, then recursive call to revise and adopt, which will be case1 or case2
                     *my_freelist = o->freelist_link;
                     start_free = reinterpret_cast<char*>(o);
-                    end_free = start_free + i;
+                    end_free = start_free + SizeClass::size(i);
                     return chunk_alloc(sz, nobjs);
                 }
             }
             // no memory everywhere
             end_free = nullptr;
             // call malloc_alloc, then get enough space or throw an exception
-            start_free = reinterpret_cast<char*>(malloc_alloc::allocate(bytes_to_get));
+            raw = malloc_alloc::allocate(bytes_to_get + CHUNK_OVERHEAD);
+            start_free = link_chunk(raw, bytes_to_get);
         }
         // we get enough space
+        count_chunk();
         heap_size += bytes_to_get;
         end_free = start_free + bytes_to_get;
         // recursive call to revise and adopt
@@ -215,10 +488,130 @@ char* default_alloc::chunk_alloc(size_t sz, int& nobjs) {
     }
 } 
 
+// usable space is aligned to ALIGN, header sits right before it
+template <class SizeClass>
+char* default_alloc_template<SizeClass>::link_chunk(void* raw, size_t sz) {
+    const size_t space = roundUp(reinterpret_cast<size_t>(raw) + sizeof(chunk));
+    chunk* c = reinterpret_cast<chunk*>(space) - 1;
+    c->raw = raw;
+    c->size = sz;
+    chunk** pos = &chunk_list;
+    while(*pos && *pos < c)
+        pos = &(*pos)->next;
+    c->next = *pos;
+    *pos = c;
+    return chunk_space(c);
+}
+
+// binary search the chunk containing p, usage is sorted by address
+template <class SizeClass>
+typename default_alloc_template<SizeClass>::chunk_usage* 
+default_alloc_template<SizeClass>::find_chunk(chunk_usage* usage, size_t n, const void* p) {
+    const char* cp = reinterpret_cast<const char*>(p);
+    size_t lo = 0, hi = n;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(usage[mid].last <= cp)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (lo < n && usage[lo].first <= cp) ? usage + lo : nullptr;
+}
+
+// a chunk is free when its free objects and unused tail add up to its size
+template <class SizeClass>
+size_t default_alloc_template<SizeClass>::trim(size_t pad) {
+    size_t n = 0;
+    for(chunk* c = chunk_list;c;c = c->next)
+        ++n;
+    if(n == 0)
+        return 0;
+    chunk_usage* usage = reinterpret_cast<chunk_usage*>(std::malloc(n * sizeof(chunk_usage)));
+    if(usage == nullptr)
+        return 0;
+
+    size_t i = 0;
+    for(chunk* c = chunk_list;c;c = c->next, ++i) {
+        usage[i].first = chunk_space(c);
+        usage[i].last = usage[i].first + c->size;
+        usage[i].free_bytes = 0;
+    }
+
+    if(start_free != end_free) {
+        chunk_usage* u = find_chunk(usage, n, start_free);
+        if(u)
+            u->free_bytes += end_free - start_free;
+    }
+    for(size_t idx = 0;idx < NFREELISTS;++idx) {
+        const size_t sz = SizeClass::size(idx);
+        for(obj* o = freelist[idx];o;o = o->freelist_link) {
+            chunk_usage* u = find_chunk(usage, n, o);
+            if(u)
+                u->free_bytes += sz;
+        }
+    }
+
+    // pick free chunks, mark them by an empty range
+    size_t released = 0;
+    for(i = 0;i < n;++i) {
+        const size_t sz = usage[i].last - usage[i].first;
+        if(usage[i].free_bytes == sz && heap_size - released - sz >= pad) {
+            released += sz;
+            usage[i].free_bytes = 0;
+        } else {
+            usage[i].free_bytes = 1;
+        }
+    }
+
+    if(released != 0) {
+        // drop objects of released chunks from freelists
+        for(size_t idx = 0;idx < NFREELISTS;++idx) {
+            obj* head = nullptr;
+            obj** link = &head;
+            for(obj* o = freelist[idx];o;o = o->freelist_link) {
+                chunk_usage* u = find_chunk(usage, n, o);
+                if(u == nullptr || u->free_bytes != 0) {
+                    *link = o;
+                    link = &o->freelist_link;
+                }
+            }
+            *link = nullptr;
+            freelist[idx] = head;
+        }
+        if(start_free != end_free) {
+            chunk_usage* u = find_chunk(usage, n, start_free);
+            if(u && u->free_bytes == 0)
+                start_free = end_free = nullptr;
+        }
+
+        chunk** pos = &chunk_list;
+        for(i = 0;i < n;++i) {
+            chunk* c = *pos;
+            if(usage[i].free_bytes == 0) {
+                *pos = c->next;
+                std::free(c->raw);
+            } else {
+                pos = &c->next;
+            }
+        }
+        heap_size -= released;
+        count_trim(released);
+#ifdef __GLIBC__
+        // hand freed pages in the middle of heap back to OS as well
+        malloc_trim(0);
+#endif
+    }
+    std::free(usage);
+    return released;
+}
+
 // get sz size space and build freelist by call chunk_alloc
-// sz must be aligned
-void* default_alloc::refill(size_t sz) {
+// sz must be a class size
+template <class SizeClass>
+void* default_alloc_template<SizeClass>::refill(size_t sz) {
     int nobjs = 20;
+    count_refill(freelist_index(sz));
     char* chunk = chunk_alloc(sz, nobjs);
     obj* volatile* my_freelist;
     obj *cur_obj, *next_obj;
@@ -241,15 +634,19 @@ void* default_alloc::refill(size_t sz) {
     return reinterpret_cast<void*>(reinterpret_cast<obj*>(chunk));
 }
 
-void* default_alloc::allocate(size_t sz) {
+template <class SizeClass>
+void* default_alloc_template<SizeClass>::allocate(size_t sz) {
     void* res = nullptr;
     if(sz > static_cast<size_t>(MAX_BYTES)) {
         res = malloc_alloc::allocate(sz);
+        count_large_alloc(sz);
     } else {
-        obj* volatile* my_freelist = freelist + freelist_index(sz);
+        const size_t idx = freelist_index(sz);
+        count_alloc(idx);
+        obj* volatile* my_freelist = freelist + idx;
         obj* o = *my_freelist;
         if(o == nullptr) {
-            res = refill(sz);
+            res = refill(class_size(sz));
         } else {
             *my_freelist = o->freelist_link;
             res = reinterpret_cast<void*>(o);
@@ -258,23 +655,31 @@ void* default_alloc::allocate(size_t sz) {
     return res;
 }
 
-void default_alloc::deallocate(void* p, size_t sz) {
+template <class SizeClass>
+void default_alloc_template<SizeClass>::deallocate(void* p, size_t sz) {
     if(sz > static_cast<size_t>(MAX_BYTES)) {
+        count_large_free(sz);
         malloc_alloc::deallocate(p, sz);
     } else {
-        obj* volatile* my_freelist = freelist + freelist_index(sz);
+        const size_t idx = freelist_index(sz);
+        count_free(idx);
+        obj* volatile* my_freelist = freelist + idx;
         obj* o = reinterpret_cast<obj*>(p);
         o->freelist_link = *my_freelist;
         *my_freelist = o;
     }
 }
 
-void* default_alloc::reallocate(void* p, size_t old_sz, size_t new_sz) {
+template <class SizeClass>
+void* default_alloc_template<SizeClass>::reallocate(void* p, size_t old_sz, size_t new_sz) {
     void* res;
     if(old_sz > static_cast<size_t>(MAX_BYTES) && new_sz > static_cast<size_t>(MAX_BYTES)) {
-        return std::realloc(p, new_sz);
+        res = malloc_alloc::realloc(p, old_sz, new_sz);
+        count_large_realloc(old_sz, new_sz);
+        return res;
     }
-    if(roundUp(old_sz) == roundUp(new_sz)) {
+    if(old_sz <= static_cast<size_t>(MAX_BYTES) && new_sz <= static_cast<size_t>(MAX_BYTES)
+       && freelist_index(old_sz) == freelist_index(new_sz)) {
         return p;
     }
     res = allocate(new_sz);
@@ -283,4 +688,41 @@ void* default_alloc::reallocate(void* p, size_t old_sz, size_t new_sz) {
     return res;
 }
 
+template <class SizeClass>
+alloc_stats<default_alloc_template<SizeClass>::NFREELISTS> 
+default_alloc_template<SizeClass>::stats() {
+    alloc_stats<NFREELISTS> s = {};
+    s.heap_bytes = heap_size;
+    for(chunk* c = chunk_list;c;c = c->next)
+        ++s.chunks;
+    s.pool_bytes = end_free - start_free;
+    for(size_t idx = 0;idx < NFREELISTS;++idx) {
+        alloc_class_stats& c = s.classes[idx];
+        c.size = SizeClass::size(idx);
+        for(obj* o = freelist[idx];o;o = o->freelist_link)
+            ++c.free_objects;
+        s.free_bytes += c.free_bytes();
+    }
+#ifdef USE_ALLOC_STATS
+    s.enabled = true;
+    for(size_t idx = 0;idx < NFREELISTS;++idx) {
+        alloc_class_stats& c = s.classes[idx];
+        c.allocs = stat.allocs[idx];
+        c.frees = stat.frees[idx];
+        c.refills = stat.refills[idx];
+    }
+    s.live_bytes = stat.live_bytes;
+    s.peak_bytes = stat.peak_bytes;
+    s.chunk_allocs = stat.chunk_allocs;
+    s.leftover_pieces = stat.leftover_pieces;
+    s.leftover_bytes = stat.leftover_bytes;
+    s.trims = stat.trims;
+    s.trimmed_bytes = stat.trimmed_bytes;
+    s.large_allocs = stat.large_allocs;
+    s.large_frees = stat.large_frees;
+    s.large_live_bytes = stat.large_live_bytes;
+#endif
+    return s;
+}
+
 } // MiniSTL
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+
+namespace MiniSTL {
+
+// Snapshot of default_alloc, taken by default_alloc::stats()
+// Implementation properties:
+//      1. Call counters(allocs, frees, refills, chunk and leftover
+//      counts, peak...) are only collected when compiled with
+//      USE_ALLOC_STATS, otherwise they stay 0 and enabled is false,
+//      and the allocate/deallocate paths carry no extra code at all.
+//      2. Gauges found by walking the allocator(heap_bytes, chunks,
+//      free_objects, free_bytes, pool_bytes) are always filled.
+//      3. live_bytes counts objects by their class size, that is what
+//      they really take from chunks.
+
+// counters of one size class
+struct alloc_class_stats {
+    size_t size;            // bytes of an object of this class
+    size_t allocs;          // allocate calls
+    size_t frees;           // deallocate calls
+    size_t refills;         // times an empty freelist was refilled
+    size_t free_objects;    // objects in freelist at snapshot
+
+    size_t live_objects() const { return allocs - frees; }
+    size_t live_bytes() const { return live_objects() * size; }
+    size_t free_bytes() const { return free_objects * size; }
+};
+
+template <size_t NClasses>
+struct alloc_stats {
+    bool enabled;               // compiled with USE_ALLOC_STATS
+    alloc_class_stats classes[NClasses];
+
+    // objects handed out by freelists
+    size_t live_bytes;
+    size_t peak_bytes;          // peak of live_bytes + large_live_bytes
+
+    // chunks
+    size_t heap_bytes;          // usable bytes of all chunks
+    size_t chunks;              // chunks alive
+    size_t chunk_allocs;        // chunks got from malloc so far
+    size_t free_bytes;          // bytes in freelists
+    size_t pool_bytes;          // uncut tail of current chunk
+    size_t leftover_pieces;     // tail pieces cut into smaller classes
+    size_t leftover_bytes;
+    size_t trims;               // trim() calls which released memory
+    size_t trimmed_bytes;
+
+    // requests bigger than MAX_BYTES, served by malloc_alloc
+    size_t large_allocs;
+    size_t large_frees;
+    size_t large_live_bytes;
+
+    static constexpr size_t nclasses() { return NClasses; }
+
+    // heap bytes neither handed out nor ready in freelists/pool,
+    // e.g. objects cached by thread_alloc or padding of leftover pieces
+    size_t unaccounted_bytes() const {
+        const size_t known = live_bytes + free_bytes + pool_bytes;
+        return heap_bytes > known ? heap_bytes - known : 0;
+    }
+
+    // one "key value" per line, then one line per size class in use
+    void dump_text(std::ostream& os) const;
+
+    // a single JSON object, classes without any activity are left out
+    void dump_json(std::ostream& os) const;
+};
+
+template <size_t NClasses>
+void alloc_stats<NClasses>::dump_text(std::ostream& os) const {
+    os << "enabled " << (enabled ? 1 : 0) << '\n'
+       << "live_bytes " << live_bytes << '\n'
+       << "peak_bytes " << peak_bytes << '\n'
+       << "heap_bytes " << heap_bytes << '\n'
+       << "chunks " << chunks << '\n'
+       << "chunk_allocs " << chunk_allocs << '\n'
+       << "free_bytes " << free_bytes << '\n'
+       << "pool_bytes " << pool_bytes << '\n'
+       << "leftover_pieces " << leftover_pieces << '\n'
+       << "leftover_bytes " << leftover_bytes << '\n'
+       << "trims " << trims << '\n'
+       << "trimmed_bytes " << trimmed_bytes << '\n'
+       << "large_allocs " << large_allocs << '\n'
+       << "large_frees " << large_frees << '\n'
+       << "large_live_bytes " << large_live_bytes << '\n'
+       << "class size allocs frees refills live_objects free_objects\n";
+    for(size_t i = 0;i < NClasses;++i) {
+        const alloc_class_stats& c = classes[i];
+        if(c.allocs == 0 && c.free_objects == 0)
+            continue;
+        os << i << ' ' << c.size << ' ' << c.allocs << ' ' << c.frees << ' '
+           << c.refills << ' ' << c.live_objects() << ' ' << c.free_objects << '\n';
+    }
+}
+
+template <size_t NClasses>
+void alloc_stats<NClasses>::dump_json(std::ostream& os) const {
+    os << "{\"enabled\":" << (enabled ? "true" : "false")
+       << ",\"live_bytes\":" << live_bytes
+       << ",\"peak_bytes\":" << peak_bytes
+       << ",\"heap_bytes\":" << heap_bytes
+       << ",\"chunks\":" << chunks
+       << ",\"chunk_allocs\":" << chunk_allocs
+       << ",\"free_bytes\":" << free_bytes
+       << ",\"pool_bytes\":" << pool_bytes
+       << ",\"leftover_pieces\":" << leftover_pieces
+       << ",\"leftover_bytes\":" << leftover_bytes
+       << ",\"trims\":" << trims
+       << ",\"trimmed_bytes\":" << trimmed_bytes
+       << ",\"large_allocs\":" << large_allocs
+       << ",\"large_frees\":" << large_frees
+       << ",\"large_live_bytes\":" << large_live_bytes
+       << ",\"classes\":[";
+    bool first = true;
+    for(size_t i = 0;i < NClasses;++i) {
+        const alloc_class_stats& c = classes[i];
+        if(c.allocs == 0 && c.free_objects == 0)
+            continue;
+        if(!first)
+            os << ',';
+        first = false;
+        os << "{\"index\":" << i
+           << ",\"size\":" << c.size
+           << ",\"allocs\":" << c.allocs
+           << ",\"frees\":" << c.frees
+           << ",\"refills\":" << c.refills
+           << ",\"live_objects\":" << c.live_objects()
+           << ",\"free_objects\":" << c.free_objects << '}';
+    }
+    os << "]}";
+}
+
+} // MiniSTL
@@ -1,7 +1,13 @@
 #pragma once
 
 #include "alloc.hpp"
+#include "thread_alloc.hpp"
+#include "arena_alloc.hpp"
+#include "Traits/type_traits.hpp"
 #include <climits>
+#include <cstddef>
+#include <cstring>
+#include <utility>
 
 /*
  * class relationship:
@@ -18,6 +24,8 @@ namespace MiniSTL {
 
 #ifdef USE_MALLOC
 using alloc_t = malloc_alloc;
+#elif defined(USE_THREAD_ALLOC)
+using alloc_t = thread_alloc;
 #else
 using alloc_t = default_alloc;
 #endif
@@ -65,6 +73,11 @@ public:
         Alloc_t::deallocate(p, sz * sizeof(T));
     }
 
+    // moves bytes, so only for relocatable T
+    T* reallocate(pointer p, size_type old_sz, size_type new_sz) {
+        return static_cast<T*>(Alloc_t::reallocate(p, old_sz * sizeof(T), new_sz * sizeof(T)));
+    }
+
     size_type max_size() const noexcept { 
         return UINT_MAX / sizeof(T);
     }
@@ -123,6 +136,18 @@ public:
     static void deallocate(T* p) { 
         Alloc_t::deallocate(p, sizeof(T));
     }
+
+    // resize a buffer of old_sz objects to new_sz, contents moved 
+    // bitwise, so only for relocatable T
+    static T* reallocate(T* p, size_t old_sz, size_t new_sz) {
+        if(0 == old_sz)
+            return allocate(new_sz);
+        if(0 == new_sz) {
+            deallocate(p, old_sz);
+            return 0;
+        }
+        return (T*) Alloc_t::reallocate(p, old_sz * sizeof(T), new_sz * sizeof(T));
+    }
 };
 
 
@@ -172,6 +197,12 @@ struct allocAdaptor {
         underlying_alloc.deallocate(p, sz * sizeof(T)); 
     }
 
+    // moves bytes, so only for relocatable T
+    T* reallocate(pointer p, size_type old_sz, size_type new_sz) {
+        return static_cast<T*>(underlying_alloc.reallocate(p, old_sz * sizeof(T), 
+                                                           new_sz * sizeof(T)));
+    }
+
     size_type max_size() const noexcept {
         return UINT_MAX / sizeof(T); 
     }
@@ -261,11 +292,34 @@ struct alloc_traits<T, malloc_alloc> {
     using allocator_type = allocAdaptor<T, malloc_alloc>;
 };
 
+template <class T, class SizeClass>
+struct alloc_traits<T, default_alloc_template<SizeClass>> {
+    static const bool instanceless = true;
+    using alloc_type = simple_alloc<T, default_alloc_template<SizeClass>>;
+    using allocator_type = allocAdaptor<T, default_alloc_template<SizeClass>>;
+};
+
+template <class T, class SizeClass>
+struct alloc_traits<T, thread_alloc_template<SizeClass>> {
+    static const bool instanceless = true;
+    using alloc_type = simple_alloc<T, thread_alloc_template<SizeClass>>;
+    using allocator_type = allocAdaptor<T, thread_alloc_template<SizeClass>>;
+};
+
 template <class T>
-struct alloc_traits<T, default_alloc> {
+struct alloc_traits<T, arena_alloc> {
+    static const bool instanceless = true;
+    using alloc_type = simple_alloc<T, arena_alloc>;
+    using allocator_type = allocAdaptor<T, arena_alloc>;
+};
+
+// Version for simple_alloc, the default allocator of containers.
+// Containers rebind it to their node type.
+template <class T, class U, class Alloc_t>
+struct alloc_traits<T, simple_alloc<U, Alloc_t>> {
     static const bool instanceless = true;
-    using alloc_type = simple_alloc<T, default_alloc>;
-    using allocator_type = allocAdaptor<T, default_alloc>;
+    using alloc_type = simple_alloc<T, Alloc_t>;
+    using allocator_type = allocAdaptor<T, Alloc_t>;
 };
 
 
@@ -278,11 +332,188 @@ struct alloc_traits<T, allocAdaptor<U, malloc_alloc>> {
     using allocator_type = allocAdaptor<T, malloc_alloc>;
 };
 
+template <class T, class U, class SizeClass>
+struct alloc_traits<T, allocAdaptor<U, default_alloc_template<SizeClass>>> {
+    static const bool instanceless = true;
+    using alloc_type = simple_alloc<T, default_alloc_template<SizeClass>>;
+    using allocator_type = allocAdaptor<T, default_alloc_template<SizeClass>>;
+};
+
+template <class T, class U, class SizeClass>
+struct alloc_traits<T, allocAdaptor<U, thread_alloc_template<SizeClass>>> {
+    static const bool instanceless = true;
+    using alloc_type = simple_alloc<T, thread_alloc_template<SizeClass>>;
+    using allocator_type = allocAdaptor<T, thread_alloc_template<SizeClass>>;
+};
+
 template <class T, class U>
-struct alloc_traits<T, allocAdaptor<U, default_alloc>> {
+struct alloc_traits<T, allocAdaptor<U, arena_alloc>> {
     static const bool instanceless = true;
-    using alloc_type = simple_alloc<T, default_alloc>;
-    using allocator_type = allocAdaptor<T, default_alloc>;
+    using alloc_type = simple_alloc<T, arena_alloc>;
+    using allocator_type = allocAdaptor<T, arena_alloc>;
+};
+
+
+// Propagation traits of an allocator: its member typedefs
+// propagate_on_container_copy_assignment, propagate_on_container_move_assignment
+// and propagate_on_container_swap if it has them, false_type otherwise.
+template <class T>
+struct alloc_void { using type = void; };
+
+template <class Alloc_t, class = void>
+struct alloc_pocca { using type = false_type; };
+
+template <class Alloc_t>
+struct alloc_pocca<Alloc_t, typename alloc_void<
+        typename Alloc_t::propagate_on_container_copy_assignment>::type> {
+    using type = typename Alloc_t::propagate_on_container_copy_assignment;
+};
+
+template <class Alloc_t, class = void>
+struct alloc_pocma { using type = false_type; };
+
+template <class Alloc_t>
+struct alloc_pocma<Alloc_t, typename alloc_void<
+        typename Alloc_t::propagate_on_container_move_assignment>::type> {
+    using type = typename Alloc_t::propagate_on_container_move_assignment;
+};
+
+template <class Alloc_t, class = void>
+struct alloc_pocs { using type = false_type; };
+
+template <class Alloc_t>
+struct alloc_pocs<Alloc_t, typename alloc_void<
+        typename Alloc_t::propagate_on_container_swap>::type> {
+    using type = typename Alloc_t::propagate_on_container_swap;
+};
+
+// true_type if allocator has reallocate(p, old_n, new_n), which may
+// grow a buffer in place
+template <class Alloc_t, class = void>
+struct alloc_can_realloc { using type = false_type; };
+
+template <class Alloc_t>
+struct alloc_can_realloc<Alloc_t, typename alloc_void<
+        decltype(std::declval<Alloc_t&>().reallocate(
+            std::declval<typename Alloc_t::pointer>(), size_t(), size_t()))>::type> {
+    using type = true_type;
+};
+
+
+// Base class of containers, holds the allocator used for objects of type T
+// (element, node or buffer of the container).
+// Implementation properties:
+//      1. For an instanceless allocator nothing is stored, allocation goes
+//      through the static alloc_type, and all allocators compare equal.
+//      2. Otherwise an instance of allocator_type rebound to T is stored as
+//      a private base class, so an empty allocator still costs no space.
+//      3. copy_alloc and swap_alloc are dispatched on the propagate tags,
+//      containers call them on copy assignment, move assignment and swap.
+template <class T, class Allocator,
+          bool instanceless = alloc_traits<T, Allocator>::instanceless>
+class alloc_base : private alloc_traits<T, Allocator>::allocator_type {
+public:
+    using allocator_type = Allocator;
+
+    allocator_type get_allocator() const {
+        return allocator_type(get_node_allocator());
+    }
+
+protected:
+    using node_allocator = typename alloc_traits<T, Allocator>::allocator_type;
+    using propagate_on_copy = typename alloc_pocca<node_allocator>::type;
+    using propagate_on_move = typename alloc_pocma<node_allocator>::type;
+    using propagate_on_swap = typename alloc_pocs<node_allocator>::type;
+
+    alloc_base() {}
+    explicit alloc_base(const allocator_type& a) : node_allocator(a) {}
+
+    node_allocator& get_node_allocator() noexcept { return *this; }
+    const node_allocator& get_node_allocator() const noexcept { return *this; }
+
+    T* allocate_n(size_t n) {
+        return n != 0 ? get_node_allocator().allocate(n) : nullptr;
+    }
+
+    void deallocate_n(T* p, size_t n) {
+        if(p)
+            get_node_allocator().deallocate(p, n);
+    }
+
+    // resize buffer p of old_n objects to new_n objects, contents moved
+    // bitwise, so only for relocatable T. Without reallocate in allocator
+    // it allocates, copies and frees.
+    T* reallocate_n(T* p, size_t old_n, size_t new_n) {
+        if(p == nullptr)
+            return allocate_n(new_n);
+        if(new_n == 0) {
+            deallocate_n(p, old_n);
+            return nullptr;
+        }
+        return reallocate_aux(p, old_n, new_n, 
+                              typename alloc_can_realloc<node_allocator>::type());
+    }
+
+    T* reallocate_aux(T* p, size_t old_n, size_t new_n, true_type) {
+        return get_node_allocator().reallocate(p, old_n, new_n);
+    }
+
+    T* reallocate_aux(T* p, size_t old_n, size_t new_n, false_type) {
+        T* res = allocate_n(new_n);
+        memcpy(static_cast<void*>(res), static_cast<const void*>(p), 
+               (old_n < new_n ? old_n : new_n) * sizeof(T));
+        deallocate_n(p, old_n);
+        return res;
+    }
+
+    bool alloc_equal(const alloc_base& x) const {
+        return get_node_allocator() == x.get_node_allocator();
+    }
+
+    void copy_alloc(const alloc_base& x, true_type) {
+        get_node_allocator() = x.get_node_allocator();
+    }
+    void copy_alloc(const alloc_base&, false_type) {}
+
+    void swap_alloc(alloc_base& x, true_type) {
+        node_allocator tmp = get_node_allocator();
+        get_node_allocator() = x.get_node_allocator();
+        x.get_node_allocator() = tmp;
+    }
+    void swap_alloc(alloc_base&, false_type) {}
+};
+
+template <class T, class Allocator>
+class alloc_base<T, Allocator, true> {
+public:
+    using allocator_type = Allocator;
+
+    allocator_type get_allocator() const { return allocator_type(); }
+
+protected:
+    using node_allocator = typename alloc_traits<T, Allocator>::allocator_type;
+    using alloc_type = typename alloc_traits<T, Allocator>::alloc_type;
+    using propagate_on_copy = false_type;
+    using propagate_on_move = false_type;
+    using propagate_on_swap = false_type;
+
+    alloc_base() {}
+    explicit alloc_base(const allocator_type&) {}
+
+    node_allocator get_node_allocator() const noexcept { return node_allocator(); }
+
+    static T* allocate_n(size_t n) { return alloc_type::allocate(n); }
+
+    static void deallocate_n(T* p, size_t n) { alloc_type::deallocate(p, n); }
+
+    static T* reallocate_n(T* p, size_t old_n, size_t new_n) {
+        return alloc_type::reallocate(p, old_n, new_n);
+    }
+
+    bool alloc_equal(const alloc_base&) const { return true; }
+
+    void copy_alloc(const alloc_base&, false_type) {}
+    void swap_alloc(alloc_base&, false_type) {}
 };
 
 } // MiniSTL
\ No newline at end of file
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "alloc.hpp"
+#include "Traits/type_traits.hpp"
+#include <cstddef>
+#include <cstdint>
+
+
+namespace MiniSTL {
+
+// Monotonic arena, a bump pointer allocator
+// Implementation properties:
+//      1. allocate carves memory from the current buffer by bumping a
+//      pointer. When the buffer runs out, a new block twice as big as the
+//      last one is got from malloc_alloc.
+//      2. deallocate does nothing. Memory only comes back in bulk by reset()
+//      or release(), so freeing every object of a container costs O(1).
+//      3. The first buffer may be supplied by caller(e.g. on stack), it is
+//      never freed by arena.
+//      4. reset() keeps the newest block for reuse so that a request loop
+//      settles without touching malloc, release() gives all blocks back.
+// Note: an arena is not thread-safe, use one arena per thread.
+class monotonic_arena {
+private:
+    struct block {
+        block* next;
+        size_t size;    // usable bytes after header
+    };
+
+    enum arena_setting {
+        BLOCK_HEADER = (sizeof(block) + alignof(std::max_align_t) - 1)
+                        & ~(alignof(std::max_align_t) - 1),
+        MIN_BLOCK = 1024
+    };
+
+    char* cur;
+    char* end;
+    block* blocks;      // blocks got from malloc_alloc, newest first
+    block* spare;       // block kept by reset(), not in use
+    char* initial_buf;
+    size_t initial_size;
+    size_t next_size;   // usable bytes of next block
+
+    static char* block_space(block* b) {
+        return reinterpret_cast<char*>(b) + BLOCK_HEADER;
+    }
+
+    static char* align_up(char* p, size_t align) {
+        const uintptr_t v = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((v + align - 1) & ~(uintptr_t(align) - 1));
+    }
+
+    // switch to a block which can hold sz bytes aligned to align
+    void grow(size_t sz, size_t align);
+
+public:
+    explicit monotonic_arena(size_t block_size = 4096)
+        : cur(nullptr), end(nullptr), blocks(nullptr), spare(nullptr),
+          initial_buf(nullptr), initial_size(0),
+          next_size(block_size < MIN_BLOCK ? static_cast<size_t>(MIN_BLOCK) : block_size) {}
+
+    monotonic_arena(void* buf, size_t size, size_t block_size = 4096)
+        : cur(reinterpret_cast<char*>(buf)), end(cur + size),
+          blocks(nullptr), spare(nullptr),
+          initial_buf(cur), initial_size(size),
+          next_size(block_size < MIN_BLOCK ? static_cast<size_t>(MIN_BLOCK) : block_size) {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena() { release(); }
+
+    void* allocate(size_t sz, size_t align = alignof(std::max_align_t)) {
+        char* p = align_up(cur, align);
+        if(p == nullptr || p > end || sz > static_cast<size_t>(end - p)) {
+            grow(sz, align);
+            p = align_up(cur, align);
+        }
+        cur = p + sz;
+        return p;
+    }
+
+    void deallocate(void* /* p */, size_t /* sz */) {}
+
+    // grow the newest allocation in place if possible
+    void* reallocate(void* p, size_t old_sz, size_t new_sz,
+                     size_t align = alignof(std::max_align_t)) {
+        char* cp = reinterpret_cast<char*>(p);
+        if(cp + old_sz == cur && new_sz <= static_cast<size_t>(end - cp)) {
+            cur = cp + new_sz;
+            return p;
+        }
+        if(new_sz <= old_sz)
+            return p;
+        void* res = allocate(new_sz, align);
+        memcpy(res, p, old_sz);
+        return res;
+    }
+
+    // drop all objects, keep the newest block for later requests
+    void reset();
+
+    // drop all objects, give all blocks back
+    void release();
+
+    // bytes got from malloc_alloc, spare block included
+    size_t upstream_bytes() const;
+};
+
+inline void monotonic_arena::grow(size_t sz, size_t align) {
+    const size_t need = sz + align;
+    block* b;
+    if(spare && spare->size >= need) {
+        b = spare;
+        spare = nullptr;
+    } else {
+        while(next_size < need)
+            next_size *= 2;
+        b = reinterpret_cast<block*>(malloc_alloc::allocate(next_size + BLOCK_HEADER));
+        b->size = next_size;
+        next_size *= 2;
+    }
+    b->next = blocks;
+    blocks = b;
+    cur = block_space(b);
+    end = cur + b->size;
+}
+
+inline void monotonic_arena::reset() {
+    if(blocks) {
+        if(spare)
+            malloc_alloc::deallocate(spare, spare->size + BLOCK_HEADER);
+        spare = blocks;
+        blocks = blocks->next;
+        while(blocks) {
+            block* next = blocks->next;
+            malloc_alloc::deallocate(blocks, blocks->size + BLOCK_HEADER);
+            blocks = next;
+        }
+    }
+    cur = initial_buf;
+    end = initial_buf + initial_size;
+}
+
+inline void monotonic_arena::release() {
+    reset();
+    if(spare) {
+        malloc_alloc::deallocate(spare, spare->size + BLOCK_HEADER);
+        spare = nullptr;
+    }
+}
+
+inline size_t monotonic_arena::upstream_bytes() const {
+    size_t n = spare ? spare->size + BLOCK_HEADER : 0;
+    for(block* b = blocks;b;b = b->next)
+        n += b->size + BLOCK_HEADER;
+    return n;
+}
+
+
+// SGI-style allocator on top of the arena of the current arena_scope
+// Implementation properties:
+//      1. allocate takes memory from the arena bound to the calling thread
+//      by the innermost arena_scope, and throws std::bad_alloc when there
+//      is none. An object of size sz is aligned to the biggest power of two
+//      dividing sz, which is enough for any type of that size.
+//      2. deallocate does nothing, objects die when their arena resets.
+// So a container using arena_alloc must be filled inside a scope, and
+// must not be used after its arena is reset or destroyed:
+//      monotonic_arena arena;
+//      {
+//          arena_scope scope(arena);
+//          map<int, int, less<int>, arena_alloc> m;
+//          ...
+//      }
+//      arena.reset();
+class arena_alloc {
+    friend class arena_scope;
+
+private:
+    static thread_local monotonic_arena* current_arena;
+
+    static size_t natural_align(size_t sz) {
+        const size_t align = sz & (~sz + 1);
+        return align == 0 || align > alignof(std::max_align_t)
+                ? alignof(std::max_align_t) : align;
+    }
+
+public:
+    static void* allocate(size_t sz) {
+        if(current_arena == nullptr)
+            throw std::bad_alloc();
+        return current_arena->allocate(sz, natural_align(sz));
+    }
+
+    static void deallocate(void* /* p */, size_t /* sz */) {}
+
+    static void* reallocate(void* p, size_t old_sz, size_t new_sz) {
+        if(current_arena == nullptr)
+            throw std::bad_alloc();
+        return current_arena->reallocate(p, old_sz, new_sz, natural_align(new_sz));
+    }
+
+    static monotonic_arena* current() { return current_arena; }
+};
+
+thread_local monotonic_arena* arena_alloc::current_arena = nullptr;
+
+// bind an arena to arena_alloc of the calling thread until end of scope,
+// scopes nest
+class arena_scope {
+private:
+    monotonic_arena* prev;
+
+public:
+    explicit arena_scope(monotonic_arena& arena)
+        : prev(arena_alloc::current_arena) {
+        arena_alloc::current_arena = &arena;
+    }
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+
+    ~arena_scope() { arena_alloc::current_arena = prev; }
+};
+
+
+// Standard-conforming allocator holding a pointer to its arena
+// Implementation properties:
+//      1. Unlike arena_alloc, every container keeps its own arena, so
+//      containers in different arenas can live side by side without scopes.
+//      2. A default constructed arena_allocator has no arena and goes to
+//      malloc_alloc, deallocate frees its objects as usual then.
+//      3. Allocators compare equal when they point to the same arena.
+//      Containers never propagate it: a container copy/move assigned from
+//      another arena copies elements into its own arena.
+template <class T>
+class arena_allocator {
+    template <class U> friend class arena_allocator;
+
+private:
+    monotonic_arena* arena;
+
+public:
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using propagate_on_container_copy_assignment = false_type;
+    using propagate_on_container_move_assignment = false_type;
+    using propagate_on_container_swap = false_type;
+
+    template <class U> struct rebind {
+        typedef arena_allocator<U> other;
+    };
+
+    arena_allocator() noexcept : arena(nullptr) {}
+    arena_allocator(monotonic_arena& a) noexcept : arena(&a) {}
+    template <class U>
+    arena_allocator(const arena_allocator<U>& x) noexcept : arena(x.arena) {}
+
+    pointer address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+
+    T* allocate(size_type n, const void* = 0) {
+        if(n == 0)
+            return nullptr;
+        if(arena == nullptr)
+            return static_cast<T*>(malloc_alloc::allocate(n * sizeof(T)));
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(pointer p, size_type n) {
+        if(arena == nullptr)
+            malloc_alloc::deallocate(p, n * sizeof(T));
+    }
+
+    // the newest object of an arena grows in place
+    T* reallocate(pointer p, size_type old_n, size_type new_n) {
+        if(arena == nullptr)
+            return static_cast<T*>(malloc_alloc::reallocate(p, old_n * sizeof(T), new_n * sizeof(T)));
+        return static_cast<T*>(arena->reallocate(p, old_n * sizeof(T), new_n * sizeof(T), alignof(T)));
+    }
+
+    size_type max_size() const noexcept {
+        return size_t(-1) / sizeof(T);
+    }
+
+    void construct(pointer p, const T& v) { new(p) T(v); }
+    void destroy(pointer p) { p->~T(); }
+
+    monotonic_arena* resource() const noexcept { return arena; }
+
+    template <class U>
+    bool operator==(const arena_allocator<U>& x) const noexcept {
+        return arena == x.arena;
+    }
+
+    template <class U>
+    bool operator!=(const arena_allocator<U>& x) const noexcept {
+        return arena != x.arena;
+    }
+};
+
+} // MiniSTL
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+
+#include "Allocator/allocator.hpp"
+#include "Container/Associative/map.hpp"
+#include "Container/Sequence/list.hpp"
+
+/*  build: g++ -std=c++11 -O2 -pthread -I. Allocator/bench_alloc.cpp
+ *
+ *  stress:
+ *      every thread keeps a window of SLOTS live objects of random
+ *      size in [1, 128] and keeps replacing a random one of them,
+ *      ops/sec counts allocate + deallocate calls of all threads.
+ *      1. malloc_alloc: thread-safe through malloc
+ *      2. default_alloc: single-threaded, shared only under a global lock
+ *      3. thread_alloc: per-thread cache in front of default_alloc
+ *
+ *  burst and clear:
+ *      fill a map and a list with BURST elements, destroy them, then
+ *      report RSS before and after default_alloc::trim(), then dump
+ *      default_alloc::stats(), build with -DUSE_ALLOC_STATS for counters
+ */
+
+using namespace MiniSTL;
+
+const size_t SLOTS = 1024;
+const size_t ROUNDS = 2000000;
+const int BURST = 1000000;
+
+// resident set size in bytes, read from /proc
+size_t rss() {
+    size_t pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if(f) {
+        if(fscanf(f, "%zu %zu", &pages, &resident) != 2)
+            resident = 0;
+        fclose(f);
+    }
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void burst_and_clear() {
+    const size_t before = rss();
+    {
+        map<int, int> m;
+        list<int> l;
+        for(int i = 0;i < BURST;++i) {
+            m.insert(make_pair(i, i));
+            l.push_back(i);
+        }
+        std::cout << "burst:    rss " << rss() / 1024 << " KiB" << std::endl;
+    }
+    std::cout << "cleared:  rss " << rss() / 1024 << " KiB, chunks hold "
+              << default_alloc::heap_bytes() / 1024 << " KiB" << std::endl;
+    const size_t released = default_alloc::trim();
+    std::cout << "trimmed:  rss " << rss() / 1024 << " KiB, released "
+              << released / 1024 << " KiB (baseline " << before / 1024
+              << " KiB)" << std::endl;
+    default_alloc::stats().dump_text(std::cout);
+}
+
+struct locked_default_alloc {
+    static std::mutex lock;
+
+    static void* allocate(size_t sz) {
+        std::lock_guard<std::mutex> guard(lock);
+        return default_alloc::allocate(sz);
+    }
+
+    static void deallocate(void* p, size_t sz) {
+        std::lock_guard<std::mutex> guard(lock);
+        default_alloc::deallocate(p, sz);
+    }
+};
+
+std::mutex locked_default_alloc::lock;
+
+template <class Alloc>
+void stress(unsigned seed) {
+    void* ptr[SLOTS];
+    size_t sz[SLOTS];
+    for(size_t i = 0;i < SLOTS;++i) {
+        sz[i] = 1 + rand_r(&seed) % 128;
+        ptr[i] = Alloc::allocate(sz[i]);
+    }
+    for(size_t r = 0;r < ROUNDS;++r) {
+        size_t i = rand_r(&seed) % SLOTS;
+        Alloc::deallocate(ptr[i], sz[i]);
+        sz[i] = 1 + rand_r(&seed) % 128;
+        ptr[i] = Alloc::allocate(sz[i]);
+    }
+    for(size_t i = 0;i < SLOTS;++i)
+        Alloc::deallocate(ptr[i], sz[i]);
+}
+
+template <class Alloc>
+double run(unsigned nthreads) {
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(unsigned t = 0;t < nthreads;++t)
+        threads.emplace_back(stress<Alloc>, t + 1);
+    for(auto& th : threads)
+        th.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    double ops = 2.0 * (ROUNDS + SLOTS) * nthreads;
+    return ops / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    unsigned max_threads = argc > 1 ? static_cast<unsigned>(atoi(argv[1]))
+                                    : std::thread::hardware_concurrency();
+    if(max_threads == 0)
+        max_threads = 4;
+
+    burst_and_clear();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "single thread, unlocked default_alloc: "
+              << run<default_alloc>(1) / 1e6 << " Mops/s" << std::endl;
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "malloc_alloc"
+              << std::setw(16) << "default+lock"
+              << std::setw(16) << "thread_alloc"
+              << "   (Mops/s)" << std::endl;
+    for(unsigned n = 1;n <= max_threads;n *= 2) {
+        std::cout << std::setw(8) << n
+                  << std::setw(16) << run<malloc_alloc>(n) / 1e6
+                  << std::setw(16) << run<locked_default_alloc>(n) / 1e6
+                  << std::setw(16) << run<thread_alloc>(n) / 1e6
+                  << std::endl;
+    }
+    return 0;
+}
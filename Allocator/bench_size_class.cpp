@@ -0,0 +1,119 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+#include "Allocator/allocator.hpp"
+#include "Container/Associative/map.hpp"
+#include "Container/Associative/hash_map.hpp"
+#include "Container/Sequence/list.hpp"
+
+/*  build, once per size class setting:
+ *      g++ -std=c++11 -O2 -I. Allocator/bench_size_class.cpp
+ *      g++ -std=c++11 -O2 -I. -DUSE_GEOMETRIC_SIZE_CLASS Allocator/bench_size_class.cpp
+ *      g++ -std=c++11 -O2 -I. -DUSE_MALLOC Allocator/bench_size_class.cpp
+ *
+ *  for every value size, fill map, hash_map and list with N elements,
+ *  look every key up once(map and hash_map), then destroy the container.
+ *  reports ns per element of each phase and RSS when all runs are done.
+ *  With linear size classes(8..128) nodes of values bigger than about
+ *  100 bytes fall through to malloc, geometric classes keep nodes up to
+ *  4 KiB in freelists.
+ */
+
+using namespace MiniSTL;
+
+const int N = 50000;
+
+template <size_t Size>
+struct value {
+    char payload[Size];
+};
+
+// resident set size in bytes, read from /proc
+size_t rss() {
+    size_t pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if(f) {
+        if(fscanf(f, "%zu %zu", &pages, &resident) != 2)
+            resident = 0;
+        fclose(f);
+    }
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+double ns_per_elem(bench_clock::time_point begin, bench_clock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - begin).count() / N;
+}
+
+// volatile sink so lookups are not optimized away
+volatile size_t found = 0;
+
+template <class Map, class V>
+void bench_map(const char* name) {
+    auto t0 = bench_clock::now();
+    Map* m = new Map;
+    for(int i = 0;i < N;++i)
+        m->insert(make_pair(i, V()));
+    auto t1 = bench_clock::now();
+    for(int i = 0;i < N;++i)
+        found = found + (m->find(i) != m->end());
+    auto t2 = bench_clock::now();
+    delete m;
+    auto t3 = bench_clock::now();
+    std::cout << std::setw(10) << name << std::setw(8) << sizeof(V)
+              << std::setw(12) << ns_per_elem(t0, t1)
+              << std::setw(12) << ns_per_elem(t1, t2)
+              << std::setw(12) << ns_per_elem(t2, t3) << std::endl;
+}
+
+template <class List, class V>
+void bench_list() {
+    auto t0 = bench_clock::now();
+    List* l = new List;
+    V e = V();
+    for(int i = 0;i < N;++i)
+        l->push_back(e);
+    auto t1 = bench_clock::now();
+    delete l;
+    auto t2 = bench_clock::now();
+    std::cout << std::setw(10) << "list" << std::setw(8) << sizeof(V)
+              << std::setw(12) << ns_per_elem(t0, t1)
+              << std::setw(12) << "-"
+              << std::setw(12) << ns_per_elem(t1, t2) << std::endl;
+}
+
+template <size_t Size>
+void bench_size() {
+    using V = value<Size>;
+    bench_map<map<int, V>, V>("map");
+    bench_map<hash_map<int, V, hash<int>, equal_to<int>>, V>("hash_map");
+    bench_list<list<V>, V>();
+}
+
+int main() {
+#if defined(USE_MALLOC)
+    std::cout << "malloc_alloc" << std::endl;
+#elif defined(USE_GEOMETRIC_SIZE_CLASS)
+    std::cout << "default_alloc, geometric size classes" << std::endl;
+#else
+    std::cout << "default_alloc, linear size classes" << std::endl;
+#endif
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(10) << "container" << std::setw(8) << "value"
+              << std::setw(12) << "fill" << std::setw(12) << "find"
+              << std::setw(12) << "destroy" << "   (ns/elem)" << std::endl;
+    // rounds twice so the second one runs on warm freelists
+    for(int round = 0;round < 2;++round) {
+        bench_size<16>();
+        bench_size<64>();
+        bench_size<200>();
+        bench_size<480>();
+        bench_size<1000>();
+    }
+    std::cout << "rss " << rss() / 1024 << " KiB" << std::endl;
+    return 0;
+}
@@ -22,7 +22,7 @@ inline void destroy(ForwardIterator first, ForwardIterator last) {
 }
 
 template <class ForwardIterator>
-inline void __destroy_aux(ForwardIterator first, ForwardIterator last, true_type) {}
+inline void __destroy_aux(ForwardIterator, ForwardIterator, true_type) {}
 
 template <class ForwardIterator>
 inline void __destroy_aux(ForwardIterator first, ForwardIterator last, false_type) {
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "Allocator/allocator.hpp"
+
+namespace MiniSTL {
+
+// stateful allocator for the container tests. Each instance has an id,
+// every block records the id it was allocated with and is checked
+// against the allocator which frees it. live[id] counts the blocks not
+// freed yet. Propagate selects propagate_on_container_copy_assignment,
+// _move_assignment and _swap at once.
+template <class T, class Propagate = true_type>
+class test_alloc {
+public:
+    enum { MAX_ID = 8 };
+    static size_t live[MAX_ID];
+
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using propagate_on_container_copy_assignment = Propagate;
+    using propagate_on_container_move_assignment = Propagate;
+    using propagate_on_container_swap = Propagate;
+
+    template <class U> struct rebind {
+        typedef test_alloc<U, Propagate> other;
+    };
+
+    explicit test_alloc(int i = 0) noexcept : id(i) {}
+    template <class U>
+    test_alloc(const test_alloc<U, Propagate>& x) noexcept : id(x.id) {}
+
+    T* allocate(size_type n, const void* = 0) {
+        if(n == 0)
+            return nullptr;
+        // header keeps T aligned
+        char* p = static_cast<char*>(malloc(HEADER + n * sizeof(T)));
+        if(p == nullptr)
+            throw std::bad_alloc();
+        *reinterpret_cast<int*>(p) = id;
+        test_alloc<char, Propagate>::live[id] += 1;
+        return reinterpret_cast<T*>(p + HEADER);
+    }
+
+    void deallocate(pointer p, size_type) {
+        if(p == nullptr)
+            return;
+        char* b = reinterpret_cast<char*>(p) - HEADER;
+        if(*reinterpret_cast<int*>(b) != id) {
+            fprintf(stderr, "test_alloc: block of allocator %d freed by %d\n",
+                    *reinterpret_cast<int*>(b), id);
+            abort();
+        }
+        test_alloc<char, Propagate>::live[id] -= 1;
+        free(b);
+    }
+
+    size_type max_size() const noexcept {
+        return size_t(-1) / sizeof(T);
+    }
+
+    void construct(pointer p, const T& v) { new(p) T(v); }
+    void destroy(pointer p) { p->~T(); }
+
+    // blocks of allocator id not freed yet
+    static size_t blocks(int i) { return test_alloc<char, Propagate>::live[i]; }
+
+    template <class U>
+    bool operator==(const test_alloc<U, Propagate>& x) const noexcept {
+        return id == x.id;
+    }
+    template <class U>
+    bool operator!=(const test_alloc<U, Propagate>& x) const noexcept {
+        return id != x.id;
+    }
+
+    int id;
+
+private:
+    enum { HEADER = 16 };
+};
+
+template <class T, class Propagate>
+size_t test_alloc<T, Propagate>::live[test_alloc<T, Propagate>::MAX_ID];
+
+} // MiniSTL
@@ -0,0 +1,222 @@
+#pragma once
+
+#include "alloc.hpp"
+#include <mutex>
+
+
+namespace MiniSTL {
+
+// Thread-caching allocator, a front end of default_alloc
+// Implementation properties:
+//      1. Every thread owns a cache of NFREELISTS freelists. allocate and
+//      deallocate only touch the cache of the calling thread, so the
+//      common path takes no lock at all.
+//      2. An empty cache freelist is refilled with a batch of BATCH objects
+//      from the central pool(freelists and chunks of default_alloc) under
+//      central_lock. A cache freelist holding more than HIGH_WATER objects
+//      flushes a batch back to the central pool.
+//      3. When a thread exits, its cache is given back to the central pool,
+//      so objects can be allocated in one thread and freed in another.
+//      4. Request of size > MAX_BYTES goes to malloc_alloc directly.
+//      5. trim() flushes the cache of the calling thread, then trims central
+//      pool. Objects cached by other threads keep their chunks alive.
+// Note: default_alloc itself stays single-threaded. thread_alloc serializes
+// its own access to the central pool, so don't call default_alloc directly
+// from several threads while thread_alloc is in use.
+template <class SizeClass>
+class thread_alloc_template {
+private:
+    using central = default_alloc_template<SizeClass>;
+    using obj = typename central::obj;
+
+    enum {
+        ALIGN = central::ALIGN,
+        MAX_BYTES = central::MAX_BYTES,
+        NFREELISTS = central::NFREELISTS
+    };
+
+    enum cache_setting {
+        BATCH = 32,
+        HIGH_WATER = 2 * BATCH
+    };
+
+    struct cache {
+        obj* freelist[NFREELISTS];
+        size_t count[NFREELISTS];
+
+        cache() {
+            for(size_t i = 0;i < NFREELISTS;++i) {
+                freelist[i] = nullptr;
+                count[i] = 0;
+            }
+        }
+
+        // give all cached objects back to central pool
+        ~cache() {
+            for(size_t i = 0;i < NFREELISTS;++i) {
+                if(count[i] != 0)
+                    flush(*this, i, count[i]);
+            }
+        }
+    };
+
+    static thread_local cache tcache;
+    static std::mutex central_lock;
+
+    // return an obj of size sz, and put the rest of a batch
+    // fetched from central pool into the cache
+    static void* refill(size_t sz);
+
+    // unlink n objects from cache freelist idx and return them to central pool
+    static void flush(cache& c, size_t idx, size_t n);
+
+public:
+
+    static void* allocate(size_t sz);
+
+    static void deallocate(void* p, size_t sz);
+
+    static void* reallocate(void* p, size_t old_sz, size_t new_sz);
+
+    static size_t trim(size_t pad = 0);
+
+    static void set_high_water(size_t bytes) {
+        std::lock_guard<std::mutex> guard(central_lock);
+        central::set_high_water(bytes);
+    }
+
+    // stats of central pool, objects in thread caches are neither
+    // live nor free there, see alloc_stats::unaccounted_bytes()
+    static alloc_stats<NFREELISTS> stats() {
+        std::lock_guard<std::mutex> guard(central_lock);
+        return central::stats();
+    }
+};
+
+using thread_alloc = thread_alloc_template<default_size_class>;
+
+template <class SizeClass>
+thread_local typename thread_alloc_template<SizeClass>::cache 
+thread_alloc_template<SizeClass>::tcache;
+
+template <class SizeClass>
+std::mutex thread_alloc_template<SizeClass>::central_lock;
+
+template <class SizeClass>
+void* thread_alloc_template<SizeClass>::refill(size_t sz) {
+    const size_t idx = central::freelist_index(sz);
+    obj* first = nullptr;
+    obj* last = nullptr;
+    size_t n = 0;
+    {
+        std::lock_guard<std::mutex> guard(central_lock);
+        obj* volatile* my_freelist = central::freelist + idx;
+        first = *my_freelist;
+        if(first) {
+            // case1: take up to BATCH objects off central freelist
+            last = first;
+            for(n = 1;n < BATCH && last->freelist_link;++n)
+                last = last->freelist_link;
+            *my_freelist = last->freelist_link;
+            last->freelist_link = nullptr;
+        } else {
+            // case2: carve a fresh batch from central chunk
+            int nobjs = BATCH;
+            char* chunk = central::chunk_alloc(sz, nobjs);
+            first = reinterpret_cast<obj*>(chunk);
+            n = static_cast<size_t>(nobjs);
+        }
+    }
+
+    // chaining a carved chunk is done out of the lock
+    if(last == nullptr) {
+        obj* cur = first;
+        for(size_t i = 1;i < n;++i) {
+            obj* next = reinterpret_cast<obj*>(reinterpret_cast<char*>(cur) + sz);
+            cur->freelist_link = next;
+            cur = next;
+        }
+        cur->freelist_link = nullptr;
+    }
+
+    tcache.freelist[idx] = first->freelist_link;
+    tcache.count[idx] = n - 1;
+    return reinterpret_cast<void*>(first);
+}
+
+template <class SizeClass>
+void thread_alloc_template<SizeClass>::flush(cache& c, size_t idx, size_t n) {
+    obj* first = c.freelist[idx];
+    obj* last = first;
+    for(size_t i = 1;i < n;++i)
+        last = last->freelist_link;
+    c.freelist[idx] = last->freelist_link;
+    c.count[idx] -= n;
+
+    std::lock_guard<std::mutex> guard(central_lock);
+    obj* volatile* my_freelist = central::freelist + idx;
+    last->freelist_link = *my_freelist;
+    *my_freelist = first;
+}
+
+template <class SizeClass>
+inline void* thread_alloc_template<SizeClass>::allocate(size_t sz) {
+    if(sz > static_cast<size_t>(MAX_BYTES))
+        return malloc_alloc::allocate(sz);
+    // size 0 takes the smallest class, freelist_index(0) wraps around
+    if(sz == 0)
+        sz = 1;
+
+    const size_t idx = central::freelist_index(sz);
+    obj* o = tcache.freelist[idx];
+    if(o == nullptr)
+        return refill(central::class_size(sz));
+    tcache.freelist[idx] = o->freelist_link;
+    --tcache.count[idx];
+    return reinterpret_cast<void*>(o);
+}
+
+template <class SizeClass>
+inline void thread_alloc_template<SizeClass>::deallocate(void* p, size_t sz) {
+    if(sz > static_cast<size_t>(MAX_BYTES)) {
+        malloc_alloc::deallocate(p, sz);
+        return;
+    }
+    if(sz == 0)
+        sz = 1;
+
+    const size_t idx = central::freelist_index(sz);
+    obj* o = reinterpret_cast<obj*>(p);
+    o->freelist_link = tcache.freelist[idx];
+    tcache.freelist[idx] = o;
+    if(++tcache.count[idx] > HIGH_WATER)
+        flush(tcache, idx, BATCH);
+}
+
+template <class SizeClass>
+void* thread_alloc_template<SizeClass>::reallocate(void* p, size_t old_sz, size_t new_sz) {
+    void* res;
+    if(old_sz > static_cast<size_t>(MAX_BYTES) && new_sz > static_cast<size_t>(MAX_BYTES)) {
+        return malloc_alloc::realloc(p, old_sz, new_sz);
+    }
+    if(old_sz <= static_cast<size_t>(MAX_BYTES) && new_sz <= static_cast<size_t>(MAX_BYTES)
+       && central::freelist_index(old_sz) == central::freelist_index(new_sz)) {
+        return p;
+    }
+    res = allocate(new_sz);
+    memcpy(res, p, new_sz > old_sz ? old_sz : new_sz);
+    deallocate(p, old_sz);
+    return res;
+}
+
+template <class SizeClass>
+size_t thread_alloc_template<SizeClass>::trim(size_t pad) {
+    for(size_t i = 0;i < NFREELISTS;++i) {
+        if(tcache.count[i] != 0)
+            flush(tcache, i, tcache.count[i]);
+    }
+    std::lock_guard<std::mutex> guard(central_lock);
+    return central::trim(pad);
+}
+
+} // MiniSTL
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstring>
+#include <utility>
 #include "construct.hpp"
 #include "Traits/type_traits.hpp"
 #include "Iterator/iterator_base.hpp"
@@ -26,7 +27,7 @@ inline ForwardIter __uninitialized_copy_aux(InputIter first, InputIter last, For
 
 template <class InputIter, class ForwardIter>
 inline ForwardIter __uninitialized_copy_aux(InputIter first, InputIter last, ForwardIter res, true_type) {
-    return copy(first, last, res);
+    return MiniSTL::copy(first, last, res);
 }
 
 inline char* uninitialized_copy(const char* first, const char* last, char* res) {
@@ -62,7 +63,7 @@ inline pair<RandomAccessIter, ForwardIter>
 __uninitialized_copy_n_aux(RandomAccessIter first, Size n, ForwardIter res, random_access_iterator_tag) {
     RandomAccessIter last = first + n;
     return pair<RandomAccessIter, ForwardIter>(last, 
-                uninitialized_copy(first, last, res));
+                MiniSTL::uninitialized_copy(first, last, res));
 }
 
 
@@ -82,7 +83,7 @@ inline void __uninitialized_fill_aux(ForwardIter first, ForwardIter last, const
 
 template <class ForwardIter, class T>
 inline void __uninitialized_fill_aux(ForwardIter first, ForwardIter last, const T& x, true_type) {
-    fill(first, last, x);
+    MiniSTL::fill(first, last, x);
 }
 
 // fill [first, first + n) with x
@@ -102,7 +103,57 @@ inline ForwardIter __uninitialized_fill_n_aux(ForwardIter first, Size n, const T
 
 template <class ForwardIter, class Size, class T>
 inline ForwardIter __uninitialized_fill_n_aux(ForwardIter first, Size n, const T& x, true_type) {
-    fill_n(first, n, x);   
+    return MiniSTL::fill_n(first, n, x);
+}
+
+// relocate [first, last) into raw memory at res, as vector does on
+// reallocation
+// Implementation properties:
+//      1. relocatable types(see is_relocatable) are copied bitwise by a
+//      single memcpy.
+//      2. others are moved if their move constructor is noexcept, copied
+//      otherwise, so a throw leaves the source untouched. Objects already
+//      constructed in res are destroyed before rethrow.
+// Source objects must then be ended by destroy_relocated, never destroy.
+template <class T>
+inline T* uninitialized_relocate(T* first, T* last, T* res) {
+    return __uninitialized_relocate_aux(first, last, res, relocatable_t<T>());
+}
+
+template <class T>
+inline T* __uninitialized_relocate_aux(T* first, T* last, T* res, true_type) {
+    const size_t n = static_cast<size_t>(last - first);
+    if(n != 0)
+        memcpy(static_cast<void*>(res), static_cast<const void*>(first), n * sizeof(T));
+    return res + n;
+}
+
+template <class T>
+inline T* __uninitialized_relocate_aux(T* first, T* last, T* res, false_type) {
+    T* cur = res;
+    try {
+        for(;first != last;++first, ++cur)
+            new (static_cast<void*>(cur)) T(std::move_if_noexcept(*first));
+    } catch(...) {
+        MiniSTL::destroy(res, cur);
+        throw;
+    }
+    return cur;
+}
+
+// end the source objects of uninitialized_relocate, bitwise relocated
+// objects live on in their new memory and are not destroyed
+template <class T>
+inline void destroy_relocated(T* first, T* last) {
+    __destroy_relocated_aux(first, last, relocatable_t<T>());
+}
+
+template <class T>
+inline void __destroy_relocated_aux(T*, T*, true_type) {}
+
+template <class T>
+inline void __destroy_relocated_aux(T* first, T* last, false_type) {
+    MiniSTL::destroy(first, last);
 }
 
 
@@ -1,10 +1,12 @@
 /*
  * avl-tree invariant:
- *      1. balance_factor(node) = height(left) - height(right)
+ *      1. balance_factor(node) = height(right) - height(left)
  *         for each node, | balance_factor | <= 1
  *      2. height(empty tree) = 0;
- *  when arriving at the insert pos, the height of new node's ancestors 
- *  will adjust, if disobey the invariants, we must rotate the tree.
+ *  each node keeps its balance factor. An insert or erase changes the
+ *  height of one subtree, the factors are updated on the way up until
+ *  a height stays the same; a factor reaching 2 or -2 is fixed by a
+ *  single or double rotation.
  * 
  *  Special design:
  *  add a node header for iterator operation
@@ -13,7 +15,7 @@
  *      3. header->left = leftmost, aka, min, begin()
  *      4. header->right = rightmost, aka, max
  *      5. header = end()
- *      6. header.height = -1;
+ *      6. header's balance factor is avl_tree_header
  *  we can get begin() in O(1), instead of O(log2(N))
  */
 
@@ -24,24 +26,41 @@
 #include "Function/function.hpp"
 #include "Iterator/iterator.hpp"
 #include "Util/pair.hpp"
+#include "tree_node_base.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <climits>
 
 namespace MiniSTL {
 
-template <class Value>
+using avl_tree_balance_t = signed char;
+// marks the header, no node has this balance factor
+const avl_tree_balance_t avl_tree_header = 2;
+
+// nodes are read and written through get_parent/set_parent and
+// get_balance/set_balance, whatever their layout. A packed node(see
+// tree_node_base.hpp) keeps balance factor + 1 in the two low bits of
+// the parent pointer.
+template <class Value, class Packed = tree_node_packed_t>
 struct avl_tree_node {
-    using height_t = int;
+    using balance_t = avl_tree_balance_t;
     using node_ptr_t = avl_tree_node*;
 
-    height_t height;
+    balance_t balance;
     node_ptr_t parent;
     node_ptr_t left;
     node_ptr_t right;
     Value value_field;
 
+    node_ptr_t get_parent() const { return parent; }
+    void set_parent(node_ptr_t p) { parent = p; }
+    balance_t get_balance() const { return balance; }
+    void set_balance(balance_t b) { balance = b; }
+    // both at once, for a new node
+    void set_parent_balance(node_ptr_t p, balance_t b) { parent = p; balance = b; }
+
     static node_ptr_t minimum(node_ptr_t x) {
         while(x->left)
             x = x->left;
@@ -53,15 +72,45 @@ struct avl_tree_node {
             x = x->right;
         return x;
     }
+};
 
-    void updateHeight() {
-        height = 1 + max(left ? left->height : 0, 
-                         right ? right->height : 0);
+template <class Value>
+struct avl_tree_node<Value, true_type> {
+    using balance_t = avl_tree_balance_t;
+    using node_ptr_t = avl_tree_node*;
+
+    // parent pointer | (balance factor + 1)
+    uintptr_t parent_balance;
+    node_ptr_t left;
+    node_ptr_t right;
+    Value value_field;
+
+    node_ptr_t get_parent() const {
+        return reinterpret_cast<node_ptr_t>(parent_balance & ~uintptr_t(3));
+    }
+    void set_parent(node_ptr_t p) {
+        parent_balance = reinterpret_cast<uintptr_t>(p) | (parent_balance & 3);
+    }
+    balance_t get_balance() const {
+        return static_cast<balance_t>(parent_balance & 3) - 1;
+    }
+    void set_balance(balance_t b) {
+        parent_balance = (parent_balance & ~uintptr_t(3)) | uintptr_t(b + 1);
+    }
+    void set_parent_balance(node_ptr_t p, balance_t b) {
+        parent_balance = reinterpret_cast<uintptr_t>(p) | uintptr_t(b + 1);
     }
 
-    bool Balanced() {
-        return !((left->height - right->height < 2) && 
-                 (right->height - left->height < 2));
+    static node_ptr_t minimum(node_ptr_t x) {
+        while(x->left)
+            x = x->left;
+        return x;
+    }
+
+    static node_ptr_t maximum(node_ptr_t x) {
+        while(x->right)
+            x = x->right;
+        return x;
     }
 };
 
@@ -97,10 +146,10 @@ struct avl_tree_iterator {
             // case2: no right subtree
             // up until node is left of p
             // case 2.1: p is next
-            node_ptr_t p = node->parent;
+            node_ptr_t p = node->get_parent();
             while(node == p->right) {
                 node = p;
-                p = p->parent;
+                p = p->get_parent();
             }
             // special case2.2: node = root withour right and 
             // p == header, next is header, aka end();
@@ -110,7 +159,7 @@ struct avl_tree_iterator {
     }
 
     void decre() {
-        if(node->height == -1 && node->parent->parent == node) {
+        if(node->get_balance() == avl_tree_header) {
             // special case1: node = header, 
             // prev = mostright, aka max;
             node = node->right;
@@ -122,10 +171,10 @@ struct avl_tree_iterator {
             // up until node is right of p, p is prev
             // ? if node = begin(), aks min, after loop p =  
             // ? header and node = root, then node will be end()
-            node_ptr_t p = node->parent;
+            node_ptr_t p = node->get_parent();
             while(node == p->left) {
                 node = p;
-                p = p->parent;
+                p = p->get_parent();
             }
             node = p;
         }
@@ -155,11 +204,14 @@ struct avl_tree_iterator {
 
 template <class Key, class Value, class KeyOfValue, 
           class Compare, class Alloc = simple_alloc<Value>>
-class avl_tree {
+class avl_tree : protected alloc_base<avl_tree_node<Value>, Alloc> {
+private:
+    using base = alloc_base<avl_tree_node<Value>, Alloc>;
+
 protected:
     using node_t = avl_tree_node<Value>;
     using node_ptr_t = avl_tree_node<Value>*;
-    using node_alloc = simple_alloc<node_t>;
+    using balance_t = avl_tree_balance_t;
 
 public:
     using key_type = Key;
@@ -178,7 +230,7 @@ public:
 
 public:
     // observior
-    allocator_type get_allocator() { return allocator_type(); }
+    allocator_type get_allocator() const { return base::get_allocator(); }
     Compare key_compare() const { return key_comp; }
 
 protected:
@@ -188,8 +240,8 @@ protected:
     Compare key_comp;
 
 protected:
-    node_ptr_t get_node() { return node_alloc::allocate(1); }
-    void put_node(node_ptr_t p) { node_alloc::deallocate(p, 1); }
+    node_ptr_t get_node() { return this->allocate_n(1); }
+    void put_node(node_ptr_t p) { this->deallocate_n(p, 1); }
 
     node_ptr_t create_node(const Value& val) {
         node_ptr_t tmp = get_node();
@@ -213,11 +265,10 @@ protected:
         return tmp;
     }
 
-    // clone a new node with value and color
+    // clone a new node with value and balance factor
     node_ptr_t clone_node(node_ptr_t p) {
         node_ptr_t tmp = create_node(p->value_field);
-        tmp->parent = nullptr;
-        tmp->height = p->height;
+        tmp->set_parent_balance(nullptr, p->get_balance());
         tmp->left = nullptr;
         tmp->right = nullptr;
         return tmp;
@@ -227,7 +278,8 @@ protected:
         { destroy(&p->value_field); put_node(p); }
 
 protected:
-    node_ptr_t& root() const { return header->parent; }
+    node_ptr_t root() const { return header->get_parent(); }
+    void set_root(node_ptr_t x) { header->set_parent(x); }
     node_ptr_t& leftmost() const { return header->left; }
     node_ptr_t& rightmost() const { return header->right; }
 
@@ -242,51 +294,83 @@ protected:
     static node_ptr_t maximum(node_ptr_t p)
         { return node_t::maximum(p); }
 
+    static iterator mutable_iterator(const_iterator it)
+        { return iterator(it.node); }
+
 private:
     void empty_initialize() {
         header = get_node();
         // used to distinguish header from root, when iterator++
-        header->height = -1;
-        root() = nullptr;
+        header->set_parent_balance(nullptr, avl_tree_header);
         leftmost() = header;
         rightmost() = header;
     }
 
-    void clear() {
-        if(node_count != 0) {
-            erase(root());
-            root() = nullptr;
-            leftmost() = header;
-            rightmost() = header;
-            node_count = 0;
+    node_ptr_t copy(node_ptr_t x, node_ptr_t p);
+
+    // header belongs to the allocator, so it is rebuilt when
+    // an unequal allocator takes over
+    void replace_alloc(const avl_tree& x) {
+        if(!this->alloc_equal(x)) {
+            clear();
+            put_node(header);
+            this->copy_alloc(x, true_type());
+            empty_initialize();
+        } else {
+            this->copy_alloc(x, true_type());
         }
     }
 
-    node_ptr_t copy(node_ptr_t x, node_ptr_t p);
+    void copy_assign_alloc(const avl_tree& x, true_type) { replace_alloc(x); }
+
+    void copy_assign_alloc(const avl_tree&, false_type) {}
+
+    void move_assign(avl_tree& x, true_type) {
+        clear();
+        replace_alloc(x);
+        MiniSTL::swap(header, x.header);
+        MiniSTL::swap(node_count, x.node_count);
+    }
+
+    // nodes can only be taken from an equal allocator,
+    // otherwise elements are copied into our own nodes
+    void move_assign(avl_tree& x, false_type) {
+        if(this->alloc_equal(x)) {
+            clear();
+            MiniSTL::swap(header, x.header);
+            MiniSTL::swap(node_count, x.node_count);
+        } else {
+            *this = x;
+            x.clear();
+        }
+    }
 
 public:
     //  ctor/dtor/assign
     avl_tree() : node_count(0), key_comp() { empty_initialize(); }
-    avl_tree(const Compare& c) : node_count(0), key_comp(c)
-        { empty_initialize(); }
+    explicit avl_tree(const Compare& c, const allocator_type& a = allocator_type())
+        : base(a), node_count(0), key_comp(c) { empty_initialize(); }
     
-    avl_tree(const avl_tree& x) : node_count(0), key_comp(x.key_comp) {
+    avl_tree(const avl_tree& x) 
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
         if(x.root() == nullptr)
             empty_initialize();
         else {
             header = get_node();
-            header->height = -1;
-            root() = copy(x.root(), header);
+            header->set_parent_balance(nullptr, avl_tree_header);
+            set_root(copy(x.root(), header));
             leftmost() = node_t::minimum(root());
             rightmost() = node_t::maximum(root());
         }
         node_count = x.node_count;
     }
 
+    // x keeps an empty tree, so it can still be used or destroyed
     avl_tree(avl_tree&& x) 
-        : header(x.header), node_count(x.node_count), key_comp(x.key_comp) {
-        x.node_count = 0;
-        x.header = nullptr;
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
+        empty_initialize();
+        MiniSTL::swap(header, x.header);
+        MiniSTL::swap(node_count, x.node_count);
     }
 
     ~avl_tree() {
@@ -294,8 +378,15 @@ public:
         put_node(header);
     }
 
-    avl_tree& operator==(const avl_tree& x);
-    avl_tree& operator==(avl_tree&& x);
+    avl_tree& operator=(const avl_tree& x);
+
+    avl_tree& operator=(avl_tree&& x) {
+        if(&x != this) {
+            key_comp = x.key_comp;
+            move_assign(x, typename base::propagate_on_move());
+        }
+        return *this;
+    }
 
 public:
     // element access
@@ -313,8 +404,8 @@ public:
     const_reverse_iterator  rend() const noexcept
         { return const_reverse_iterator(begin()); }
  
-    const_iterator          cbegin() noexcept { return leftmost(); }
-    const_iterator          cend() noexcept { return header(); }
+    const_iterator          cbegin() const noexcept { return leftmost(); }
+    const_iterator          cend() const noexcept { return header; }
     const_reverse_iterator  crbegin() const noexcept
         { return const_reverse_iterator(end()); }
     const_reverse_iterator  crend() const noexcept
@@ -330,18 +421,30 @@ public:
 public:
     //swap
     void swap(avl_tree& y) {
-        swap(header, y.header);
-        swap(node_count, y.node_count);
-        swap(key_comp, y.key_comp);
+        this->swap_alloc(y, typename base::propagate_on_swap());
+        MiniSTL::swap(header, y.header);
+        MiniSTL::swap(node_count, y.node_count);
+        MiniSTL::swap(key_comp, y.key_comp);
+    }
+
+    void clear() {
+        if(node_count != 0) {
+            erase(root());
+            set_root(nullptr);
+            leftmost() = header;
+            rightmost() = header;
+            node_count = 0;
+        }
     }
 
 private:
-    void avl_tree_rotate_left(node_ptr_t x, node_ptr_t& root);
-	void avl_tree_rotate_right(node_ptr_t x, node_ptr_t& root);
-	void avl_tree_rebalance(node_ptr_t x, node_ptr_t& root);
-	node_ptr_t 
-    avl_tree_rebalance_for_erase(node_ptr_t z, node_ptr_t& root, 
-                node_ptr_t& leftmost, node_ptr_t& rightmost);
+    void avl_tree_rotate_left(node_ptr_t x);
+	void avl_tree_rotate_right(node_ptr_t x);
+	node_ptr_t avl_tree_rotate_left_right(node_ptr_t x);
+	node_ptr_t avl_tree_rotate_right_left(node_ptr_t x);
+	void avl_tree_rebalance(node_ptr_t x);
+	void avl_tree_rebalance_after_erase(node_ptr_t x, bool left_shrunk);
+	node_ptr_t avl_tree_rebalance_for_erase(node_ptr_t z);
 
     iterator insert(node_ptr_t x, node_ptr_t y, const Value& val);
     iterator insert(node_ptr_t x, node_ptr_t y, Value&& val);
@@ -353,11 +456,15 @@ public:
 
 	iterator insert_unique(iterator pos, const Value& val);
     iterator insert_unique(iterator pos, Value&& val); 
+    iterator insert_unique(const_iterator pos, const Value& val)
+        { return insert_unique(mutable_iterator(pos), val); }
+    iterator insert_unique(const_iterator pos, Value&& val)
+        { return insert_unique(mutable_iterator(pos), std::move(val)); }
 
+	// an empty tree is built in O(n) from sorted forward iterators
 	template<class InputIt>
 	void insert_unique(InputIt first, InputIt last) {
-        while(first != last)
-            insert_unique(*first++);
+        insert_range(first, last, true, iterator_category_t<InputIt>());
     }
 
     iterator insert_equal(const Value& val);
@@ -365,13 +472,48 @@ public:
 
 	iterator insert_equal(iterator pos, const Value& val);
     iterator insert_equal(iterator pos, Value&& val);
+    iterator insert_equal(const_iterator pos, const Value& val)
+        { return insert_equal(mutable_iterator(pos), val); }
+    iterator insert_equal(const_iterator pos, Value&& val)
+        { return insert_equal(mutable_iterator(pos), std::move(val)); }
 
 	template<class InputIt>
 	void insert_equal(InputIt first, InputIt last) {
-       while(first != last)
-            insert_equal(*first++);
+        insert_range(first, last, false, iterator_category_t<InputIt>());
+    }
+
+private:
+    template <class InputIt>
+    void insert_range(InputIt first, InputIt last, bool unique, input_iterator_tag) {
+        for(;first != last;++first) {
+            if(unique)
+                insert_unique(*first);
+            else
+                insert_equal(*first);
+        }
     }
 
+    template <class ForwardIt>
+    void insert_range(ForwardIt first, ForwardIt last, bool unique, forward_iterator_tag) {
+        size_type n = 0;
+        if(node_count == 0 && sorted_range(first, last, unique, n))
+            build_sorted(first, n);
+        else
+            insert_range(first, last, unique, input_iterator_tag());
+    }
+
+    // whether [first, last) is sorted, strictly if unique, n is
+    // its length when it is
+    template <class ForwardIt>
+    bool sorted_range(ForwardIt first, ForwardIt last, bool unique, size_type& n) const;
+
+    // link n sorted values into an empty tree
+    template <class ForwardIt>
+    void build_sorted(ForwardIt first, size_type n);
+
+    template <class ForwardIt>
+    node_ptr_t build_subtree(ForwardIt& first, size_type n, int& height);
+
 private:
     // erase without rebalance
     void erase(node_ptr_t x) {
@@ -385,22 +527,18 @@ private:
     }
 
 public:
-    // erase and rebalance
+    // erase
 	iterator erase(iterator pos) {
-        node_ptr_t y = avl_tree_rebalance_for_erase(pos.node,
-                                                   root(),
-                                                   leftmost(),
-                                                   rightmost());
-        iterator i(y);
-        ++i;
-        destroy_node(y);
+        iterator next = pos;
+        ++next;
+        destroy_node(avl_tree_rebalance_for_erase(pos.node));
         --node_count;
-        return i;
+        return next;
     }
 
 	size_type erase(const Key& x) {
         pair<iterator, iterator> p = equal_range(x);
-        size_type n = distance(p.first, p.second);
+        size_type n = MiniSTL::distance(p.first, p.second);
         erase(p.first, p.second);
         return n;
     }
@@ -410,139 +548,160 @@ public:
             clear();
         else {
             while(first != last)
-                erase(*first++);
+                erase(first++);
         }
+        return last;
     }
 
-public:
-    // find
-    // if x exists, return first x, else return end();
-	iterator find(const Key& k) noexcept {
+    iterator erase(const_iterator pos) { return erase(mutable_iterator(pos)); }
+    iterator erase(const_iterator first, const_iterator last)
+        { return erase(mutable_iterator(first), mutable_iterator(last)); }
+
+private:
+    // last node not less than k, header if none
+    template <class K>
+    node_ptr_t lower_bound_node(const K& k) const noexcept {
         node_ptr_t y = header;
         node_ptr_t x = root();
 
         while(x) {
-            if(key_comp(key(x), k)) // k > x
+            if(key_comp(key(x), k))
                 x = x->right;
-            else { // k <= x,set y = x,last node not less than k
+            else {
+                // if k <= x, set y is last node which y >= k
                 y = x;
                 x = x->left;
             }
         }
-
-        iterator i(y);
-        // if found, y == k, but can't use y == k, because
-        // y may be end(), that is empty tree
-        // if found, y == k and 2 cases no found:
-        //      a. empty tree
-        //      b. k < y and y is last node which k <= y
-        return (i == end() || key_comp(k, key(y))) ? end() : i;
+        // if k > max, y header, aka end()
+        return y;
     }
 
-	const_iterator find(const Key& k) const noexcept {
+    // first node greater than k, header if none
+    template <class K>
+    node_ptr_t upper_bound_node(const K& k) const noexcept {
         node_ptr_t y = header;
         node_ptr_t x = root();
 
         while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
+            if(key_comp(k, key(x))) {
+                // k < x, set y is first node which k < y
                 y = x;
                 x = x->left;
             }
+            else
+                x = x->right;
         }
 
-        const_iterator i(y);
-        return (i == end() || key_comp(k, key(y))) ? end() : i;
+        return y;
     }
 
-	size_type count(const Key& k) const noexcept {
-        pair<iterator, iterator> p = equal_range(k);
-        return distance(p.first, p.second);
+    template <class K>
+    node_ptr_t find_node(const K& k) const noexcept {
+        node_ptr_t y = lower_bound_node(k);
+        // if found, y == k, but can't use y == k, because
+        // y may be end(), that is empty tree
+        // if found, y == k and 2 cases no found:
+        //      a. empty tree
+        //      b. k < y and y is last node which k <= y
+        return (y == header || key_comp(k, key(y))) ? header : y;
     }
 
-	iterator lower_bound(const Key& k) noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
+public:
+    // find
+    // if x exists, return first x, else return end();
+	iterator find(const Key& k) noexcept { return iterator(find_node(k)); }
 
-        while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
-                // if k <= x, set y is last node which y >= k
-                y = x;
-                x = x->left;
-            }
-        }
-        // if k > max, y header, aka end()
-        return iterator(y);
+	const_iterator find(const Key& k) const noexcept {
+        return const_iterator(find_node(k));
     }
 
-	const_iterator lower_bound(const Key& k) const noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
+	size_type count(const Key& k) const noexcept {
+        pair<const_iterator, const_iterator> p = equal_range(k);
+        return MiniSTL::distance(p.first, p.second);
+    }
 
-        while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
-                y = x;
-                x = x->left;
-            }
-        }
+	iterator lower_bound(const Key& k) noexcept {
+        return iterator(lower_bound_node(k));
+    }
 
-        return const_iterator(y);
+	const_iterator lower_bound(const Key& k) const noexcept {
+        return const_iterator(lower_bound_node(k));
     }
 
 	iterator upper_bound(const Key& k) noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(k, key(x))) {
-                // k < x, set y is first node which k < y
-                y = x;
-                x = x->left;
-            }
-            else
-                x = x->right;
-        }
-
-        return iterator(y);
+        return iterator(upper_bound_node(k));
     }
 
 	const_iterator upper_bound(const Key& k) const noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(k, key(x))) {
-                // k < x, set y is first node which k < y
-                y = x;
-                x = x->left;
-            }
-            else
-                x = x->right;
-        }
-
-        return const_iterator(y);
+        return const_iterator(upper_bound_node(k));
     }
 
 	pair<iterator,iterator> 
     equal_range(const Key& k) noexcept {
-        return make_pair(lower_bound(k), upper_bound(k));
+        return MiniSTL::make_pair(lower_bound(k), upper_bound(k));
     }
 
 	pair<const_iterator,const_iterator> 
     equal_range(const Key& k) const noexcept {
-        return make_pair(lower_bound(k), upper_bound(k));
+        return MiniSTL::make_pair(lower_bound(k), upper_bound(k));
+    }
+
+    // heterogeneous lookup of any k which Compare orders against Key,
+    // only if Compare declares is_transparent(e.g. less<>)
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& k) noexcept {
+        return iterator(find_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& k) const noexcept {
+        return const_iterator(find_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& k) const noexcept {
+        return MiniSTL::distance(const_iterator(lower_bound_node(k)),
+                        const_iterator(upper_bound_node(k)));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& k) noexcept {
+        return iterator(lower_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& k) const noexcept {
+        return const_iterator(lower_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& k) noexcept {
+        return iterator(upper_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& k) const noexcept {
+        return const_iterator(upper_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& k) noexcept {
+        return MiniSTL::make_pair(iterator(lower_bound_node(k)), iterator(upper_bound_node(k)));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& k) const noexcept {
+        return MiniSTL::make_pair(const_iterator(lower_bound_node(k)),
+                         const_iterator(upper_bound_node(k)));
     }
 };
 
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 inline bool operator==(const avl_tree<Key, Value, KeyOfValue, Compare, Alloc>& x, avl_tree<Key, Value, KeyOfValue, Compare, Alloc>& y){
-	return x.size() == y.size() && equal(x.cbegin(), x.cend(), y.cbegin());
+	return x.size() == y.size() && MiniSTL::equal(x.cbegin(), x.cend(), y.cbegin());
 }
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -552,7 +711,7 @@ inline bool operator!=(const avl_tree<Key, Value, KeyOfValue, Compare, Alloc>& x
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 inline bool operator<(const avl_tree<Key, Value, KeyOfValue, Compare, Alloc>& x, avl_tree<Key, Value, KeyOfValue, Compare, Alloc>& y){
-	return std::lexicographical_compare(x.cbegin(), x.cend(),                                        y.cbegin(), y.cend());
+	return MiniSTL::lexicographical_compare(x.cbegin(), x.cend(), y.cbegin(), y.cend());
 }
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -579,44 +738,22 @@ template<class Key, class Value, class KeyOfValue,
          class Compare, class Alloc>
 avl_tree<Key, Value, KeyOfValue, Compare, Alloc>&
 avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-operator==(const avl_tree& x) {
+operator=(const avl_tree& x) {
     if(&x != this) {
         clear();
+        copy_assign_alloc(x, typename base::propagate_on_copy());
         node_count = 0;
         key_comp = x.key_comp;
         if(x.root()) {
-            root() = copy(x.root(), header);
+            set_root(copy(x.root(), header));
             leftmost() = node_t::minimum(root());
             rightmost() = node_t::maximum(root());
             node_count = x.node_count;
         } else {
-            root() = nullptr;
-            leftmost() = header;
-            rightmost() = header;
-        }
-    }
-    return *this;
-}
-
-template<class Key, class Value, class KeyOfValue, 
-         class Compare, class Alloc>
-avl_tree<Key, Value, KeyOfValue, Compare, Alloc>&
-avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-operator==(avl_tree&& x) {
-    if(&x != this) {
-        clear();
-        node_count = 0;
-        key_comp = x.key_comp;
-        if(x.root()) {
-            header = x.header;
-            node_count = x.node_count;
-        } else {
-            root() = nullptr;
+            set_root(nullptr);
             leftmost() = header;
             rightmost() = header;
         }
-        x.node_count = 0;
-        x.header = nullptr;
     }
     return *this;
 }
@@ -627,7 +764,7 @@ typename avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
 avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
 copy(node_ptr_t x, node_ptr_t p) {
     node_ptr_t top = clone_node(x);
-    top->parent = p;
+    top->set_parent(p);
 
     try {
         // copy right child recursively
@@ -641,7 +778,7 @@ copy(node_ptr_t x, node_ptr_t p) {
         while(x) {
             node_ptr_t y = clone_node(x);
             p->left = y;
-            y->parent = p;
+            y->set_parent(p);
             if(x->right)
                 y->right = copy(x->right, y);
             p = y;
@@ -658,83 +795,261 @@ copy(node_ptr_t x, node_ptr_t p) {
 
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
-void avl_tree<Key, Value, KeyOfValue, Compare, Alloc>:: avl_tree_rotate_left(node_ptr_t x, node_ptr_t& root) {
+template <class ForwardIt>
+bool avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+sorted_range(ForwardIt first, ForwardIt last, bool unique, size_type& n) const {
+    n = 0;
+    if(first == last)
+        return true;
+    ForwardIt prev = first;
+    for(++first, n = 1;first != last;++first, ++prev, ++n) {
+        if(unique ? !key_comp(KeyOfValue()(*prev), KeyOfValue()(*first))
+                  : key_comp(KeyOfValue()(*first), KeyOfValue()(*prev)))
+            return false;
+    }
+    return true;
+}
+
+// the middle value is the root, the halves are built the same way, so
+// the heights of two siblings differ by at most one
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+template <class ForwardIt>
+void avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+build_sorted(ForwardIt first, size_type n) {
+    if(n == 0)
+        return;
+    int height = 0;
+    set_root(build_subtree(first, n, height));
+    root()->set_parent(header);
+    leftmost() = node_t::minimum(root());
+    rightmost() = node_t::maximum(root());
+    node_count = n;
+}
+
+// nodes are created in order, first is advanced past the subtree
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+template <class ForwardIt>
+typename avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
+avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+build_subtree(ForwardIt& first, size_type n, int& height) {
+    height = 0;
+    if(n == 0)
+        return nullptr;
+    int left_height = 0, right_height = 0;
+    node_ptr_t l = build_subtree(first, (n - 1) / 2, left_height);
+    node_ptr_t x = nullptr;
+    try {
+        x = create_node(*first);
+    } catch(std::exception&) {
+        erase(l);
+        throw;
+    }
+    ++first;
+    x->set_parent_balance(nullptr, 0);
+    x->left = l;
+    x->right = nullptr;
+    if(l)
+        l->set_parent(x);
+
+    try {
+        x->right = build_subtree(first, n - 1 - (n - 1) / 2, right_height);
+    } catch(std::exception&) {
+        erase(x);
+        throw;
+    }
+    if(x->right)
+        x->right->set_parent(x);
+    x->set_balance(static_cast<balance_t>(right_height - left_height));
+    height = (left_height > right_height ? left_height : right_height) + 1;
+    return x;
+}
+
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+void avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::avl_tree_rotate_left(node_ptr_t x) {
     node_ptr_t y = x->right;
     x->right = y->left;
     if(y->left)
-        y->left->parent = x;
-    y->parent = x->parent;
+        y->left->set_parent(x);
+    y->set_parent(x->get_parent());
 
-    if(x == root)
-        root = y;
-    else if(x == x->parent->left)
-        x->parent->left = y;
+    if(x == root())
+        set_root(y);
+    else if(x == x->get_parent()->left)
+        x->get_parent()->left = y;
     else
-        x->parent->right = y;
+        x->get_parent()->right = y;
     y->left = x;
-    x->parent = y;
-    x->updateHeight();
-    y->updateHeight();
+    x->set_parent(y);
 }
 
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
 void avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-avl_tree_rotate_right(node_ptr_t x, node_ptr_t& root) {
+avl_tree_rotate_right(node_ptr_t x) {
     node_ptr_t y = x->left;
     x->left = y->right;
     if(y->right)
-        y->right->parent = x;
-    y->parent = x->parent;
+        y->right->set_parent(x);
+    y->set_parent(x->get_parent());
 
-    if(x == root)
-        root = y;
-    else if(x == x->parent->left)
-        x->parent->left = y;
+    if(x == root())
+        set_root(y);
+    else if(x == x->get_parent()->left)
+        x->get_parent()->left = y;
     else
-        x->parent->right = y;
+        x->get_parent()->right = y;
     y->right = x;
-    x->parent = y;
-    x->updateHeight();
-    y->updateHeight();
+    x->set_parent(y);
+}
+
+// x has a right child y which is left heavy, rotate y right then x
+// left, return the new top. Factors are those after an insert or an
+// erase: the new top is balanced and takes over
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+typename avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
+avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+avl_tree_rotate_right_left(node_ptr_t x) {
+    node_ptr_t y = x->right;
+    node_ptr_t w = y->left;
+    avl_tree_rotate_right(y);
+    avl_tree_rotate_left(x);
+    const balance_t b = w->get_balance();
+    x->set_balance(b > 0 ? -1 : 0);
+    y->set_balance(b < 0 ? 1 : 0);
+    w->set_balance(0);
+    return w;
 }
 
-// rebalance until root tree obey invariants
+// symmetrical
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+typename avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
+avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+avl_tree_rotate_left_right(node_ptr_t x) {
+    node_ptr_t y = x->left;
+    node_ptr_t w = y->right;
+    avl_tree_rotate_left(y);
+    avl_tree_rotate_right(x);
+    const balance_t b = w->get_balance();
+    x->set_balance(b < 0 ? 1 : 0);
+    y->set_balance(b > 0 ? -1 : 0);
+    w->set_balance(0);
+    return w;
+}
+
+// x is a new leaf, its subtree grew by one, update ancestors upward
+// until a subtree keeps its height
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
 void avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-avl_tree_rebalance(node_ptr_t x, node_ptr_t& root) {
-    while(x != root && x->parent->height == -1) {
-        if(x->parent->parent->Balanced()) {
-            // balanced, just need to adjust height upward
-            x->updateHeight();
-            x = x->parent;
+avl_tree_rebalance(node_ptr_t x) {
+    while(x != root()) {
+        node_ptr_t p = x->get_parent();
+        if(x == p->left) {
+            if(p->get_balance() > 0) {
+                // right was higher, now equal
+                p->set_balance(0);
+                return;
+            } else if(p->get_balance() == 0) {
+                // p grew, go up
+                p->set_balance(-1);
+                x = p;
+            } else {
+                // left too high, rotation restores the height of p
+                if(x->get_balance() > 0)
+                    avl_tree_rotate_left_right(p);
+                else {
+                    avl_tree_rotate_right(p);
+                    p->set_balance(0);
+                    x->set_balance(0);
+                }
+                return;
+            }
         } else {
-            // need rotate
-            if(x->parent == x->parent->parent->left) {
-                // case 1 : insert in left
-                if(x == x->parent->right) {
-                    // case 1.1: insert pos is inside
-                    // first rorate left, turn to case2.2
-                    x = x->parent;
-                    avl_tree_rotate_left(x, root);
-                } 
-                // case 1.2: insert pos is outside
-                // then rotate right
-                avl_tree_rotate_right(x->parent->parent, root);
+            // symmetrical
+            if(p->get_balance() < 0) {
+                p->set_balance(0);
+                return;
+            } else if(p->get_balance() == 0) {
+                p->set_balance(1);
+                x = p;
             } else {
-                // father is grandfather's right
-                // symmetrical case2:
-                if(x == x->parent->left) {
-                    x = x->parent;
-                    avl_tree_rotate_right(x, root);
+                if(x->get_balance() < 0)
+                    avl_tree_rotate_right_left(p);
+                else {
+                    avl_tree_rotate_left(p);
+                    p->set_balance(0);
+                    x->set_balance(0);
                 }
-                avl_tree_rotate_left(x->parent->parent, root);
+                return;
+            }
+        }
+    }
+}
+
+// a subtree of x shrank by one, left or right, update x and its
+// ancestors upward until a subtree keeps its height
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+void avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+avl_tree_rebalance_after_erase(node_ptr_t x, bool left_shrunk) {
+    while(x != header) {
+        if(left_shrunk) {
+            if(x->get_balance() < 0) {
+                // x shrank, go up
+                x->set_balance(0);
+            } else if(x->get_balance() == 0) {
+                // x keeps its height
+                x->set_balance(1);
+                return;
+            } else {
+                // right too high
+                node_ptr_t s = x->right;
+                if(s->get_balance() == 0) {
+                    // single rotation, height kept
+                    avl_tree_rotate_left(x);
+                    s->set_balance(-1);
+                    x->set_balance(1);
+                    return;
+                } else if(s->get_balance() > 0) {
+                    avl_tree_rotate_left(x);
+                    s->set_balance(0);
+                    x->set_balance(0);
+                    x = s;
+                } else
+                    x = avl_tree_rotate_right_left(x);
+            }
+        } else {
+            // symmetrical
+            if(x->get_balance() > 0) {
+                x->set_balance(0);
+            } else if(x->get_balance() == 0) {
+                x->set_balance(-1);
+                return;
+            } else {
+                node_ptr_t s = x->left;
+                if(s->get_balance() == 0) {
+                    avl_tree_rotate_right(x);
+                    s->set_balance(1);
+                    x->set_balance(-1);
+                    return;
+                } else if(s->get_balance() < 0) {
+                    avl_tree_rotate_right(x);
+                    s->set_balance(0);
+                    x->set_balance(0);
+                    x = s;
+                } else
+                    x = avl_tree_rotate_left_right(x);
             }
-            // after rotate, sub-tree's height not change
-            // dont't need to update or adjust upward
-            break;
         }
+        // the subtree of x is one lower
+        node_ptr_t p = x->get_parent();
+        left_shrunk = x == p->left;
+        x = p;
     }
 }
 
@@ -743,11 +1058,11 @@ template<class Key, class Value, class KeyOfValue,
          class Compare, class Alloc>
 typename avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
 avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-avl_tree_rebalance_for_erase(node_ptr_t z, node_ptr_t& root, 
-                node_ptr_t& leftmost, node_ptr_t& rightmost) {
+avl_tree_rebalance_for_erase(node_ptr_t z) {
     node_ptr_t y = z;
     node_ptr_t x = nullptr; // x one of y's child, may be null
     node_ptr_t x_parent = nullptr; 
+    bool left_shrunk = false; // x replaced left child of x_parent
 
     if(y->left) { // z has at least one child
         if(y->right) { // z has two child
@@ -761,90 +1076,61 @@ avl_tree_rebalance_for_erase(node_ptr_t z, node_ptr_t& root,
         x = y->right; // x may be null
     
     if(y != z) { // z has successor y, relink y in place of z
-        z->left->parent = y;
+        z->left->set_parent(y);
         y->left = z->left;
         if(y == z->right)
             x_parent = y;
         else { // y is not right of z directly
-            x_parent = y->parent; 
+            x_parent = y->get_parent(); 
             if(x)
-                x->parent = y->parent; // set x's parent = y's parent
-            x->parent->left = x; // y is y's parent 's left
+                x->set_parent(x_parent); // set x's parent = y's parent
+            x_parent->left = x; // y is y's parent 's left
+            left_shrunk = true;
             y->right = z->right;
-            z->right->parent = y;
+            z->right->set_parent(y);
         }
 
         // revise parent
-        if(root == z)
-            root = y;
-        else if(z->parent->left == z)
-            z->parent->left = y;
+        if(root() == z)
+            set_root(y);
+        else if(z->get_parent()->left == z)
+            z->get_parent()->left = y;
         else
-            z->parent->right = y;
+            z->get_parent()->right = y;
 
-        y->parent = z->parent;
-        swap(y->height, z->height);
+        y->set_parent(z->get_parent());
+        y->set_balance(z->get_balance());
         y = z; // y now points to node to be actually deleted
     } else { // y == z, z has no successor
-        x_parent = y->parent;
+        x_parent = y->get_parent();
         if(x)
-            x->parent = y->parent;
+            x->set_parent(x_parent);
         
-        if(root == z)
-            root = x; // set root be x, one of child of z
-        else if(z->parent->left == z)
-            z->parent->left = x;
-        else 
-            z->parent->right = x;
-
-        if(leftmost == z) {
+        if(root() == z)
+            set_root(x); // set root be x, one of child of z
+        else if(z->get_parent()->left == z) {
+            z->get_parent()->left = x;
+            left_shrunk = true;
+        } else 
+            z->get_parent()->right = x;
+
+        if(leftmost() == z) {
             if(z->right) // x is z's right, set leftmost min(x)
-                leftmost = node_t::minimum(x);
+                leftmost() = node_t::minimum(x);
             else   // z has no child
-                leftmost = z->parent; // set leftmost z->parent
+                leftmost() = z->get_parent(); // set leftmost z->parent
         }
-        if(rightmost == z) {
+        if(rightmost() == z) {
             if(z->left)
-                rightmost = node_t::maximum(x);
+                rightmost() = node_t::maximum(x);
             else
-                rightmost = z->parent;
+                rightmost() = z->get_parent();
         }
     }
 
     // now y has replaced z, x has replaced previous y
-    // we must adjust x'previous parent and accessor
-    x = x_parent;
-    while(x != root && x->parent->height == -1) {
-        if(x->parent->parent->Balanced()) {
-            // balanced, just need to adjust height upward
-            x->udpateHeight();
-            x = x->parent;
-        } else {
-            // need rotate
-            if(x->parent == x->parent->parent->left) {
-                // case 1 : insert in left
-                if(x == x->parent->right) {
-                    // case 1.1: insert pos is inside
-                    // first rorate left, turn to case2.2
-                    x = x->parent;
-                    avl_tree_rotate_left(x, root);
-                } 
-                // case 1.2: insert pos is outside
-                // then rotate right
-                avl_tree_rotate_right(x->parent->parent, root);
-            } else {
-                // father is grandfather's right
-                // symmetrical case2:
-                if(x == x->parent->left) {
-                    x = x->parent;
-                    avl_tree_rotate_right(x, root);
-                }
-                avl_tree_rotate_left(x->parent->parent, root);
-            }
-            // after rotate, we need adjust x's grandparents's accessors
-            x = x->parent;
-        }
-    }
+    // the subtree of x_parent on the side of x shrank
+    avl_tree_rebalance_after_erase(x_parent, left_shrunk);
     return y;
 }
 
@@ -860,7 +1146,7 @@ insert(node_ptr_t x, node_ptr_t y, const Value& val) {
         y->left = z; // if y = header, set leftmost = z;
 
         if(y == header) {
-            root() = z;
+            set_root(z);
             rightmost() = z;
         } else if(y == leftmost()) 
             leftmost() = z;
@@ -869,11 +1155,10 @@ insert(node_ptr_t x, node_ptr_t y, const Value& val) {
         if(y == rightmost())
             rightmost() = z;
     }
-    z->parent = y;
+    z->set_parent_balance(y, 0);
     z->left = nullptr;
     z->right = nullptr;
-    z->height = 1;
-    avl_tree_rebalance(z, root());
+    avl_tree_rebalance(z);
     ++node_count;
     return iterator(z);
 }
@@ -889,7 +1174,7 @@ insert(node_ptr_t x, node_ptr_t y, Value&& val) {
         y->left = z;
 
         if(y == header) {
-            root() = z;
+            set_root(z);
             rightmost() = z;
         } else if(y == leftmost()) 
             leftmost() = z;
@@ -898,11 +1183,10 @@ insert(node_ptr_t x, node_ptr_t y, Value&& val) {
         if(y == rightmost())
             rightmost() = z;
     }
-    z->parent = y;
+    z->set_parent_balance(y, 0);
     z->left = nullptr;
     z->right = nullptr;
-    z->height = 1;
-    avl_tree_rebalance(z, root());
+    avl_tree_rebalance(z);
     ++node_count;
     return iterator(z);
 }
@@ -927,16 +1211,16 @@ insert_unique(const Value& val) {
     if(comp) { // val < y, new node will at left tree
         if(i == begin()) 
         // case1: y is leftmost, insert new leftmost
-            return make_pair(insert(x, y, val), true);
+            return MiniSTL::make_pair(insert(x, y, val), true);
         else
             --i; // check the prev
     }
     // case2: val >= y and y < val, not equal
     // case3: prev(y) < val < y , not equal
     if(key_comp(key(i.node), KeyOfValue()(val)))
-        return make_pair(insert(x, y, val), true);
+        return MiniSTL::make_pair(insert(x, y, val), true);
     // get there, val equals to y or --y;
-    return make_pair(i, false);
+    return MiniSTL::make_pair(i, false);
 }
 
 template <class Key, class Value, class KeyOfValue, 
@@ -956,13 +1240,13 @@ avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(Value&& val) {
     iterator i(y);
     if(comp) {
         if(i == begin())
-            return make_pair(insert(x, y, std::move(val)), true);
+            return MiniSTL::make_pair(insert(x, y, std::move(val)), true);
         else
             --i;
     }
     if(key_comp(key(i.node), KeyOfValue()(val)))
-        return make_pair(insert(x, y, std::move(val)), true);
-    return make_pair(i, false);
+        return MiniSTL::make_pair(insert(x, y, std::move(val)), true);
+    return MiniSTL::make_pair(i, false);
 }
 
 // inserts value in the pos as close as possible, 
@@ -979,12 +1263,12 @@ insert_unique(iterator pos, const Value& val) {
            // header's key has no meaning
            return insert(pos.node, pos.node, val);
         else
-            insert_unique(val).first;
+            return insert_unique(val).first;
     } else if(pos.node == header) { // case2: pos = end()
         if(key_comp(key(rightmost()), KeyOfValue()(val)))
             return insert(nullptr, rightmost(), val);
         else
-            insert_unique(val).first;
+            return insert_unique(val).first;
     } else {
         iterator prev = pos;
         --prev;
@@ -1010,12 +1294,12 @@ insert_unique(iterator pos, Value&& val) {
            key_comp(KeyOfValue()(val), key(pos.node)))
            return insert(pos.node, pos.node, std::move(val));
         else
-            insert_unique(std::move(val)).first;
+            return insert_unique(std::move(val)).first;
     } else if(pos.node == header) {
         if(key_comp(key(rightmost()), KeyOfValue()(val)))
             return insert(nullptr, rightmost(), std::move(val));
         else
-            insert_unique(std::move(val)).first;
+            return insert_unique(std::move(val)).first;
     } else {
         iterator prev = pos;
         --prev;
@@ -1069,19 +1353,19 @@ avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
 insert_equal(iterator pos, const Value& val) {
     if(pos.node == leftmost()) { // case1: pos = begin()
         if(size() > 0 && 
-           !key_comp(key(pos.node)), KeyOfValue()(val))
+           !key_comp(key(pos.node), KeyOfValue()(val)))
            // case: pos >= val
            // need size() > 0 because pos may be header
            // header's key has no meaning
            return insert(pos.node, pos.node, val);
         else
-            insert_equal(val);
+            return insert_equal(val);
     } else if(pos.node == header) { // case2: pos = end()
-        if(!key_comp(KeyOfValue()(val)), key(rightmost()))
+        if(!key_comp(KeyOfValue()(val), key(rightmost())))
             // case: val >= rightmost
             return insert(nullptr, rightmost(), val);
         else
-            insert_equal(val);
+            return insert_equal(val);
     } else {
         iterator prev = pos;
         --prev;
@@ -1093,7 +1377,7 @@ insert_equal(iterator pos, const Value& val) {
             else
                 return insert(nullptr, prev.node, val);
         } else
-            return insert_equal(val).first;
+            return insert_equal(val);
     }
 }
 
@@ -1104,15 +1388,15 @@ avl_tree<Key, Value, KeyOfValue, Compare, Alloc>::
 insert_equal(iterator pos, Value&& val) {
     if(pos.node == leftmost()) {
         if(size() > 0 && 
-           !key_comp(key(pos.node)), KeyOfValue()(val))
+           !key_comp(key(pos.node), KeyOfValue()(val)))
            return insert(pos.node, pos.node, std::move(val));
         else
-            insert_equal(std::move(val));
+            return insert_equal(std::move(val));
     } else if(pos.node == header) {
-        if(!key_comp(KeyOfValue()(val)), key(rightmost()))
+        if(!key_comp(KeyOfValue()(val), key(rightmost())))
             return insert(nullptr, rightmost(), std::move(val));
         else
-            insert_equal(std::move(val));
+            return insert_equal(std::move(val));
     } else {
         iterator prev = pos;
         --prev;
@@ -1123,7 +1407,7 @@ insert_equal(iterator pos, Value&& val) {
             else
                 return insert(nullptr, prev.node, std::move(val));
         } else
-            return insert_equal(std::move(val)).first;
+            return insert_equal(std::move(val));
     }
 }
 
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/hash_map.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_bucket_policy.cpp
+ *  run:   ./a.out [max_keys], max_keys defaults to 1e7
+ *
+ *  hash_map<uint64_t, size_t> with the identity hash of hash_fun.hpp and
+ *  each bucket policy: prime % n, power of two & mask after hash_mix and
+ *  fast range. For n = 1e3, 1e4, ..., max_keys keys, which are either
+ *  0, 1, ..., n - 1, i * 4096 like page aligned addresses, or random.
+ *  reports ns per insert, ns per find of a present key and the longest
+ *  bucket. Small n is repeated so every row does about 1e7 operations.
+ */
+
+using namespace MiniSTL;
+
+const size_t WORK = 10000000;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+template <class Policy>
+void bench(const char* name, const char* keys_name, const vector<uint64_t>& keys) {
+    using map_t = hash_map<uint64_t, size_t, hash<uint64_t>, equal_to<uint64_t>,
+                           simple_alloc<pair<const uint64_t, size_t>>, Policy>;
+    const size_t n = keys.size();
+    const size_t rounds = n < WORK ? WORK / n : 1;
+    double insert_ns = 0, find_ns = 0;
+    size_t longest = 0;
+    for(size_t r = 0;r < rounds;++r) {
+        map_t m;
+        auto begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            m.insert(pair<const uint64_t, size_t>(keys[i], i));
+        insert_ns += ns_since(begin);
+
+        size_t found = 0;
+        begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            found += m.find(keys[i])->second;
+        find_ns += ns_since(begin);
+        sink = sink + found;
+
+        if(r == 0) {
+            for(size_t b = 0;b < m.bucket_count();++b) {
+                const size_t len = m.elems_in_bucket(b);
+                longest = len > longest ? len : longest;
+            }
+        }
+    }
+    const double ops = static_cast<double>(rounds * n);
+    std::cout << std::setw(12) << name << std::setw(8) << keys_name << std::setw(12) << n
+              << std::setw(10) << insert_ns / ops
+              << std::setw(10) << find_ns / ops
+              << std::setw(10) << longest << std::endl;
+}
+
+void bench_keys(const char* keys_name, const vector<uint64_t>& keys) {
+    bench<prime_bucket_policy>("prime", keys_name, keys);
+    bench<pow2_bucket_policy>("pow2", keys_name, keys);
+    bench<fastrange_bucket_policy>("fastrange", keys_name, keys);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_keys = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 10000000;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(12) << "policy" << std::setw(8) << "keys" << std::setw(12) << "n"
+              << std::setw(10) << "insert" << std::setw(10) << "find"
+              << std::setw(10) << "longest" << std::endl;
+    for(size_t n = 1000;n <= max_keys;n *= 10) {
+        vector<uint64_t> seq, page, rnd;
+        key_gen gen(n);
+        for(size_t i = 0;i < n;++i) {
+            seq.push_back(i);
+            page.push_back(i * 4096);
+            rnd.push_back(gen());
+        }
+        bench_keys("seq", seq);
+        bench_keys("page", page);
+        bench_keys("random", rnd);
+    }
+    return 0;
+}
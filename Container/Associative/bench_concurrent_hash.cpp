@@ -0,0 +1,138 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#include "Container/Associative/concurrent_hash_map.hpp"
+#include "Container/Associative/hash_map.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -pthread -I. Container/Associative/bench_concurrent_hash.cpp
+ *  run:   ./a.out [ops], ops per thread defaults to 1e6
+ *
+ *  throughput of concurrent_hash_map<uint64_t, uint64_t> against hash_map
+ *  behind one std::mutex, with 1, 2, 4 and 8 threads, for a read mostly
+ *  mix(90% find, 10% insert or erase) and a write heavy one(50/50). Keys
+ *  are drawn from 1e6 random keys, half of them inserted up front.
+ *  reports million operations per second over all threads. Threads beyond
+ *  the number of cores only show the cost of contention.
+ */
+
+using namespace MiniSTL;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+const size_t KEYS = 1000000;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+double ms_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+}
+
+using cmap_t = concurrent_hash_map<uint64_t, uint64_t, mixed_hash<uint64_t>, equal_to<uint64_t>>;
+using map_t = hash_map<uint64_t, uint64_t, mixed_hash<uint64_t>, equal_to<uint64_t>>;
+
+// the same interface over a hash_map and one mutex
+struct locked_map {
+    std::mutex lock;
+    map_t m;
+
+    bool find(uint64_t key, uint64_t& out) {
+        std::lock_guard<std::mutex> guard(lock);
+        map_t::iterator it = m.find(key);
+        if(it == m.end())
+            return false;
+        out = it->second;
+        return true;
+    }
+
+    bool insert(uint64_t key, uint64_t val) {
+        std::lock_guard<std::mutex> guard(lock);
+        return m.insert(map_t::value_type(key, val)).second;
+    }
+
+    size_t erase(uint64_t key) {
+        std::lock_guard<std::mutex> guard(lock);
+        return m.erase(key);
+    }
+};
+
+template <class Map>
+void worker(Map& m, const vector<uint64_t>& keys, size_t ops, unsigned write_pct, uint64_t seed) {
+    key_gen gen(seed);
+    uint64_t found = 0;
+    for(size_t i = 0;i < ops;++i) {
+        const uint64_t r = gen();
+        const uint64_t key = keys[r % KEYS];
+        uint64_t val;
+        if((r >> 32) % 100 >= write_pct) {
+            if(m.find(key, val))
+                found += val;
+        }
+        else if((r >> 40) & 1)
+            m.insert(key, r);
+        else
+            m.erase(key);
+    }
+    sink = sink + found;
+}
+
+template <class Map>
+double bench(const vector<uint64_t>& keys, size_t threads, size_t ops, unsigned write_pct) {
+    Map m;
+    for(size_t i = 0;i < KEYS / 2;++i)
+        m.insert(keys[i], i);
+    vector<std::thread*> pool;
+    const auto begin = bench_clock::now();
+    for(size_t t = 0;t < threads;++t)
+        pool.push_back(new std::thread(worker<Map>, std::ref(m), std::cref(keys),
+                                       ops, write_pct, t + 1));
+    for(size_t t = 0;t < threads;++t) {
+        pool[t]->join();
+        delete pool[t];
+    }
+    return threads * ops / ms_since(begin) / 1e3;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t ops = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 1000000;
+    std::cout << std::fixed << std::setprecision(2);
+    key_gen gen(KEYS);
+    vector<uint64_t> keys;
+    for(size_t i = 0;i < KEYS;++i)
+        keys.push_back(gen());
+
+    std::cout << "cores " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(8) << "mix" << std::setw(8) << "threads"
+              << std::setw(14) << "mutex Mops/s" << std::setw(14) << "striped" << std::endl;
+    const unsigned mixes[] = {10, 50};
+    for(unsigned w : mixes) {
+        for(size_t threads = 1;threads <= 8;threads *= 2) {
+            const double locked = bench<locked_map>(keys, threads, ops, w);
+            const double striped = bench<cmap_t>(keys, threads, ops, w);
+            std::cout << std::setw(5) << 100 - w << "/" << std::setw(2) << w
+                      << std::setw(8) << threads << std::setw(14) << locked
+                      << std::setw(14) << striped << std::endl;
+        }
+    }
+    return 0;
+}
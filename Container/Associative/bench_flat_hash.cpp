@@ -0,0 +1,105 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/hash_map.hpp"
+#include "Container/Associative/flat_hash_map.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_flat_hash.cpp
+ *  run:   ./a.out [max_keys], max_keys defaults to 1e7, 1e8 needs some GB
+ *
+ *  for n = 1e3, 1e4, ..., max_keys random 64-bit keys, with hash_map and
+ *  flat_hash_map: insert all keys into an empty map, look up every key
+ *  (hit), look up n keys not in the map (miss), then erase every key.
+ *  reports ns per operation. Small n is repeated so every row does about
+ *  1e7 operations.
+ */
+
+using namespace MiniSTL;
+
+const size_t WORK = 10000000;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64, keys of a run are distinct with overwhelming probability
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+template <class Map>
+void bench(const char* name, const vector<uint64_t>& keys,
+           const vector<uint64_t>& misses) {
+    const size_t n = keys.size();
+    const size_t rounds = n < WORK ? WORK / n : 1;
+    double insert_ns = 0, hit_ns = 0, miss_ns = 0, erase_ns = 0;
+    for(size_t r = 0;r < rounds;++r) {
+        Map m;
+        auto begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            m.insert(typename Map::value_type(keys[i], i));
+        insert_ns += ns_since(begin);
+
+        size_t found = 0;
+        begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            found += m.find(keys[i]) != m.end();
+        hit_ns += ns_since(begin);
+
+        begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            found += m.find(misses[i]) != m.end();
+        miss_ns += ns_since(begin);
+
+        begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            found += m.erase(keys[i]);
+        erase_ns += ns_since(begin);
+        sink = sink + found;
+    }
+    const double ops = static_cast<double>(rounds * n);
+    std::cout << std::setw(16) << name << std::setw(12) << n
+              << std::setw(10) << insert_ns / ops
+              << std::setw(10) << hit_ns / ops
+              << std::setw(10) << miss_ns / ops
+              << std::setw(10) << erase_ns / ops << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_keys = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 10000000;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(16) << "map" << std::setw(12) << "keys"
+              << std::setw(10) << "insert" << std::setw(10) << "hit"
+              << std::setw(10) << "miss" << std::setw(10) << "erase" << std::endl;
+    for(size_t n = 1000;n <= max_keys;n *= 10) {
+        vector<uint64_t> keys, misses;
+        keys.reserve(n);
+        misses.reserve(n);
+        key_gen gen(n);
+        for(size_t i = 0;i < n;++i) {
+            keys.push_back(gen());
+            misses.push_back(gen());
+        }
+        bench<hash_map<uint64_t, size_t, hash<uint64_t>, equal_to<uint64_t>>>("hash_map", keys, misses);
+        bench<flat_hash_map<uint64_t, size_t, hash<uint64_t>, equal_to<uint64_t>>>("flat_hash_map", keys, misses);
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/hashtable.hpp"
+#include "Container/Associative/flat_hashtable.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -march=native -I. Container/Associative/bench_flat_probe.cpp
+ *  run:   ./a.out [max_keys], max_keys defaults to 1e7
+ *
+ *  latency of find on 64-bit integer keys, for n = 1e3, 1e4, ..., max_keys
+ *  keys: chained hashtable against flat_hashtable probing with the 8 byte
+ *  portable group, 16 bytes of SSE2 and 32 bytes of AVX2(only those the
+ *  build targets, -march=native enables all the cpu has).
+ *  Each found value is the index of the next key to look up, so lookups
+ *  can not overlap and one lookup costs its full latency. Misses chain
+ *  the same way through keys not in the table. Reports the median and
+ *  the 99th percentile of SAMPLES batches of BATCH lookups, in ns per
+ *  lookup.
+ */
+
+using namespace MiniSTL;
+
+const int SAMPLES = 201;
+const size_t BATCH = 1000;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+using value_t = pair<const uint64_t, size_t>;
+
+using chained_map_t = hashtable<value_t, uint64_t, hash<uint64_t>, select1st<value_t>,
+                                equal_to<uint64_t>>;
+
+template <class Group>
+using flat_map_t = flat_hashtable<value_t, uint64_t, hash<uint64_t>, select1st<value_t>,
+                                  equal_to<uint64_t>, simple_alloc<value_t>, Group>;
+
+struct input {
+    vector<uint64_t> keys;
+    vector<uint64_t> misses;
+    vector<size_t> next;    // key visited after keys[i], one cycle
+};
+
+void print_row(const char* name, size_t n, const char* kind, vector<double>& ns) {
+    std::sort(ns.begin(), ns.end());
+    std::cout << std::setw(14) << name << std::setw(12) << n << std::setw(6) << kind
+              << std::setw(10) << ns[ns.size() / 2]
+              << std::setw(10) << ns[ns.size() * 99 / 100] << std::endl;
+}
+
+template <class Map>
+void bench(const char* name, const input& in) {
+    const size_t n = in.keys.size();
+    Map m(0, hash<uint64_t>(), equal_to<uint64_t>());
+    for(size_t i = 0;i < n;++i)
+        m.insert_unique(value_t(in.keys[i], in.next[i]));
+
+    vector<double> hit, miss;
+    size_t idx = 0;
+    for(int s = 0;s < SAMPLES;++s) {
+        auto begin = bench_clock::now();
+        for(size_t i = 0;i < BATCH;++i)
+            idx = m.find(in.keys[idx])->second;
+        hit.push_back(std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count() / BATCH);
+    }
+    for(int s = 0;s < SAMPLES;++s) {
+        auto begin = bench_clock::now();
+        for(size_t i = 0;i < BATCH;++i)
+            idx = in.next[idx] + (m.find(in.misses[idx]) != m.end());
+        miss.push_back(std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count() / BATCH);
+    }
+    sink = sink + idx;
+    print_row(name, n, "hit", hit);
+    print_row(name, n, "miss", miss);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_keys = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 10000000;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(14) << "map" << std::setw(12) << "keys" << std::setw(6) << ""
+              << std::setw(10) << "median" << std::setw(10) << "p99" << std::endl;
+    for(size_t n = 1000;n <= max_keys;n *= 10) {
+        input in;
+        key_gen gen(n);
+        vector<size_t> order;
+        for(size_t i = 0;i < n;++i) {
+            in.keys.push_back(gen());
+            in.misses.push_back(gen());
+            order.push_back(i);
+        }
+        for(size_t i = n - 1;i > 0;--i)
+            MiniSTL::swap(order[i], order[gen() % (i + 1)]);
+        in.next.resize(n);
+        for(size_t i = 0;i < n;++i)
+            in.next[order[i]] = order[(i + 1) % n];
+
+        bench<chained_map_t>("chained", in);
+        bench<flat_map_t<flat_group_portable>>("flat scalar", in);
+#if defined(__SSE2__)
+        bench<flat_map_t<flat_group_sse2>>("flat sse2", in);
+#endif
+#if defined(__AVX2__)
+        bench<flat_map_t<flat_group_avx2>>("flat avx2", in);
+#endif
+    }
+    return 0;
+}
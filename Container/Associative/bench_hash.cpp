@@ -0,0 +1,136 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/hash_fun.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_hash.cpp
+ *  run:   ./a.out [bytes], bytes defaults to 1e8
+ *
+ *  throughput of the hashers in hash_fun.hpp.
+ *  integers: ns per hash of 1e7 random 64-bit keys with hash<> (identity),
+ *  mixed_hash<> and hash_mix, latency(each key depends on the previous
+ *  hash) and throughput(independent keys).
+ *  strings: hash<const char*>(h = 5 * h + c over a C string) against
+ *  mixed_hash<const char*>(strlen + __hash_bytes) and __hash_bytes alone
+ *  on 4, 8, 16, 32, 64, ..., 4096 byte keys. Reports ns per key and GB/s,
+ *  about `bytes` bytes are hashed per row.
+ */
+
+using namespace MiniSTL;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so hashes are not optimized away
+volatile size_t sink = 0;
+
+const size_t INT_KEYS = 10000000;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+struct hash_mix_fn {
+    size_t operator()(unsigned long x) const { return hash_mix(x); }
+};
+
+struct hash_bytes_fn {
+    size_t len;
+
+    explicit hash_bytes_fn(size_t n) : len(n) {}
+
+    size_t operator()(const char* s) const { return __hash_bytes(s, len); }
+};
+
+template <class Hash>
+void bench_int(const char* name, const vector<unsigned long>& keys) {
+    Hash hf;
+    // the next key is picked by the previous hash, so the hashes run one
+    // after another
+    size_t h = 0;
+    auto begin = bench_clock::now();
+    for(size_t i = 0;i < keys.size();++i)
+        h = hf(keys[i] ^ (h & 1));
+    const double latency = ns_since(begin) / keys.size();
+    sink = sink + h;
+
+    size_t sum = 0;
+    begin = bench_clock::now();
+    for(size_t i = 0;i < keys.size();++i)
+        sum += hf(keys[i]);
+    const double throughput = ns_since(begin) / keys.size();
+    sink = sink + sum;
+
+    std::cout << std::setw(14) << name << std::setw(12) << latency
+              << std::setw(12) << throughput << std::endl;
+}
+
+template <class Hash>
+void bench_str(const char* name, const vector<const char*>& keys, size_t len, Hash hf) {
+    size_t sum = 0;
+    auto begin = bench_clock::now();
+    for(size_t i = 0;i < keys.size();++i)
+        sum += hf(keys[i]);
+    const double ns = ns_since(begin);
+    sink = sink + sum;
+
+    const double n = static_cast<double>(keys.size());
+    std::cout << std::setw(14) << name << std::setw(8) << len
+              << std::setw(12) << ns / n
+              << std::setw(10) << n * len / ns << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t bytes = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 100000000;
+    std::cout << std::fixed << std::setprecision(2);
+    key_gen gen(bytes);
+
+    vector<unsigned long> ints;
+    for(size_t i = 0;i < INT_KEYS;++i)
+        ints.push_back(gen());
+    std::cout << std::setw(14) << "hasher" << std::setw(12) << "latency"
+              << std::setw(12) << "throughput" << std::endl;
+    bench_int<hash<unsigned long>>("hash", ints);
+    bench_int<mixed_hash<unsigned long>>("mixed_hash", ints);
+    bench_int<hash_mix_fn>("hash_mix", ints);
+    std::cout << std::endl;
+
+    std::cout << std::setw(14) << "hasher" << std::setw(8) << "bytes"
+              << std::setw(12) << "ns/key" << std::setw(10) << "GB/s" << std::endl;
+    for(size_t len = 4;len <= 4096;len *= 2) {
+        // keys packed in 64 MB at most, walked again until `bytes` are hashed
+        const size_t stride = len + 1;
+        const size_t total = bytes / len;
+        const size_t distinct = total < (1 << 26) / stride ? total : (1 << 26) / stride;
+        vector<char> buf(distinct * stride);
+        for(size_t i = 0;i < buf.size();++i)
+            buf[i] = static_cast<char>('a' + gen() % 26);
+        vector<const char*> keys;
+        for(size_t i = 0;i < total;++i) {
+            char* p = &buf[(i % distinct) * stride];
+            p[len] = '\0';
+            keys.push_back(p);
+        }
+        bench_str("hash", keys, len, hash<const char*>());
+        bench_str("mixed_hash", keys, len, mixed_hash<const char*>());
+        bench_str("__hash_bytes", keys, len, hash_bytes_fn(len));
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/hash_map.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_hash_batch.cpp
+ *  run:   ./a.out [keys], keys defaults to 4e6
+ *
+ *  hash_map<uint64_t, uint64_t, mixed_hash> built from `keys` random keys
+ *  by one insert per key, by the range insert and by bulk_insert, then
+ *  probed with as many keys, half of them present, by one find per key
+ *  and by find_batch. Reports ns per element.
+ */
+
+using namespace MiniSTL;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+using map_t = hash_map<uint64_t, uint64_t, mixed_hash<uint64_t>, equal_to<uint64_t>>;
+// vector elements must be assignable, the maps convert them
+using value_t = pair<uint64_t, uint64_t>;
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+void report(const char* name, double ns, size_t n) {
+    std::cout << std::setw(16) << name << std::setw(10) << ns / n << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t n = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 4000000;
+    std::cout << std::fixed << std::setprecision(1);
+    key_gen gen(n);
+    vector<value_t> values;
+    for(size_t i = 0;i < n;++i)
+        values.push_back(value_t(gen(), i));
+    vector<uint64_t> probes;
+    for(size_t i = 0;i < n;++i)
+        probes.push_back(i % 2 ? values[gen() % n].first : gen());
+
+    std::cout << std::setw(16) << "build" << std::setw(10) << "ns" << std::endl;
+    {
+        map_t m;
+        auto begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            m.insert(map_t::value_type(values[i].first, values[i].second));
+        report("insert", ns_since(begin), n);
+    }
+    {
+        map_t m;
+        auto begin = bench_clock::now();
+        m.insert(values.begin(), values.end());
+        report("range insert", ns_since(begin), n);
+    }
+    map_t m;
+    auto begin = bench_clock::now();
+    m.bulk_insert(values.begin(), values.end());
+    report("bulk_insert", ns_since(begin), n);
+
+    std::cout << std::setw(16) << "probe" << std::setw(10) << "ns" << std::endl;
+    uint64_t found = 0;
+    begin = bench_clock::now();
+    for(size_t i = 0;i < n;++i) {
+        map_t::iterator it = m.find(probes[i]);
+        if(it != m.end())
+            found += it->second;
+    }
+    report("find", ns_since(begin), n);
+
+    vector<map_t::iterator> out(n, m.end());
+    begin = bench_clock::now();
+    m.find_batch(probes.begin(), probes.end(), out.begin());
+    for(size_t i = 0;i < n;++i) {
+        if(out[i] != m.end())
+            found -= out[i]->second;
+    }
+    report("find_batch", ns_since(begin), n);
+    sink = sink + found;
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "Container/Associative/hash_set.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_hash_cache.cpp
+ *  run:   ./a.out [keys], keys defaults to 1e6
+ *
+ *  hash_set<const char*> of strings with a 64 byte common prefix and 16
+ *  to 256 bytes in all, with and without hash codes cached in the nodes
+ *  (cache_hash_code), for the old h = 5 * h + c hash and mixed_hash.
+ *  reports ns per insert while the set grows from the default 100
+ *  buckets, per find of a present key, per find of an absent key which
+ *  shares the prefix, and per element of a full iteration.
+ */
+
+using namespace MiniSTL;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+struct eq_str {
+    bool operator()(const char* a, const char* b) const { return strcmp(a, b) == 0; }
+};
+
+// the same hashers under other names, cache_hash_code is false for them
+struct plain_string_hash : hash<const char*> {};
+struct plain_mixed_hash : mixed_hash<const char*> {};
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+template <class Hash>
+void bench(const char* name, const vector<const char*>& keys,
+           const vector<const char*>& absent) {
+    using set_t = hash_set<const char*, Hash, eq_str>;
+    const double n = static_cast<double>(keys.size());
+    set_t s;
+    auto begin = bench_clock::now();
+    for(size_t i = 0;i < keys.size();++i)
+        s.insert(keys[i]);
+    const double insert_ns = ns_since(begin) / n;
+
+    size_t found = 0;
+    begin = bench_clock::now();
+    for(size_t i = 0;i < keys.size();++i)
+        found += s.count(keys[i]);
+    const double hit_ns = ns_since(begin) / n;
+
+    begin = bench_clock::now();
+    for(size_t i = 0;i < absent.size();++i)
+        found += s.count(absent[i]);
+    const double miss_ns = ns_since(begin) / n;
+
+    begin = bench_clock::now();
+    for(auto it = s.begin();it != s.end();++it)
+        found += (*it)[0];
+    const double iter_ns = ns_since(begin) / n;
+    sink = sink + found;
+
+    std::cout << std::setw(14) << name << std::setw(10) << insert_ns
+              << std::setw(10) << hit_ns << std::setw(10) << miss_ns
+              << std::setw(10) << iter_ns << std::endl;
+}
+
+const size_t PREFIX = 64;
+const size_t MAX_LEN = 256;
+
+int main(int argc, char* argv[]) {
+    const size_t n = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 1000000;
+    std::cout << std::fixed << std::setprecision(1);
+
+    // key i and absent key i differ in their last byte only
+    key_gen gen(n);
+    vector<char> buf(2 * n * (MAX_LEN + 1));
+    vector<const char*> keys, absent;
+    for(size_t i = 0;i < n;++i) {
+        char* p = &buf[2 * i * (MAX_LEN + 1)];
+        char* q = p + MAX_LEN + 1;
+        const size_t len = 16 + gen() % (MAX_LEN - 15);
+        for(size_t j = 0;j < len;++j)
+            p[j] = j < PREFIX ? 'p' : static_cast<char>('a' + gen() % 26);
+        for(size_t j = 0;j < 16 && j < len;++j)
+            p[len - 1 - j] = static_cast<char>('a' + (i >> (4 * (j % 8))) % 16 + 10 * (j / 8));
+        p[len] = '\0';
+        memcpy(q, p, len + 1);
+        q[len - 1] = 'Z';
+        keys.push_back(p);
+        absent.push_back(q);
+    }
+
+    std::cout << std::setw(14) << "hasher" << std::setw(10) << "insert" << std::setw(10) << "hit"
+              << std::setw(10) << "miss" << std::setw(10) << "iterate" << std::endl;
+    bench<plain_string_hash>("hash", keys, absent);
+    bench<hash<const char*>>("hash cached", keys, absent);
+    bench<plain_mixed_hash>("mixed", keys, absent);
+    bench<mixed_hash<const char*>>("mixed cached", keys, absent);
+    return 0;
+}
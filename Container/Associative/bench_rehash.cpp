@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/hash_map.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_rehash.cpp
+ *  run:   ./a.out [keys], keys defaults to 1e7
+ *
+ *  latency of every insert while a hash_map<uint64_t, size_t> grows from
+ *  the default 100 buckets to `keys` random keys, with one pass rehash
+ *  (step 0) and incremental rehash moving 2, 4 or 16 buckets per insert.
+ *  reports median, p99, p99.9 and max ns per insert, the total time, and
+ *  ns per find of a present key after the growth.
+ */
+
+using namespace MiniSTL;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+double ns_between(bench_clock::time_point begin, bench_clock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - begin).count();
+}
+
+void bench(size_t step, const vector<uint64_t>& keys) {
+    using map_t = hash_map<uint64_t, size_t, hash<uint64_t>, equal_to<uint64_t>>;
+    const size_t n = keys.size();
+    vector<double> lat(n);
+    map_t m;
+    m.set_rehash_step(step);
+
+    const auto start = bench_clock::now();
+    auto begin = start;
+    for(size_t i = 0;i < n;++i) {
+        m.insert(pair<const uint64_t, size_t>(keys[i], i));
+        const auto end = bench_clock::now();
+        lat[i] = ns_between(begin, end);
+        begin = end;
+    }
+    const double total_ms = ns_between(start, begin) / 1e6;
+
+    size_t found = 0;
+    begin = bench_clock::now();
+    for(size_t i = 0;i < n;++i)
+        found += m.find(keys[i])->second;
+    const double find_ns = ns_between(begin, bench_clock::now()) / n;
+    sink = sink + found;
+
+    std::sort(lat.begin(), lat.end());
+    std::cout << std::setw(6) << step
+              << std::setw(10) << lat[n / 2]
+              << std::setw(10) << lat[n * 99 / 100]
+              << std::setw(10) << lat[n * 999 / 1000]
+              << std::setw(14) << lat[n - 1]
+              << std::setw(12) << total_ms
+              << std::setw(8) << find_ns << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t n = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 10000000;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(6) << "step" << std::setw(10) << "p50" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << std::setw(14) << "max"
+              << std::setw(12) << "total ms" << std::setw(8) << "find" << std::endl;
+    key_gen gen(n);
+    vector<uint64_t> keys;
+    for(size_t i = 0;i < n;++i)
+        keys.push_back(gen());
+    const size_t steps[] = {0, 2, 4, 16};
+    for(size_t s : steps)
+        bench(s, keys);
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/avl_tree.hpp"
+#include "Container/Associative/bs_tree.hpp"
+#include "Container/Associative/map.hpp"
+#include "Container/Associative/rb_tree.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_tree_build.cpp
+ *  run:   ./a.out [max_keys], max_keys defaults to 1e7
+ *
+ *  for n = 1e3, 1e4, ..., max_keys sorted distinct 64-bit keys, build
+ *  rb_tree, avl_tree and bs_tree as sets of uint64_t and a map from
+ *  uint64_t to uint64_t: one insert per key (insert), and one range
+ *  insert into the empty tree, the range constructor for map, which
+ *  links the sorted keys in O(n) (bulk). Reports ns per key, destroying
+ *  the tree included. bs_tree degrades to a list when inserting sorted
+ *  keys one by one, so its insert is not timed.
+ */
+
+using namespace MiniSTL;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so trees are not optimized away
+volatile size_t sink = 0;
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+template <class Tree, class Vec>
+double build_one_by_one(const Vec& values) {
+    auto begin = bench_clock::now();
+    {
+        Tree t;
+        for(size_t i = 0;i < values.size();++i)
+            t.insert_unique(values[i]);
+        sink = sink + t.size();
+    }
+    return ns_since(begin);
+}
+
+template <class Tree, class Vec>
+double build_bulk(const Vec& values) {
+    auto begin = bench_clock::now();
+    {
+        Tree t;
+        t.insert_unique(values.begin(), values.end());
+        sink = sink + t.size();
+    }
+    return ns_since(begin);
+}
+
+// map goes through its range constructor
+using u64_map = map<uint64_t, uint64_t>;
+
+template <class Vec>
+double map_one_by_one(const Vec& values) {
+    auto begin = bench_clock::now();
+    {
+        u64_map m;
+        for(size_t i = 0;i < values.size();++i)
+            m.insert(values[i]);
+        sink = sink + m.size();
+    }
+    return ns_since(begin);
+}
+
+template <class Vec>
+double map_bulk(const Vec& values) {
+    auto begin = bench_clock::now();
+    {
+        u64_map m(values.begin(), values.end());
+        sink = sink + m.size();
+    }
+    return ns_since(begin);
+}
+
+void report(const char* name, size_t n, double insert_ns, double bulk_ns) {
+    std::cout << std::setw(10) << name << std::setw(12) << n;
+    if(insert_ns > 0)
+        std::cout << std::setw(10) << insert_ns / n;
+    else
+        std::cout << std::setw(10) << "-";
+    std::cout << std::setw(10) << bulk_ns / n << std::endl;
+}
+
+template <template <class, class, class, class, class> class Tree>
+using tree_set = Tree<uint64_t, uint64_t, identity<uint64_t>, less<uint64_t>,
+                      simple_alloc<uint64_t>>;
+
+int main(int argc, char* argv[]) {
+    const size_t max_keys = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 10000000;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(10) << "tree" << std::setw(12) << "keys"
+              << std::setw(10) << "insert" << std::setw(10) << "bulk" << std::endl;
+    for(size_t n = 1000;n <= max_keys;n *= 10) {
+        // sorted with random gaps
+        vector<uint64_t> keys;
+        vector<pair<uint64_t, uint64_t>> pairs;
+        keys.reserve(n);
+        pairs.reserve(n);
+        uint64_t k = 0;
+        for(size_t i = 0;i < n;++i) {
+            k += 1 + (k * 0x9E3779B97F4A7C15ULL >> 60);
+            keys.push_back(k);
+            pairs.push_back(pair<uint64_t, uint64_t>(k, i));
+        }
+        report("rb_tree", n, build_one_by_one<tree_set<rb_tree>>(keys),
+               build_bulk<tree_set<rb_tree>>(keys));
+        report("avl_tree", n, build_one_by_one<tree_set<avl_tree>>(keys),
+               build_bulk<tree_set<avl_tree>>(keys));
+        report("bs_tree", n, 0, build_bulk<tree_set<bs_tree>>(keys));
+        report("map", n, map_one_by_one(pairs), map_bulk(pairs));
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Container/Associative/avl_tree.hpp"
+#include "Container/Associative/rb_tree.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/bench_tree_node.cpp
+ *         g++ -std=c++11 -O2 -I. -DUSE_PACKED_TREE_NODE Container/Associative/bench_tree_node.cpp
+ *  run:   ./a.out [max_keys], max_keys defaults to 1e7
+ *
+ *  node layout of rb_tree and avl_tree, built once as is and once with
+ *  USE_PACKED_TREE_NODE. For n = 1e3, 1e4, ..., max_keys random 64-bit
+ *  keys, as sets of uint64_t: bytes per node, then look up every key
+ *  (hit) and n keys not in the tree (miss). Reports ns per lookup.
+ *  Small n is repeated so every row does about 1e7 lookups.
+ */
+
+using namespace MiniSTL;
+
+const size_t WORK = 10000000;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so lookups are not optimized away
+volatile size_t sink = 0;
+
+// splitmix64, keys of a run are distinct with overwhelming probability
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+double ns_since(bench_clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+}
+
+template <class Tree, class Node>
+void bench(const char* name, const vector<uint64_t>& keys,
+           const vector<uint64_t>& misses) {
+    const size_t n = keys.size();
+    const size_t rounds = n < WORK ? WORK / n : 1;
+    Tree t;
+    for(size_t i = 0;i < n;++i)
+        t.insert_unique(keys[i]);
+
+    double hit_ns = 0, miss_ns = 0;
+    size_t found = 0;
+    for(size_t r = 0;r < rounds;++r) {
+        auto begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            found += t.find(keys[i]) != t.end();
+        hit_ns += ns_since(begin);
+
+        begin = bench_clock::now();
+        for(size_t i = 0;i < n;++i)
+            found += t.find(misses[i]) != t.end();
+        miss_ns += ns_since(begin);
+    }
+    sink = sink + found;
+    const double ops = static_cast<double>(rounds * n);
+    std::cout << std::setw(10) << name << std::setw(12) << n
+              << std::setw(10) << sizeof(Node)
+              << std::setw(10) << hit_ns / ops
+              << std::setw(10) << miss_ns / ops << std::endl;
+}
+
+template <template <class, class, class, class, class> class Tree>
+using tree_set = Tree<uint64_t, uint64_t, identity<uint64_t>, less<uint64_t>,
+                      simple_alloc<uint64_t>>;
+
+int main(int argc, char* argv[]) {
+    const size_t max_keys = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 10000000;
+#ifdef USE_PACKED_TREE_NODE
+    std::cout << "layout: packed" << std::endl;
+#else
+    std::cout << "layout: unpacked" << std::endl;
+#endif
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(10) << "tree" << std::setw(12) << "keys"
+              << std::setw(10) << "bytes" << std::setw(10) << "hit"
+              << std::setw(10) << "miss" << std::endl;
+    for(size_t n = 1000;n <= max_keys;n *= 10) {
+        vector<uint64_t> keys, misses;
+        keys.reserve(n);
+        misses.reserve(n);
+        key_gen gen(n);
+        for(size_t i = 0;i < n;++i) {
+            keys.push_back(gen());
+            misses.push_back(gen());
+        }
+        bench<tree_set<rb_tree>, rb_tree_node<uint64_t>>("rb_tree", keys, misses);
+        bench<tree_set<avl_tree>, avl_tree_node<uint64_t>>("avl_tree", keys, misses);
+    }
+    return 0;
+}
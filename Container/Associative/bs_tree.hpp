@@ -98,7 +98,10 @@ struct bs_tree_iterator {
     }
 
     void decre() {
-        if(node->parent->parent == node) {
+        // root and header are parents of each other, the right of
+        // the header is the max, a descendant unless the root is max
+        if(node->parent->parent == node && node->right &&
+           (node->right == node->parent || node->right->parent != node)) {
             // special case1: node = header, 
             // prev = mostright, aka max;
             node = node->right;
@@ -142,11 +145,13 @@ struct bs_tree_iterator {
 
 template <class Key, class Value, class KeyOfValue, 
           class Compare, class Alloc = simple_alloc<Value>>
-class bs_tree {
+class bs_tree : protected alloc_base<bs_tree_node<Value>, Alloc> {
+private:
+    using base = alloc_base<bs_tree_node<Value>, Alloc>;
+
 protected:
     using node_t = bs_tree_node<Value>;
     using node_ptr_t = bs_tree_node<Value>*;
-    using node_alloc = simple_alloc<node_t>;
 
 public:
     using key_type = Key;
@@ -165,7 +170,7 @@ public:
 
 public:
     // observior
-    allocator_type get_allocator() { return allocator_type(); }
+    allocator_type get_allocator() const { return base::get_allocator(); }
     Compare key_compare() const { return key_comp; }
 
 protected:
@@ -175,8 +180,8 @@ protected:
     Compare key_comp;
 
 protected:
-    node_ptr_t get_node() { return node_alloc::allocate(1); }
-    void put_node(node_ptr_t p) { node_alloc::deallocate(p, 1); }
+    node_ptr_t get_node() { return this->allocate_n(1); }
+    void put_node(node_ptr_t p) { this->deallocate_n(p, 1); }
 
     node_ptr_t create_node(const Value& val) {
         node_ptr_t tmp = get_node();
@@ -236,25 +241,53 @@ private:
         rightmost() = header;
     }
 
-    void clear() {
-        if(node_count != 0) {
-            erase(root());
-            root() = nullptr;
-            leftmost() = header;
-            rightmost() = header;
-            node_count = 0;
+    node_ptr_t copy(node_ptr_t x, node_ptr_t p);
+
+    // header belongs to the allocator, so it is rebuilt when
+    // an unequal allocator takes over
+    void replace_alloc(const bs_tree& x) {
+        if(!this->alloc_equal(x)) {
+            clear();
+            put_node(header);
+            this->copy_alloc(x, true_type());
+            empty_initialize();
+        } else {
+            this->copy_alloc(x, true_type());
         }
     }
 
-    node_ptr_t copy(node_ptr_t x, node_ptr_t p);
+    void copy_assign_alloc(const bs_tree& x, true_type) { replace_alloc(x); }
+
+    void copy_assign_alloc(const bs_tree&, false_type) {}
+
+    void move_assign(bs_tree& x, true_type) {
+        clear();
+        replace_alloc(x);
+        MiniSTL::swap(header, x.header);
+        MiniSTL::swap(node_count, x.node_count);
+    }
+
+    // nodes can only be taken from an equal allocator,
+    // otherwise elements are copied into our own nodes
+    void move_assign(bs_tree& x, false_type) {
+        if(this->alloc_equal(x)) {
+            clear();
+            MiniSTL::swap(header, x.header);
+            MiniSTL::swap(node_count, x.node_count);
+        } else {
+            *this = x;
+            x.clear();
+        }
+    }
 
 public:
     //  ctor/dtor/assign
     bs_tree() : node_count(0), key_comp() { empty_initialize(); }
-    bs_tree(const Compare& c) : node_count(0), key_comp(c)
-        { empty_initialize(); }
+    explicit bs_tree(const Compare& c, const allocator_type& a = allocator_type())
+        : base(a), node_count(0), key_comp(c) { empty_initialize(); }
     
-    bs_tree(const bs_tree& x) : node_count(0), key_comp(x.key_comp) {
+    bs_tree(const bs_tree& x) 
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
         if(x.root() == nullptr)
             empty_initialize();
         else {
@@ -266,10 +299,12 @@ public:
         node_count = x.node_count;
     }
 
+    // x keeps an empty tree, so it can still be used or destroyed
     bs_tree(bs_tree&& x) 
-        : header(x.header), node_count(x.node_count), key_comp(x.key_comp) {
-        x.node_count = 0;
-        x.header = nullptr;
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
+        empty_initialize();
+        MiniSTL::swap(header, x.header);
+        MiniSTL::swap(node_count, x.node_count);
     }
 
     ~bs_tree() {
@@ -277,8 +312,15 @@ public:
         put_node(header);
     }
 
-    bs_tree& operator==(const bs_tree& x);
-    bs_tree& operator==(bs_tree&& x);
+    bs_tree& operator=(const bs_tree& x);
+
+    bs_tree& operator=(bs_tree&& x) {
+        if(&x != this) {
+            key_comp = x.key_comp;
+            move_assign(x, typename base::propagate_on_move());
+        }
+        return *this;
+    }
 
 public:
     // element access
@@ -313,9 +355,20 @@ public:
 public:
     //swap
     void swap(bs_tree& y) {
-        swap(header, y.header);
-        swap(node_count, y.node_count);
-        swap(key_comp, y.key_comp);
+        this->swap_alloc(y, typename base::propagate_on_swap());
+        MiniSTL::swap(header, y.header);
+        MiniSTL::swap(node_count, y.node_count);
+        MiniSTL::swap(key_comp, y.key_comp);
+    }
+
+    void clear() {
+        if(node_count != 0) {
+            erase(root());
+            root() = nullptr;
+            leftmost() = header;
+            rightmost() = header;
+            node_count = 0;
+        }
     }
 
 private:
@@ -333,10 +386,11 @@ public:
 	iterator insert_unique(iterator pos, const Value& val);
     iterator insert_unique(iterator pos, Value&& val); 
 
+	// an empty tree is built in O(n) from sorted forward iterators,
+	// balanced, instead of the list inserting them one by one makes
 	template<class InputIt>
 	void insert_unique(InputIt first, InputIt last) {
-        while(first != last)
-            insert_unique(*first++);
+        insert_range(first, last, true, iterator_category_t<InputIt>());
     }
 
     iterator insert_equal(const Value& val);
@@ -347,10 +401,41 @@ public:
 
 	template<class InputIt>
 	void insert_equal(InputIt first, InputIt last) {
-       while(first != last)
-            insert_equal(*first++);
+        insert_range(first, last, false, iterator_category_t<InputIt>());
     }
 
+private:
+    template <class InputIt>
+    void insert_range(InputIt first, InputIt last, bool unique, input_iterator_tag) {
+        for(;first != last;++first) {
+            if(unique)
+                insert_unique(*first);
+            else
+                insert_equal(*first);
+        }
+    }
+
+    template <class ForwardIt>
+    void insert_range(ForwardIt first, ForwardIt last, bool unique, forward_iterator_tag) {
+        size_type n = 0;
+        if(node_count == 0 && sorted_range(first, last, unique, n))
+            build_sorted(first, n);
+        else
+            insert_range(first, last, unique, input_iterator_tag());
+    }
+
+    // whether [first, last) is sorted, strictly if unique, n is
+    // its length when it is
+    template <class ForwardIt>
+    bool sorted_range(ForwardIt first, ForwardIt last, bool unique, size_type& n) const;
+
+    // link n sorted values into an empty tree
+    template <class ForwardIt>
+    void build_sorted(ForwardIt first, size_type n);
+
+    template <class ForwardIt>
+    node_ptr_t build_subtree(ForwardIt& first, size_type n);
+
 private:
     // erase without rebalance
     void erase(node_ptr_t x) {
@@ -390,118 +475,84 @@ public:
         }
     }
 
-public:
-    // find
-    // if x exists, return first x, else return end();
-	iterator find(const Key& k) noexcept {
+private:
+    // last node not less than k, header if none
+    template <class K>
+    node_ptr_t lower_bound_node(const K& k) const noexcept {
         node_ptr_t y = header;
         node_ptr_t x = root();
 
         while(x) {
-            if(key_comp(key(x), k)) // k > x
+            if(key_comp(key(x), k))
                 x = x->right;
-            else { // k <= x,set y = x,last node not less than k
+            else {
+                // if k <= x, set y is last node which y >= k
                 y = x;
                 x = x->left;
             }
         }
-
-        iterator i(y);
-        // if found, y == k, but can't use y == k, because
-        // y may be end(), that is empty tree
-        // if found, y == k and 2 cases no found:
-        //      a. empty tree
-        //      b. k < y and y is last node which k <= y
-        return (i == end() || key_comp(k, key(y))) ? end() : i;
+        // if k > max, y header, aka end()
+        return y;
     }
 
-	const_iterator find(const Key& k) const noexcept {
+    // first node greater than k, header if none
+    template <class K>
+    node_ptr_t upper_bound_node(const K& k) const noexcept {
         node_ptr_t y = header;
         node_ptr_t x = root();
 
         while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
+            if(key_comp(k, key(x))) {
+                // k < x, set y is first node which k < y
                 y = x;
                 x = x->left;
             }
+            else
+                x = x->right;
         }
 
-        const_iterator i(y);
-        return (i == end() || key_comp(k, key(y))) ? end() : i;
+        return y;
+    }
+
+    template <class K>
+    node_ptr_t find_node(const K& k) const noexcept {
+        node_ptr_t y = lower_bound_node(k);
+        // if found, y == k, but can't use y == k, because
+        // y may be end(), that is empty tree
+        // if found, y == k and 2 cases no found:
+        //      a. empty tree
+        //      b. k < y and y is last node which k <= y
+        return (y == header || key_comp(k, key(y))) ? header : y;
+    }
+
+public:
+    // find
+    // if x exists, return first x, else return end();
+	iterator find(const Key& k) noexcept { return iterator(find_node(k)); }
+
+	const_iterator find(const Key& k) const noexcept {
+        return const_iterator(find_node(k));
     }
 
 	size_type count(const Key& k) const noexcept {
-        pair<iterator, iterator> p = equal_range(k);
+        pair<const_iterator, const_iterator> p = equal_range(k);
         return distance(p.first, p.second);
     }
 
 	iterator lower_bound(const Key& k) noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
-                // if k <= x, set y is last node which y >= k
-                y = x;
-                x = x->left;
-            }
-        }
-        // if k > max, y header, aka end()
-        return iterator(y);
+        return iterator(lower_bound_node(k));
     }
 
 	const_iterator lower_bound(const Key& k) const noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
-                y = x;
-                x = x->left;
-            }
-        }
-
-        return const_iterator(y);
+        return const_iterator(lower_bound_node(k));
     }
 
 	iterator upper_bound(const Key& k) noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(k, key(x))) {
-                // k < x, set y is first node which k < y
-                y = x;
-                x = x->left;
-            }
-            else
-                x = x->right;
-        }
-
-        return iterator(y);
+        return iterator(upper_bound_node(k));
     }
 
 	const_iterator upper_bound(const Key& k) const noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(k, key(x))) {
-                // k < x, set y is first node which k < y
-                y = x;
-                x = x->left;
-            }
-            else
-                x = x->right;
-        }
-
-        return const_iterator(y);
+        return const_iterator(upper_bound_node(k));
     }
 
 	pair<iterator,iterator> 
@@ -513,6 +564,56 @@ public:
     equal_range(const Key& k) const noexcept {
         return make_pair(lower_bound(k), upper_bound(k));
     }
+
+    // heterogeneous lookup of any k which Compare orders against Key,
+    // only if Compare declares is_transparent(e.g. less<>)
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& k) noexcept {
+        return iterator(find_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& k) const noexcept {
+        return const_iterator(find_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& k) const noexcept {
+        return distance(const_iterator(lower_bound_node(k)),
+                        const_iterator(upper_bound_node(k)));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& k) noexcept {
+        return iterator(lower_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& k) const noexcept {
+        return const_iterator(lower_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& k) noexcept {
+        return iterator(upper_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& k) const noexcept {
+        return const_iterator(upper_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& k) noexcept {
+        return make_pair(iterator(lower_bound_node(k)), iterator(upper_bound_node(k)));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& k) const noexcept {
+        return make_pair(const_iterator(lower_bound_node(k)),
+                         const_iterator(upper_bound_node(k)));
+    }
 };
 
 
@@ -555,9 +656,10 @@ template<class Key, class Value, class KeyOfValue,
          class Compare, class Alloc>
 bs_tree<Key, Value, KeyOfValue, Compare, Alloc>&
 bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-operator==(const bs_tree& x) {
+operator=(const bs_tree& x) {
     if(&x != this) {
         clear();
+        copy_assign_alloc(x, typename base::propagate_on_copy());
         node_count = 0;
         key_comp = x.key_comp;
         if(x.root()) {
@@ -574,29 +676,6 @@ operator==(const bs_tree& x) {
     return *this;
 }
 
-template<class Key, class Value, class KeyOfValue, 
-         class Compare, class Alloc>
-bs_tree<Key, Value, KeyOfValue, Compare, Alloc>&
-bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-operator==(bs_tree&& x) {
-    if(&x != this) {
-        clear();
-        node_count = 0;
-        key_comp = x.key_comp;
-        if(x.root()) {
-            header = x.header;
-            node_count = x.node_count;
-        } else {
-            root() = nullptr;
-            leftmost() = header;
-            rightmost() = header;
-        }
-        x.node_count = 0;
-        x.header = nullptr;
-    }
-    return *this;
-}
-
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
 typename bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
@@ -631,6 +710,73 @@ copy(node_ptr_t x, node_ptr_t p) {
 }
 
 
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+template <class ForwardIt>
+bool bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+sorted_range(ForwardIt first, ForwardIt last, bool unique, size_type& n) const {
+    n = 0;
+    if(first == last)
+        return true;
+    ForwardIt prev = first;
+    for(++first, n = 1;first != last;++first, ++prev, ++n) {
+        if(unique ? !key_comp(KeyOfValue()(*prev), KeyOfValue()(*first))
+                  : key_comp(KeyOfValue()(*first), KeyOfValue()(*prev)))
+            return false;
+    }
+    return true;
+}
+
+// the middle value is the root, the halves are built the same way
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+template <class ForwardIt>
+void bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+build_sorted(ForwardIt first, size_type n) {
+    if(n == 0)
+        return;
+    root() = build_subtree(first, n);
+    root()->parent = header;
+    leftmost() = node_t::minimum(root());
+    rightmost() = node_t::maximum(root());
+    node_count = n;
+}
+
+// nodes are created in order, first is advanced past the subtree
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+template <class ForwardIt>
+typename bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
+bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+build_subtree(ForwardIt& first, size_type n) {
+    if(n == 0)
+        return nullptr;
+    node_ptr_t l = build_subtree(first, (n - 1) / 2);
+    node_ptr_t x = nullptr;
+    try {
+        x = create_node(*first);
+    } catch(std::exception&) {
+        erase(l);
+        throw;
+    }
+    ++first;
+    x->parent = nullptr;
+    x->left = l;
+    x->right = nullptr;
+    if(l)
+        l->parent = x;
+
+    try {
+        x->right = build_subtree(first, n - 1 - (n - 1) / 2);
+    } catch(std::exception&) {
+        erase(x);
+        throw;
+    }
+    if(x->right)
+        x->right->parent = x;
+    return x;
+}
+
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
 typename bs_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
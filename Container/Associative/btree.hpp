@@ -0,0 +1,1065 @@
+/*
+ * B-tree, ordered container with the interface of rb_tree
+ *  Implementation properties:
+ *      1. A node holds up to SLOTS values side by side, SLOTS is picked
+ *      so the values of a node take about 256 bytes. A lookup compares
+ *      against a few contiguous values per level and visits
+ *      log(SLOTS, N) nodes, instead of one node per comparison.
+ *      2. Leaves hold values only, internal nodes hold values and
+ *      SLOTS + 1 child pointers. All leaves are at the same depth.
+ *      3. Every node knows its parent and its position in the parent,
+ *      an iterator is a node and a position in it.
+ *      4. A full node is split before a value goes into it, the middle
+ *      value moves up to the parent. A node split by an insert at its
+ *      end keeps all but one of its values, so sorted input fills nodes.
+ *      5. A node left with less than MIN values by an erase borrows a
+ *      value from a sibling, or is merged with it.
+ *  Values move between nodes on insert and erase, so unlike rb_tree,
+ *  insert and erase invalidate all iterators and references.
+ */
+
+#pragma once
+
+#include "Algorithms/algobase.hpp"
+#include "Allocator/memory.hpp"
+#include "Function/function.hpp"
+#include "Iterator/iterator.hpp"
+#include "Util/pair.hpp"
+
+#include <cstddef>
+#include <exception>
+#include <climits>
+#include <new>
+#include <utility>
+
+namespace MiniSTL {
+
+template <class Value>
+struct btree_internal_node;
+
+template <class Value>
+struct btree_node {
+    using node_ptr_t = btree_node*;
+
+    // values per node: about 256 bytes of them, at least 4
+    static constexpr size_t SLOTS = 256 / sizeof(Value) < 4 ? 4
+                                  : 256 / sizeof(Value) > 64 ? 64
+                                  : 256 / sizeof(Value);
+
+    node_ptr_t parent;
+    unsigned char position;     // index in parent->children
+    unsigned char count;        // number of values
+    bool leaf;
+    alignas(Value) unsigned char storage[SLOTS * sizeof(Value)];
+
+    Value& value(size_t i) { return reinterpret_cast<Value*>(storage)[i]; }
+
+    // only for internal nodes
+    node_ptr_t& child(size_t i);
+
+    static node_ptr_t leftmost_leaf(node_ptr_t x) {
+        while(!x->leaf)
+            x = x->child(0);
+        return x;
+    }
+
+    static node_ptr_t rightmost_leaf(node_ptr_t x) {
+        while(!x->leaf)
+            x = x->child(x->count);
+        return x;
+    }
+};
+
+template <class Value>
+struct btree_internal_node : btree_node<Value> {
+    btree_node<Value>* children[btree_node<Value>::SLOTS + 1];
+};
+
+template <class Value>
+inline btree_node<Value>*& btree_node<Value>::child(size_t i) {
+    return static_cast<btree_internal_node<Value>*>(this)->children[i];
+}
+
+template <class Value, class Ref, class Ptr>
+struct btree_iterator {
+    using iterator = btree_iterator<Value, Value&, Value*>;
+    using const_iterator = btree_iterator<Value, const Value&, const Value*>;
+
+    using iterator_category = bidirectional_iterator_tag;
+    using value_type = Value;
+    using pointer = Ptr;
+    using reference = Ref;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using node_t = btree_node<Value>;
+    using node_ptr_t = btree_node<Value>*;
+    using self_t = btree_iterator<Value, Ref, Ptr>;
+
+    node_ptr_t node;
+    int position;
+
+    btree_iterator() : node(nullptr), position(0) {}
+    btree_iterator(node_ptr_t x, int i) : node(x), position(i) {}
+    btree_iterator(const iterator& it) : node(it.node), position(it.position) {}
+
+    // position == node->count is the gap after the last value of a
+    // node, walk up until a value follows it. end() if none does.
+    void up_to_value() {
+        node_ptr_t save = node;
+        int save_position = position;
+        while(position == node->count && node->parent) {
+            position = node->position;
+            node = node->parent;
+        }
+        if(position == node->count) {
+            node = save;
+            position = save_position;
+        }
+    }
+
+    void incre() {
+        if(node->leaf) {
+            ++position;
+            if(position == node->count)
+                up_to_value();
+        } else {
+            // next is the min of the right subtree
+            node = node_t::leftmost_leaf(node->child(position + 1));
+            position = 0;
+        }
+    }
+
+    void decre() {
+        if(node->leaf) {
+            if(position > 0) {
+                --position;
+                return;
+            }
+            // first of a leaf, prev is the value on the left of the
+            // nearest ancestor it is not the leftmost descendant of
+            node_ptr_t save = node;
+            while(position == 0 && node->parent) {
+                position = node->position;
+                node = node->parent;
+            }
+            if(position == 0) {
+                // begin()
+                node = save;
+                return;
+            }
+            --position;
+        } else {
+            // prev is the max of the left subtree
+            node = node_t::rightmost_leaf(node->child(position));
+            position = node->count - 1;
+        }
+    }
+
+    reference operator*() const { return node->value(position); }
+    pointer operator->() const { return &(operator*()); }
+
+    self_t& operator++() { incre(); return *this; }
+    self_t operator++(int) {
+        self_t tmp = *this;
+        incre();
+        return tmp;
+    }
+
+    self_t& operator--() { decre(); return *this; }
+    self_t operator--(int) {
+        self_t tmp = *this;
+        decre();
+        return tmp;
+    }
+
+    bool operator==(const self_t& y) const
+        { return node == y.node && position == y.position; }
+    bool operator!=(const self_t& y) const
+        { return !(*this == y); }
+};
+
+
+template <class Key, class Value, class KeyOfValue,
+          class Compare, class Alloc = simple_alloc<Value>>
+class btree : protected alloc_base<btree_node<Value>, Alloc> {
+private:
+    using base = alloc_base<btree_node<Value>, Alloc>;
+
+protected:
+    using node_t = btree_node<Value>;
+    using node_ptr_t = btree_node<Value>*;
+    using internal_node_t = btree_internal_node<Value>;
+
+    static constexpr int SLOTS = static_cast<int>(node_t::SLOTS);
+    // fewest values of a node but the root after an erase
+    static constexpr int MIN = (SLOTS - 1) / 2;
+
+    // internal nodes allocate from the same allocator as leaves
+    struct internal_alloc : alloc_base<internal_node_t, Alloc> {
+        explicit internal_alloc(const Alloc& a) : alloc_base<internal_node_t, Alloc>(a) {}
+        using alloc_base<internal_node_t, Alloc>::allocate_n;
+        using alloc_base<internal_node_t, Alloc>::deallocate_n;
+    };
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = Value&;
+    using const_reference = const Value&;
+    using pointer = Value*;
+    using const_pointer = const Value*;
+    using iterator = btree_iterator<Value, Value&, Value*>;
+    using const_iterator = btree_iterator<Value, const Value&, const Value*>;
+    using reverse_iterator = __reverse_iterator<iterator>;
+    using const_reverse_iterator = __reverse_iterator<const_iterator>;
+
+public:
+    // observior
+    allocator_type get_allocator() const { return base::get_allocator(); }
+    Compare key_compare() const { return key_comp; }
+
+protected:
+    // data member, all null for an empty tree
+    node_ptr_t root;
+    node_ptr_t leftmost;        // leaf of begin()
+    node_ptr_t rightmost;       // leaf of end()
+    size_t node_count;          // number of values, not of nodes
+    Compare key_comp;
+
+protected:
+    node_ptr_t new_node(bool leaf) {
+        node_ptr_t x = leaf ? this->allocate_n(1)
+                            : internal_alloc(get_allocator()).allocate_n(1);
+        x->parent = nullptr;
+        x->position = 0;
+        x->count = 0;
+        x->leaf = leaf;
+        return x;
+    }
+
+    void put_node(node_ptr_t x) {
+        if(x->leaf)
+            this->deallocate_n(x, 1);
+        else
+            internal_alloc(get_allocator())
+                .deallocate_n(static_cast<internal_node_t*>(x), 1);
+    }
+
+    static Value& value(node_ptr_t x, int i) { return x->value(i); }
+    static const Key& key(node_ptr_t x, int i)
+        { return KeyOfValue()(x->value(i)); }
+
+    // move construct into raw dst, src is left raw
+    static void move_value(Value* dst, Value* src) {
+        new (dst) Value(std::move(*src));
+        destroy(src);
+    }
+
+    static void set_child(node_ptr_t p, int i, node_ptr_t c) {
+        p->child(i) = c;
+        c->parent = p;
+        c->position = static_cast<unsigned char>(i);
+    }
+
+    static iterator mutable_iterator(const_iterator it)
+        { return iterator(it.node, it.position); }
+
+    // iterator on the first value at or after gap(x, i)
+    iterator make_iterator(node_ptr_t x, int i) const {
+        iterator it(x, i);
+        if(i == x->count)
+            it.up_to_value();
+        return it;
+    }
+
+private:
+    void empty_initialize() {
+        root = nullptr;
+        leftmost = nullptr;
+        rightmost = nullptr;
+    }
+
+    node_ptr_t copy(node_ptr_t x, node_ptr_t p);
+    void erase_subtree(node_ptr_t x);
+
+    node_ptr_t split(node_ptr_t x, int i);
+    void merge(node_ptr_t left, node_ptr_t right);
+    void rotate_right(node_ptr_t left, node_ptr_t x);
+    void rotate_left(node_ptr_t x, node_ptr_t right);
+    void rebalance_after_erase(node_ptr_t& x, int& i);
+
+    template <class V>
+    iterator insert_leaf(node_ptr_t x, int i, V&& val);
+    template <class V>
+    iterator insert_before(iterator pos, V&& val);
+    template <class V>
+    pair<iterator, bool> insert_unique_value(V&& val);
+    template <class V>
+    iterator insert_equal_value(V&& val);
+    template <class V>
+    iterator insert_unique_hint(iterator pos, V&& val);
+    template <class V>
+    iterator insert_equal_hint(iterator pos, V&& val);
+
+    void copy_from(const btree& x) {
+        if(x.root) {
+            root = copy(x.root, nullptr);
+            leftmost = node_t::leftmost_leaf(root);
+            rightmost = node_t::rightmost_leaf(root);
+            node_count = x.node_count;
+        }
+    }
+
+    void steal(btree& x) {
+        MiniSTL::swap(root, x.root);
+        MiniSTL::swap(leftmost, x.leftmost);
+        MiniSTL::swap(rightmost, x.rightmost);
+        MiniSTL::swap(node_count, x.node_count);
+    }
+
+    void copy_assign_alloc(const btree& x, true_type) {
+        this->copy_alloc(x, true_type());
+    }
+
+    void copy_assign_alloc(const btree&, false_type) {}
+
+    void move_assign(btree& x, true_type) {
+        clear();
+        this->copy_alloc(x, true_type());
+        steal(x);
+    }
+
+    // nodes can only be taken from an equal allocator,
+    // otherwise values are copied into our own nodes
+    void move_assign(btree& x, false_type) {
+        if(this->alloc_equal(x)) {
+            clear();
+            steal(x);
+        } else {
+            *this = x;
+            x.clear();
+        }
+    }
+
+public:
+    //  ctor/dtor/assign
+    btree() : node_count(0), key_comp() { empty_initialize(); }
+    explicit btree(const Compare& c, const allocator_type& a = allocator_type())
+        : base(a), node_count(0), key_comp(c) { empty_initialize(); }
+
+    btree(const btree& x)
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
+        empty_initialize();
+        copy_from(x);
+    }
+
+    // x keeps an empty tree, so it can still be used or destroyed
+    btree(btree&& x)
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
+        empty_initialize();
+        steal(x);
+    }
+
+    ~btree() { clear(); }
+
+    btree& operator=(const btree& x) {
+        if(&x != this) {
+            clear();
+            copy_assign_alloc(x, typename base::propagate_on_copy());
+            key_comp = x.key_comp;
+            copy_from(x);
+        }
+        return *this;
+    }
+
+    btree& operator=(btree&& x) {
+        if(&x != this) {
+            key_comp = x.key_comp;
+            move_assign(x, typename base::propagate_on_move());
+        }
+        return *this;
+    }
+
+public:
+    // element access
+    iterator begin() noexcept { return iterator(leftmost, 0); }
+    const_iterator begin() const noexcept { return const_iterator(leftmost, 0); }
+    iterator end() noexcept
+        { return iterator(rightmost, rightmost ? rightmost->count : 0); }
+    const_iterator end() const noexcept
+        { return const_iterator(rightmost, rightmost ? rightmost->count : 0); }
+
+    reverse_iterator        rbegin() noexcept
+        { return reverse_iterator(end()); }
+    const_reverse_iterator  rbegin() const noexcept
+        { return const_reverse_iterator(end()); }
+    reverse_iterator        rend() noexcept
+        { return reverse_iterator(begin()); }
+    const_reverse_iterator  rend() const noexcept
+        { return const_reverse_iterator(begin()); }
+
+    const_iterator          cbegin() const noexcept { return begin(); }
+    const_iterator          cend() const noexcept { return end(); }
+    const_reverse_iterator  crbegin() const noexcept
+        { return const_reverse_iterator(end()); }
+    const_reverse_iterator  crend() const noexcept
+        { return const_reverse_iterator(begin()); }
+
+public:
+    // capacity
+    size_type size() const noexcept { return node_count; }
+    size_type max_size() const noexcept
+        { return UINT_MAX / sizeof(value_type); }
+    bool empty() const noexcept { return node_count == 0; }
+
+public:
+    //swap
+    void swap(btree& y) {
+        this->swap_alloc(y, typename base::propagate_on_swap());
+        steal(y);
+        MiniSTL::swap(key_comp, y.key_comp);
+    }
+
+    void clear() {
+        if(root) {
+            erase_subtree(root);
+            empty_initialize();
+            node_count = 0;
+        }
+    }
+
+public:
+    // insert
+    pair<iterator, bool> insert_unique(const Value& val)
+        { return insert_unique_value(val); }
+    pair<iterator, bool> insert_unique(Value&& val)
+        { return insert_unique_value(std::move(val)); }
+
+    iterator insert_unique(iterator pos, const Value& val)
+        { return insert_unique_hint(pos, val); }
+    iterator insert_unique(iterator pos, Value&& val)
+        { return insert_unique_hint(pos, std::move(val)); }
+    iterator insert_unique(const_iterator pos, const Value& val)
+        { return insert_unique_hint(mutable_iterator(pos), val); }
+    iterator insert_unique(const_iterator pos, Value&& val)
+        { return insert_unique_hint(mutable_iterator(pos), std::move(val)); }
+
+    template<class InputIt>
+    void insert_unique(InputIt first, InputIt last) {
+        while(first != last)
+            insert_unique(*first++);
+    }
+
+    iterator insert_equal(const Value& val)
+        { return insert_equal_value(val); }
+    iterator insert_equal(Value&& val)
+        { return insert_equal_value(std::move(val)); }
+
+    iterator insert_equal(iterator pos, const Value& val)
+        { return insert_equal_hint(pos, val); }
+    iterator insert_equal(iterator pos, Value&& val)
+        { return insert_equal_hint(pos, std::move(val)); }
+    iterator insert_equal(const_iterator pos, const Value& val)
+        { return insert_equal_hint(mutable_iterator(pos), val); }
+    iterator insert_equal(const_iterator pos, Value&& val)
+        { return insert_equal_hint(mutable_iterator(pos), std::move(val)); }
+
+    template<class InputIt>
+    void insert_equal(InputIt first, InputIt last) {
+        while(first != last)
+            insert_equal(*first++);
+    }
+
+public:
+    // erase, returns iterator to the value after pos
+    iterator erase(iterator pos);
+
+    size_type erase(const Key& x) {
+        pair<iterator, iterator> p = equal_range(x);
+        size_type n = MiniSTL::distance(p.first, p.second);
+        erase_n(p.first, n);
+        return n;
+    }
+
+    iterator erase(iterator first, iterator last) {
+        if(first == begin() && last == end()) {
+            clear();
+            return end();
+        }
+        // every erase invalidates last, count instead
+        return erase_n(first, MiniSTL::distance(first, last));
+    }
+
+    iterator erase(const_iterator pos) { return erase(mutable_iterator(pos)); }
+    iterator erase(const_iterator first, const_iterator last)
+        { return erase(mutable_iterator(first), mutable_iterator(last)); }
+
+private:
+    iterator erase_n(iterator first, size_type n) {
+        while(n--)
+            first = erase(first);
+        return first;
+    }
+
+    // first value not less than k in x. The range halves whatever the
+    // comparison says, so the loop has no branch to mispredict and the
+    // compiler can pick base with a conditional move.
+    template <class K>
+    int node_lower_bound(node_ptr_t x, const K& k) const {
+        int n = x->count;
+        if(n == 0)
+            return 0;
+        int base = 0;
+        while(n > 1) {
+            const int half = n / 2;
+            base = key_comp(key(x, base + half - 1), k) ? base + half : base;
+            n -= half;
+        }
+        return base + key_comp(key(x, base), k);
+    }
+
+    // first value greater than k in x
+    template <class K>
+    int node_upper_bound(node_ptr_t x, const K& k) const {
+        int n = x->count;
+        if(n == 0)
+            return 0;
+        int base = 0;
+        while(n > 1) {
+            const int half = n / 2;
+            base = key_comp(k, key(x, base + half - 1)) ? base : base + half;
+            n -= half;
+        }
+        return base + !key_comp(k, key(x, base));
+    }
+
+    // leaf gap of lower_bound(k): the descent always ends in a leaf,
+    // the value at or after the gap is the answer
+    template <class K>
+    node_ptr_t leaf_lower_bound(const K& k, int& i) const {
+        node_ptr_t x = root;
+        for(;;) {
+            i = node_lower_bound(x, k);
+            if(x->leaf)
+                return x;
+            x = x->child(i);
+        }
+    }
+
+    template <class K>
+    node_ptr_t leaf_upper_bound(const K& k, int& i) const {
+        node_ptr_t x = root;
+        for(;;) {
+            i = node_upper_bound(x, k);
+            if(x->leaf)
+                return x;
+            x = x->child(i);
+        }
+    }
+
+    template <class K>
+    iterator lower_bound_pos(const K& k) const {
+        if(!root)
+            return iterator();
+        int i;
+        node_ptr_t x = leaf_lower_bound(k, i);
+        return make_iterator(x, i);
+    }
+
+    template <class K>
+    iterator upper_bound_pos(const K& k) const {
+        if(!root)
+            return iterator();
+        int i;
+        node_ptr_t x = leaf_upper_bound(k, i);
+        return make_iterator(x, i);
+    }
+
+    template <class K>
+    iterator find_pos(const K& k) const {
+        iterator it = lower_bound_pos(k);
+        iterator last(rightmost, rightmost ? rightmost->count : 0);
+        return (it == last || key_comp(k, KeyOfValue()(*it))) ? last : it;
+    }
+
+public:
+    // find
+    // if x exists, return first x, else return end();
+    iterator find(const Key& k) noexcept { return find_pos(k); }
+
+    const_iterator find(const Key& k) const noexcept { return find_pos(k); }
+
+    size_type count(const Key& k) const noexcept {
+        pair<const_iterator, const_iterator> p = equal_range(k);
+        return MiniSTL::distance(p.first, p.second);
+    }
+
+    iterator lower_bound(const Key& k) noexcept { return lower_bound_pos(k); }
+
+    const_iterator lower_bound(const Key& k) const noexcept
+        { return lower_bound_pos(k); }
+
+    iterator upper_bound(const Key& k) noexcept { return upper_bound_pos(k); }
+
+    const_iterator upper_bound(const Key& k) const noexcept
+        { return upper_bound_pos(k); }
+
+    pair<iterator,iterator>
+    equal_range(const Key& k) noexcept {
+        return MiniSTL::make_pair(lower_bound(k), upper_bound(k));
+    }
+
+    pair<const_iterator,const_iterator>
+    equal_range(const Key& k) const noexcept {
+        return MiniSTL::make_pair(lower_bound(k), upper_bound(k));
+    }
+
+    // heterogeneous lookup of any k which Compare orders against Key,
+    // only if Compare declares is_transparent(e.g. less<>)
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& k) noexcept {
+        return find_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& k) const noexcept {
+        return find_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& k) const noexcept {
+        return MiniSTL::distance(const_iterator(lower_bound_pos(k)),
+                        const_iterator(upper_bound_pos(k)));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& k) noexcept {
+        return lower_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& k) const noexcept {
+        return lower_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& k) noexcept {
+        return upper_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& k) const noexcept {
+        return upper_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& k) noexcept {
+        return MiniSTL::make_pair(lower_bound_pos(k), upper_bound_pos(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& k) const noexcept {
+        return MiniSTL::make_pair(const_iterator(lower_bound_pos(k)),
+                         const_iterator(upper_bound_pos(k)));
+    }
+};
+
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator==(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const btree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return x.size() == y.size() && MiniSTL::equal(x.cbegin(), x.cend(), y.cbegin());
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator!=(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const btree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return !(x == y);
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator<(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                      const btree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return MiniSTL::lexicographical_compare(x.cbegin(), x.cend(), y.cbegin(), y.cend());
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator>(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                      const btree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return y < x;
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator<=(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const btree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return !(y < x);
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator>=(const btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const btree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return !(x < y);
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline void swap(btree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                 btree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    x.swap(y);
+}
+
+// clone subtree x under p, recursion depth is the tree height
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
+btree<Key, Value, KeyOfValue, Compare, Alloc>::
+copy(node_ptr_t x, node_ptr_t p) {
+    node_ptr_t y = new_node(x->leaf);
+    y->parent = p;
+    y->position = x->position;
+    int children = 0;
+    try {
+        for(;y->count < x->count;++y->count)
+            construct(&value(y, y->count), value(x, y->count));
+        if(!x->leaf) {
+            for(;children <= x->count;++children)
+                y->child(children) = copy(x->child(children), y);
+        }
+    } catch(std::exception&) {
+        for(int i = 0;i < children;++i)
+            erase_subtree(y->child(i));
+        for(int i = 0;i < y->count;++i)
+            destroy(&value(y, i));
+        put_node(y);
+        throw;
+    }
+    return y;
+}
+
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+void btree<Key, Value, KeyOfValue, Compare, Alloc>::erase_subtree(node_ptr_t x) {
+    if(!x->leaf) {
+        for(int i = 0;i <= x->count;++i)
+            erase_subtree(x->child(i));
+    }
+    for(int i = 0;i < x->count;++i)
+        destroy(&value(x, i));
+    put_node(x);
+}
+
+// split full x, whose gap i a value is inserted at, into x and a new
+// right sibling which is returned. The middle value goes up to the
+// parent, which is split first if full.
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
+btree<Key, Value, KeyOfValue, Compare, Alloc>::split(node_ptr_t x, int i) {
+    if(x == root) {
+        root = new_node(false);
+        set_child(root, 0, x);
+    } else if(x->parent->count == SLOTS) {
+        split(x->parent, x->position);
+    }
+    node_ptr_t p = x->parent;
+    const int pos = x->position;
+    // an insert at the end keeps x full, for sorted inserts
+    const int mid = i == SLOTS ? SLOTS - 1 : SLOTS / 2;
+
+    node_ptr_t y = new_node(x->leaf);
+    for(int j = mid + 1;j < SLOTS;++j)
+        move_value(&value(y, j - mid - 1), &value(x, j));
+    y->count = static_cast<unsigned char>(SLOTS - mid - 1);
+    if(!x->leaf) {
+        for(int j = mid + 1;j <= SLOTS;++j)
+            set_child(y, j - mid - 1, x->child(j));
+    }
+
+    // value mid goes to p at pos, y becomes its right child
+    for(int j = p->count;j > pos;--j)
+        move_value(&value(p, j), &value(p, j - 1));
+    for(int j = p->count + 1;j > pos + 1;--j)
+        set_child(p, j, p->child(j - 1));
+    move_value(&value(p, pos), &value(x, mid));
+    set_child(p, pos + 1, y);
+    ++p->count;
+    x->count = static_cast<unsigned char>(mid);
+
+    if(x == rightmost)
+        rightmost = y;
+    return y;
+}
+
+// append separator and right to left, right is freed
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+void btree<Key, Value, KeyOfValue, Compare, Alloc>::merge(node_ptr_t left,
+                                                          node_ptr_t right) {
+    node_ptr_t p = left->parent;
+    const int sep = left->position;
+    const int n = left->count;
+    move_value(&value(left, n), &value(p, sep));
+    for(int j = 0;j < right->count;++j)
+        move_value(&value(left, n + 1 + j), &value(right, j));
+    if(!left->leaf) {
+        for(int j = 0;j <= right->count;++j)
+            set_child(left, n + 1 + j, right->child(j));
+    }
+    left->count = static_cast<unsigned char>(n + 1 + right->count);
+
+    for(int j = sep;j + 1 < p->count;++j)
+        move_value(&value(p, j), &value(p, j + 1));
+    for(int j = sep + 1;j < p->count;++j)
+        set_child(p, j, p->child(j + 1));
+    --p->count;
+
+    if(right == rightmost)
+        rightmost = left;
+    put_node(right);
+}
+
+// x takes the separator on its left, which the last value of left replaces
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+void btree<Key, Value, KeyOfValue, Compare, Alloc>::rotate_right(node_ptr_t left,
+                                                                 node_ptr_t x) {
+    node_ptr_t p = x->parent;
+    const int sep = left->position;
+    for(int j = x->count;j > 0;--j)
+        move_value(&value(x, j), &value(x, j - 1));
+    move_value(&value(x, 0), &value(p, sep));
+    move_value(&value(p, sep), &value(left, left->count - 1));
+    if(!x->leaf) {
+        for(int j = x->count + 1;j > 0;--j)
+            set_child(x, j, x->child(j - 1));
+        set_child(x, 0, left->child(left->count));
+    }
+    ++x->count;
+    --left->count;
+}
+
+// x takes the separator on its right, which the first value of right replaces
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+void btree<Key, Value, KeyOfValue, Compare, Alloc>::rotate_left(node_ptr_t x,
+                                                                node_ptr_t right) {
+    node_ptr_t p = x->parent;
+    const int sep = x->position;
+    move_value(&value(x, x->count), &value(p, sep));
+    move_value(&value(p, sep), &value(right, 0));
+    if(!x->leaf)
+        set_child(x, x->count + 1, right->child(0));
+    for(int j = 0;j + 1 < right->count;++j)
+        move_value(&value(right, j), &value(right, j + 1));
+    if(!right->leaf) {
+        for(int j = 0;j < right->count;++j)
+            set_child(right, j, right->child(j + 1));
+    }
+    ++x->count;
+    --right->count;
+}
+
+// leaf x lost a value. Fix nodes short of MIN from x up, gap(x, i) is
+// moved along with the values around it.
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+void btree<Key, Value, KeyOfValue, Compare, Alloc>::
+rebalance_after_erase(node_ptr_t& x, int& i) {
+    node_ptr_t n = x;
+    while(n != root && n->count < MIN) {
+        node_ptr_t p = n->parent;
+        const int pos = n->position;
+        node_ptr_t left = pos > 0 ? p->child(pos - 1) : nullptr;
+        node_ptr_t right = pos < p->count ? p->child(pos + 1) : nullptr;
+        if(left && left->count > MIN) {
+            rotate_right(left, n);
+            if(n == x)
+                ++i;
+            return;
+        }
+        if(right && right->count > MIN) {
+            rotate_left(n, right);
+            return;
+        }
+        if(left) {
+            if(n == x) {
+                x = left;
+                i += left->count + 1;
+            }
+            merge(left, n);
+        } else {
+            merge(n, right);
+        }
+        n = p;
+    }
+    if(root->count == 0) {
+        node_ptr_t old = root;
+        if(root->leaf) {
+            empty_initialize();
+        } else {
+            root = root->child(0);
+            root->parent = nullptr;
+            root->position = 0;
+        }
+        put_node(old);
+    }
+}
+
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+btree<Key, Value, KeyOfValue, Compare, Alloc>::erase(iterator pos) {
+    node_ptr_t x = pos.node;
+    int i = pos.position;
+    const bool internal = !x->leaf;
+    destroy(&value(x, i));
+    if(internal) {
+        // predecessor, the last value of a leaf, fills the hole
+        node_ptr_t y = node_t::rightmost_leaf(x->child(i));
+        move_value(&value(x, i), &value(y, y->count - 1));
+        x = y;
+        i = y->count - 1;
+    } else {
+        for(int j = i;j + 1 < x->count;++j)
+            move_value(&value(x, j), &value(x, j + 1));
+    }
+    --x->count;
+    --node_count;
+    // gap(x, i) is before the next value, or before the predecessor
+    // if it moved up
+    rebalance_after_erase(x, i);
+    if(!root)
+        return end();
+    iterator it = make_iterator(x, i);
+    if(internal)
+        ++it;
+    return it;
+}
+
+// insert val at gap i of leaf x
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+template <class V>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+btree<Key, Value, KeyOfValue, Compare, Alloc>::insert_leaf(node_ptr_t x, int i,
+                                                          V&& val) {
+    if(!root) {
+        root = leftmost = rightmost = x = new_node(true);
+        i = 0;
+    } else if(x->count == SLOTS) {
+        node_ptr_t y = split(x, i);
+        if(i > x->count) {
+            i -= x->count + 1;
+            x = y;
+        }
+    }
+    for(int j = x->count;j > i;--j)
+        move_value(&value(x, j), &value(x, j - 1));
+    try {
+        new (&value(x, i)) Value(std::forward<V>(val));
+    } catch(std::exception&) {
+        for(int j = i;j < x->count;++j)
+            move_value(&value(x, j), &value(x, j + 1));
+        if(node_count == 0) {
+            put_node(x);
+            empty_initialize();
+        }
+        throw;
+    }
+    ++x->count;
+    ++node_count;
+    return iterator(x, i);
+}
+
+// insert val just before pos, which is a gap of a leaf or is right
+// after the max of the left subtree of an internal value
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+template <class V>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+btree<Key, Value, KeyOfValue, Compare, Alloc>::insert_before(iterator pos,
+                                                            V&& val) {
+    if(!pos.node || pos.node->leaf)
+        return insert_leaf(pos.node, pos.position, std::forward<V>(val));
+    node_ptr_t x = node_t::rightmost_leaf(pos.node->child(pos.position));
+    return insert_leaf(x, x->count, std::forward<V>(val));
+}
+
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+template <class V>
+pair<typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
+btree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique_value(V&& val) {
+    if(!root)
+        return pair<iterator, bool>(insert_leaf(nullptr, 0, std::forward<V>(val)), true);
+    int i;
+    node_ptr_t x = leaf_lower_bound(KeyOfValue()(val), i);
+    iterator it = make_iterator(x, i);
+    if(it != end() && !key_comp(KeyOfValue()(val), KeyOfValue()(*it)))
+        return pair<iterator, bool>(it, false);
+    return pair<iterator, bool>(insert_leaf(x, i, std::forward<V>(val)), true);
+}
+
+// after all values equal to val, as rb_tree does
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+template <class V>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+btree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal_value(V&& val) {
+    if(!root)
+        return insert_leaf(nullptr, 0, std::forward<V>(val));
+    int i;
+    node_ptr_t x = leaf_upper_bound(KeyOfValue()(val), i);
+    return insert_leaf(x, i, std::forward<V>(val));
+}
+
+// right hint: val goes before pos and after --pos without a descent
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+template <class V>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+btree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique_hint(iterator pos,
+                                                                 V&& val) {
+    const Key& k = KeyOfValue()(val);
+    if(pos == end() || key_comp(k, KeyOfValue()(*pos))) {
+        if(pos == begin())
+            return insert_before(pos, std::forward<V>(val));
+        iterator before = pos;
+        --before;
+        if(key_comp(KeyOfValue()(*before), k))
+            return insert_before(pos, std::forward<V>(val));
+    } else if(!key_comp(KeyOfValue()(*pos), k)) {
+        // equal key
+        return pos;
+    } else {
+        iterator after = pos;
+        ++after;
+        if(after == end() || key_comp(k, KeyOfValue()(*after)))
+            return insert_before(after, std::forward<V>(val));
+    }
+    return insert_unique_value(std::forward<V>(val)).first;
+}
+
+template<class Key, class Value, class KeyOfValue,
+         class Compare, class Alloc>
+template <class V>
+typename btree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+btree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal_hint(iterator pos,
+                                                                V&& val) {
+    const Key& k = KeyOfValue()(val);
+    if(pos == end() || !key_comp(KeyOfValue()(*pos), k)) {
+        if(pos == begin())
+            return insert_before(pos, std::forward<V>(val));
+        iterator before = pos;
+        --before;
+        if(!key_comp(k, KeyOfValue()(*before)))
+            return insert_before(pos, std::forward<V>(val));
+    }
+    return insert_equal_value(std::forward<V>(val));
+}
+
+} // MiniSTL
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "btree.hpp"
+#include "Function/function.hpp"
+
+#include <initializer_list>
+
+
+namespace MiniSTL {
+    
+template <class Key, class Compare = less<Key>,
+          class Allocator = simple_alloc<Key> >
+class btree_set {
+// for btree_set, value_type = key_type = Key
+protected:
+    using impl_t = btree<Key, Key, identity<Key>, Compare, Allocator>;
+	impl_t impl;
+ 
+
+public:
+    // types alias
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using value_compare = Compare;
+    using allocator_type = Allocator;
+
+    using size_type	= typename impl_t::size_type;
+    using difference_type = typename impl_t::difference_type;
+    using reference	= typename impl_t::reference;
+    using const_reference = typename impl_t::const_reference;
+    using pointer = typename impl_t::pointer;
+    using const_pointer = typename impl_t::const_pointer;
+    using iterator = typename impl_t::iterator;
+    using const_iterator = typename impl_t::const_iterator;
+    using reverse_iterator	= typename impl_t::reverse_iterator;
+    using const_reverse_iterator = typename impl_t::const_reverse_iterator;
+
+
+public:
+    // construct/copy/destroy:
+    explicit btree_set(const Compare& comp = Compare(),
+                 const allocator_type& a = allocator_type())
+        : impl(comp, a) {}
+
+    template <class InputIt>
+    btree_set(InputIt first, InputIt last, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(first, last); }
+    
+    btree_set(const btree_set& x) : impl(x.impl) {}
+    btree_set(btree_set&& x) : impl(std::move(x.impl)) {}
+    btree_set(std::initializer_list<value_type> ilist, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(ilist.begin(), ilist.end()); }
+    
+    ~btree_set() {}
+    
+    // assign
+    btree_set& operator=(const btree_set& x) { impl = x.impl; return *this; }
+    btree_set& operator=(btree_set&& x) { impl = std::move(x.impl); return *this; }
+    btree_set& operator=(std::initializer_list<value_type> ilist) {
+        impl.clear();
+        impl.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return impl.get_allocator(); }
+ 
+    // iterators:
+    iterator        begin() noexcept { return impl.begin(); }
+    const_iterator  begin() const noexcept { return impl.begin(); }
+    iterator        end() noexcept { return impl.end(); }
+    const_iterator  end() const noexcept { return impl.end(); }
+ 
+    reverse_iterator        rbegin() noexcept { return impl.rbegin(); }
+    const_reverse_iterator  rbegin() const noexcept { return impl.rbegin(); }
+    reverse_iterator        rend() noexcept { return impl.rend(); }
+    const_reverse_iterator  rend() const noexcept { return impl.rend(); }
+ 
+    const_iterator          cbegin() const noexcept { return impl.cbegin(); }
+    const_iterator          cend() const noexcept { return impl.cend(); }
+    const_reverse_iterator  crbegin() const noexcept { return impl.crbegin(); }
+    const_reverse_iterator  crend() const noexcept { return impl.crend(); }
+ 
+    // capacity:
+    bool        empty() const noexcept { return impl.empty(); }
+    size_type   size() const noexcept { return impl.size(); }
+    size_type   max_size() const noexcept { return impl.max_size(); }
+ 
+    // modifiers:
+    template <class... Args> 
+    pair<iterator, bool> emplace(Args&&... args)
+        { return impl.insert_unique(std::move(value_type(args...))); }
+    
+    template <class... Args> 
+    iterator emplace_hint(const_iterator pos, Args&&... args)
+        { return impl.insert_unique(pos, std::move(value_type(args...))); }
+    
+    pair<iterator,bool> insert(const value_type& x) 
+    { return impl.insert_unique(x); }
+
+    pair<iterator,bool> insert(value_type&& x)
+        { return impl.insert_unique(std::move(x)); }
+    iterator insert(const_iterator pos, const value_type& x) {
+        return impl.insert_unique(pos, x);
+    }
+    iterator insert(const_iterator pos, value_type&& x) 
+        { return impl.insert_unique(pos, std::move(x)); }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) 
+        { impl.insert_unique(first, last); }
+    void insert(std::initializer_list<value_type> ilist) 
+        { impl.insert_unique(ilist.begin(), ilist.end()); }
+       
+    iterator erase(const_iterator pos) { return impl.erase(pos); }
+    size_type erase(const key_type& x) { return impl.erase(x); }
+    iterator erase(const_iterator first, const_iterator last)
+        { return impl.erase(first, last); }
+ 
+    void swap(btree_set& x) { impl.swap(x.impl); }
+    void clear() noexcept { impl.clear(); }
+ 
+    // observers:
+    key_compare   key_comp() const { return impl.key_compare(); }
+    value_compare value_comp() const { return value_compare(impl.key_compare()); }
+ 
+    // btree_set operations:
+    iterator       find(const key_type& x) { return impl.find(x); }
+    const_iterator find(const key_type& x) const 
+        { return impl.find(x); }
+
+    size_type      count(const key_type& x) const 
+        { return impl.count(x); }
+
+    iterator       lower_bound(const key_type& x)
+        { return impl.lower_bound(x); }
+    const_iterator lower_bound(const key_type& x) const
+        { return impl.lower_bound(x); }
+    iterator       upper_bound(const key_type& x) 
+        { return impl.upper_bound(x); }
+    const_iterator upper_bound(const key_type& x) const
+        { return impl.upper_bound(x); }
+
+    pair<iterator, iterator> 
+    equal_range(const key_type& x) 
+        { return impl.equal_range(x); }
+    pair<const_iterator, const_iterator> 
+    equal_range(const key_type& x) const 
+        { return impl.equal_range(x); }
+
+    // heterogeneous lookup, only if Compare declares is_transparent
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& x) { return impl.find(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& x) const
+        { return impl.find(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& x) const
+        { return impl.count(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& x)
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& x) const
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& x)
+        { return impl.upper_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& x) const
+        { return impl.upper_bound(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& x)
+        { return impl.equal_range(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& x) const
+        { return impl.equal_range(x); }
+};
+
+template <class Key, class Compare, class Alloc>
+bool operator==(const btree_set<Key,Compare,Alloc>& x, const btree_set<Key,Compare,Alloc>& y) {
+    return x.size() == y.size() && MiniSTL::equal(x.begin(), x.end(), y.begin());
+}
+template <class Key, class Compare, class Alloc>
+bool operator< (const btree_set<Key,Compare,Alloc>& x, const btree_set<Key,Compare,Alloc>& y) {
+    return MiniSTL::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+template <class Key, class Compare, class Alloc>
+bool operator!=(const btree_set<Key,Compare,Alloc>& x, const btree_set<Key,Compare,Alloc>& y) {
+    return !(x == y);
+}
+template <class Key, class Compare, class Alloc>
+bool operator> (const btree_set<Key,Compare,Alloc>& x, const btree_set<Key,Compare,Alloc>& y) {
+    return y < x;
+}
+template <class Key, class Compare, class Alloc>
+bool operator>=(const btree_set<Key,Compare,Alloc>& x, const btree_set<Key,Compare,Alloc>& y) {
+    return !(x < y);
+}
+template <class Key, class Compare, class Alloc>
+bool operator<=(const btree_set<Key,Compare,Alloc>& x, const btree_set<Key,Compare,Alloc>& y) {
+    return !(y < x);
+}
+
+template <class Key, class Compare, class Alloc>
+void swap(btree_set<Key,Compare,Alloc>& x, btree_set<Key,Compare,Alloc>& y) {
+    x.swap(y);
+}
+
+
+} // MiniSTL
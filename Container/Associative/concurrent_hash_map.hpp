@@ -0,0 +1,100 @@
+#pragma once
+
+
+#include "concurrent_hashtable.hpp"
+#include "Function/function.hpp"
+
+namespace MiniSTL {
+
+// hash_map which threads may share, on concurrent_hashtable(a segment
+// per mutex, see there). It takes the hashers and bucket policies of
+// hash_map, but elements are only reached under their lock, so
+// there are no iterators and no operator[]:
+//      find(key, out) copies the mapped value out,
+//      find_or_insert(key, f) runs f(T&) on the value of key, inserting
+//      T() first if key is absent, e.g. a shared counter:
+//          m.find_or_insert(word, [](size_t& n) { ++n; });
+//      for_each(f) runs f(const Key&, T&) on every element.
+template <class Key, class T, class HashFunc, class EqualKey,
+          class Alloc = simple_alloc<pair<const Key, T>, thread_alloc>,
+          class BucketPolicy = prime_bucket_policy>
+class concurrent_hash_map {
+private:
+    using Ht = concurrent_hashtable<pair<const Key,T>,Key,HashFunc,
+                        select1st<pair<const Key,T> >,EqualKey,Alloc,BucketPolicy>;
+    Ht ht;
+
+public:
+    using key_type = typename Ht::key_type;
+    using data_type = T;
+    using mapped_type = T;
+    using value_type = typename Ht::value_type;
+    using hasher = typename Ht::hasher;
+    using key_equal = typename Ht::key_equal;
+    using size_type = typename Ht::size_type;
+    using allocator_type = typename Ht::allocator_type;
+
+    hasher hash_funct() const { return ht.hash_funct(); }
+    key_equal key_eq() const { return ht.key_eq(); }
+    allocator_type get_allocator() const { return ht.get_allocator(); }
+
+public: // ctor
+    concurrent_hash_map()
+        : ht(100, Ht::DEFAULT_SEGMENTS, hasher(), key_equal()) {}
+    explicit concurrent_hash_map(size_type n)
+        : ht(n, Ht::DEFAULT_SEGMENTS, hasher(), key_equal()) {}
+    concurrent_hash_map(size_type n, size_type n_segments)
+        : ht(n, n_segments, hasher(), key_equal()) {}
+    concurrent_hash_map(size_type n, size_type n_segments, const hasher& hf,
+                        const key_equal& eql = key_equal(),
+                        const allocator_type& a = allocator_type())
+        : ht(n, n_segments, hf, eql, select1st<value_type>(), a) {}
+
+public: // size
+    size_type size() const { return ht.size(); }
+    bool empty() const { return ht.empty(); }
+
+    size_type bucket_count() const { return ht.bucket_count(); }
+    size_type elems_in_bucket(size_type n) const { return ht.elems_in_bucket(n); }
+    size_type segment_count() const { return ht.segment_count(); }
+    void reserve(size_type n) { ht.reserve(n); }
+    void max_load_factor(float z) { ht.max_load_factor(z); }
+
+public: // insert, erase
+    bool insert(const value_type& obj) { return ht.insert_unique(obj); }
+    bool insert(const key_type& key, const T& val)
+        { return ht.insert_unique(value_type(key, val)); }
+
+    size_type erase(const key_type& key) { return ht.erase(key); }
+    void clear() { ht.clear(); }
+
+public: // find
+    bool find(const key_type& key, T& out) const {
+        return ht.visit(key, [&out](const value_type& v) { out = v.second; });
+    }
+
+    size_type count(const key_type& key) const { return ht.count(key); }
+
+    // f(T&) on the value of key under its lock, false if key is absent
+    template <class F>
+    bool visit(const key_type& key, F f) {
+        return ht.visit(key, [&f](value_type& v) { f(v.second); });
+    }
+
+    template <class F>
+    void find_or_insert(const key_type& key, F f) {
+        ht.find_or_insert(value_type(key, T()), [&f](value_type& v) { f(v.second); });
+    }
+
+    template <class F>
+    void for_each(F f) {
+        ht.for_each([&f](value_type& v) { f(v.first, v.second); });
+    }
+
+    template <class F>
+    void for_each(F f) const {
+        ht.for_each([&f](const value_type& v) { f(v.first, v.second); });
+    }
+};
+
+} // MiniSTL
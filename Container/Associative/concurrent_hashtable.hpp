@@ -0,0 +1,253 @@
+#pragma once
+
+#include "hashtable.hpp"
+#include "Allocator/thread_alloc.hpp"
+#include <mutex>
+#include <new>
+
+namespace MiniSTL {
+
+// hashtable shared by threads, split into segments. Each segment is a
+// hashtable of its own with its own mutex, a key always lives in the
+// segment picked by the low bits of __hash_int(hash(key)). Operations on
+// keys of different segments run in parallel, and growing a segment
+// blocks only that segment.
+// Implementation properties:
+//      1. There are no iterators and no references to elements, they
+//      would outlive the lock. visit and find_or_insert run a functor on
+//      the element under the segment lock.
+//      2. for_each locks one segment at a time, so it sees a snapshot of
+//      every segment but not of the whole table. size() likewise.
+//      3. A functor must not call back into the same table.
+//      4. Nodes of all segments come from Alloc, which must be thread
+//      safe. The default is simple_alloc over thread_alloc.
+//      5. The key is hashed twice, once for its segment and once in the
+//      segment.
+//      6. The segment bits come from a mix unlike hash_mix, which the
+//      bucket policies apply before taking their high(fastrange) or low
+//      (pow2) bits, so the keys of one segment still spread over all of
+//      its buckets.
+template <class Ht>
+struct __concurrent_segment {
+    // padded, so mutexes of neighbour segments share no cache line
+    mutable std::mutex lock;
+    Ht ht;
+    char pad[64];
+
+    template <class HashFunc, class EqualKey, class ExtractKey, class Alloc>
+    __concurrent_segment(size_t n, const HashFunc& hf, const EqualKey& eql,
+                         const ExtractKey& ext, const Alloc& a)
+        : ht(n, hf, eql, ext, a) {}
+};
+
+template <class Value, class Key, class HashFunc,
+          class ExtractKey, class EqualKey,
+          class Alloc = simple_alloc<Value, thread_alloc>,
+          class BucketPolicy = prime_bucket_policy>
+class concurrent_hashtable 
+    : protected alloc_base<__concurrent_segment<
+                hashtable<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc,BucketPolicy>>,
+                Alloc> {
+private:
+    using Ht = hashtable<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc,BucketPolicy>;
+    using segment = __concurrent_segment<Ht>;
+    using base = alloc_base<segment, Alloc>;
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using hasher = HashFunc;
+    using key_equal = EqualKey;
+    using size_type = size_t;
+    using allocator_type = Alloc;
+
+    enum { DEFAULT_SEGMENTS = 64 };
+
+private:
+    hasher      hash;
+    ExtractKey  get_key;
+    segment*    segs;
+    size_type   num_segs;
+    // segment of hash code h is __hash_int(h) & seg_mask
+    size_type   seg_mask;
+
+    segment& seg_of(const key_type& key) const {
+        if(num_segs == 1)
+            return segs[0];
+        return segs[static_cast<size_type>(__hash_int(hash(key))) & seg_mask];
+    }
+
+public: // ctor, dtor
+    // n is the bucket count hint of the whole table, n_segments is
+    // rounded up to a power of two
+    concurrent_hashtable(size_type n, size_type n_segments,
+                         const HashFunc& hf, const EqualKey& eql,
+                         const ExtractKey& ext = ExtractKey(),
+                         const allocator_type& a = allocator_type())
+        : base(a), hash(hf), get_key(ext), segs(nullptr), num_segs(1), seg_mask(0) {
+        while(num_segs < n_segments)
+            num_segs <<= 1;
+        seg_mask = num_segs - 1;
+        segs = this->allocate_n(num_segs);
+        size_type i = 0;
+        try {
+            for(;i < num_segs;++i)
+                new (segs + i) segment(n / num_segs, hf, eql, ext, a);
+        } catch(...) {
+            while(i > 0)
+                segs[--i].~segment();
+            this->deallocate_n(segs, num_segs);
+            throw;
+        }
+    }
+
+    concurrent_hashtable(const concurrent_hashtable&) = delete;
+    concurrent_hashtable& operator=(const concurrent_hashtable&) = delete;
+
+    ~concurrent_hashtable() {
+        for(size_type i = 0;i < num_segs;++i)
+            segs[i].~segment();
+        this->deallocate_n(segs, num_segs);
+    }
+
+public: // observer
+    hasher hash_funct() const { return hash;}
+    key_equal key_eq() const { return segs[0].ht.key_eq();}
+    allocator_type get_allocator() const { return base::get_allocator();}
+
+    size_type segment_count() const { return num_segs;}
+
+    size_type size() const {
+        size_type result = 0;
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            result += segs[i].ht.size();
+        }
+        return result;
+    }
+
+    bool empty() const { return size() == 0;}
+
+    size_type bucket_count() const {
+        size_type result = 0;
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            result += segs[i].ht.bucket_count();
+        }
+        return result;
+    }
+
+    // buckets are numbered segment after segment
+    size_type elems_in_bucket(size_type bucket) const {
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            const size_type n = segs[i].ht.bucket_count();
+            if(bucket < n)
+                return segs[i].ht.elems_in_bucket(bucket);
+            bucket -= n;
+        }
+        return 0;
+    }
+
+    // buckets for n elements spread evenly over the segments
+    void reserve(size_type n) {
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            segs[i].ht.reserve(n / num_segs + 1);
+        }
+    }
+
+    void max_load_factor(float z) {
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            segs[i].ht.max_load_factor(z);
+        }
+    }
+
+public: // insert, erase
+    bool insert_unique(const value_type& obj) {
+        segment& s = seg_of(get_key(obj));
+        std::lock_guard<std::mutex> guard(s.lock);
+        return s.ht.insert_unique(obj).second;
+    }
+
+    void insert_equal(const value_type& obj) {
+        segment& s = seg_of(get_key(obj));
+        std::lock_guard<std::mutex> guard(s.lock);
+        s.ht.insert_equal(obj);
+    }
+
+    size_type erase(const key_type& key) {
+        segment& s = seg_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        return s.ht.erase(key);
+    }
+
+    void clear() {
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            segs[i].ht.clear();
+        }
+    }
+
+public: // find
+    size_type count(const key_type& key) const {
+        segment& s = seg_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        return s.ht.count(key);
+    }
+
+    // f(value_type&) on the element of key under its lock, false if absent
+    template <class F>
+    bool visit(const key_type& key, F f) {
+        segment& s = seg_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        typename Ht::iterator it = s.ht.find(key);
+        if(it == s.ht.end())
+            return false;
+        f(*it);
+        return true;
+    }
+
+    template <class F>
+    bool visit(const key_type& key, F f) const {
+        const segment& s = seg_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        typename Ht::const_iterator it = s.ht.find(key);
+        if(it == s.ht.end())
+            return false;
+        f(*it);
+        return true;
+    }
+
+    // inserts obj unless its key exists, then f(value_type&) on the
+    // element under its lock, so read-modify-write of a value is atomic
+    template <class F>
+    void find_or_insert(const value_type& obj, F f) {
+        segment& s = seg_of(get_key(obj));
+        std::lock_guard<std::mutex> guard(s.lock);
+        f(s.ht.find_or_insert(obj));
+    }
+
+    // f(value_type&) on every element, one segment locked at a time
+    template <class F>
+    void for_each(F f) {
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            for(typename Ht::iterator it = segs[i].ht.begin();it != segs[i].ht.end();++it)
+                f(*it);
+        }
+    }
+
+    template <class F>
+    void for_each(F f) const {
+        for(size_type i = 0;i < num_segs;++i) {
+            std::lock_guard<std::mutex> guard(segs[i].lock);
+            const Ht& ht = segs[i].ht;
+            for(typename Ht::const_iterator it = ht.begin();it != ht.end();++it)
+                f(*it);
+        }
+    }
+};
+
+} // MiniSTL
@@ -0,0 +1,199 @@
+#pragma once
+
+
+#include "flat_hashtable.hpp"
+#include "Function/function.hpp"
+#include "Iterator/iterator_adaptor.hpp"
+#include <initializer_list>
+
+namespace MiniSTL {
+
+// hash_map on open addressing(flat_hashtable), it takes the template
+// parameters of hash_map so one can replace the other. Differences:
+//      1. insert may move elements, so it invalidates iterators and
+//      references, erase does not.
+//      2. there are no buckets, bucket_count() is the number of slots,
+//      and size hints count elements, not buckets.
+//      3. no elems_in_bucket and insert_noresize.
+template <class Key, class T, class HashFunc, class EqualKey,
+          class Alloc = simple_alloc<pair<const Key, T>> >
+class flat_hash_map {
+private:
+    using Ht = flat_hashtable<pair<const Key,T>,Key,HashFunc,
+                        select1st<pair<const Key,T> >,EqualKey,Alloc>;
+    Ht ht;
+
+public:
+    using key_type = typename Ht::key_type;
+    using data_type = T;
+    using mapped_type = T;
+    using value_type = typename Ht::value_type;
+    using hasher = typename Ht::hasher;
+    using key_equal = typename Ht::key_equal;
+    
+    using size_type = typename Ht::size_type;
+    using difference_type = typename Ht::difference_type;
+    using pointer = typename Ht::pointer;
+    using const_pointer = typename Ht::const_pointer;
+    using reference = typename Ht::reference;
+    using const_reference = typename Ht::const_reference;
+
+    using iterator = typename Ht::iterator;
+    using const_iterator = typename Ht::const_iterator;
+
+    using allocator_type = typename Ht::allocator_type;
+
+    hasher hash_funct() const { return ht.hash_funct(); }
+    key_equal key_eq() const { return ht.key_eq(); }
+    allocator_type get_allocator() const { return ht.get_allocator(); }
+
+    template <class K1, class T1, class HF, class Eq, class Al>
+    friend bool operator== (const flat_hash_map<K1, T1, HF, Eq, Al>&,
+                            const flat_hash_map<K1, T1, HF, Eq, Al>&);
+
+public: // ctor
+    flat_hash_map() : ht(0, hasher(), key_equal()) {}
+    explicit flat_hash_map(size_type n)
+        : ht(n, hasher(), key_equal()) {}
+    flat_hash_map(size_type n, const hasher& hf)
+        : ht(n, hf, key_equal()) {}
+    flat_hash_map(size_type n, const hasher& hf, const key_equal& eql,
+             const allocator_type& a = allocator_type())
+        : ht(n, hf, eql, a) {}
+
+
+    template <class InputIt>
+    flat_hash_map(InputIt f, InputIt l)
+        : ht(0, hasher(), key_equal())
+        { ht.insert_unique(f, l); }
+    template <class InputIt>
+    flat_hash_map(InputIt f, InputIt l, size_type n)
+        : ht(n, hasher(), key_equal())
+        { ht.insert_unique(f, l); }
+    template <class InputIt>
+    flat_hash_map(InputIt f, InputIt l, size_type n, const hasher& hf)
+        : ht(n, hf, key_equal())
+        { ht.insert_unique(f, l); }
+    
+    template <class InputIt>
+    flat_hash_map(InputIt f, InputIt l, size_type n,
+            const hasher& hf, const key_equal& eql,
+            const allocator_type& a = allocator_type())
+        : ht(n, hf, eql, a)
+        { ht.insert_unique(f, l); }
+
+    flat_hash_map(std::initializer_list<pair<const Key, T>> ilist)
+        : ht(ilist.size(), hasher(), key_equal()) 
+        { ht.insert_unique(ilist.begin(), ilist.end()); }
+
+public: // size
+    size_type size() const { return ht.size(); }
+    size_type max_size() const { return ht.max_size(); }
+    bool empty() const { return ht.empty(); }
+
+    void resize(size_type hint) { ht.resize(hint); }
+    size_type bucket_count() const { return ht.bucket_count(); }
+    size_type max_bucket_count() const { return ht.max_bucket_count(); }
+
+    iterator begin() { return ht.begin(); }
+    iterator end() { return ht.end(); }
+    const_iterator begin() const { return ht.begin(); }
+    const_iterator end() const { return ht.end(); }
+
+public: // insert
+    pair<iterator,bool> insert(const value_type& obj)
+        { return ht.insert_unique(obj); }
+    
+    template <class InputIt>
+    void insert(InputIt f, InputIt l)
+        { ht.insert_unique(f,l); }
+    
+    void insert(const value_type* f, const value_type* l) 
+        { ht.insert_unique(f,l); }
+
+    void insert(const_iterator f, const_iterator l)
+        { ht.insert_unique(f, l); }
+
+public: // find
+    iterator find(const key_type& key) { return ht.find(key); }
+
+    const_iterator find(const key_type& key) const 
+        { return ht.find(key); }
+
+    // map[key] semantics: if key exists, return value;else insert (key, T());
+    T& operator[](const key_type& key) {
+        return ht.find_or_insert(value_type(key, T())).second;
+    }
+
+    size_type count(const key_type& key) const { return ht.count(key); }
+    
+    pair<iterator, iterator> equal_range(const key_type& key)
+        { return ht.equal_range(key); }
+    
+    pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const
+        { return ht.equal_range(key); }
+
+public: // erase
+    size_type erase(const key_type& key) {return ht.erase(key); }
+    void erase(iterator it) { ht.erase(it); }
+    void erase(iterator f, iterator l) { ht.erase(f, l); }
+    void clear() { ht.clear(); }
+
+    void swap(flat_hash_map& hm) { ht.swap(hm.ht); }
+};
+
+template <class Key, class T, class HashFunc, class EqlKey, class Alloc>
+inline bool 
+operator==(const flat_hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm1,
+           const flat_hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm2) {
+    return hm1.ht == hm2.ht;
+}
+
+template <class Key, class T, class HashFunc, class EqlKey, class Alloc>
+inline bool 
+operator!=(const flat_hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm1,
+           const flat_hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm2) {
+    return !(hm1 == hm2);
+}
+
+template <class Key, class T, class HashFunc, class EqlKey, class Alloc>
+inline void 
+swap(flat_hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm1,
+     flat_hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm2) {
+    hm1.swap(hm2);
+}
+
+
+// Specialization of insert_iterator so that it will work for flat_hash_map
+
+template <class Key, class T, class HF,  class Eq, class Alloc>
+class insert_iterator<flat_hash_map<Key, T, HF, Eq, Alloc> > {
+protected:
+    using Container = flat_hash_map<Key, T, HF, Eq, Alloc>;
+    Container* c;
+public:
+
+    using container_type = Container;
+    using iterator_category = output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+
+    insert_iterator(Container& x) : c(&x) {}
+    insert_iterator(Container& x, typename Container::iterator)
+        : c(&x) {}
+    
+    insert_iterator<Container>&
+    operator=(const typename Container::value_type& val) { 
+        c->insert(val);
+        return *this;
+    }
+
+    insert_iterator<Container>& operator*() { return *this; }
+    insert_iterator<Container>& operator++() { return *this; }
+    insert_iterator<Container>& operator++(int) { return *this; }
+};
+
+} // MiniSTL
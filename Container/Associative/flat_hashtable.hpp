@@ -0,0 +1,871 @@
+#pragma once
+
+#include "Allocator/memory.hpp"
+#include "Function/function.hpp"
+#include "Util/pair.hpp"
+#include "hash_fun.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+namespace MiniSTL {
+
+// Open addressing hash table with one control byte per slot,
+// after SwissTable(abseil flat_hash_map)
+// Implementation properties:
+//      1. Elements live in a flat slot array, no node per element. A
+//      parallel array of control bytes tells for each slot whether it
+//      is empty, deleted or full, a full slot keeps 7 bits of the hash
+//      of its key(H2).
+//      2. The rest of the hash(H1) picks where probing starts. Probing
+//      reads a group of control bytes at once, compares all of them to
+//      H2, and only calls EqualKey on the slots matching it. A group with
+//      an empty byte ends the probe. Groups are 16 bytes compared by SSE2,
+//      or 8 bytes in a 64-bit word where there is no SSE2.
+//      3. Number of slots is 2^k - 1. Control bytes are followed by a
+//      sentinel, which ends iteration, and a copy of the first group - 1
+//      bytes, so a group read never has to wrap around.
+//      4. The table grows by doubling when 7/8 of slots are used, erase
+//      leaves a tombstone unless no probe can have passed the slot.
+//      5. Rehashing moves elements, iterators and references are
+//      invalidated by insert, but not by erase.
+// An empty table allocates nothing, its control bytes are a static
+// empty group.
+
+// control byte of a slot: full slots hold H2 in [0, 127]
+using flat_ctrl_t = signed char;
+
+enum flat_ctrl_value {
+    CTRL_EMPTY = -128,
+    CTRL_DELETED = -2,
+    CTRL_SENTINEL = -1
+};
+
+inline int flat_ctz(uint32_t x) { return __builtin_ctz(x); }
+inline int flat_ctz(uint64_t x) { return __builtin_ctzll(x); }
+inline int flat_clz(uint32_t x) { return __builtin_clz(x); }
+inline int flat_clz(uint64_t x) { return __builtin_clzll(x); }
+
+// slots of a group matching some condition, one bit per slot
+// (Shift = 0) or the top bit of one byte per slot(Shift = 3)
+template <class T, int Width, int Shift>
+struct flat_bitmask {
+    T mask;
+
+    explicit flat_bitmask(T m) : mask(m) {}
+
+    explicit operator bool() const { return mask != 0; }
+
+    // index in group of first match
+    int lowest() const { return flat_ctz(mask) >> Shift; }
+    void clear_lowest() { mask &= mask - 1; }
+
+    // matches at start and end of group
+    int trailing_zeros() const {
+        return mask != 0 ? flat_ctz(mask) >> Shift : Width;
+    }
+    int leading_zeros() const {
+        const int unused = static_cast<int>(sizeof(T) * 8) - (Width << Shift);
+        return mask != 0 ? (flat_clz(mask) - unused) >> Shift : Width;
+    }
+};
+
+// group of 8 control bytes handled in a 64-bit word(SWAR),
+// works on every target
+struct flat_group_portable {
+    enum { WIDTH = 8 };
+    using bitmask = flat_bitmask<uint64_t, WIDTH, 3>;
+
+    static constexpr uint64_t LSBS = 0x0101010101010101ull;
+    static constexpr uint64_t MSBS = 0x8080808080808080ull;
+
+    uint64_t ctrl;
+
+    explicit flat_group_portable(const flat_ctrl_t* pos) {
+        memcpy(&ctrl, pos, sizeof(ctrl));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        ctrl = __builtin_bswap64(ctrl);
+#endif
+    }
+
+    // may report a false match next to a true one, callers compare keys
+    bitmask match(flat_ctrl_t h2) const {
+        const uint64_t x = ctrl ^ (LSBS * static_cast<unsigned char>(h2));
+        return bitmask((x - LSBS) & ~x & MSBS);
+    }
+
+    // top bit set, bit 1 clear: only CTRL_EMPTY
+    bitmask match_empty() const {
+        return bitmask((ctrl & (~ctrl << 6)) & MSBS);
+    }
+
+    // top bit set, bit 0 clear: CTRL_EMPTY and CTRL_DELETED
+    bitmask match_empty_or_deleted() const {
+        return bitmask((ctrl & (~ctrl << 7)) & MSBS);
+    }
+};
+
+#if defined(__SSE2__)
+// group of 16 control bytes compared at once by SSE2
+struct flat_group_sse2 {
+    enum { WIDTH = 16 };
+    using bitmask = flat_bitmask<uint32_t, WIDTH, 0>;
+
+    __m128i ctrl;
+
+    explicit flat_group_sse2(const flat_ctrl_t* pos)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    bitmask match(flat_ctrl_t h2) const {
+        return bitmask(static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+    }
+
+    bitmask match_empty() const {
+        return match(static_cast<flat_ctrl_t>(CTRL_EMPTY));
+    }
+
+    // signed compare: CTRL_EMPTY and CTRL_DELETED are below CTRL_SENTINEL
+    bitmask match_empty_or_deleted() const {
+        const __m128i sentinel = _mm_set1_epi8(static_cast<char>(CTRL_SENTINEL));
+        return bitmask(static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpgt_epi8(sentinel, ctrl))));
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+// group of 32 control bytes compared at once by AVX2
+struct flat_group_avx2 {
+    enum { WIDTH = 32 };
+    using bitmask = flat_bitmask<uint32_t, WIDTH, 0>;
+
+    __m256i ctrl;
+
+    explicit flat_group_avx2(const flat_ctrl_t* pos)
+        : ctrl(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos))) {}
+
+    bitmask match(flat_ctrl_t h2) const {
+        return bitmask(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(h2), ctrl))));
+    }
+
+    bitmask match_empty() const {
+        return match(static_cast<flat_ctrl_t>(CTRL_EMPTY));
+    }
+
+    bitmask match_empty_or_deleted() const {
+        const __m256i sentinel = _mm256_set1_epi8(static_cast<char>(CTRL_SENTINEL));
+        return bitmask(static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpgt_epi8(sentinel, ctrl))));
+    }
+};
+#endif
+
+// default group of flat_hashtable, another one may be given as its last
+// template parameter. Not AVX2: a 32 byte group finds no key faster than
+// a 16 byte one(see bench_flat_probe.cpp) and makes small tables bigger.
+#if defined(__SSE2__)
+using flat_group = flat_group_sse2;
+#else
+using flat_group = flat_group_portable;
+#endif
+
+inline size_t flat_h1(size_t hash) { return hash >> 7; }
+inline flat_ctrl_t flat_h2(size_t hash) { return static_cast<flat_ctrl_t>(hash & 0x7F); }
+
+// triangular probing over groups of Width, visits every group once when
+// number of slots + 1 is a power of two
+template <int Width>
+struct flat_probe {
+    size_t mask;
+    size_t offset;
+    size_t index;
+
+    flat_probe(size_t h1, size_t m) : mask(m), offset(h1 & m), index(0) {}
+
+    size_t at(size_t i) const { return (offset + i) & mask; }
+
+    void next() {
+        index += Width;
+        offset = (offset + index) & mask;
+    }
+};
+
+// control bytes of a table without slots: a sentinel, then empty bytes
+// enough for any group read
+inline flat_ctrl_t* flat_empty_group() {
+    alignas(16) static const flat_ctrl_t empty_group[32] = {
+        CTRL_SENTINEL, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY,
+        CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY, CTRL_EMPTY
+    };
+    // never written, insert allocates real control bytes first
+    return const_cast<flat_ctrl_t*>(empty_group);
+}
+
+
+template <class Value, class Key, class HashFunc,
+          class ExtractKey, class EqualKey, class Alloc = simple_alloc<Value>,
+          class Group = flat_group>
+class flat_hashtable;
+
+template <class Value>
+struct flat_hashtable_const_iterator;
+
+template <class Value>
+struct flat_hashtable_iterator {
+    using iterator = flat_hashtable_iterator<Value>;
+    using const_iterator = flat_hashtable_const_iterator<Value>;
+
+    using iterator_category = forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = ptrdiff_t;
+    using size_type = size_t;
+    using reference = Value&;
+    using pointer = Value*;
+
+    const flat_ctrl_t* ctrl;
+    Value* slot;
+
+    flat_hashtable_iterator(const flat_ctrl_t* c, Value* s)
+        : ctrl(c), slot(s) {}
+
+    flat_hashtable_iterator() {}
+
+    reference operator*() const { return *slot; }
+    pointer operator->() const { return &(operator*()); }
+
+    // stop on a full slot or the sentinel
+    void skip_empty() {
+        while(*ctrl < CTRL_SENTINEL) {
+            ++ctrl;
+            ++slot;
+        }
+    }
+
+    iterator& operator++() {
+        ++ctrl;
+        ++slot;
+        skip_empty();
+        return *this;
+    }
+    iterator operator++(int) {
+        iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const iterator& it) const
+        { return ctrl == it.ctrl;}
+    bool operator!=(const iterator& it) const
+        { return ctrl != it.ctrl;}
+};
+
+template <class Value>
+struct flat_hashtable_const_iterator {
+    using iterator = flat_hashtable_iterator<Value>;
+    using const_iterator = flat_hashtable_const_iterator<Value>;
+
+    using iterator_category = forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = ptrdiff_t;
+    using size_type = size_t;
+    using reference = const Value&;
+    using pointer = const Value*;
+
+    const flat_ctrl_t* ctrl;
+    const Value* slot;
+
+    flat_hashtable_const_iterator(const flat_ctrl_t* c, const Value* s)
+        : ctrl(c), slot(s) {}
+    flat_hashtable_const_iterator() {}
+    flat_hashtable_const_iterator(const iterator& it)
+        : ctrl(it.ctrl), slot(it.slot) {}
+
+    reference operator*() const { return *slot; }
+    pointer operator->() const { return &(operator*()); }
+
+    void skip_empty() {
+        while(*ctrl < CTRL_SENTINEL) {
+            ++ctrl;
+            ++slot;
+        }
+    }
+
+    const_iterator& operator++() {
+        ++ctrl;
+        ++slot;
+        skip_empty();
+        return *this;
+    }
+    const_iterator operator++(int) {
+        const_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const const_iterator& it) const
+        { return ctrl == it.ctrl;}
+    bool operator!=(const const_iterator& it) const
+        { return ctrl != it.ctrl;}
+};
+
+
+template <class Value, class Key, class HashFunc,
+          class ExtractKey, class EqualKey, class Alloc, class Group>
+class flat_hashtable : protected alloc_base<Value, Alloc> {
+private:
+    using base = alloc_base<Value, Alloc>;
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using hasher = HashFunc;
+    using key_equal = EqualKey;
+
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = Value*;
+    using const_pointer = const Value*;
+    using reference = Value&;
+    using const_reference = const Value&;
+
+    using iterator = flat_hashtable_iterator<Value>;
+    using const_iterator = flat_hashtable_const_iterator<Value>;
+
+    hasher hash_funct() const { return hash;}
+    key_equal key_eq() const { return equals;}
+
+public:
+    using allocator_type = Alloc;
+    allocator_type get_allocator() const { return base::get_allocator();}
+
+private:
+    using group = Group;
+    using probe = flat_probe<group::WIDTH>;
+
+    // control bytes allocate from the same allocator as slots
+    struct ctrl_alloc : alloc_base<flat_ctrl_t, Alloc> {
+        explicit ctrl_alloc(const Alloc& a) : alloc_base<flat_ctrl_t, Alloc>(a) {}
+        using alloc_base<flat_ctrl_t, Alloc>::allocate_n;
+        using alloc_base<flat_ctrl_t, Alloc>::deallocate_n;
+    };
+
+    // group reads past the end are covered by clone bytes only from
+    // WIDTH - 1 slots on
+    enum { MIN_SLOTS = group::WIDTH > 16 ? group::WIDTH - 1 : 15 };
+
+    hasher          hash;
+    key_equal       equals;
+    ExtractKey      get_key;
+    flat_ctrl_t*    ctrl;
+    Value*          slots;
+    size_type       num_slots;      // 2^k - 1, or 0 if nothing allocated
+    size_type       num_elements;
+    size_type       growth_left;    // inserts into empty slots before rehash
+
+private: // slots related operation
+    static size_type ctrl_bytes(size_type n) { return n + group::WIDTH; }
+
+    // max elements in n slots: 7/8 load factor
+    static size_type slots_to_growth(size_type n) { return n - n / 8; }
+
+    // least number of slots holding n elements
+    static size_type growth_to_slots(size_type n) {
+        size_type want = n + (n + 6) / 7;
+        size_type slots = MIN_SLOTS;
+        while(slots < want)
+            slots = slots * 2 + 1;
+        return slots;
+    }
+
+    static bool is_full(flat_ctrl_t c) { return c >= 0; }
+
+    // all bits of the hash are mixed before it is split into H1 and H2
+    size_t hash_of_key(const key_type& key) const {
+        return hash_mix(hash(key));
+    }
+
+    // set control byte i and its copy after the sentinel
+    void set_ctrl(size_type i, flat_ctrl_t c) {
+        ctrl[i] = c;
+        ctrl[((i - (group::WIDTH - 1)) & num_slots) + ((group::WIDTH - 1) & num_slots)] = c;
+    }
+
+    void reset_ctrl() {
+        memset(ctrl, CTRL_EMPTY, ctrl_bytes(num_slots));
+        ctrl[num_slots] = CTRL_SENTINEL;
+        growth_left = slots_to_growth(num_slots) - num_elements;
+    }
+
+    void initialize_empty() {
+        ctrl = flat_empty_group();
+        slots = nullptr;
+        num_slots = 0;
+        num_elements = 0;
+        growth_left = 0;
+    }
+
+    // allocate n slots, all empty, elements are counted but not placed
+    void initialize_slots(size_type n) {
+        flat_ctrl_t* c = ctrl_alloc(get_allocator()).allocate_n(ctrl_bytes(n));
+        try {
+            slots = this->allocate_n(n);
+        } catch(std::exception&) {
+            ctrl_alloc(get_allocator()).deallocate_n(c, ctrl_bytes(n));
+            throw;
+        }
+        ctrl = c;
+        num_slots = n;
+        reset_ctrl();
+    }
+
+    // free arrays of storage(ctrl, slots, n), elements are gone already
+    void deallocate_slots(flat_ctrl_t* c, Value* s, size_type n) {
+        if(n != 0) {
+            ctrl_alloc(get_allocator()).deallocate_n(c, ctrl_bytes(n));
+            this->deallocate_n(s, n);
+        }
+    }
+
+    void destroy_slots() {
+        for(size_type i = 0;i < num_slots;++i) {
+            if(is_full(ctrl[i]))
+                destroy(slots + i);
+        }
+    }
+
+    // first empty or deleted slot on the probe sequence of hash
+    size_type find_first_non_full(size_t hash) const {
+        probe seq(flat_h1(hash), num_slots);
+        for(;;) {
+            const typename group::bitmask m = group(ctrl + seq.offset).match_empty_or_deleted();
+            if(m)
+                return seq.at(m.lowest());
+            seq.next();
+        }
+    }
+
+    // slot of key into idx, false if key is not here
+    bool find_index(const key_type& key, size_t hash, size_type& idx) const {
+        const flat_ctrl_t h2 = flat_h2(hash);
+        probe seq(flat_h1(hash), num_slots);
+        for(;;) {
+            const group g(ctrl + seq.offset);
+            for(typename group::bitmask m = g.match(h2);m;m.clear_lowest()) {
+                const size_type i = seq.at(m.lowest());
+                if(equals(get_key(slots[i]), key)) {
+                    idx = i;
+                    return true;
+                }
+            }
+            if(g.match_empty())
+                return false;
+            seq.next();
+        }
+    }
+
+    // slot for a new element of hash, growing the table if needed
+    size_type prepare_insert(size_t hash) {
+        size_type idx = find_first_non_full(hash);
+        if(growth_left == 0 && ctrl[idx] != CTRL_DELETED) {
+            rehash_and_grow();
+            idx = find_first_non_full(hash);
+        }
+        return idx;
+    }
+
+    // control byte of a slot just constructed
+    void finish_insert(size_type idx, size_t hash) {
+        growth_left -= ctrl[idx] == CTRL_EMPTY;
+        set_ctrl(idx, flat_h2(hash));
+        ++num_elements;
+    }
+
+    // many tombstones: rehash in place, else double the slots
+    void rehash_and_grow() {
+        if(num_slots == 0)
+            rehash_slots(MIN_SLOTS);
+        else if(num_slots > group::WIDTH && num_elements * 32 <= num_slots * 25)
+            rehash_slots(num_slots);
+        else
+            rehash_slots(num_slots * 2 + 1);
+    }
+
+    void rehash_slots(size_type n);
+
+    void erase_at(size_type idx);
+
+    iterator iterator_at(size_type idx) {
+        return iterator(ctrl + idx, slots + idx);
+    }
+    const_iterator iterator_at(size_type idx) const {
+        return const_iterator(ctrl + idx, slots + idx);
+    }
+
+    void copy_from(const flat_hashtable& ht);
+
+    // allocator of ht replaces ours on copy assignment if it propagates,
+    // storage got from our allocator must go first
+    void copy_assign_alloc(const flat_hashtable& ht, true_type) {
+        if(!this->alloc_equal(ht)) {
+            deallocate_slots(ctrl, slots, num_slots);
+            initialize_empty();
+        }
+        this->copy_alloc(ht, true_type());
+    }
+
+    void copy_assign_alloc(const flat_hashtable&, false_type) {}
+
+    void move_assign(flat_hashtable& ht, true_type) {
+        clear();
+        copy_assign_alloc(ht, true_type());
+        swap(ht);
+    }
+
+    // slots can only be taken from an equal allocator,
+    // otherwise elements are copied into our own slots
+    void move_assign(flat_hashtable& ht, false_type) {
+        if(this->alloc_equal(ht)) {
+            clear();
+            swap(ht);
+        } else {
+            *this = ht;
+            ht.clear();
+        }
+    }
+
+public: // ctor, dtor
+    // n: number of elements to make room for
+    flat_hashtable(size_type n, const HashFunc& hf, const EqualKey& eql,
+                   const ExtractKey& ext,
+                   const allocator_type& a = allocator_type())
+        : base(a), hash(hf), equals(eql), get_key(ext) {
+        initialize_empty();
+        resize(n);
+    }
+
+    flat_hashtable(size_type n, const HashFunc& hf, const EqualKey& eql,
+                   const allocator_type& a = allocator_type())
+        : base(a), hash(hf), equals(eql), get_key(ExtractKey()) {
+        initialize_empty();
+        resize(n);
+    }
+
+    flat_hashtable(const flat_hashtable& ht)
+        : base(ht.get_allocator()), hash(ht.hash), equals(ht.equals),
+        get_key(ht.get_key) {
+        initialize_empty();
+        copy_from(ht);
+    }
+
+    flat_hashtable(flat_hashtable&& ht)
+        : base(ht.get_allocator()), hash(ht.hash), equals(ht.equals),
+        get_key(ht.get_key) {
+        initialize_empty();
+        swap(ht);
+    }
+
+    flat_hashtable& operator= (const flat_hashtable& ht) {
+        if(&ht != this) {
+            clear();
+            copy_assign_alloc(ht, typename base::propagate_on_copy());
+            hash = ht.hash;
+            equals = ht.equals;
+            get_key = ht.get_key;
+            copy_from(ht);
+        }
+        return *this;
+    }
+
+    flat_hashtable& operator= (flat_hashtable&& ht) {
+        if(&ht != this)
+            move_assign(ht, typename base::propagate_on_move());
+        return *this;
+    }
+
+    ~flat_hashtable() {
+        destroy_slots();
+        deallocate_slots(ctrl, slots, num_slots);
+    }
+
+public:
+    iterator begin() {
+        iterator it(ctrl, slots);
+        it.skip_empty();
+        return it;
+    }
+
+    iterator end() { return iterator(ctrl + num_slots, slots + num_slots);}
+
+    const_iterator begin() const {
+        const_iterator it(ctrl, slots);
+        it.skip_empty();
+        return it;
+    }
+
+    const_iterator end() const { return const_iterator(ctrl + num_slots, slots + num_slots);}
+
+public: // observer
+    // slots play the part of buckets
+    size_type bucket_count() const { return num_slots;}
+    size_type max_bucket_count() const { return SIZE_MAX / sizeof(Value);}
+
+    size_type size() const { return num_elements;}
+    size_type max_size() const { return slots_to_growth(max_bucket_count());}
+    bool empty() const { return size() == 0;}
+
+public: // insert
+    pair<iterator, bool> insert_unique(const value_type& obj);
+
+    template <class InputIt>
+    void insert_unique(InputIt f, InputIt l) {
+        insert_unique(f, l, iterator_category_t<InputIt>());
+    }
+
+    template <class InputIt>
+    void insert_unique(InputIt f, InputIt l, input_iterator_tag) {
+        for(;f != l;++f)
+            insert_unique(*f);
+    }
+
+    template <class ForwardIt>
+    void insert_unique(ForwardIt f, ForwardIt l, forward_iterator_tag) {
+        size_type n = MiniSTL::distance(f, l);
+        resize(num_elements + n);
+        for(;n > 0;--n, ++f)
+            insert_unique(*f);
+    }
+
+public: // find
+    reference find_or_insert(const value_type& obj);
+
+    iterator find(const key_type& key) {
+        size_type idx;
+        return find_index(key, hash_of_key(key), idx) ? iterator_at(idx) : end();
+    }
+
+    const_iterator find(const key_type& key) const {
+        size_type idx;
+        return find_index(key, hash_of_key(key), idx) ? iterator_at(idx) : end();
+    }
+
+    size_type count(const key_type& key) const {
+        size_type idx;
+        return find_index(key, hash_of_key(key), idx) ? 1 : 0;
+    }
+
+    pair<iterator, iterator> equal_range(const key_type& key) {
+        iterator first = find(key);
+        iterator last = first;
+        if(first != end())
+            ++last;
+        return pair<iterator, iterator>(first, last);
+    }
+
+    pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+        const_iterator first = find(key);
+        const_iterator last = first;
+        if(first != end())
+            ++last;
+        return pair<const_iterator, const_iterator>(first, last);
+    }
+
+public: // erase, resize, swap
+    size_type erase(const key_type& key) {
+        size_type idx;
+        if(!find_index(key, hash_of_key(key), idx))
+            return 0;
+        erase_at(idx);
+        return 1;
+    }
+
+    void erase(const const_iterator& it) {
+        if(it.ctrl != ctrl + num_slots)
+            erase_at(static_cast<size_type>(it.ctrl - ctrl));
+    }
+
+    // erase leaves other elements in place, so iteration goes on
+    void erase(const_iterator first, const_iterator last) {
+        while(first != last)
+            erase(first++);
+    }
+
+    // make room for num_elements_hint elements without growing
+    void resize(size_type num_elements_hint) {
+        if(num_elements_hint > slots_to_growth(num_slots))
+            rehash_slots(growth_to_slots(num_elements_hint));
+    }
+
+    void clear();
+
+    void swap(flat_hashtable& ht) {
+        this->swap_alloc(ht, typename base::propagate_on_swap());
+        MiniSTL::swap(hash, ht.hash);
+        MiniSTL::swap(equals, ht.equals);
+        MiniSTL::swap(get_key, ht.get_key);
+        MiniSTL::swap(ctrl, ht.ctrl);
+        MiniSTL::swap(slots, ht.slots);
+        MiniSTL::swap(num_slots, ht.num_slots);
+        MiniSTL::swap(num_elements, ht.num_elements);
+        MiniSTL::swap(growth_left, ht.growth_left);
+    }
+};
+
+
+// same elements, whatever their slots
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+bool operator==(const flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>& ht1,
+                const flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>& ht2) {
+    if(ht1.size() != ht2.size())
+        return false;
+    const Ex get_key = Ex();
+    for(auto it = ht1.begin();it != ht1.end();++it) {
+        auto pos = ht2.find(get_key(*it));
+        if(pos == ht2.end() || !(*pos == *it))
+            return false;
+    }
+    return true;
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+inline bool operator!=(const flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>& ht1,
+                       const flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>& ht2) {
+    return !(ht1 == ht2);
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+inline void swap(flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>& ht1,
+                 flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>& ht2) {
+    ht1.swap(ht2);
+}
+
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+pair<typename flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::iterator, bool>
+flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::insert_unique(const value_type& obj) {
+    const size_t h = hash_of_key(get_key(obj));
+    size_type idx;
+    if(find_index(get_key(obj), h, idx))
+        return pair<iterator, bool>(iterator_at(idx), false);
+    idx = prepare_insert(h);
+    construct(slots + idx, obj);
+    finish_insert(idx, h);
+    return pair<iterator, bool>(iterator_at(idx), true);
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+typename flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::reference
+flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::find_or_insert(const value_type& obj) {
+    return *insert_unique(obj).first;
+}
+
+// move elements into n new slots, old slots are freed only when all
+// elements made it, so a throwing copy leaves the table as it was
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+void flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::rehash_slots(size_type n) {
+    flat_ctrl_t* old_ctrl = ctrl;
+    Value* old_slots = slots;
+    const size_type old_n = num_slots;
+    const size_type old_growth = growth_left;
+
+    initialize_slots(n);
+    size_type i = 0;
+    try {
+        for(;i < old_n;++i) {
+            if(is_full(old_ctrl[i])) {
+                const size_t h = hash_of_key(get_key(old_slots[i]));
+                const size_type idx = find_first_non_full(h);
+                new (static_cast<void*>(slots + idx)) Value(std::move_if_noexcept(old_slots[i]));
+                set_ctrl(idx, flat_h2(h));
+            }
+        }
+    } catch(...) {
+        destroy_slots();
+        deallocate_slots(ctrl, slots, num_slots);
+        ctrl = old_ctrl;
+        slots = old_slots;
+        num_slots = old_n;
+        growth_left = old_growth;
+        throw;
+    }
+
+    for(i = 0;i < old_n;++i) {
+        if(is_full(old_ctrl[i]))
+            destroy(old_slots + i);
+    }
+    deallocate_slots(old_ctrl, old_slots, old_n);
+}
+
+// a slot may become empty again if no probe ever went past it, that is
+// if the run of full and deleted slots around it is shorter than a group
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+void flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::erase_at(size_type idx) {
+    destroy(slots + idx);
+    --num_elements;
+    const size_type before = (idx - group::WIDTH) & num_slots;
+    const typename group::bitmask empty_after = group(ctrl + idx).match_empty();
+    const typename group::bitmask empty_before = group(ctrl + before).match_empty();
+    const bool never_full = empty_before && empty_after &&
+        empty_after.trailing_zeros() + empty_before.leading_zeros() < group::WIDTH;
+    set_ctrl(idx, never_full ? CTRL_EMPTY : CTRL_DELETED);
+    growth_left += never_full;
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+void flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::clear() {
+    if(num_elements == 0)
+        return;
+    destroy_slots();
+    num_elements = 0;
+    reset_ctrl();
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Gr>
+void flat_hashtable<Value,Key,HF,Ex,Eq,Al,Gr>::copy_from(const flat_hashtable& ht) {
+    if(num_slots != ht.num_slots) {
+        deallocate_slots(ctrl, slots, num_slots);
+        initialize_empty();
+        if(ht.num_slots != 0)
+            initialize_slots(ht.num_slots);
+    }
+    if(ht.num_slots == 0)
+        return;
+    memcpy(ctrl, ht.ctrl, ctrl_bytes(num_slots));
+    size_type i = 0;
+    try {
+        for(;i < num_slots;++i) {
+            if(is_full(ctrl[i]))
+                construct(slots + i, ht.slots[i]);
+        }
+    } catch(...) {
+        while(i-- > 0) {
+            if(is_full(ctrl[i]))
+                destroy(slots + i);
+        }
+        num_elements = 0;
+        reset_ctrl();
+        throw;
+    }
+    num_elements = ht.num_elements;
+    growth_left = ht.growth_left;
+}
+
+} // MiniSTL
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "flat_tree.hpp"
+#include "Function/function.hpp"
+
+#include <initializer_list>
+#include <stdexcept>
+
+
+namespace MiniSTL {
+    
+template <class Key, class T, class Compare = less<Key>,
+          class Allocator = simple_alloc<pair<Key, T>> >
+class flat_map {
+public:
+    // types alias
+    using key_type = Key;
+    using map_type = T;
+    // values are shifted and sorted in place, so the key is not const
+    using value_type = pair<Key, T>;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+protected:
+    using impl_t = flat_tree<key_type, value_type,     
+                              select1st<value_type>, 
+                              Compare, Allocator>;
+	impl_t impl;
+
+public:
+    // type alias
+    using size_type	= typename impl_t::size_type;
+    using difference_type = typename impl_t::difference_type;
+    using reference	= typename impl_t::reference;
+    using const_reference = typename impl_t::const_reference;
+    using pointer = typename impl_t::pointer;
+    using const_pointer = typename impl_t::const_pointer;
+    using iterator = typename impl_t::iterator;
+    using const_iterator = typename impl_t::const_iterator;
+    using reverse_iterator	= typename impl_t::reverse_iterator;
+    using const_reverse_iterator = typename impl_t::const_reverse_iterator;
+
+    class value_compare : public binary_function<value_type, value_type, bool> {
+		friend class flat_map;
+	protected:
+		Compare comp;
+		value_compare(Compare c) : comp(c) {}
+	public:
+        typedef bool        result_type;
+        typedef value_type  first_argument_type;
+        typedef value_type  second_argument_type;
+        bool operator()(const value_type& x, const value_type& y) const {
+            return comp(x.first, y.first);
+        }
+	};
+
+    // construct/copy/destroy:
+    explicit flat_map(const Compare& comp = Compare(),
+                 const allocator_type& a = allocator_type())
+        : impl(comp, a) {}
+
+    template <class InputIt>
+    flat_map(InputIt first, InputIt last, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(first, last); }
+    
+    flat_map(const flat_map& x) : impl(x.impl) {}
+    flat_map(flat_map&& x) : impl(std::move(x.impl)) {}
+    flat_map(std::initializer_list<value_type> ilist, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(ilist.begin(), ilist.end()); }
+    ~flat_map() {}
+    
+    // assign
+    flat_map& operator=(const flat_map& x) { impl = x.impl; return *this; }
+    flat_map& operator=(flat_map&& x) { impl = std::move(x.impl); return *this; }
+    flat_map& operator=(std::initializer_list<value_type> ilist) {
+        impl.clear();
+        impl.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return impl.get_allocator(); }
+ 
+    // iterators:
+    iterator        begin() noexcept { return impl.begin(); }
+    const_iterator  begin() const noexcept { return impl.begin(); }
+    iterator        end() noexcept { return impl.end(); }
+    const_iterator  end() const noexcept { return impl.end(); }
+ 
+    reverse_iterator        rbegin() noexcept { return impl.rbegin(); }
+    const_reverse_iterator  rbegin() const noexcept { return impl.rbegin(); }
+    reverse_iterator        rend() noexcept { return impl.rend(); }
+    const_reverse_iterator  rend() const noexcept { return impl.rend(); }
+ 
+    const_iterator          cbegin() const noexcept { return impl.cbegin(); }
+    const_iterator          cend() const noexcept { return impl.cend(); }
+    const_reverse_iterator  crbegin() const noexcept { return impl.crbegin(); }
+    const_reverse_iterator  crend() const noexcept { return impl.crend(); }
+ 
+    // capacity:
+    bool        empty() const noexcept { return impl.empty(); }
+    size_type   size() const noexcept { return impl.size(); }
+    size_type   max_size() const noexcept { return impl.max_size(); }
+    size_type   capacity() const noexcept { return impl.capacity(); }
+    void        reserve(size_type n) { impl.reserve(n); }
+    void        shrink_to_fit() { impl.shrink_to_fit(); }
+    
+    // element access:
+    // default constructed T is inserted for a missing key
+    T& operator[](const key_type& x) {
+        iterator i = impl.lower_bound(x);
+        if(i == end() || impl.key_compare()(x, i->first))
+            i = impl.insert_unique(i, value_type(x, T()));
+        return i->second;
+    }
+    T& operator[](key_type&& x) {
+        iterator i = impl.lower_bound(x);
+        if(i == end() || impl.key_compare()(x, i->first))
+            i = impl.insert_unique(i, value_type(std::move(x), T()));
+        return i->second;
+    }
+
+    // throw std::out_of_range for a missing key
+    T& at(const key_type& x) {
+        iterator i = impl.find(x);
+        if(i == end())
+            throw std::out_of_range("key not found in flat_map");
+        return i->second;
+    }
+    const T& at(const key_type& x) const {
+        const_iterator i = impl.find(x);
+        if(i == end())
+            throw std::out_of_range("key not found in flat_map");
+        return i->second;
+    }
+
+    // modifiers:
+    template <class... Args> 
+    pair<iterator, bool> emplace(Args&&... args)
+        { return impl.insert_unique(std::move(value_type(args...))); }
+    
+    template <class... Args> 
+    iterator emplace_hint(const_iterator pos, Args&&... args)
+        { return impl.insert_unique(pos, std::move(value_type(args...))); }
+ 
+    pair<iterator,bool> insert(const value_type& x) 
+    { return impl.insert_unique(x); }
+
+    pair<iterator,bool> insert(value_type&& x)
+        { return impl.insert_unique(std::move(x)); }
+    iterator insert(const_iterator pos, const value_type& x) {
+        return impl.insert_unique(pos, x);
+    }
+    iterator insert(const_iterator pos, value_type&& x) 
+        { return impl.insert_unique(pos, std::move(x)); }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) 
+        { impl.insert_unique(first, last); }
+    void insert(std::initializer_list<value_type> ilist) 
+        { impl.insert_unique(ilist.begin(), ilist.end()); }
+       
+    iterator erase(const_iterator pos) { return impl.erase(pos); }
+    size_type erase(const key_type& x) { return impl.erase(x); }
+    iterator erase(const_iterator first, const_iterator last)
+        { return impl.erase(first, last); }
+ 
+    void swap(flat_map& x) { impl.swap(x.impl); }
+    void clear() noexcept { impl.clear(); }
+ 
+    // observers:
+    key_compare   key_comp() const { return impl.key_compare(); }
+    value_compare value_comp() const { return value_compare(impl.key_compare()); }
+ 
+    // flat_map operations:
+    iterator       find(const key_type& x) { return impl.find(x); }
+    const_iterator find(const key_type& x) const 
+        { return impl.find(x); }
+
+    size_type      count(const key_type& x) const 
+        { return impl.count(x); }
+
+    iterator       lower_bound(const key_type& x)
+        { return impl.lower_bound(x); }
+    const_iterator lower_bound(const key_type& x) const
+        { return impl.lower_bound(x); }
+    iterator       upper_bound(const key_type& x) 
+        { return impl.upper_bound(x); }
+    const_iterator upper_bound(const key_type& x) const
+        { return impl.upper_bound(x); }
+
+    pair<iterator, iterator> 
+    equal_range(const key_type& x) 
+        { return impl.equal_range(x); }
+    pair<const_iterator, const_iterator> 
+    equal_range(const key_type& x) const 
+        { return impl.equal_range(x); }
+
+    // heterogeneous lookup, only if Compare declares is_transparent
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& x) { return impl.find(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& x) const
+        { return impl.find(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& x) const
+        { return impl.count(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& x)
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& x) const
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& x)
+        { return impl.upper_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& x) const
+        { return impl.upper_bound(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& x)
+        { return impl.equal_range(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& x) const
+        { return impl.equal_range(x); }
+};
+
+template <class Key, class T, class Compare, class Alloc>
+bool operator==(const flat_map<Key, T, Compare, Alloc> &x,
+                const flat_map<Key, T, Compare, Alloc> &y) {
+    return x.size() == y.size() && MiniSTL::equal(x.begin(), x.end(), y.begin());
+}
+template <class Key, class T, class Compare, class Alloc>
+bool operator< (const flat_map<Key,T,Compare,Alloc>& x,
+                const flat_map<Key,T,Compare,Alloc>& y) {
+    return MiniSTL::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+}
+template <class Key, class T, class Compare, class Alloc>
+bool operator!=(const flat_map<Key,T,Compare,Alloc>& x,
+                const flat_map<Key,T,Compare,Alloc>& y) {
+    return !(x == y);
+}
+template <class Key, class T, class Compare, class Alloc>
+bool operator> (const flat_map<Key,T,Compare,Alloc>& x,
+                const flat_map<Key,T,Compare,Alloc>& y) {
+    return y < x;
+}
+template <class Key, class T, class Compare, class Alloc>
+bool operator>=(const flat_map<Key,T,Compare,Alloc>& x,
+                const flat_map<Key,T,Compare,Alloc>& y) {
+    return !(x < y);
+}
+template <class Key, class T, class Compare, class Alloc>
+bool operator<=(const flat_map<Key,T,Compare,Alloc>& x,
+                const flat_map<Key,T,Compare,Alloc>& y) {
+    return !(y < x);
+}
+
+template <class Key, class T, class Compare, class Alloc>
+void swap(flat_map<Key,T,Compare,Alloc>& x, flat_map<Key,T,Compare,Alloc>& y) {
+    x.swap(y);
+}
+
+
+} // MiniSTL
@@ -0,0 +1,418 @@
+/*
+ * flat_tree: sorted vector with the interface of rb_tree
+ *  Implementation properties:
+ *      1. Values are kept in a vector sorted by key, a lookup is a
+ *      binary search over contiguous memory and an ordered scan walks
+ *      an array. No node per value.
+ *      2. A single insert or erase shifts the values after it, O(N).
+ *      A range insert appends the range, sorts it, merges it with the
+ *      old values and drops duplicates: one O(N + M log M) pass instead
+ *      of M shifting inserts.
+ *      3. Values are moved around by sort and by inserts, so Value must
+ *      be assignable. Insert and erase invalidate iterators and
+ *      references past the changed position, insert may invalidate all.
+ *  For tables built once and read many times.
+ */
+
+#pragma once
+
+#include "Algorithms/algo.hpp"
+#include "Algorithms/algobase.hpp"
+#include "Algorithms/sort.hpp"
+#include "Container/Sequence/vector.hpp"
+#include "Function/function.hpp"
+#include "Util/pair.hpp"
+
+#include <cstddef>
+
+namespace MiniSTL {
+
+template <class Key, class Value, class KeyOfValue,
+          class Compare, class Alloc = simple_alloc<Value>>
+class flat_tree {
+protected:
+    using seq_t = vector<Value, Alloc>;
+
+    // orders values by key, for sort and merge
+    struct value_less {
+        Compare comp;
+        explicit value_less(const Compare& c) : comp(c) {}
+        bool operator()(const Value& x, const Value& y) const
+            { return comp(KeyOfValue()(x), KeyOfValue()(y)); }
+    };
+
+    // value < key, for lower_bound
+    struct value_key_less {
+        Compare comp;
+        explicit value_key_less(const Compare& c) : comp(c) {}
+        template <class K>
+        bool operator()(const Value& x, const K& k) const
+            { return comp(KeyOfValue()(x), k); }
+    };
+
+    // key < value, for upper_bound
+    struct key_value_less {
+        Compare comp;
+        explicit key_value_less(const Compare& c) : comp(c) {}
+        template <class K>
+        bool operator()(const K& k, const Value& x) const
+            { return comp(k, KeyOfValue()(x)); }
+    };
+
+    // key of x not less than key of y: y, x adjacent in sorted order
+    // are equivalent, for unique
+    struct value_equiv {
+        Compare comp;
+        explicit value_equiv(const Compare& c) : comp(c) {}
+        bool operator()(const Value& x, const Value& y) const
+            { return !comp(KeyOfValue()(x), KeyOfValue()(y)); }
+    };
+
+public:
+    using key_type = Key;
+    using value_type = Value;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = Value&;
+    using const_reference = const Value&;
+    using pointer = Value*;
+    using const_pointer = const Value*;
+    using iterator = typename seq_t::iterator;
+    using const_iterator = typename seq_t::const_iterator;
+    using reverse_iterator = __reverse_iterator<iterator>;
+    using const_reverse_iterator = __reverse_iterator<const_iterator>;
+
+public:
+    // observior
+    allocator_type get_allocator() const { return seq.get_allocator(); }
+    Compare key_compare() const { return key_comp; }
+
+protected:
+    // data member
+    seq_t seq;
+    Compare key_comp;
+
+    iterator mutable_iterator(const_iterator it)
+        { return seq.begin() + (it - seq.cbegin()); }
+
+    const Key& key(const_iterator it) const { return KeyOfValue()(*it); }
+
+public:
+    //  ctor/dtor/assign
+    flat_tree() : seq(), key_comp() {}
+    explicit flat_tree(const Compare& c, const allocator_type& a = allocator_type())
+        : seq(a), key_comp(c) {}
+
+    flat_tree(const flat_tree& x) : seq(x.seq), key_comp(x.key_comp) {}
+    flat_tree(flat_tree&& x) : seq(std::move(x.seq)), key_comp(x.key_comp) {}
+
+    flat_tree& operator=(const flat_tree& x) {
+        if(&x != this) {
+            seq = x.seq;
+            key_comp = x.key_comp;
+        }
+        return *this;
+    }
+
+    flat_tree& operator=(flat_tree&& x) {
+        if(&x != this) {
+            seq = std::move(x.seq);
+            key_comp = x.key_comp;
+        }
+        return *this;
+    }
+
+public:
+    // element access
+    iterator                begin() noexcept { return seq.begin(); }
+    const_iterator          begin() const noexcept { return seq.begin(); }
+    iterator                end() noexcept { return seq.end(); }
+    const_iterator          end() const noexcept { return seq.end(); }
+
+    reverse_iterator        rbegin() noexcept
+        { return reverse_iterator(end()); }
+    const_reverse_iterator  rbegin() const noexcept
+        { return const_reverse_iterator(end()); }
+    reverse_iterator        rend() noexcept
+        { return reverse_iterator(begin()); }
+    const_reverse_iterator  rend() const noexcept
+        { return const_reverse_iterator(begin()); }
+
+    const_iterator          cbegin() const noexcept { return begin(); }
+    const_iterator          cend() const noexcept { return end(); }
+    const_reverse_iterator  crbegin() const noexcept
+        { return const_reverse_iterator(end()); }
+    const_reverse_iterator  crend() const noexcept
+        { return const_reverse_iterator(begin()); }
+
+public:
+    // capacity
+    size_type size() const noexcept { return seq.size(); }
+    size_type max_size() const noexcept { return seq.max_size(); }
+    bool empty() const noexcept { return seq.empty(); }
+
+    size_type capacity() const noexcept { return seq.capacity(); }
+    void reserve(size_type n) { seq.reserve(n); }
+    void shrink_to_fit() { seq.shrink_to_fit(); }
+
+public:
+    //swap
+    void swap(flat_tree& y) {
+        seq.swap(y.seq);
+        MiniSTL::swap(key_comp, y.key_comp);
+    }
+
+    void clear() { seq.clear(); }
+
+public:
+    // insert
+    pair<iterator, bool> insert_unique(const Value& val) {
+        iterator i = lower_bound(KeyOfValue()(val));
+        if(i != end() && !key_comp(KeyOfValue()(val), key(i)))
+            return pair<iterator, bool>(i, false);
+        return pair<iterator, bool>(seq.insert(i, val), true);
+    }
+
+    pair<iterator, bool> insert_unique(Value&& val) {
+        iterator i = lower_bound(KeyOfValue()(val));
+        if(i != end() && !key_comp(KeyOfValue()(val), key(i)))
+            return pair<iterator, bool>(i, false);
+        return pair<iterator, bool>(seq.insert(i, std::move(val)), true);
+    }
+
+    iterator insert_unique(const_iterator pos, const Value& val) {
+        if(unique_hint(pos, KeyOfValue()(val)))
+            return seq.insert(pos, val);
+        return insert_unique(val).first;
+    }
+
+    iterator insert_unique(const_iterator pos, Value&& val) {
+        if(unique_hint(pos, KeyOfValue()(val)))
+            return seq.insert(pos, std::move(val));
+        return insert_unique(std::move(val)).first;
+    }
+
+    // append, sort the new values, merge them into the old ones and
+    // drop duplicates. Stable all along, so of equivalent values the
+    // one already in, then the first of the range, is kept.
+    template<class InputIt>
+    void insert_unique(InputIt first, InputIt last) {
+        if(append_sorted(first, last) != size())
+            seq.erase(MiniSTL::unique(begin(), end(), value_equiv(key_comp)), end());
+    }
+
+    iterator insert_equal(const Value& val)
+        { return seq.insert(upper_bound(KeyOfValue()(val)), val); }
+
+    iterator insert_equal(Value&& val) {
+        iterator i = upper_bound(KeyOfValue()(val));
+        return seq.insert(i, std::move(val));
+    }
+
+    iterator insert_equal(const_iterator pos, const Value& val) {
+        if(equal_hint(pos, KeyOfValue()(val)))
+            return seq.insert(pos, val);
+        return insert_equal(val);
+    }
+
+    iterator insert_equal(const_iterator pos, Value&& val) {
+        if(equal_hint(pos, KeyOfValue()(val)))
+            return seq.insert(pos, std::move(val));
+        return insert_equal(std::move(val));
+    }
+
+    template<class InputIt>
+    void insert_equal(InputIt first, InputIt last) { append_sorted(first, last); }
+
+private:
+    // k fits right before pos and no value equals it
+    bool unique_hint(const_iterator pos, const Key& k) const {
+        return (pos == end() || key_comp(k, key(pos))) &&
+               (pos == begin() || key_comp(key(pos - 1), k));
+    }
+
+    // k fits right before pos, after the values equal to it
+    bool equal_hint(const_iterator pos, const Key& k) const {
+        return (pos == end() || !key_comp(key(pos), k)) &&
+               (pos == begin() || !key_comp(k, key(pos - 1)));
+    }
+
+    // sorted merge of [first, last) after the old values, returns the
+    // number of old values
+    template<class InputIt>
+    size_type append_sorted(InputIt first, InputIt last) {
+        const size_type n = size();
+        seq.insert(seq.end(), first, last);
+        iterator mid = begin() + n;
+        if(mid == end())
+            return n;
+        MiniSTL::stable_sort(mid, end(), value_less(key_comp));
+        // already in order when all new keys follow the old ones,
+        // e.g. a range loaded in key order
+        if(mid != begin() && key_comp(KeyOfValue()(*mid), key(mid - 1)))
+            MiniSTL::inplace_merge(begin(), mid, end(), value_less(key_comp));
+        return n;
+    }
+
+public:
+    // erase
+    iterator erase(const_iterator pos) { return seq.erase(pos); }
+
+    size_type erase(const Key& x) {
+        pair<iterator, iterator> p = equal_range(x);
+        const size_type n = p.second - p.first;
+        seq.erase(p.first, p.second);
+        return n;
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+        { return seq.erase(first, last); }
+
+private:
+    template <class K>
+    iterator lower_bound_pos(const K& k) const {
+        const_iterator i = MiniSTL::lower_bound(seq.begin(), seq.end(), k,
+                                                value_key_less(key_comp));
+        return const_cast<iterator>(i);
+    }
+
+    template <class K>
+    iterator upper_bound_pos(const K& k) const {
+        const_iterator i = MiniSTL::upper_bound(seq.begin(), seq.end(), k,
+                                                key_value_less(key_comp));
+        return const_cast<iterator>(i);
+    }
+
+    template <class K>
+    iterator find_pos(const K& k) const {
+        iterator i = lower_bound_pos(k);
+        iterator last = const_cast<iterator>(seq.end());
+        return (i == last || key_comp(k, KeyOfValue()(*i))) ? last : i;
+    }
+
+public:
+    // find
+    // if x exists, return first x, else return end();
+    iterator find(const Key& k) noexcept { return find_pos(k); }
+
+    const_iterator find(const Key& k) const noexcept { return find_pos(k); }
+
+    size_type count(const Key& k) const noexcept
+        { return upper_bound_pos(k) - lower_bound_pos(k); }
+
+    iterator lower_bound(const Key& k) noexcept { return lower_bound_pos(k); }
+
+    const_iterator lower_bound(const Key& k) const noexcept
+        { return lower_bound_pos(k); }
+
+    iterator upper_bound(const Key& k) noexcept { return upper_bound_pos(k); }
+
+    const_iterator upper_bound(const Key& k) const noexcept
+        { return upper_bound_pos(k); }
+
+    pair<iterator,iterator>
+    equal_range(const Key& k) noexcept {
+        return pair<iterator, iterator>(lower_bound_pos(k), upper_bound_pos(k));
+    }
+
+    pair<const_iterator,const_iterator>
+    equal_range(const Key& k) const noexcept {
+        return pair<const_iterator, const_iterator>(lower_bound_pos(k),
+                                                    upper_bound_pos(k));
+    }
+
+    // heterogeneous lookup of any k which Compare orders against Key,
+    // only if Compare declares is_transparent(e.g. less<>)
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& k) noexcept {
+        return find_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& k) const noexcept {
+        return find_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& k) const noexcept {
+        return upper_bound_pos(k) - lower_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& k) noexcept {
+        return lower_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& k) const noexcept {
+        return lower_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& k) noexcept {
+        return upper_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& k) const noexcept {
+        return upper_bound_pos(k);
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& k) noexcept {
+        return pair<iterator, iterator>(lower_bound_pos(k), upper_bound_pos(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& k) const noexcept {
+        return pair<const_iterator, const_iterator>(lower_bound_pos(k),
+                                                    upper_bound_pos(k));
+    }
+};
+
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator==(const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return x.size() == y.size() && MiniSTL::equal(x.cbegin(), x.cend(), y.cbegin());
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator!=(const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return !(x == y);
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator<(const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                      const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return MiniSTL::lexicographical_compare(x.cbegin(), x.cend(), y.cbegin(), y.cend());
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator>(const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                      const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return y < x;
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator<=(const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return !(y < x);
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline bool operator>=(const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                       const flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    return !(x < y);
+}
+
+template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+inline void swap(flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
+                 flat_tree<Key, Value, KeyOfValue, Compare, Alloc>& y) {
+    x.swap(y);
+}
+
+} // MiniSTL
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 namespace MiniSTL
 {
@@ -74,4 +76,163 @@ struct hash<unsigned long> {
     size_t operator()(unsigned long x) const { return x; }
 };
 
+// spread all bits of a hash code over the high and the low bits. The
+// integer hashes above return the key itself, which is fine for a prime
+// modulus but not for tables that use only some bits of the hash.
+// The middle bits of the double width product h * K depend on all bits
+// of h, its two halves are folded into one(as abseil does).
+inline size_t hash_mix(size_t h) {
+#if defined(__SIZEOF_INT128__)
+    if(sizeof(size_t) == 8) {
+        const unsigned __int128 m = static_cast<unsigned __int128>(h) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(m) ^ static_cast<size_t>(m >> 64);
+    }
+#endif
+    const uint64_t m = static_cast<uint64_t>(h) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(m ^ (m >> 32));
+}
+
+// h * n / 2^bits(size_t): maps a hash uniform over size_t to [0, n)
+inline size_t __fastrange(size_t h, size_t n) {
+#if defined(__SIZEOF_INT128__)
+    if(sizeof(size_t) == 8)
+        return static_cast<size_t>((static_cast<unsigned __int128>(h) * n) >> 64);
+#endif
+    if(sizeof(size_t) == 4)
+        return static_cast<size_t>((static_cast<uint64_t>(h) * n) >> 32);
+    return h % n;
+}
+
+
+
+// 64-bit finalizer of MurmurHash3: xorshift and multiply twice, every
+// input bit flips each output bit with probability about 1/2
+inline uint64_t __hash_int(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// 128-bit product of a and b, low half xor high half
+inline uint64_t __hash_mum(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 m = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(m) ^ static_cast<uint64_t>(m >> 64);
+#else
+    const uint64_t ha = a >> 32, hb = b >> 32, la = a & 0xFFFFFFFFull, lb = b & 0xFFFFFFFFull;
+    const uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    const uint64_t t = ll + (hl << 32);
+    const uint64_t lo = t + (lh << 32);
+    const uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (t < ll) + (lo < t);
+    return lo ^ hi;
+#endif
+}
+
+inline uint64_t __hash_read8(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t __hash_read4(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// hash of len bytes at key, after wyhash(final version 4): 48 bytes per
+// step in three independent lanes, strings up to 16 bytes read at most
+// four overlapping words and no loop. Values depend on byte order.
+inline size_t __hash_bytes(const void* key, size_t len, uint64_t seed = 0) {
+    const uint64_t s0 = 0xA0761D6478BD642Full, s1 = 0xE7037ED1A0B428DBull,
+                   s2 = 0x8EBC6AF09C88C6E3ull, s3 = 0x589965CC75374CC3ull;
+    const unsigned char* p = static_cast<const unsigned char*>(key);
+    seed ^= __hash_mum(seed ^ s0, s1);
+    uint64_t a, b;
+    if(len <= 16) {
+        if(len >= 4) {
+            const size_t mid = (len >> 3) << 2;
+            a = (__hash_read4(p) << 32) | __hash_read4(p + mid);
+            b = (__hash_read4(p + len - 4) << 32) | __hash_read4(p + len - 4 - mid);
+        } else if(len > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if(i > 48) {
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = __hash_mum(__hash_read8(p) ^ s1, __hash_read8(p + 8) ^ seed);
+                seed1 = __hash_mum(__hash_read8(p + 16) ^ s2, __hash_read8(p + 24) ^ seed1);
+                seed2 = __hash_mum(__hash_read8(p + 32) ^ s3, __hash_read8(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while(i > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        for(;i > 16;i -= 16, p += 16)
+            seed = __hash_mum(__hash_read8(p) ^ s1, __hash_read8(p + 8) ^ seed);
+        a = __hash_read8(p + i - 16);
+        b = __hash_read8(p + i - 8);
+    }
+    return static_cast<size_t>(__hash_mum(s1 ^ len, __hash_mum(a ^ s1, b ^ seed)));
+}
+
+
+// Well mixed hashers, drop-in replacements of hash<Key> for tables of
+// sequential ids, strided keys or strings with common prefixes, e.g.
+//      hash_map<int, T, mixed_hash<int>, equal_to<int>>
+// Integers go through __hash_int, C strings through __hash_bytes. Other
+// types may specialize mixed_hash on top of __hash_bytes.
+template <class Key>
+struct mixed_hash { };
+
+template <class Int>
+struct __mixed_int_hash {
+    size_t operator()(Int x) const {
+        return static_cast<size_t>(__hash_int(static_cast<uint64_t>(x)));
+    }
+};
+
+template<> struct mixed_hash<char> : __mixed_int_hash<char> {};
+template<> struct mixed_hash<unsigned char> : __mixed_int_hash<unsigned char> {};
+template<> struct mixed_hash<signed char> : __mixed_int_hash<signed char> {};
+template<> struct mixed_hash<short> : __mixed_int_hash<short> {};
+template<> struct mixed_hash<unsigned short> : __mixed_int_hash<unsigned short> {};
+template<> struct mixed_hash<int> : __mixed_int_hash<int> {};
+template<> struct mixed_hash<unsigned int> : __mixed_int_hash<unsigned int> {};
+template<> struct mixed_hash<long> : __mixed_int_hash<long> {};
+template<> struct mixed_hash<unsigned long> : __mixed_int_hash<unsigned long> {};
+template<> struct mixed_hash<long long> : __mixed_int_hash<long long> {};
+template<> struct mixed_hash<unsigned long long> : __mixed_int_hash<unsigned long long> {};
+
+template<>
+struct mixed_hash<char*> {
+    size_t operator()(const char* s) const { return __hash_bytes(s, strlen(s)); }
+};
+
+template<>
+struct mixed_hash<const char*> {
+    size_t operator()(const char* s) const { return __hash_bytes(s, strlen(s)); }
+};
+
+// transparent string hasher for heterogeneous lookup, e.g.
+//      hash_map<std::string, T, string_hash, equal_to<>>
+// found by a const char* without building a std::string. A C string and
+// a string class with data() and size() of the same characters hash alike.
+struct string_hash {
+    using is_transparent = void;
+
+    size_t operator()(const char* s) const { return __hash_bytes(s, strlen(s)); }
+
+    template <class String>
+    size_t operator()(const String& s) const { return __hash_bytes(s.data(), s.size()); }
+};
+
 } // MiniSTL
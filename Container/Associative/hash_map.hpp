@@ -8,11 +8,12 @@
 namespace MiniSTL {
 
 template <class Key, class T, class HashFunc, class EqualKey,
-          class Alloc = simple_alloc<pair<const Key, T>> >
+          class Alloc = simple_alloc<pair<const Key, T>>,
+          class BucketPolicy = prime_bucket_policy>
 class hash_map {
 private:
     using Ht = hashtable<pair<const Key,T>,Key,HashFunc,
-                        select1st<pair<const Key,T> >,EqualKey,Alloc>;
+                        select1st<pair<const Key,T> >,EqualKey,Alloc,BucketPolicy>;
     Ht ht;
 
 public:
@@ -39,9 +40,9 @@ public:
     key_equal key_eq() const { return ht.key_eq(); }
     allocator_type get_allocator() const { return ht.get_allocator(); }
 
-    template <class K1, class T1, class HF, class Eq, class Al>
-    friend bool operator== (const hash_map<K1, T1, HF, Eq, Al>&,
-                            const hash_map<K1, T1, HF, Eq, Al>&);
+    template <class K1, class T1, class HF, class Eq, class Al, class Bp>
+    friend bool operator== (const hash_map<K1, T1, HF, Eq, Al, Bp>&,
+                            const hash_map<K1, T1, HF, Eq, Al, Bp>&);
 
 public: // ctor
     hash_map() : ht(100, hasher(), key_equal()) {}
@@ -49,8 +50,9 @@ public: // ctor
         : ht(n, hasher(), key_equal()) {}
     hash_map(size_type n, const hasher& hf)
         : ht(n, hf, key_equal()) {}
-    hash_map(size_type n, const hasher& hf, const key_equal& eql)
-        : ht(n, hf, eql) {}
+    hash_map(size_type n, const hasher& hf, const key_equal& eql,
+             const allocator_type& a = allocator_type())
+        : ht(n, hf, eql, a) {}
 
 
     template <class InputIt>
@@ -68,8 +70,9 @@ public: // ctor
     
     template <class InputIt>
     hash_map(InputIt f, InputIt l, size_type n,
-            const hasher& hf, const key_equal& eql)
-        : ht(n, hf, eql)
+            const hasher& hf, const key_equal& eql,
+            const allocator_type& a = allocator_type())
+        : ht(n, hf, eql, a)
         { ht.insert_unique(f, l); }
 
     hash_map(std::initializer_list<pair<const Key, T>> ilist)
@@ -82,11 +85,22 @@ public: // size
     bool empty() const { return ht.empty(); }
 
     void resize(size_type hint) { ht.resize(hint); }
+    void reserve(size_type n) { ht.reserve(n); }
+    void rehash(size_type n) { ht.rehash(n); }
+    float load_factor() const { return ht.load_factor(); }
+    float max_load_factor() const { return ht.max_load_factor(); }
+    void max_load_factor(float z) { ht.max_load_factor(z); }
     size_type bucket_count() const { return ht.bucket_count(); }
     size_type max_bucket_count() const { return ht.max_bucket_count(); }
     size_type elems_in_bucket(size_type n) const
         { return ht.elems_in_bucket(n); }
 
+    // incremental rehash, see hashtable::set_rehash_step
+    void set_rehash_step(size_type n) { ht.set_rehash_step(n); }
+    size_type rehash_step() const { return ht.rehash_step(); }
+    bool rehashing() const { return ht.rehashing(); }
+    void finish_rehash() { ht.finish_rehash(); }
+
     iterator begin() { return ht.begin(); }
     iterator end() { return ht.end(); }
     const_iterator begin() const { return ht.begin(); }
@@ -109,6 +123,12 @@ public: // insert
     pair<iterator,bool> insert_noresize(const value_type& obj)
         { return ht.insert_unique_noresize(obj); }    
 
+    // hashes the whole batch before linking it bucket by bucket, returns
+    // the number of elements inserted
+    template <class ForwardIt>
+    size_type bulk_insert(ForwardIt f, ForwardIt l)
+        { return ht.bulk_insert_unique(f, l); }
+
 public: // find
     iterator find(const key_type& key) { return ht.find(key); }
 
@@ -121,6 +141,15 @@ public: // find
     }
 
     size_type count(const key_type& key) const { return ht.count(key); }
+
+    // find of every key of [f, l) into out, the lookups of a batch of
+    // keys overlap their cache misses
+    template <class ForwardIt, class OutputIt>
+    OutputIt find_batch(ForwardIt f, ForwardIt l, OutputIt out)
+        { return ht.find_batch(f, l, out); }
+    template <class ForwardIt, class OutputIt>
+    OutputIt find_batch(ForwardIt f, ForwardIt l, OutputIt out) const
+        { return ht.find_batch(f, l, out); }
     
     pair<iterator, iterator> equal_range(const key_type& key)
         { return ht.equal_range(key); }
@@ -129,6 +158,28 @@ public: // find
     equal_range(const key_type& key) const
         { return ht.equal_range(key); }
 
+    // heterogeneous lookup, only if HashFunc and EqualKey declare
+    // is_transparent
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, iterator>> find(const K& key)
+        { return ht.find(key); }
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, const_iterator>> find(const K& key) const
+        { return ht.find(key); }
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, size_type>> count(const K& key) const
+        { return ht.count(key); }
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, pair<iterator, iterator>>>
+    equal_range(const K& key)
+        { return ht.equal_range(key); }
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, pair<const_iterator, const_iterator>>>
+    equal_range(const K& key) const
+        { return ht.equal_range(key); }
+
 public: // erase
     size_type erase(const key_type& key) {return ht.erase(key); }
     void erase(iterator it) { ht.erase(it); }
@@ -138,34 +189,34 @@ public: // erase
     void swap(hash_map& hm) { ht.swap(hm.ht); }
 };
 
-template <class Key, class T, class HashFunc, class EqlKey, class Alloc>
+template <class Key, class T, class HashFunc, class EqlKey, class Alloc, class Bp>
 inline bool 
-operator==(const hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm1,
-           const hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm2) {
+operator==(const hash_map<Key,T,HashFunc,EqlKey,Alloc,Bp>& hm1,
+           const hash_map<Key,T,HashFunc,EqlKey,Alloc,Bp>& hm2) {
     return hm1.ht == hm2.ht;
 }
 
-template <class Key, class T, class HashFunc, class EqlKey, class Alloc>
+template <class Key, class T, class HashFunc, class EqlKey, class Alloc, class Bp>
 inline bool 
-operator!=(const hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm1,
-           const hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm2) {
+operator!=(const hash_map<Key,T,HashFunc,EqlKey,Alloc,Bp>& hm1,
+           const hash_map<Key,T,HashFunc,EqlKey,Alloc,Bp>& hm2) {
     return !(hm1 == hm2);
 }
 
-template <class Key, class T, class HashFunc, class EqlKey, class Alloc>
+template <class Key, class T, class HashFunc, class EqlKey, class Alloc, class Bp>
 inline void 
-swap(hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm1,
-     hash_map<Key,T,HashFunc,EqlKey,Alloc>& hm2) {
+swap(hash_map<Key,T,HashFunc,EqlKey,Alloc,Bp>& hm1,
+     hash_map<Key,T,HashFunc,EqlKey,Alloc,Bp>& hm2) {
     hm1.swap(hm2);
 }
 
 
 // Specialization of insert_iterator so that it will work for hash_map
 
-template <class Key, class T, class HF,  class Eq, class Alloc>
-class insert_iterator<hash_map<Key, T, HF, Eq, Alloc> > {
+template <class Key, class T, class HF,  class Eq, class Alloc, class Bp>
+class insert_iterator<hash_map<Key, T, HF, Eq, Alloc, Bp> > {
 protected:
-    using Container = hash_map<Key, T, HF, Eq, Alloc>;
+    using Container = hash_map<Key, T, HF, Eq, Alloc, Bp>;
     Container* c;
 public:
 
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Container/Associative/hash_set.hpp"
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/hash_quality.cpp
+ *  run:   ./a.out [keys], keys defaults to 1e6
+ *
+ *  chain length report of hash<> against mixed_hash<> in a hash_set
+ *  sized for the keys(load factor about 1), with prime and power of two
+ *  buckets(no hash_mix, so the hasher alone spreads the keys).
+ *  Key sets: sequential ints, ints * 4096, random ints, strings with a
+ *  long common prefix, path-like strings and random strings of 8..40
+ *  bytes.
+ *  For every table: share of buckets used, longest chain, and
+ *      quality = sum(len * (len + 1) / 2) / (n / 2m * (n + 2m - 1))
+ *  over all m buckets, which is 1.00 for a uniform random hash and grows
+ *  with clustering. "equal" counts keys whose full hash value equals
+ *  that of another key.
+ */
+
+using namespace MiniSTL;
+
+// power of two buckets, raw low bits of the hash
+struct pow2_raw_bucket_policy {
+    static size_t next_size(size_t n) {
+        size_t size = 64;
+        while(size < n)
+            size <<= 1;
+        return size;
+    }
+    static size_t max_size() { return ~(~size_t(0) >> 1); }
+    static size_t index(size_t hash, size_t n) { return hash & (n - 1); }
+};
+
+// splitmix64
+struct key_gen {
+    uint64_t state;
+
+    explicit key_gen(uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+};
+
+template <class Key, class Hash>
+size_t equal_hashes(const vector<Key>& keys) {
+    vector<size_t> h;
+    Hash hf;
+    for(size_t i = 0;i < keys.size();++i)
+        h.push_back(hf(keys[i]));
+    std::sort(h.begin(), h.end());
+    size_t equal = 0;
+    for(size_t i = 1;i < h.size();++i)
+        equal += h[i] == h[i - 1];
+    return equal;
+}
+
+template <class Key, class Hash, class Policy>
+void report(const char* keys_name, const char* hash_name, const char* policy_name,
+            const vector<Key>& keys) {
+    hash_set<Key, Hash, equal_to<Key>, simple_alloc<Key>, Policy> s(keys.size());
+    for(size_t i = 0;i < keys.size();++i)
+        s.insert(keys[i]);
+
+    const double n = static_cast<double>(s.size());
+    const double m = static_cast<double>(s.bucket_count());
+    size_t used = 0, longest = 0;
+    double sum = 0;
+    for(size_t b = 0;b < s.bucket_count();++b) {
+        const size_t len = s.elems_in_bucket(b);
+        used += len != 0;
+        longest = len > longest ? len : longest;
+        sum += len * (len + 1) / 2.0;
+    }
+    std::cout << std::setw(8) << keys_name << std::setw(8) << hash_name
+              << std::setw(8) << policy_name
+              << std::setw(9) << 100.0 * used / m << "%"
+              << std::setw(9) << longest
+              << std::setw(10) << sum / (n / (2 * m) * (n + 2 * m - 1))
+              << std::setw(9) << equal_hashes<Key, Hash>(keys) << std::endl;
+}
+
+template <class Key, class Std, class Mixed>
+void report_keys(const char* keys_name, const vector<Key>& keys) {
+    report<Key, Std, prime_bucket_policy>(keys_name, "hash", "prime", keys);
+    report<Key, Std, pow2_raw_bucket_policy>(keys_name, "hash", "pow2", keys);
+    report<Key, Mixed, prime_bucket_policy>(keys_name, "mixed", "prime", keys);
+    report<Key, Mixed, pow2_raw_bucket_policy>(keys_name, "mixed", "pow2", keys);
+}
+
+const size_t STR_BYTES = 48;
+
+int main(int argc, char* argv[]) {
+    const size_t n = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 1000000;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(8) << "keys" << std::setw(8) << "hasher" << std::setw(8) << "buckets"
+              << std::setw(10) << "used" << std::setw(9) << "longest"
+              << std::setw(10) << "quality" << std::setw(9) << "equal" << std::endl;
+
+    key_gen gen(n);
+    vector<unsigned long> seq, page, rnd;
+    for(size_t i = 0;i < n;++i) {
+        seq.push_back(i);
+        page.push_back(i * 4096);
+        rnd.push_back(gen());
+    }
+    report_keys<unsigned long, hash<unsigned long>, mixed_hash<unsigned long>>("seq", seq);
+    report_keys<unsigned long, hash<unsigned long>, mixed_hash<unsigned long>>("page", page);
+    report_keys<unsigned long, hash<unsigned long>, mixed_hash<unsigned long>>("random", rnd);
+
+    // strings live in one buffer, keys compare by address
+    vector<char> buf(3 * n * STR_BYTES);
+    vector<const char*> prefix, path, rnd_str;
+    for(size_t i = 0;i < n;++i) {
+        char* p = &buf[(3 * i) * STR_BYTES];
+        snprintf(p, STR_BYTES, "customer/account/%010zu", i);
+        prefix.push_back(p);
+        p += STR_BYTES;
+        snprintf(p, STR_BYTES, "/usr/lib/pkg%zu/lib%zu.so", i / 100, i % 100);
+        path.push_back(p);
+        p += STR_BYTES;
+        const size_t len = 8 + gen() % 33;
+        for(size_t j = 0;j < len;++j)
+            p[j] = static_cast<char>('a' + gen() % 26);
+        p[len] = '\0';
+        rnd_str.push_back(p);
+    }
+    report_keys<const char*, hash<const char*>, mixed_hash<const char*>>("prefix", prefix);
+    report_keys<const char*, hash<const char*>, mixed_hash<const char*>>("path", path);
+    report_keys<const char*, hash<const char*>, mixed_hash<const char*>>("rndstr", rnd_str);
+    return 0;
+}
@@ -8,11 +8,12 @@
 namespace MiniSTL {
 
 template <class Value, class HashFunc, class EqualKey,
-          class Alloc = simple_alloc<Value> >
+          class Alloc = simple_alloc<Value>,
+          class BucketPolicy = prime_bucket_policy>
 class hash_set {
 private:
     using Ht = hashtable<Value, Value, HashFunc,
-                         identity<Value>, EqualKey, Alloc>;
+                         identity<Value>, EqualKey, Alloc, BucketPolicy>;
     Ht ht;
 
 public:
@@ -37,9 +38,9 @@ public:
     key_equal key_eq() const { return ht.key_eq(); }
     allocator_type get_allocator() const { return ht.get_allocator(); }
 
-    template <class V1, class HF, class Eq, class Al>
-    friend bool operator== (const hash_set<V1, HF, Eq, Al>&,
-                            const hash_set<V1, HF, Eq, Al>&);
+    template <class V1, class HF, class Eq, class Al, class Bp>
+    friend bool operator== (const hash_set<V1, HF, Eq, Al, Bp>&,
+                            const hash_set<V1, HF, Eq, Al, Bp>&);
 
 public: // ctor
     hash_set() : ht(100, hasher(), key_equal()) {}
@@ -47,8 +48,9 @@ public: // ctor
         : ht(n, hasher(), key_equal()) {}
     hash_set(size_type n, const hasher& hf)
         : ht(n, hf, key_equal()) {}
-    hash_set(size_type n, const hasher& hf, const key_equal& eql)
-        : ht(n, hf, eql) {}
+    hash_set(size_type n, const hasher& hf, const key_equal& eql,
+             const allocator_type& a = allocator_type())
+        : ht(n, hf, eql, a) {}
 
 
     template <class InputIt>
@@ -66,8 +68,9 @@ public: // ctor
     
     template <class InputIt>
     hash_set(InputIt f, InputIt l, size_type n,
-            const hasher& hf, const key_equal& eql)
-        : ht(n, hf, eql)
+            const hasher& hf, const key_equal& eql,
+            const allocator_type& a = allocator_type())
+        : ht(n, hf, eql, a)
         { ht.insert_unique(f, l); }
 
     hash_set(std::initializer_list<Value> ilist)
@@ -80,11 +83,22 @@ public: // size
     bool empty() const { return ht.empty(); }
 
     void resize(size_type hint) { ht.resize(hint); }
+    void reserve(size_type n) { ht.reserve(n); }
+    void rehash(size_type n) { ht.rehash(n); }
+    float load_factor() const { return ht.load_factor(); }
+    float max_load_factor() const { return ht.max_load_factor(); }
+    void max_load_factor(float z) { ht.max_load_factor(z); }
     size_type bucket_count() const { return ht.bucket_count(); }
     size_type max_bucket_count() const { return ht.max_bucket_count(); }
     size_type elems_in_bucket(size_type n) const
         { return ht.elems_in_bucket(n); }
 
+    // incremental rehash, see hashtable::set_rehash_step
+    void set_rehash_step(size_type n) { ht.set_rehash_step(n); }
+    size_type rehash_step() const { return ht.rehash_step(); }
+    bool rehashing() const { return ht.rehashing(); }
+    void finish_rehash() { ht.finish_rehash(); }
+
     iterator begin() { return ht.begin(); }
     iterator end() { return ht.end(); }
     const_iterator begin() const { return ht.begin(); }
@@ -92,7 +106,7 @@ public: // size
 
 public: // insert
     pair<iterator, bool> insert(const value_type& obj) { 
-        pair<typename Ht::iterator, bool> p = ht.insert_equal(obj);
+        pair<typename Ht::iterator, bool> p = ht.insert_unique(obj);
         return pair<iterator, bool>(p.first, p.second);
     }
     
@@ -109,6 +123,12 @@ public: // insert
     pair<iterator,bool> insert_noresize(const value_type& obj)
         { return ht.insert_unique_noresize(obj); }    
 
+    // hashes the whole batch before linking it bucket by bucket, returns
+    // the number of elements inserted
+    template <class ForwardIt>
+    size_type bulk_insert(ForwardIt f, ForwardIt l)
+        { return ht.bulk_insert_unique(f, l); }
+
 public: // find
     iterator find(const key_type& key) { return ht.find(key); }
 
@@ -116,6 +136,12 @@ public: // find
         { return ht.find(key); }
 
     size_type count(const key_type& key) const { return ht.count(key); }
+
+    // find of every key of [f, l) into out, the lookups of a batch of
+    // keys overlap their cache misses
+    template <class ForwardIt, class OutputIt>
+    OutputIt find_batch(ForwardIt f, ForwardIt l, OutputIt out) const
+        { return ht.find_batch(f, l, out); }
     
     pair<iterator, iterator> equal_range(const key_type& key)
         { return ht.equal_range(key); }
@@ -124,6 +150,28 @@ public: // find
     equal_range(const key_type& key) const
         { return ht.equal_range(key); }
 
+    // heterogeneous lookup, only if HashFunc and EqualKey declare
+    // is_transparent
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, iterator>> find(const K& key)
+        { return ht.find(key); }
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, const_iterator>> find(const K& key) const
+        { return ht.find(key); }
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, size_type>> count(const K& key) const
+        { return ht.count(key); }
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, pair<iterator, iterator>>>
+    equal_range(const K& key)
+        { return ht.equal_range(key); }
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, pair<const_iterator, const_iterator>>>
+    equal_range(const K& key) const
+        { return ht.equal_range(key); }
+
 public: // erase
     size_type erase(const key_type& key) {return ht.erase(key); }
     void erase(iterator it) { ht.erase(it); }
@@ -133,34 +181,34 @@ public: // erase
     void swap(hash_set& hs) { ht.swap(hs.ht); }
 };
 
-template <class Value, class HashFunc, class EqlKey, class Alloc>
+template <class Value, class HashFunc, class EqlKey, class Alloc, class Bp>
 inline bool 
-operator==(const hash_set<Value,HashFunc,EqlKey,Alloc>& hs1,
-           const hash_set<Value,HashFunc,EqlKey,Alloc>& hs2) {
+operator==(const hash_set<Value,HashFunc,EqlKey,Alloc,Bp>& hs1,
+           const hash_set<Value,HashFunc,EqlKey,Alloc,Bp>& hs2) {
     return hs1.ht == hs2.ht;
 }
 
-template <class Value, class HashFunc, class EqlKey, class Alloc>
+template <class Value, class HashFunc, class EqlKey, class Alloc, class Bp>
 inline bool 
-operator!=(const hash_set<Value,HashFunc,EqlKey,Alloc>& hs1,
-           const hash_set<Value,HashFunc,EqlKey,Alloc>& hs2) {
+operator!=(const hash_set<Value,HashFunc,EqlKey,Alloc,Bp>& hs1,
+           const hash_set<Value,HashFunc,EqlKey,Alloc,Bp>& hs2) {
     return !(hs1 == hs2);
 }
 
-template <class Value, class HashFunc, class EqlKey, class Alloc>
+template <class Value, class HashFunc, class EqlKey, class Alloc, class Bp>
 inline void 
-swap(hash_set<Value,HashFunc,EqlKey,Alloc>& hs1,
-     hash_set<Value,HashFunc,EqlKey,Alloc>& hs2) {
+swap(hash_set<Value,HashFunc,EqlKey,Alloc,Bp>& hs1,
+     hash_set<Value,HashFunc,EqlKey,Alloc,Bp>& hs2) {
     hs1.swap(hs2);
 }
 
 
 // Specialization of insert_iterator so that it will work for hash_set
 
-template <class V, class HF,  class Eq, class Alloc>
-class insert_iterator<hash_set<V, HF, Eq, Alloc> > {
+template <class V, class HF,  class Eq, class Alloc, class Bp>
+class insert_iterator<hash_set<V, HF, Eq, Alloc, Bp> > {
 protected:
-    using Container = hash_set<V, HF, Eq, Alloc>;
+    using Container = hash_set<V, HF, Eq, Alloc, Bp>;
     Container* c;
 public:
 
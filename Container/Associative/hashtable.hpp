@@ -5,36 +5,72 @@
 #include "Util/tempbuf.hpp"
 #include "Function/function.hpp"
 #include "Container/Sequence/vector.hpp"
-#include "hash_fun.h"
+#include "hash_fun.hpp"
 
 
 namespace MiniSTL {
 
-template <class Value>
+template <class Value, class CacheHash = false_type>
 struct hashtable_node {
     hashtable_node* next;
     Value val;
 }; 
 
+template <class Value>
+struct hashtable_node<Value, true_type> {
+    hashtable_node* next;
+    size_t hash_code;
+    Value val;
+};
+
+// cache_hash_code: nodes of a hashtable with this hasher store the hash
+// code of their key, so growing the table and iterator increments never
+// call the hasher, and lookups compare keys only if their codes match.
+// One more word per node, worth it for keys which hash or compare
+// slowly, like strings. To cache codes of another hasher:
+//      template<>
+//      struct cache_hash_code<my_hash> {
+//          using cache = true_type;
+//      };
+template <class HashFunc>
+struct cache_hash_code {
+    using cache = false_type;
+};
+
+template <class HashFunc>
+using cache_hash_code_t = typename cache_hash_code<HashFunc>::cache;
+
+template<> struct cache_hash_code<hash<char*>> { using cache = true_type; };
+template<> struct cache_hash_code<hash<const char*>> { using cache = true_type; };
+template<> struct cache_hash_code<mixed_hash<char*>> { using cache = true_type; };
+template<> struct cache_hash_code<mixed_hash<const char*>> { using cache = true_type; };
+template<> struct cache_hash_code<string_hash> { using cache = true_type; };
+
+struct prime_bucket_policy;
+
 template <class Value, class Key, class HashFunc,
-          class ExtractKey, class EqualKey, class Alloc = simple_alloc<Value>>
+          class ExtractKey, class EqualKey, class Alloc = simple_alloc<Value>,
+          class BucketPolicy = prime_bucket_policy>
 class hashtable;
 
 template <class Value, class Key, class HashFunc,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class BucketPolicy>
 struct hashtable_iterator;
 
 template <class Value, class Key, class HashFunc,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class BucketPolicy>
 struct hashtable_const_iterator;
 
 template <class Value, class Key, class HashFunc,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class BucketPolicy>
 struct hashtable_iterator {
-    using Hashtable = hashtable<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc>;
-    using iterator = hashtable_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc>;
-    using const_iterator = hashtable_const_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc>;
-    using node = hashtable_node<Value>;
+    using Hashtable = hashtable<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc,BucketPolicy>;
+    using iterator = hashtable_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc, BucketPolicy>;
+    using const_iterator = hashtable_const_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc, BucketPolicy>;
+    using node = hashtable_node<Value, cache_hash_code_t<HashFunc>>;
 
     using iterator_category = forward_iterator_tag;
     using value_type = Value;
@@ -58,9 +94,9 @@ struct hashtable_iterator {
         const node* old = cur;
         cur = cur->next;
         if(!cur) {
-            size_type bkt = ht->bkt_num(old->val);
-            while(!cur && ++bkt < ht->buckets.size())
-                cur = ht->buckets[bkt];
+            size_type bkt = ht->bkt_num(old);
+            while(!cur && ++bkt < ht->bkt_end())
+                cur = ht->head(bkt);
         }
         return *this;
     }
@@ -78,19 +114,20 @@ struct hashtable_iterator {
 
 
 template <class Value, class Key, class HashFunc,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class BucketPolicy>
 struct hashtable_const_iterator {
-    using Hashtable = hashtable<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc>;
-    using iterator = hashtable_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc>;
-    using const_iterator = hashtable_const_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc>;
-    using node = hashtable_node<Value>;
+    using Hashtable = hashtable<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc,BucketPolicy>;
+    using iterator = hashtable_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc, BucketPolicy>;
+    using const_iterator = hashtable_const_iterator<Value, Key, HashFunc, ExtractKey, EqualKey, Alloc, BucketPolicy>;
+    using node = hashtable_node<Value, cache_hash_code_t<HashFunc>>;
 
     using iterator_category = forward_iterator_tag;
     using value_type = Value;
     using difference_type = ptrdiff_t;
     using size_type = size_t;
-    using reference = Value&;
-    using pointer = Value*;
+    using reference = const Value&;
+    using pointer = const Value*;
     
     const node* cur;
     const Hashtable* ht;
@@ -108,9 +145,9 @@ struct hashtable_const_iterator {
         const node* old = cur;
         cur = cur->next;
         if(!cur) {
-            size_type bkt = ht->bkt_num(old->val);
-            while(!cur && ++bkt < ht->buckets.size())
-                cur = ht->buckets[bkt];
+            size_type bkt = ht->bkt_num(old);
+            while(!cur && ++bkt < ht->bkt_end())
+                cur = ht->head(bkt);
         }
         return *this;
     }
@@ -148,10 +185,54 @@ inline unsigned long __next_prime(unsigned long n)
   return pos == last ? *(last - 1) : *pos;
 }
 
+// bucket policy: bucket counts of a hashtable and the bucket of a hash
+// code, the last template parameter of hashtable
+//      next_size(n): least bucket count >= n, counts grow about 2x
+//      max_size(): largest bucket count
+//      index(hash, n): bucket of hash in n buckets
+
+// prime bucket counts, hash % n. Buckets are fine even for poor hash
+// functions, but every lookup pays an integer division.
+struct prime_bucket_policy {
+    static size_t next_size(size_t n) { return __next_prime(n); }
+    static size_t max_size() { return __prime_list[__num_primes - 1]; }
+    static size_t index(size_t hash, size_t n) { return hash % n; }
+};
+
+// power of two bucket counts, low bits of the hash after hash_mix,
+// since low bits of the integer hashes alone repeat with any stride
+// which is a power of two.
+struct pow2_bucket_policy {
+    static size_t next_size(size_t n) {
+        size_t size = 64;
+        while(size < n && size < max_size())
+            size <<= 1;
+        return size;
+    }
+    static size_t max_size() { return ~(~size_t(0) >> 1); }
+    static size_t index(size_t hash, size_t n) { return hash_mix(hash) & (n - 1); }
+};
+
+// bucket counts of prime_bucket_policy, but the bucket is the high half
+// of hash * n(Lemire's fast range), a multiply instead of a division.
+// High bits of integer hashes are mostly zero, so the hash is mixed first.
+struct fastrange_bucket_policy {
+    static size_t next_size(size_t n) { return __next_prime(n); }
+    static size_t max_size() { return __prime_list[__num_primes - 1]; }
+    static size_t index(size_t hash, size_t n) {
+        return __fastrange(hash_mix(hash), n);
+    }
+};
+
 
 template <class Value, class Key, class HashFunc,
-          class ExtractKey, class EqualKey, class Alloc>
-class hashtable {
+          class ExtractKey, class EqualKey, class Alloc,
+          class BucketPolicy>
+class hashtable : protected alloc_base<hashtable_node<Value, cache_hash_code_t<HashFunc>>,
+                                       Alloc> {
+private:
+    using base = alloc_base<hashtable_node<Value, cache_hash_code_t<HashFunc>>, Alloc>;
+
 public:
     using key_type = Key;
     using value_type = Value;
@@ -170,20 +251,22 @@ public:
 
 public:
     using allocator_type = Alloc;
-    allocator_type get_allocator() const { return allocator_type();}
+    allocator_type get_allocator() const { return base::get_allocator();}
 
 private:
-    using node = hashtable_node<Value>;
-    using node_alloc = simple_alloc<node>;
+    using cache_hash = cache_hash_code_t<HashFunc>;
+    using node = hashtable_node<Value, cache_hash>;
+    // bucket vector allocates from the same allocator as nodes
+    using bucket_vector = vector<node*, typename alloc_traits<node*, Alloc>::allocator_type>;
 
-    node* get_node() { return node_alloc::allocate(1);}
-    void put_node(node* p) { node_alloc::deallocate(p, 1);}
+    node* get_node() { return this->allocate_n(1);}
+    void put_node(node* p) { this->deallocate_n(p, 1);}
 
     node* new_node(const value_type& obj) {
         node* n = get_node();
         n->next = nullptr;
         try {
-            construct(&n->val, obj);
+            MiniSTL::construct(&n->val, obj);
             return n;
         } catch(std::exception&) {
             put_node(n);
@@ -192,7 +275,7 @@ private:
     }
     
     void delete_node(node* n) {
-        destroy(&n->val);
+        MiniSTL::destroy(&n->val);
         put_node(n);
     }
 
@@ -200,26 +283,35 @@ private:
     hasher          hash;
     key_equal       equals;
     ExtractKey      get_key;
-    vector<node*>   buckets;
+    bucket_vector   buckets;
     size_type       num_elements;
+    // incremental rehash: buckets is zeroed up to rehash_size first, then
+    // nodes of old_buckets[migrated, size) are moved into it.
+    // old_buckets is empty when no rehash runs.
+    bucket_vector   old_buckets;
+    size_type       migrated;
+    size_type       rehash_size;
+    size_type       migrate_step;
+    // elements per bucket the table grows beyond
+    float           max_load;
 
 public:
-    using iterator = hashtable_iterator<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc>;
+    using iterator = hashtable_iterator<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc,BucketPolicy>;
     using const_iterator = hashtable_const_iterator<Value,Key,HashFunc,ExtractKey,EqualKey,
-                                    Alloc>;
+                                    Alloc,BucketPolicy>;
 
     friend struct
-    hashtable_iterator<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc>;
+    hashtable_iterator<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc,BucketPolicy>;
     friend struct
-    hashtable_const_iterator<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc>;
+    hashtable_const_iterator<Value,Key,HashFunc,ExtractKey,EqualKey,Alloc,BucketPolicy>;
 
-    template <class val, class Ky, class HF, class Ex, class Eq, class Al>
-    friend bool operator== (const hashtable<val, Ky, HF, Ex, Eq, Al>&,
-                            const hashtable<val, Ky, HF, Ex, Eq, Al>&);
+    template <class val, class Ky, class HF, class Ex, class Eq, class Al, class Bp>
+    friend bool operator== (const hashtable<val, Ky, HF, Ex, Eq, Al, Bp>&,
+                            const hashtable<val, Ky, HF, Ex, Eq, Al, Bp>&);
 
 private: // buckets related operation
     size_type next_size(size_type n) const
-    { return __next_prime(n);}
+    { return BucketPolicy::next_size(n);}
 
     void initialize_buckets(size_type n) {
         const size_type n_buckets = next_size(n);
@@ -228,46 +320,147 @@ private: // buckets related operation
         num_elements = 0;
     }
 
+    // bucket positions: while a rehash runs, [0, old_buckets.size()) are
+    // the old buckets and the new buckets follow them. Otherwise
+    // positions are bucket numbers.
+    size_type bkt_end() const { return old_buckets.size() + buckets.size();}
+
+    node*& head(size_type pos) {
+        const size_type old_n = old_buckets.size();
+        return pos < old_n ? old_buckets[pos] : buckets[pos - old_n];
+    }
+
+    node* head(size_type pos) const {
+        const size_type old_n = old_buckets.size();
+        return pos < old_n ? old_buckets[pos] : buckets[pos - old_n];
+    }
+
+    void migrate(size_type n_buckets);
+    void release_old_buckets() {
+        bucket_vector(buckets.get_allocator()).swap(old_buckets);
+        migrated = 0;
+    }
+
+    void copy_chains(bucket_vector& dst, const bucket_vector& src);
+
     void copy_from(const hashtable& ht);
 
+    // least bucket count that holds n elements within max_load
+    size_type buckets_for(size_type n) const {
+        const double d = static_cast<double>(n) / max_load;
+        const size_type b = static_cast<size_type>(d);
+        return b < d ? b + 1 : b;
+    }
+
+    void grow(size_type n_buckets);
+
+    // allocator of ht replaces ours on copy assignment if it propagates.
+    // Bucket vectors propagate the same way, they take it from empty
+    // ones and free the buckets got from our allocator
+    void copy_assign_alloc(const hashtable& ht, true_type) {
+        this->copy_alloc(ht, true_type());
+        const bucket_vector no_buckets(this->get_node_allocator());
+        buckets = no_buckets;
+        old_buckets = no_buckets;
+    }
+
+    void copy_assign_alloc(const hashtable&, false_type) {}
+
+    // bucket vectors take ht's allocator with its buckets,
+    // ht is left with no buckets
+    void move_assign(hashtable& ht, true_type) {
+        clear();
+        this->copy_alloc(ht, true_type());
+        buckets = std::move(ht.buckets);
+        old_buckets = std::move(ht.old_buckets);
+        MiniSTL::swap(hash, ht.hash);
+        MiniSTL::swap(equals, ht.equals);
+        MiniSTL::swap(get_key, ht.get_key);
+        MiniSTL::swap(num_elements, ht.num_elements);
+        MiniSTL::swap(migrated, ht.migrated);
+        MiniSTL::swap(rehash_size, ht.rehash_size);
+        MiniSTL::swap(migrate_step, ht.migrate_step);
+        MiniSTL::swap(max_load, ht.max_load);
+    }
+
+    // nodes can only be taken from an equal allocator, 
+    // otherwise elements are copied into our own nodes
+    void move_assign(hashtable& ht, false_type) {
+        if(this->alloc_equal(ht)) {
+            clear();
+            swap(ht);
+        } else {
+            *this = ht;
+            ht.clear();
+        }
+    }
+
 public: // ctor, dtor
     hashtable(size_type n, const HashFunc& hf, const EqualKey& eql,
-              const ExtractKey& ext)
-        : hash(hf), equals(eql), get_key(ext), buckets(),
-        num_elements(0) {
+              const ExtractKey& ext, 
+              const allocator_type& a = allocator_type())
+        : base(a), hash(hf), equals(eql), get_key(ext), 
+        buckets(this->get_node_allocator()), num_elements(0),
+        old_buckets(this->get_node_allocator()), migrated(0), rehash_size(0),
+        migrate_step(0), max_load(1.0f) {
         initialize_buckets(n);
     }
 
-    hashtable(size_type n, const HashFunc& hf, const EqualKey& eql)
-        : hash(hf), equals(eql), get_key(ExtractKey()), buckets(),
-        num_elements(0) {
+    hashtable(size_type n, const HashFunc& hf, const EqualKey& eql,
+              const allocator_type& a = allocator_type())
+        : base(a), hash(hf), equals(eql), get_key(ExtractKey()), 
+        buckets(this->get_node_allocator()), num_elements(0),
+        old_buckets(this->get_node_allocator()), migrated(0), rehash_size(0),
+        migrate_step(0), max_load(1.0f) {
         initialize_buckets(n);
     }
 
     hashtable(const hashtable& ht)
-        : hash(ht.hash), equals(ht.equals), get_key(ht.get_key), buckets(),
-        num_elements(0) {
+        : base(ht.get_allocator()), hash(ht.hash), equals(ht.equals), 
+        get_key(ht.get_key), buckets(this->get_node_allocator()),
+        num_elements(0), old_buckets(this->get_node_allocator()),
+        migrated(0), rehash_size(0), migrate_step(ht.migrate_step),
+        max_load(ht.max_load) {
         copy_from(ht);
     }
 
+    // allocates nothing, ht is left with no buckets until an insert
+    hashtable(hashtable&& ht) noexcept
+        : base(ht.get_allocator()), hash(ht.hash), equals(ht.equals),
+        get_key(ht.get_key), buckets(this->get_node_allocator()),
+        num_elements(0), old_buckets(this->get_node_allocator()),
+        migrated(0), rehash_size(0), migrate_step(ht.migrate_step),
+        max_load(ht.max_load) {
+        swap(ht);
+    }
+
     hashtable& operator= (const hashtable& ht) {
         if(&ht != this) {
             clear();
+            copy_assign_alloc(ht, typename base::propagate_on_copy());
             hash = ht.hash;
             equals = ht.equals;
             get_key = ht.get_key;
+            migrate_step = ht.migrate_step;
+            max_load = ht.max_load;
             copy_from(ht);
         }
         return *this;
     }
 
+    hashtable& operator= (hashtable&& ht) {
+        if(&ht != this)
+            move_assign(ht, typename base::propagate_on_move());
+        return *this;
+    }
+
     ~hashtable() { clear();}
 
 public: //
     iterator begin() { 
-        for(size_type n = 0;n < buckets.size();++n) {
-            if(buckets[n])
-                return iterator(buckets[n], this);
+        for(size_type n = 0;n < bkt_end();++n) {
+            if(head(n))
+                return iterator(head(n), this);
         }
         return end();
     }
@@ -276,9 +469,9 @@ public: //
 
     const_iterator begin() const
     {
-        for(size_type n = 0;n < buckets.size();++n) {
-            if(buckets[n])
-                return const_iterator(buckets[n], this);
+        for(size_type n = 0;n < bkt_end();++n) {
+            if(head(n))
+                return const_iterator(head(n), this);
         }
         return end();
     }
@@ -290,8 +483,19 @@ public: // observor
     size_type bucket_count() const { return buckets.size();}
 
     size_type max_bucket_count() const
-        { return __prime_list[__num_primes - 1];} 
+        { return BucketPolicy::max_size();} 
+
+    float load_factor() const
+        { return buckets.empty() ? 0.0f
+                 : static_cast<float>(num_elements) / buckets.size();}
+    float max_load_factor() const { return max_load;}
+    // z > 0, the table grows at once if size() / bucket_count() > z
+    void max_load_factor(float z) {
+        max_load = z;
+        resize(num_elements);
+    }
 
+    // while a rehash runs, nodes not migrated yet are not counted
     size_type elems_in_bucket(size_type bucket) const {
         size_type result = 0;
         for(node* cur = buckets[bucket];cur;cur = cur->next)
@@ -346,7 +550,7 @@ public: // insert
     template <class ForwardIt>
     void insert_unique(ForwardIt f, ForwardIt l,
                         forward_iterator_tag) {
-        size_type n = distance(f, l);
+        size_type n = MiniSTL::distance(f, l);
         resize(num_elements + n);
         for(;n > 0;--n, ++f)
             insert_unique_noresize(*f);
@@ -355,66 +559,203 @@ public: // insert
     template <class ForwardIt>
     void insert_equal(ForwardIt f, ForwardIt l,
                         forward_iterator_tag) {
-        size_type n = distance(f, l);
+        size_type n = MiniSTL::distance(f, l);
         resize(num_elements + n);
         for(;n > 0;--n, ++f)
             insert_equal_noresize(*f);
     }
 
+    // bulk insert of a batch: all keys are hashed first, then the batch is
+    // partitioned by ranges of buckets and linked range after range, so
+    // the bucket heads and chains written stay in cache instead of each
+    // insert missing on a random bucket. Finishes a running rehash.
+    // Returns the number of elements inserted.
+    template <class ForwardIt>
+    size_type bulk_insert_unique(ForwardIt f, ForwardIt l)
+        { return bulk_insert(f, l, true_type()); }
+
+    template <class ForwardIt>
+    size_type bulk_insert_equal(ForwardIt f, ForwardIt l)
+        { return bulk_insert(f, l, false_type()); }
+
+private:
+    pair<iterator, bool> insert_unique_hashed(const value_type& obj, size_type code);
+    iterator insert_equal_hashed(const value_type& obj, size_type code);
+
+    // bucket heads of one partition of a bulk insert, 32 KB of pointers
+    enum { BULK_SPAN = 4096 };
+
+    template <class ForwardIt, class Unique>
+    size_type bulk_insert(ForwardIt f, ForwardIt l, Unique);
+
+    void insert_hashed(const value_type& obj, size_type code, true_type)
+        { insert_unique_hashed(obj, code); }
+    void insert_hashed(const value_type& obj, size_type code, false_type)
+        { insert_equal_hashed(obj, code); }
+
 private:
-    size_type bkt_num_key(const key_type& key) const{
-        return bkt_num_key(key, buckets.size());
+    // hash code of a node, stored in it if cache_hash
+    size_type node_hash(const node* n) const{
+        return node_hash(n, cache_hash());
+    }
+    size_type node_hash(const node* n, true_type) const{ return n->hash_code;}
+    size_type node_hash(const node* n, false_type) const{
+        return hash(get_key(n->val));
     }
 
-    size_type bkt_num_key(const key_type& key, size_t n) const{
-        return hash(key) % n;
+    void set_node_hash(node* n, size_type code) {
+        set_node_hash(n, code, cache_hash());
     }
+    void set_node_hash(node* n, size_type code, true_type) { n->hash_code = code;}
+    void set_node_hash(node*, size_type, false_type) {}
 
-    size_type bkt_num(const value_type& obj) const{
-        return bkt_num_key(get_key(obj));
+    // code is the hash code of key, compared first if cache_hash
+    template <class K>
+    bool node_equals(const node* n, const K& key, size_type code) const{
+        return node_equals(n, key, code, cache_hash());
+    }
+    template <class K>
+    bool node_equals(const node* n, const K& key, size_type code,
+                     true_type) const{
+        return n->hash_code == code && equals(get_key(n->val), key);
+    }
+    template <class K>
+    bool node_equals(const node* n, const K& key, size_type,
+                     false_type) const{
+        return equals(get_key(n->val), key);
     }
 
-    size_type bkt_num(const value_type& obj, size_t n) const{
-        return bkt_num_key(get_key(obj), n);
+    // position of hash code h, an old bucket not migrated yet while a
+    // rehash runs
+    size_type bkt_num_hash(size_type h) const{
+        const size_type old_n = old_buckets.size();
+        if(old_n != 0) {
+            const size_type old_bkt = BucketPolicy::index(h, old_n);
+            if(old_bkt >= migrated)
+                return old_bkt;
+            return old_n + BucketPolicy::index(h, buckets.size());
+        }
+        return BucketPolicy::index(h, buckets.size());
     }
 
-public: // find
-    reference find_or_insert(const value_type& obj);
+    size_type bkt_num(const node* p) const{
+        return bkt_num_hash(node_hash(p));
+    }
 
-    iterator find(const key_type& key) {
-        size_type n = bkt_num_key(key);
+    size_type bkt_num(const node* p, size_t n) const{
+        return BucketPolicy::index(node_hash(p), n);
+    }
+
+private:
+    // lookups take any key type K which the hasher and key_equal accept
+    // a moved-from table has no buckets, so lookups check for no
+    // elements before hashing
+    template <class K>
+    node* find_node(const K& key) const {
+        if(num_elements == 0)
+            return nullptr;
+        const size_type code = hash(key);
         node* first;
-        for(first = buckets[n];
-            first && !equals(get_key(first->val), key);
-            first = first->next) {}
-        return iterator(first, this);
-    } 
-
-    const_iterator find(const key_type& key) const {
-        size_type n = bkt_num_key(key);
-        const node* first;
-        for(first = buckets[n];
-            first && !equals(get_key(first->val), key);
+        for(first = head(bkt_num_hash(code));
+            first && !node_equals(first, key, code);
             first = first->next) {}
-        return const_iterator(first, this);
-    } 
+        return first;
+    }
 
-    size_type count(const key_type& key) const {
-        const size_type n = bkt_num_key(key);
+    template <class K>
+    size_type count_key(const K& key) const {
+        if(num_elements == 0)
+            return 0;
+        const size_type code = hash(key);
         size_type result = 0;
 
-        for(const node* cur = buckets[n];cur;cur = cur->next) {
-            if(equals(get_key(cur->val), key))
+        for(const node* cur = head(bkt_num_hash(code));cur;cur = cur->next) {
+            if(node_equals(cur, key, code))
                 ++result;
         }
         return result;
     }
 
+    // nullptr for end()
+    template <class K>
+    pair<node*, node*> equal_range_nodes(const K& key) const;
+
+    // keys a batched find hashes ahead of the one it compares
+    enum { FIND_AHEAD = 16 };
+
+    template <class ForwardIt, class Put>
+    void find_batch_nodes(ForwardIt first, ForwardIt last, Put put) const;
+
+public: // find
+    reference find_or_insert(const value_type& obj);
+
+    iterator find(const key_type& key) { return iterator(find_node(key), this);} 
+
+    const_iterator find(const key_type& key) const
+        { return const_iterator(find_node(key), this);} 
+
+    size_type count(const key_type& key) const { return count_key(key);}
+
     pair<iterator, iterator> 
-    equal_range(const key_type& key);
+    equal_range(const key_type& key) {
+        const pair<node*, node*> p = equal_range_nodes(key);
+        return MiniSTL::make_pair(iterator(p.first, this), iterator(p.second, this));
+    }
 
     pair<const_iterator, const_iterator> 
-    equal_range(const key_type& key) const;
+    equal_range(const key_type& key) const {
+        const pair<node*, node*> p = equal_range_nodes(key);
+        return MiniSTL::make_pair(const_iterator(p.first, this),
+                         const_iterator(p.second, this));
+    }
+
+    // heterogeneous lookup of any key which the hasher and key_equal
+    // accept, only if both declare is_transparent. The hasher must give
+    // such a key the hash code of an equal key_type.
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, iterator>> find(const K& key)
+        { return iterator(find_node(key), this);}
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, const_iterator>> find(const K& key) const
+        { return const_iterator(find_node(key), this);}
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, size_type>> count(const K& key) const
+        { return count_key(key);}
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, pair<iterator, iterator>>>
+    equal_range(const K& key) {
+        const pair<node*, node*> p = equal_range_nodes(key);
+        return MiniSTL::make_pair(iterator(p.first, this), iterator(p.second, this));
+    }
+
+    template <class K, class H = HashFunc, class E = EqualKey>
+    transparent_t<H, transparent_t<E, pair<const_iterator, const_iterator>>>
+    equal_range(const K& key) const {
+        const pair<node*, node*> p = equal_range_nodes(key);
+        return MiniSTL::make_pair(const_iterator(p.first, this),
+                         const_iterator(p.second, this));
+    }
+
+    // find of every key of [first, last), written to out in order, end()
+    // for an absent key. The bucket heads of a batch of keys are
+    // prefetched together, then their first nodes, before the chains are
+    // walked, so the cache misses of a batch overlap.
+    template <class ForwardIt, class OutputIt>
+    OutputIt find_batch(ForwardIt first, ForwardIt last, OutputIt out) {
+        find_batch_nodes(first, last,
+                         [this, &out](node* p) { *out++ = iterator(p, this); });
+        return out;
+    }
+
+    template <class ForwardIt, class OutputIt>
+    OutputIt find_batch(ForwardIt first, ForwardIt last, OutputIt out) const {
+        find_batch_nodes(first, last,
+                         [this, &out](node* p) { *out++ = const_iterator(p, this); });
+        return out;
+    }
 
 private:
     void erase_bucket(const size_type n, node* first, node* last);
@@ -428,28 +769,55 @@ public: // erase, resize, swap
     void erase(const const_iterator& it);
     void erase(const_iterator first, const_iterator last);
 
+    // buckets for num_elements_hint elements within max_load_factor()
     void resize(size_type num_elements_hint);
+    void reserve(size_type n) { resize(n);}
+    // at least n buckets and enough for size() elements, never shrinks
+    void rehash(size_type n) {
+        const size_type need = buckets_for(num_elements);
+        grow(n > need ? n : need);
+    }
     void clear();
 
+    // incremental rehash: with n > 0, growing the table only reserves the
+    // new buckets. Every later insert zeroes 8 * n of them, and once all
+    // are zeroed, moves the nodes of the next n old buckets. Lookups
+    // search the old bucket of a key until it has been moved. Growing
+    // again first finishes the running rehash, which never has work left
+    // for n * max_load_factor() >= 2 and 2x growth. Inserts may move
+    // nodes between buckets while a rehash runs, which invalidates
+    // iterators. n = 0(the default) rehashes in one pass.
+    void set_rehash_step(size_type n) { migrate_step = n;}
+    size_type rehash_step() const { return migrate_step;}
+    bool rehashing() const { return !old_buckets.empty();}
+    void finish_rehash() { migrate(rehash_size);}
+
     void swap(hashtable& ht) {
+        this->swap_alloc(ht, typename base::propagate_on_swap());
         MiniSTL::swap(hash, ht.hash);
         MiniSTL::swap(equals, ht.equals);
         MiniSTL::swap(get_key, ht.get_key);
         buckets.swap(ht.buckets);
         MiniSTL::swap(num_elements, ht.num_elements);
+        old_buckets.swap(ht.old_buckets);
+        MiniSTL::swap(migrated, ht.migrated);
+        MiniSTL::swap(rehash_size, ht.rehash_size);
+        MiniSTL::swap(migrate_step, ht.migrate_step);
+        MiniSTL::swap(max_load, ht.max_load);
     }
 };
  
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-bool operator==(const hashtable<Value,Key,HF,Ex,Eq,Al>& ht1,
-                const hashtable<Value,Key,HF,Ex,Eq,Al>& ht2) {
-    using node = typename hashtable<Value,Key,HF,Ex,Eq,Al>::node;
-    if(ht1.buckets.size() != ht2.buckets.size())
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+bool operator==(const hashtable<Value,Key,HF,Ex,Eq,Al,Bp>& ht1,
+                const hashtable<Value,Key,HF,Ex,Eq,Al,Bp>& ht2) {
+    using node = typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::node;
+    if(ht1.buckets.size() != ht2.buckets.size() ||
+       ht1.old_buckets.size() != ht2.old_buckets.size())
         return false;
-    for(int n = 0;n < ht1.buckets.size();++n) {
-        node* cur1 = ht1.buckets[n];
-        node* cur2 = ht2.buckets[n];
+    for(size_t n = 0;n < ht1.bkt_end();++n) {
+        const node* cur1 = ht1.head(n);
+        const node* cur2 = ht2.head(n);
         for(;cur1 && cur2 && cur1->val == cur2->val;
             cur1 = cur1->next, cur2 = cur2->next)
         {}
@@ -460,47 +828,67 @@ bool operator==(const hashtable<Value,Key,HF,Ex,Eq,Al>& ht1,
 }  
 
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-inline bool operator!=(const hashtable<Value,Key,HF,Ex,Eq,Al>& ht1,
-                       const hashtable<Value,Key,HF,Ex,Eq,Al>& ht2) {
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+inline bool operator!=(const hashtable<Value,Key,HF,Ex,Eq,Al,Bp>& ht1,
+                       const hashtable<Value,Key,HF,Ex,Eq,Al,Bp>& ht2) {
     return !(ht1 == ht2);
 }
 
 template <class Value, class Key, class HF, class Ex, class Eq, 
-          class Al>
-inline void swap(hashtable<Value, Key, HF, Ex, Eq, Al>& ht1,
-                 hashtable<Value, Key, HF, Ex, Eq, Al>& ht2) {
+          class Al, class Bp>
+inline void swap(hashtable<Value, Key, HF, Ex, Eq, Al, Bp>& ht1,
+                 hashtable<Value, Key, HF, Ex, Eq, Al, Bp>& ht2) {
     ht1.swap(ht2);
 }
 
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-pair<typename hashtable<Value,Key,HF,Ex,Eq,Al>::iterator, bool> 
-hashtable<Value,Key,HF,Ex,Eq,Al>::insert_unique_noresize(const value_type& obj) {
-    const size_type n = bkt_num(obj);
-    node* first = buckets[n];
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+pair<typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::iterator, bool> 
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::insert_unique_noresize(const value_type& obj) {
+    if(buckets.empty())
+        initialize_buckets(1);
+    return insert_unique_hashed(obj, hash(get_key(obj)));
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+pair<typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::iterator, bool> 
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::insert_unique_hashed(const value_type& obj,
+                                                          size_type code) {
+    const size_type n = bkt_num_hash(code);
+    node* first = head(n);
 
     for(node* cur = first;cur;cur = cur->next) {
-        if(equals(get_key(cur->val), get_key(obj)))
-            return make_pair(iterator(cur, this), false);
+        if(node_equals(cur, get_key(obj), code))
+            return MiniSTL::make_pair(iterator(cur, this), false);
     }
 
     node* tmp = new_node(obj);
+    set_node_hash(tmp, code);
     tmp->next = first;
-    buckets[n] = tmp;
+    head(n) = tmp;
     ++num_elements;
-    return make_pair(iterator(tmp, this), true);
+    return MiniSTL::make_pair(iterator(tmp, this), true);
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-typename hashtable<Value,Key,HF,Ex,Eq,Al>::iterator 
-hashtable<Value,Key,HF,Ex,Eq,Al>::insert_equal_noresize(const value_type& obj) {
-    const size_type n = bkt_num(obj);
-    node* first = buckets[n];
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::iterator 
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::insert_equal_noresize(const value_type& obj) {
+    if(buckets.empty())
+        initialize_buckets(1);
+    return insert_equal_hashed(obj, hash(get_key(obj)));
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::iterator 
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::insert_equal_hashed(const value_type& obj,
+                                                         size_type code) {
+    const size_type n = bkt_num_hash(code);
+    node* first = head(n);
 
     for(node* cur = first;cur;cur = cur->next) {
-        if(equals(get_key(cur->val), get_key(obj))) {
+        if(node_equals(cur, get_key(obj), code)) {
             node* tmp = new_node(obj);
+            set_node_hash(tmp, code);
             tmp->next = cur->next;
             cur->next = tmp;
             ++num_elements;
@@ -509,90 +897,178 @@ hashtable<Value,Key,HF,Ex,Eq,Al>::insert_equal_noresize(const value_type& obj) {
     }
 
     node* tmp = new_node(obj);
+    set_node_hash(tmp, code);
     tmp->next = first;
-    buckets[n] = tmp;
+    head(n) = tmp;
     ++num_elements;
     return iterator(tmp, this);
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-typename hashtable<Value,Key,HF,Ex,Eq,Al>::reference 
-hashtable<Value,Key,HF,Ex,Eq,Al>::find_or_insert(const value_type& obj) {
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+template <class ForwardIt, class Unique>
+typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::size_type
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::bulk_insert(ForwardIt f, ForwardIt l, Unique) {
+    const size_type n = MiniSTL::distance(f, l);
+    const size_type old_size = num_elements;
+    resize(num_elements + n);
+    finish_rehash();
+    const size_type n_buckets = buckets.size();
+
+    // sorting a batch much smaller than the table costs more than the
+    // scattered inserts it saves
+    if(n < n_buckets / 16) {
+        for(;f != l;++f)
+            insert_hashed(*f, hash(get_key(*f)), Unique());
+        return num_elements - old_size;
+    }
+
+    struct entry {
+        size_type code;
+        ForwardIt it;
+    };
+    // partition by ranges of BULK_SPAN buckets, counting sort on the
+    // range. The partition pass writes to few places at a time, and the
+    // heads of a range and the nodes linked into it stay in cache while
+    // its entries are inserted.
+    const size_type n_parts = n_buckets / BULK_SPAN + 1;
+    vector<size_type> codes(n, 0);
+    vector<size_type> first(n_parts + 1, 0);
+    ForwardIt cur = f;
+    for(size_type i = 0;i < n;++i, ++cur) {
+        codes[i] = hash(get_key(*cur));
+        ++first[Bp::index(codes[i], n_buckets) / BULK_SPAN + 1];
+    }
+    for(size_type p = 0;p < n_parts;++p)
+        first[p + 1] += first[p];
+    vector<entry> sorted(n, entry{0, f});
+    cur = f;
+    for(size_type i = 0;i < n;++i, ++cur) {
+        entry& e = sorted[first[Bp::index(codes[i], n_buckets) / BULK_SPAN]++];
+        e.code = codes[i];
+        e.it = cur;
+    }
+
+    // entries follow the bucket order, not the input order, so the
+    // value of a later entry is prefetched
+    const size_type AHEAD = 8;
+    for(size_type i = 0;i < n;++i) {
+        if(i + AHEAD < n)
+            __prefetch(&*sorted[i + AHEAD].it);
+        insert_hashed(*sorted[i].it, sorted[i].code, Unique());
+    }
+    return num_elements - old_size;
+}
+
+// software pipeline over the keys: key i + FIND_AHEAD is hashed and its
+// bucket prefetched, the head of key i + FIND_AHEAD / 2 is loaded and
+// prefetched, and the chain of key i is walked.
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+template <class ForwardIt, class Put>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::find_batch_nodes(ForwardIt first,
+                                                           ForwardIt last,
+                                                           Put put) const {
+    const size_type RING = 2 * FIND_AHEAD;
+    const size_type HALF = FIND_AHEAD / 2;
+    size_type codes[RING];
+    size_type pos[RING];
+    const node* nodes[RING];
+    if(num_elements == 0) {
+        for(;first != last;++first)
+            put(static_cast<node*>(nullptr));
+        return;
+    }
+    const size_type n = MiniSTL::distance(first, last);
+    const size_type old_n = old_buckets.size();
+    ForwardIt ahead = first;
+    for(size_type i = 0;i < n + FIND_AHEAD;++i) {
+        if(i < n) {
+            const size_type k = i % RING;
+            codes[k] = hash(*ahead);
+            pos[k] = bkt_num_hash(codes[k]);
+            __prefetch(pos[k] < old_n ? &old_buckets[pos[k]]
+                                      : &buckets[pos[k] - old_n]);
+            ++ahead;
+        }
+        if(i >= HALF && i - HALF < n) {
+            const size_type k = (i - HALF) % RING;
+            nodes[k] = head(pos[k]);
+            if(nodes[k])
+                __prefetch(nodes[k]);
+        }
+        if(i >= FIND_AHEAD) {
+            const size_type k = (i - FIND_AHEAD) % RING;
+            const node* p = nodes[k];
+            while(p && !node_equals(p, *first, codes[k]))
+                p = p->next;
+            put(const_cast<node*>(p));
+            ++first;
+        }
+    }
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::reference 
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::find_or_insert(const value_type& obj) {
     resize(num_elements + 1);
 
-    size_type n = bkt_num(obj);
-    node* first = buckets[n];
+    const size_type code = hash(get_key(obj));
+    size_type n = bkt_num_hash(code);
+    node* first = head(n);
 
     for(node* cur = first;cur;cur = cur->next) {
-        if(equals(get_key(cur->val), get_key(obj)))
+        if(node_equals(cur, get_key(obj), code))
             return cur->val;
     }
 
     node* tmp = new_node(obj);
+    set_node_hash(tmp, code);
     tmp->next = first;
-    buckets[n] = tmp;
+    head(n) = tmp;
     ++num_elements;
     return tmp->val;
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-pair<typename hashtable<Value,Key,HF,Ex,Eq,Al>::iterator,
-     typename hashtable<Value,Key,HF,Ex,Eq,Al>::iterator> 
-hashtable<Value,Key,HF,Ex,Eq,Al>::equal_range(const key_type& key) {
-    const size_type n = bkt_num_key(key);
-
-    for(node* first = buckets[n];first;first = first->next) {
-        if(equals(get_key(first->val), key)) {
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+template <class K>
+pair<typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::node*,
+     typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::node*> 
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::equal_range_nodes(const K& key) const {
+    if(num_elements == 0)
+        return MiniSTL::make_pair(static_cast<node*>(nullptr), static_cast<node*>(nullptr));
+    const size_type code = hash(key);
+    const size_type n = bkt_num_hash(code);
+
+    for(node* first = head(n);first;first = first->next) {
+        if(node_equals(first, key, code)) {
             for(node* cur = first->next;cur;cur = cur->next) {
-                if(!equals(get_key(cur->val), key))
-                    return make_pair(iterator(first, this), iterator(cur, this));
+                if(!node_equals(cur, key, code))
+                    return MiniSTL::make_pair(first, cur);
             }
-            for(size_type m = n + 1;m < buckets.size();++m) {
-                if(buckets[m])
-                    return make_pair(iterator(first, this), iterator(buckets[m], this));
+            for(size_type m = n + 1;m < bkt_end();++m) {
+                if(head(m))
+                    return MiniSTL::make_pair(first, head(m));
             }
-            return make_pair(iterator(first, this), end());
+            return MiniSTL::make_pair(first, static_cast<node*>(nullptr));
         }
     }
-    return make_pair(end(), end());
+    return MiniSTL::make_pair(static_cast<node*>(nullptr), static_cast<node*>(nullptr));
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-pair<typename hashtable<Value,Key,HF,Ex,Eq,Al>::const_iterator, 
-     typename hashtable<Value,Key,HF,Ex,Eq,Al>::const_iterator> 
-hashtable<Value,Key,HF,Ex,Eq,Al>::equal_range(const key_type& key) const {
-    const size_type n = bkt_num_key(key);
-
-    for(const node* first = buckets[n];first;first = first->next) {
-        if(equals(get_key(first->val), key)) {
-            for(const node* cur = first->next;cur;cur = cur->next) {
-                if(!equals(get_key(cur->val), key))
-                    return make_pair(const_iterator(first, this),
-                                     const_iterator(cur, this));
-            }
-            for(size_type m = n + 1;m < buckets.size();++m) {
-                if(buckets[m])
-                    return make_pair(const_iterator(first, this),
-                                     const_iterator(buckets[m], this));
-            }
-            return make_pair(const_iterator(first, this), end());
-        }
-    }
-    return make_pair(end(), end());
-}
-
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-typename hashtable<Value,Key,HF,Ex,Eq,Al>::size_type 
-hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const key_type& key) {
-    const size_type n = bkt_num_key(key);
-    node* first = buckets[n];
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+typename hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::size_type 
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::erase(const key_type& key) {
+    if(num_elements == 0)
+        return 0;
+    const size_type code = hash(key);
+    const size_type n = bkt_num_hash(code);
+    node* first = head(n);
     size_type erased = 0;
 
     if(first) {
         node* cur = first;
         node* next = cur->next;
         while(next) {
-            if(equals(get_key(next->val), key)) {
+            if(node_equals(next, key, code)) {
                 cur->next = next->next;
                 delete_node(next);
                 next = cur->next;
@@ -603,8 +1079,8 @@ hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const key_type& key) {
                 next = cur->next;
             }    
         }
-        if(equals(get_key(first->val), key)) {
-            buckets[n] = first->next;
+        if(node_equals(first, key, code)) {
+            head(n) = first->next;
             delete_node(first);
             ++erased;
             --num_elements;
@@ -613,15 +1089,15 @@ hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const key_type& key) {
     return erased;
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-void hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const iterator& it) {
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::erase(const iterator& it) {
     node* p = it.cur;
     if(p) {
-        const size_type n = bkt_num(p->val);
-        node* cur = buckets[n];
+        const size_type n = bkt_num(p);
+        node* cur = head(n);
 
         if(cur == p) {
-            buckets[n] = cur->next;
+            head(n) = cur->next;
             delete_node(cur);
             --num_elements;
         } else {
@@ -641,20 +1117,20 @@ void hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const iterator& it) {
     }
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
 inline void
-hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const const_iterator& it) {
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::erase(const const_iterator& it) {
     erase(iterator(const_cast<node*>(it.cur),
                     const_cast<hashtable*>(it.ht)));
 }
 
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-void hashtable<Value,Key,HF,Ex,Eq,Al>::erase(iterator first, iterator last) {
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::erase(iterator first, iterator last) {
     size_type f_bkt = first.cur ? 
-        bkt_num(first.cur->val) : buckets.size();
+        bkt_num(first.cur) : bkt_end();
     size_type l_bkt = last.cur ? 
-        bkt_num(last.cur->val) : buckets.size();
+        bkt_num(last.cur) : bkt_end();
 
     if(first.cur == last.cur)
         return;
@@ -664,14 +1140,14 @@ void hashtable<Value,Key,HF,Ex,Eq,Al>::erase(iterator first, iterator last) {
         erase_bucket(f_bkt, first.cur, nullptr);
         for(size_type n = f_bkt + 1;n < l_bkt;++n)
             erase_bucket(n, nullptr);
-        if(l_bkt != buckets.size())
+        if(l_bkt != bkt_end())
             erase_bucket(l_bkt, last.cur);
     }
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
 inline void
-hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const_iterator first,
+hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::erase(const_iterator first,
                                              const_iterator last) {
     erase(iterator(const_cast<node*>(first.cur),
                    const_cast<hashtable*>(first.ht)),
@@ -679,18 +1155,41 @@ hashtable<Value,Key,HF,Ex,Eq,Al>::erase(const_iterator first,
                    const_cast<hashtable*>(last.ht)));
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-void hashtable<Value,Key,HF,Ex,Eq,Al>::resize(size_type num_elements_hint) {
-    const size_type old_n = buckets.size();
-    if(num_elements_hint > old_n) {
-        const size_type n = next_size(num_elements_hint);
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::resize(size_type num_elements_hint) {
+    if(rehashing())
+        migrate(migrate_step);
+    // buckets may not be zeroed up to its size yet
+    const size_type old_n = rehashing() ? rehash_size : buckets.size();
+    if(num_elements_hint > old_n * static_cast<double>(max_load))
+        grow(buckets_for(num_elements_hint));
+}
+
+// at least n_buckets buckets, in one pass or starting an incremental rehash
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::grow(size_type n_buckets) {
+    const size_type old_n = rehashing() ? rehash_size : buckets.size();
+    if(n_buckets > old_n) {
+        const size_type n = next_size(n_buckets);
         if(n > old_n) {
-            vector<node*> tmp(n, nullptr);
+            finish_rehash();
+            // a table with no buckets has no nodes to migrate
+            if(migrate_step != 0 && old_n != 0) {
+                bucket_vector tmp(buckets.get_allocator());
+                tmp.reserve(n);
+                old_buckets.swap(buckets);
+                buckets.swap(tmp);
+                migrated = 0;
+                rehash_size = n;
+                migrate(migrate_step);
+                return;
+            }
+            bucket_vector tmp(n, nullptr, buckets.get_allocator());
             try {
                 for(size_type bucket = 0;bucket < old_n;++bucket) {
                     node* first = buckets[bucket];
                     while(first) {
-                        size_type new_bkt = bkt_num(first->val, n);
+                        size_type new_bkt = bkt_num(first, n);
                         buckets[bucket] = first->next;
 
                         first->next = tmp[new_bkt];
@@ -714,10 +1213,42 @@ void hashtable<Value,Key,HF,Ex,Eq,Al>::resize(size_type num_elements_hint) {
     }
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-void hashtable<Value,Key,HF,Ex,Eq,Al>
+// zeroes 8 * n_buckets new buckets, or after all are zeroed, moves the
+// nodes of the next n_buckets old buckets. Zeroing in steps keeps page
+// faults of a large bucket array off a single insert. A node leaves its
+// old bucket only after its new bucket is known, so a throwing hash
+// function leaves every node reachable.
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::migrate(size_type n_buckets) {
+    const size_type old_n = old_buckets.size();
+    if(old_n == 0)
+        return;
+    if(buckets.size() < rehash_size) {
+        const size_type fill = rehash_size - buckets.size();
+        buckets.insert(buckets.end(), n_buckets < fill / 8 ? n_buckets * 8 : fill,
+                       nullptr);
+        if(buckets.size() < rehash_size)
+            return;
+    }
+    const size_type last = n_buckets < old_n - migrated ? migrated + n_buckets : old_n;
+    for(;migrated < last;++migrated) {
+        node* first = old_buckets[migrated];
+        while(first) {
+            const size_type new_bkt = bkt_num(first, buckets.size());
+            old_buckets[migrated] = first->next;
+            first->next = buckets[new_bkt];
+            buckets[new_bkt] = first;
+            first = old_buckets[migrated];
+        }
+    }
+    if(migrated == old_n)
+        release_old_buckets();
+}
+
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>
     ::erase_bucket(const size_type n, node* first, node* last) {
-    node* cur = buckets[n];
+    node* cur = head(n);
     if(cur == first)
         erase_bucket(n, last);
     else {
@@ -732,58 +1263,91 @@ void hashtable<Value,Key,HF,Ex,Eq,Al>
     }
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-void hashtable<Value,Key,HF,Ex,Eq,Al>
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>
     ::erase_bucket(const size_type n, node* last) {
-    node* cur = buckets[n];
+    node* cur = head(n);
     while(cur != last) {
         node* next = cur->next;
         delete_node(cur);
         cur = next;
-        buckets[n] = cur;
+        head(n) = cur;
         --num_elements;
     }
 }
 
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-void hashtable<Value,Key,HF,Ex,Eq,Al>::clear() {
-    for(size_type i = 0;i < buckets.size();++i) {
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::clear() {
+    if(num_elements == 0 && !rehashing())
+        return;
+    // deallocate may be an opaque call, read size only once
+    const size_type n = buckets.size();
+    for(size_type i = 0;i < n;++i) {
         node* cur = buckets[i];
-        while(cur != 0) {
+        while(cur != nullptr) {
             node* next = cur->next;
             delete_node(cur);
             cur = next;
         }
         buckets[i] = nullptr;
     }
+    for(size_type i = migrated;i < old_buckets.size();++i) {
+        node* cur = old_buckets[i];
+        while(cur != nullptr) {
+            node* next = cur->next;
+            delete_node(cur);
+            cur = next;
+        }
+    }
+    release_old_buckets();
     num_elements = 0;
 }
 
     
-template <class Value, class Key, class HF, class Ex, class Eq, class Al>
-void hashtable<Value,Key,HF,Ex,Eq,Al>::copy_from(const hashtable& ht) {
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>::copy_from(const hashtable& ht) {
     buckets.clear();
     buckets.reserve(ht.buckets.size());
     buckets.insert(buckets.end(), ht.buckets.size(), (node*) 0);
+    if(ht.rehashing()) {
+        buckets.reserve(ht.rehash_size);
+        old_buckets.clear();
+        old_buckets.reserve(ht.old_buckets.size());
+        old_buckets.insert(old_buckets.end(), ht.old_buckets.size(), (node*) 0);
+    } else {
+        release_old_buckets();
+    }
+    migrated = ht.migrated;
+    rehash_size = ht.rehash_size;
+    // clear() below frees a partial copy
+    num_elements = ht.num_elements;
     try {
-        for(size_type i = 0;i < ht.buckets.size();++i) {
-            const node* cur = ht.buckets[i];
-            if(cur) {
-                node* c = new_node(cur->val);
-                buckets[i] = c;
-
-                for(node* next = cur->next;next;
-                    cur = next, next = cur->next) {
-                    c->next = new_node(next->val);
-                    c = c->next;
-                }
-            }
-        }
-        num_elements = ht.num_elements;
-    } catch(std::exception) {
+        copy_chains(buckets, ht.buckets);
+        copy_chains(old_buckets, ht.old_buckets);
+    } catch(std::exception&) {
         clear();
         throw;
     }
 }
 
+template <class Value, class Key, class HF, class Ex, class Eq, class Al, class Bp>
+void hashtable<Value,Key,HF,Ex,Eq,Al,Bp>
+    ::copy_chains(bucket_vector& dst, const bucket_vector& src) {
+    for(size_type i = 0;i < src.size();++i) {
+        const node* cur = src[i];
+        if(cur) {
+            node* c = new_node(cur->val);
+            set_node_hash(c, node_hash(cur));
+            dst[i] = c;
+
+            for(node* next = cur->next;next;
+                cur = next, next = cur->next) {
+                c->next = new_node(next->val);
+                c = c->next;
+                set_node_hash(c, node_hash(next));
+            }
+        }
+    }
+}
+
 } // MiniSTL
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Function/function.hpp"
 
 #include <initializer_list>
+#include <stdexcept>
 
 
 namespace MiniSTL {
@@ -53,28 +54,32 @@ public:
 	};
 
     // construct/copy/destroy:
-    explicit map(const Compare& comp = Compare()) : impl(comp) {}
+    explicit map(const Compare& comp = Compare(),
+                 const allocator_type& a = allocator_type())
+        : impl(comp, a) {}
 
     template <class InputIt>
-    map(InputIt first, InputIt last, const Compare& comp = Compare()) 
-        : impl(comp) { impl.insert_unique(first, last); }
+    map(InputIt first, InputIt last, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(first, last); }
     
     map(const map& x) : impl(x.impl) {}
-    map(map&& x) : impl(std::move(impl)) {}
-    map(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
-        : impl(comp) { impl.insert_unique(ilist.begin(), ilist.end()); }
+    map(map&& x) : impl(std::move(x.impl)) {}
+    map(std::initializer_list<value_type> ilist, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(ilist.begin(), ilist.end()); }
     ~map() {}
     
     // assign
     map& operator=(const map& x) { impl = x.impl; return *this; }
-    map& operator=(map&& x) { impl = std::move(impl); return *this; }
+    map& operator=(map&& x) { impl = std::move(x.impl); return *this; }
     map& operator=(std::initializer_list<value_type> ilist) {
         impl.clear();
         impl.insert_unique(ilist.begin(), ilist.end());
         return *this;
     }
 
-    allocator_type get_allocator() const noexcept { return allocator_type(); }
+    allocator_type get_allocator() const noexcept { return impl.get_allocator(); }
  
     // iterators:
     iterator        begin() noexcept { return impl.begin(); }
@@ -98,10 +103,33 @@ public:
     size_type   max_size() const noexcept { return impl.max_size(); }
     
     // element access:
-    T& operator[](const key_type& x) { return *(impl.find(x)); }
-    T& operator[](key_type&& x) { return *(impl.find(x)); }
-    T&       at(const key_type& x) { return *(impl.find(x)); }
-    const T& at(const key_type& x) const { return *(impl.find(x)); }
+    // default constructed T is inserted for a missing key
+    T& operator[](const key_type& x) {
+        iterator i = impl.lower_bound(x);
+        if(i == end() || impl.key_compare()(x, i->first))
+            i = impl.insert_unique(i, value_type(x, T()));
+        return i->second;
+    }
+    T& operator[](key_type&& x) {
+        iterator i = impl.lower_bound(x);
+        if(i == end() || impl.key_compare()(x, i->first))
+            i = impl.insert_unique(i, value_type(std::move(x), T()));
+        return i->second;
+    }
+
+    // throw std::out_of_range for a missing key
+    T& at(const key_type& x) {
+        iterator i = impl.find(x);
+        if(i == end())
+            throw std::out_of_range("key not found in map");
+        return i->second;
+    }
+    const T& at(const key_type& x) const {
+        const_iterator i = impl.find(x);
+        if(i == end())
+            throw std::out_of_range("key not found in map");
+        return i->second;
+    }
 
     // modifiers:
     template <class... Args> 
@@ -164,6 +192,38 @@ public:
     pair<const_iterator, const_iterator> 
     equal_range(const key_type& x) const 
         { return impl.equal_range(x); }
+
+    // heterogeneous lookup, only if Compare declares is_transparent
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& x) { return impl.find(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& x) const
+        { return impl.find(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& x) const
+        { return impl.count(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& x)
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& x) const
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& x)
+        { return impl.upper_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& x) const
+        { return impl.upper_bound(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& x)
+        { return impl.equal_range(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& x) const
+        { return impl.equal_range(x); }
 };
 
 template <class Key, class T, class Compare, class Alloc>
@@ -53,28 +53,32 @@ public:
 	};
 
     // construct/copy/destroy:
-    explicit multimap(const Compare& comp = Compare()) : impl(comp) {}
+    explicit multimap(const Compare& comp = Compare(),
+                      const allocator_type& a = allocator_type())
+        : impl(comp, a) {}
 
     template <class InputIt>
-    multimap(InputIt first, InputIt last, const Compare& comp = Compare()) 
-        : impl(comp) { impl.insert_equal(first, last); }
+    multimap(InputIt first, InputIt last, const Compare& comp = Compare(),
+             const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_equal(first, last); }
     
     multimap(const multimap& x) : impl(x.impl) {}
-    multimap(multimap&& x) : impl(std::move(impl)) {}
-    multimap(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
-        : impl(comp) { impl.insert_equal(ilist.begin(), ilist.end()); }
+    multimap(multimap&& x) : impl(std::move(x.impl)) {}
+    multimap(std::initializer_list<value_type> ilist, const Compare& comp = Compare(),
+             const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_equal(ilist.begin(), ilist.end()); }
     ~multimap() {}
     
     // assign
     multimap& operator=(const multimap& x) { impl = x.impl; return *this; }
-    multimap& operator=(multimap&& x) { impl = std::move(impl); return *this; }
+    multimap& operator=(multimap&& x) { impl = std::move(x.impl); return *this; }
     multimap& operator=(std::initializer_list<value_type> ilist) {
         impl.clear();
         impl.insert_equal(ilist.begin(), ilist.end());
         return *this;
     }
 
-    allocator_type get_allocator() const noexcept { return allocator_type(); }
+    allocator_type get_allocator() const noexcept { return impl.get_allocator(); }
  
     // iterators:
     iterator        begin() noexcept { return impl.begin(); }
@@ -112,10 +116,10 @@ public:
     iterator emplace_hint(const_iterator pos, Args&&... args)
         { return impl.insert_equal(pos, std::move(std::move(value_type(args...)))); }
  
-    pair<iterator,bool> insert(const value_type& x) 
+    iterator insert(const value_type& x) 
     { return impl.insert_equal(x); }
 
-    pair<iterator,bool> insert(value_type&& x)
+    iterator insert(value_type&& x)
         { return impl.insert_equal(std::move(x)); }
     iterator insert(const_iterator pos, const value_type& x) {
         return impl.insert_equal(pos, x);
@@ -164,6 +168,38 @@ public:
     pair<const_iterator, const_iterator> 
     equal_range(const key_type& x) const 
         { return impl.equal_range(x); }
+
+    // heterogeneous lookup, only if Compare declares is_transparent
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& x) { return impl.find(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& x) const
+        { return impl.find(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& x) const
+        { return impl.count(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& x)
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& x) const
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& x)
+        { return impl.upper_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& x) const
+        { return impl.upper_bound(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& x)
+        { return impl.equal_range(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& x) const
+        { return impl.equal_range(x); }
 };
 
 template <class Key, class T, class Compare, class Alloc>
@@ -26,8 +26,10 @@
 #include "Function/function.hpp"
 #include "Iterator/iterator.hpp"
 #include "Util/pair.hpp"
+#include "tree_node_base.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <climits>
 
@@ -37,7 +39,9 @@ using rb_tree_color_t = bool;
 const rb_tree_color_t rb_tree_red = false;
 const rb_tree_color_t rb_tree_black = true;
 
-template <class Value>
+// nodes are read and written through get_parent/set_parent and
+// get_color/set_color, whatever their layout
+template <class Value, class Packed = tree_node_packed_t>
 struct rb_tree_node {
     using color_t = rb_tree_color_t;
     using node_ptr_t = rb_tree_node*;
@@ -48,6 +52,51 @@ struct rb_tree_node {
     node_ptr_t right;
     Value value_field;
 
+    node_ptr_t get_parent() const { return parent; }
+    void set_parent(node_ptr_t p) { parent = p; }
+    color_t get_color() const { return color; }
+    void set_color(color_t c) { color = c; }
+    // both at once, for a new node
+    void set_parent_color(node_ptr_t p, color_t c) { parent = p; color = c; }
+
+    static node_ptr_t minimum(node_ptr_t x) {
+        while(x->left)
+            x = x->left;
+        return x;
+    }
+
+    static node_ptr_t maximum(node_ptr_t x) {
+        while(x->right)
+            x = x->right;
+        return x;
+    }
+};
+
+template <class Value>
+struct rb_tree_node<Value, true_type> {
+    using color_t = rb_tree_color_t;
+    using node_ptr_t = rb_tree_node*;
+
+    // parent pointer | color
+    uintptr_t parent_color;
+    node_ptr_t left;
+    node_ptr_t right;
+    Value value_field;
+
+    node_ptr_t get_parent() const {
+        return reinterpret_cast<node_ptr_t>(parent_color & ~uintptr_t(1));
+    }
+    void set_parent(node_ptr_t p) {
+        parent_color = reinterpret_cast<uintptr_t>(p) | (parent_color & 1);
+    }
+    color_t get_color() const { return (parent_color & 1) != 0; }
+    void set_color(color_t c) {
+        parent_color = (parent_color & ~uintptr_t(1)) | uintptr_t(c);
+    }
+    void set_parent_color(node_ptr_t p, color_t c) {
+        parent_color = reinterpret_cast<uintptr_t>(p) | uintptr_t(c);
+    }
+
     static node_ptr_t minimum(node_ptr_t x) {
         while(x->left)
             x = x->left;
@@ -93,10 +142,10 @@ struct rb_tree_iterator {
             // case2: no right subtree
             // up until node is left of p
             // case 2.1: p is next
-            node_ptr_t p = node->parent;
+            node_ptr_t p = node->get_parent();
             while(node == p->right) {
                 node = p;
-                p = p->parent;
+                p = p->get_parent();
             }
             // special case2.2: node = root withour right and 
             // p == header, next is header, aka end();
@@ -106,8 +155,8 @@ struct rb_tree_iterator {
     }
 
     void decre() {
-        if(node->color = rb_tree_red && 
-                    node->parent->parent == node) {
+        if(node->get_color() == rb_tree_red && 
+                    node->get_parent()->get_parent() == node) {
             // special case1: node = header, 
             // prev = mostright, aka max;
             node = node->right;
@@ -119,10 +168,10 @@ struct rb_tree_iterator {
             // up until node is right of p, p is prev
             // ? if node = begin(), aks min, after loop p =  
             // ? header and node = root, then node will be end()
-            node_ptr_t p = node->parent;
+            node_ptr_t p = node->get_parent();
             while(node == p->left) {
                 node = p;
-                p = p->parent;
+                p = p->get_parent();
             }
             node = p;
         }
@@ -152,12 +201,14 @@ struct rb_tree_iterator {
 
 template <class Key, class Value, class KeyOfValue, 
           class Compare, class Alloc = simple_alloc<Value>>
-class rb_tree {
+class rb_tree : protected alloc_base<rb_tree_node<Value>, Alloc> {
+private:
+    using base = alloc_base<rb_tree_node<Value>, Alloc>;
+
 protected:
     using node_t = rb_tree_node<Value>;
     using node_ptr_t = rb_tree_node<Value>*;
     using color_t = rb_tree_color_t;
-    using node_alloc = simple_alloc<node_t>;
 
 public:
     using key_type = Key;
@@ -176,7 +227,7 @@ public:
 
 public:
     // observior
-    allocator_type get_allocator() { return allocator_type(); }
+    allocator_type get_allocator() const { return base::get_allocator(); }
     Compare key_compare() const { return key_comp; }
 
 protected:
@@ -186,8 +237,8 @@ protected:
     Compare key_comp;
 
 protected:
-    node_ptr_t get_node() { return node_alloc::allocate(1); }
-    void put_node(node_ptr_t p) { node_alloc::deallocate(p, 1); }
+    node_ptr_t get_node() { return this->allocate_n(1); }
+    void put_node(node_ptr_t p) { this->deallocate_n(p, 1); }
 
     node_ptr_t create_node(const Value& val) {
         node_ptr_t tmp = get_node();
@@ -214,8 +265,7 @@ protected:
     // clone a new node with value and color
     node_ptr_t clone_node(node_ptr_t p) {
         node_ptr_t tmp = create_node(p->value_field);
-        tmp->parent = nullptr;
-        tmp->color = p->color;
+        tmp->set_parent_color(nullptr, p->get_color());
         tmp->left = nullptr;
         tmp->right = nullptr;
         return tmp;
@@ -225,7 +275,8 @@ protected:
         { destroy(&p->value_field); put_node(p); }
 
 protected:
-    node_ptr_t& root() const { return header->parent; }
+    node_ptr_t root() const { return header->get_parent(); }
+    void set_root(node_ptr_t x) { header->set_parent(x); }
     node_ptr_t& leftmost() const { return header->left; }
     node_ptr_t& rightmost() const { return header->right; }
 
@@ -240,51 +291,83 @@ protected:
     static node_ptr_t maximum(node_ptr_t p)
         { return node_t::maximum(p); }
 
+    static iterator mutable_iterator(const_iterator it)
+        { return iterator(it.node); }
+
 private:
     void empty_initialize() {
         header = get_node();
         // used to distinguish header from root, when iterator++
-        header->color = rb_tree_red;
-        root() = nullptr;
+        header->set_parent_color(nullptr, rb_tree_red);
         leftmost() = header;
         rightmost() = header;
     }
 
-    void clear() {
-        if(node_count != 0) {
-            erase(root());
-            root() = nullptr;
-            leftmost() = header;
-            rightmost() = header;
-            node_count = 0;
+    node_ptr_t copy(node_ptr_t x, node_ptr_t p);
+
+    // header belongs to the allocator, so it is rebuilt when
+    // an unequal allocator takes over
+    void replace_alloc(const rb_tree& x) {
+        if(!this->alloc_equal(x)) {
+            clear();
+            put_node(header);
+            this->copy_alloc(x, true_type());
+            empty_initialize();
+        } else {
+            this->copy_alloc(x, true_type());
         }
     }
 
-    node_ptr_t copy(node_ptr_t x, node_ptr_t p);
+    void copy_assign_alloc(const rb_tree& x, true_type) { replace_alloc(x); }
+
+    void copy_assign_alloc(const rb_tree&, false_type) {}
+
+    void move_assign(rb_tree& x, true_type) {
+        clear();
+        replace_alloc(x);
+        MiniSTL::swap(header, x.header);
+        MiniSTL::swap(node_count, x.node_count);
+    }
+
+    // nodes can only be taken from an equal allocator,
+    // otherwise elements are copied into our own nodes
+    void move_assign(rb_tree& x, false_type) {
+        if(this->alloc_equal(x)) {
+            clear();
+            MiniSTL::swap(header, x.header);
+            MiniSTL::swap(node_count, x.node_count);
+        } else {
+            *this = x;
+            x.clear();
+        }
+    }
 
 public:
     //  ctor/dtor/assign
     rb_tree() : node_count(0), key_comp() { empty_initialize(); }
-    rb_tree(const Compare& c) : node_count(0), key_comp(c)
-        { empty_initialize(); }
+    explicit rb_tree(const Compare& c, const allocator_type& a = allocator_type())
+        : base(a), node_count(0), key_comp(c) { empty_initialize(); }
     
-    rb_tree(const rb_tree& x) : node_count(0), key_comp(x.key_comp) {
+    rb_tree(const rb_tree& x) 
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
         if(x.root() == nullptr)
             empty_initialize();
         else {
             header = get_node();
-            header->color = rb_tree_red;
-            root() = copy(x.root(), header);
+            header->set_parent_color(nullptr, rb_tree_red);
+            set_root(copy(x.root(), header));
             leftmost() = node_t::minimum(root());
             rightmost() = node_t::maximum(root());
         }
         node_count = x.node_count;
     }
 
+    // x keeps an empty tree, so it can still be used or destroyed
     rb_tree(rb_tree&& x) 
-        : header(x.header), node_count(x.node_count), key_comp(x.key_comp) {
-        x.node_count = 0;
-        x.header = nullptr;
+        : base(x.get_allocator()), node_count(0), key_comp(x.key_comp) {
+        empty_initialize();
+        MiniSTL::swap(header, x.header);
+        MiniSTL::swap(node_count, x.node_count);
     }
 
     ~rb_tree() {
@@ -292,8 +375,15 @@ public:
         put_node(header);
     }
 
-    rb_tree& operator==(const rb_tree& x);
-    rb_tree& operator==(rb_tree&& x);
+    rb_tree& operator=(const rb_tree& x);
+
+    rb_tree& operator=(rb_tree&& x) {
+        if(&x != this) {
+            key_comp = x.key_comp;
+            move_assign(x, typename base::propagate_on_move());
+        }
+        return *this;
+    }
 
 public:
     // element access
@@ -311,8 +401,8 @@ public:
     const_reverse_iterator  rend() const noexcept
         { return const_reverse_iterator(begin()); }
  
-    const_iterator          cbegin() noexcept { return leftmost(); }
-    const_iterator          cend() noexcept { return header(); }
+    const_iterator          cbegin() const noexcept { return leftmost(); }
+    const_iterator          cend() const noexcept { return header; }
     const_reverse_iterator  crbegin() const noexcept
         { return const_reverse_iterator(end()); }
     const_reverse_iterator  crend() const noexcept
@@ -328,18 +418,27 @@ public:
 public:
     //swap
     void swap(rb_tree& y) {
-        swap(header, y.header);
-        swap(node_count, y.node_count);
-        swap(key_comp, y.key_comp);
+        this->swap_alloc(y, typename base::propagate_on_swap());
+        MiniSTL::swap(header, y.header);
+        MiniSTL::swap(node_count, y.node_count);
+        MiniSTL::swap(key_comp, y.key_comp);
+    }
+
+    void clear() {
+        if(node_count != 0) {
+            erase(root());
+            set_root(nullptr);
+            leftmost() = header;
+            rightmost() = header;
+            node_count = 0;
+        }
     }
 
 private:
-    void rb_tree_rotate_left(node_ptr_t x, node_ptr_t& root);
-	void rb_tree_rotate_right(node_ptr_t x, node_ptr_t& root);
-	void rb_tree_rebalance(node_ptr_t x, node_ptr_t& root);
-	node_ptr_t 
-    rb_tree_rebalance_for_erase(node_ptr_t z, node_ptr_t& root, 
-                node_ptr_t& leftmost, node_ptr_t& rightmost);
+    void rb_tree_rotate_left(node_ptr_t x);
+	void rb_tree_rotate_right(node_ptr_t x);
+	void rb_tree_rebalance(node_ptr_t x);
+	node_ptr_t rb_tree_rebalance_for_erase(node_ptr_t z);
 
     iterator insert(node_ptr_t x, node_ptr_t y, const Value& val);
     iterator insert(node_ptr_t x, node_ptr_t y, Value&& val);
@@ -351,11 +450,15 @@ public:
 
 	iterator insert_unique(iterator pos, const Value& val);
     iterator insert_unique(iterator pos, Value&& val); 
+    iterator insert_unique(const_iterator pos, const Value& val)
+        { return insert_unique(mutable_iterator(pos), val); }
+    iterator insert_unique(const_iterator pos, Value&& val)
+        { return insert_unique(mutable_iterator(pos), std::move(val)); }
 
+	// an empty tree is built in O(n) from sorted forward iterators
 	template<class InputIt>
 	void insert_unique(InputIt first, InputIt last) {
-        while(first != last)
-            insert_unique(*first++);
+        insert_range(first, last, true, iterator_category_t<InputIt>());
     }
 
     iterator insert_equal(const Value& val);
@@ -363,13 +466,48 @@ public:
 
 	iterator insert_equal(iterator pos, const Value& val);
     iterator insert_equal(iterator pos, Value&& val);
+    iterator insert_equal(const_iterator pos, const Value& val)
+        { return insert_equal(mutable_iterator(pos), val); }
+    iterator insert_equal(const_iterator pos, Value&& val)
+        { return insert_equal(mutable_iterator(pos), std::move(val)); }
 
 	template<class InputIt>
 	void insert_equal(InputIt first, InputIt last) {
-       while(first != last)
-            insert_equal(*first++);
+        insert_range(first, last, false, iterator_category_t<InputIt>());
     }
 
+private:
+    template <class InputIt>
+    void insert_range(InputIt first, InputIt last, bool unique, input_iterator_tag) {
+        for(;first != last;++first) {
+            if(unique)
+                insert_unique(*first);
+            else
+                insert_equal(*first);
+        }
+    }
+
+    template <class ForwardIt>
+    void insert_range(ForwardIt first, ForwardIt last, bool unique, forward_iterator_tag) {
+        size_type n = 0;
+        if(node_count == 0 && sorted_range(first, last, unique, n))
+            build_sorted(first, n);
+        else
+            insert_range(first, last, unique, input_iterator_tag());
+    }
+
+    // whether [first, last) is sorted, strictly if unique, n is
+    // its length when it is
+    template <class ForwardIt>
+    bool sorted_range(ForwardIt first, ForwardIt last, bool unique, size_type& n) const;
+
+    // link n sorted values into an empty tree
+    template <class ForwardIt>
+    void build_sorted(ForwardIt first, size_type n);
+
+    template <class ForwardIt>
+    node_ptr_t build_subtree(ForwardIt& first, size_type n, int depth, int red_depth);
+
 private:
     // erase without rebalance
     void erase(node_ptr_t x) {
@@ -385,20 +523,16 @@ private:
 public:
     // erase
 	iterator erase(iterator pos) {
-        node_ptr_t y = rb_tree_rebalance_for_erase(pos.node,
-                                                   root(),
-                                                   leftmost(),
-                                                   rightmost());
-        iterator i(y);
-        ++i;
-        destroy_node(y);
+        iterator next = pos;
+        ++next;
+        destroy_node(rb_tree_rebalance_for_erase(pos.node));
         --node_count;
-        return i;
+        return next;
     }
 
 	size_type erase(const Key& x) {
         pair<iterator, iterator> p = equal_range(x);
-        size_type n = distance(p.first, p.second);
+        size_type n = MiniSTL::distance(p.first, p.second);
         erase(p.first, p.second);
         return n;
     }
@@ -408,139 +542,160 @@ public:
             clear();
         else {
             while(first != last)
-                erase(*first++);
+                erase(first++);
         }
+        return last;
     }
 
-public:
-    // find
-    // if x exists, return first x, else return end();
-	iterator find(const Key& k) noexcept {
+    iterator erase(const_iterator pos) { return erase(mutable_iterator(pos)); }
+    iterator erase(const_iterator first, const_iterator last)
+        { return erase(mutable_iterator(first), mutable_iterator(last)); }
+
+private:
+    // last node not less than k, header if none
+    template <class K>
+    node_ptr_t lower_bound_node(const K& k) const noexcept {
         node_ptr_t y = header;
         node_ptr_t x = root();
 
         while(x) {
-            if(key_comp(key(x), k)) // k > x
+            if(key_comp(key(x), k))
                 x = x->right;
-            else { // k <= x,set y = x,last node not less than k
+            else {
+                // if k <= x, set y is last node which y >= k
                 y = x;
                 x = x->left;
             }
         }
-
-        iterator i(y);
-        // if found, y == k, but can't use y == k, because
-        // y may be end(), that is empty tree
-        // if found, y == k and 2 cases no found:
-        //      a. empty tree
-        //      b. k < y and y is last node which k <= y
-        return (i == end() || key_comp(k, key(y))) ? end() : i;
+        // if k > max, y header, aka end()
+        return y;
     }
 
-	const_iterator find(const Key& k) const noexcept {
+    // first node greater than k, header if none
+    template <class K>
+    node_ptr_t upper_bound_node(const K& k) const noexcept {
         node_ptr_t y = header;
         node_ptr_t x = root();
 
         while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
+            if(key_comp(k, key(x))) {
+                // k < x, set y is first node which k < y
                 y = x;
                 x = x->left;
             }
+            else
+                x = x->right;
         }
 
-        const_iterator i(y);
-        return (i == end() || key_comp(k, key(y))) ? end() : i;
+        return y;
     }
 
-	size_type count(const Key& k) const noexcept {
-        pair<iterator, iterator> p = equal_range(k);
-        return distance(p.first, p.second);
+    template <class K>
+    node_ptr_t find_node(const K& k) const noexcept {
+        node_ptr_t y = lower_bound_node(k);
+        // if found, y == k, but can't use y == k, because
+        // y may be end(), that is empty tree
+        // if found, y == k and 2 cases no found:
+        //      a. empty tree
+        //      b. k < y and y is last node which k <= y
+        return (y == header || key_comp(k, key(y))) ? header : y;
     }
 
-	iterator lower_bound(const Key& k) noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
+public:
+    // find
+    // if x exists, return first x, else return end();
+	iterator find(const Key& k) noexcept { return iterator(find_node(k)); }
 
-        while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
-                // if k <= x, set y is last node which y >= k
-                y = x;
-                x = x->left;
-            }
-        }
-        // if k > max, y header, aka end()
-        return iterator(y);
+	const_iterator find(const Key& k) const noexcept {
+        return const_iterator(find_node(k));
     }
 
-	const_iterator lower_bound(const Key& k) const noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
+	size_type count(const Key& k) const noexcept {
+        pair<const_iterator, const_iterator> p = equal_range(k);
+        return MiniSTL::distance(p.first, p.second);
+    }
 
-        while(x) {
-            if(key_comp(key(x), k))
-                x = x->right;
-            else {
-                y = x;
-                x = x->left;
-            }
-        }
+	iterator lower_bound(const Key& k) noexcept {
+        return iterator(lower_bound_node(k));
+    }
 
-        return const_iterator(y);
+	const_iterator lower_bound(const Key& k) const noexcept {
+        return const_iterator(lower_bound_node(k));
     }
 
 	iterator upper_bound(const Key& k) noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(k, key(x))) {
-                // k < x, set y is first node which k < y
-                y = x;
-                x = x->left;
-            }
-            else
-                x = x->right;
-        }
-
-        return iterator(y);
+        return iterator(upper_bound_node(k));
     }
 
 	const_iterator upper_bound(const Key& k) const noexcept {
-        node_ptr_t y = header;
-        node_ptr_t x = root();
-
-        while(x) {
-            if(key_comp(k, key(x))) {
-                // k < x, set y is first node which k < y
-                y = x;
-                x = x->left;
-            }
-            else
-                x = x->right;
-        }
-
-        return const_iterator(y);
+        return const_iterator(upper_bound_node(k));
     }
 
 	pair<iterator,iterator> 
     equal_range(const Key& k) noexcept {
-        return make_pair(lower_bound(k), upper_bound(k));
+        return MiniSTL::make_pair(lower_bound(k), upper_bound(k));
     }
 
 	pair<const_iterator,const_iterator> 
     equal_range(const Key& k) const noexcept {
-        return make_pair(lower_bound(k), upper_bound(k));
+        return MiniSTL::make_pair(lower_bound(k), upper_bound(k));
+    }
+
+    // heterogeneous lookup of any k which Compare orders against Key,
+    // only if Compare declares is_transparent(e.g. less<>)
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& k) noexcept {
+        return iterator(find_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& k) const noexcept {
+        return const_iterator(find_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& k) const noexcept {
+        return MiniSTL::distance(const_iterator(lower_bound_node(k)),
+                        const_iterator(upper_bound_node(k)));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& k) noexcept {
+        return iterator(lower_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& k) const noexcept {
+        return const_iterator(lower_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& k) noexcept {
+        return iterator(upper_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& k) const noexcept {
+        return const_iterator(upper_bound_node(k));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& k) noexcept {
+        return MiniSTL::make_pair(iterator(lower_bound_node(k)), iterator(upper_bound_node(k)));
+    }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& k) const noexcept {
+        return MiniSTL::make_pair(const_iterator(lower_bound_node(k)),
+                         const_iterator(upper_bound_node(k)));
     }
 };
 
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 inline bool operator==(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& x, rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& y){
-	return x.size() == y.size() && equal(x.cbegin(), x.cend(), y.cbegin());
+	return x.size() == y.size() && MiniSTL::equal(x.cbegin(), x.cend(), y.cbegin());
 }
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -550,7 +705,7 @@ inline bool operator!=(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& x,
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 inline bool operator<(const rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& x, rb_tree<Key, Value, KeyOfValue, Compare, Alloc>& y){
-	return std::lexicographical_compare(x.cbegin(), x.cend(),                                        y.cbegin(), y.cend());
+	return MiniSTL::lexicographical_compare(x.cbegin(), x.cend(), y.cbegin(), y.cend());
 }
 
 template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -577,18 +732,19 @@ template<class Key, class Value, class KeyOfValue,
          class Compare, class Alloc>
 rb_tree<Key, Value, KeyOfValue, Compare, Alloc>&
 rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-operator==(const rb_tree& x) {
+operator=(const rb_tree& x) {
     if(&x != this) {
         clear();
+        copy_assign_alloc(x, typename base::propagate_on_copy());
         node_count = 0;
         key_comp = x.key_comp;
         if(x.root()) {
-            root() = copy(x.root(), header);
+            set_root(copy(x.root(), header));
             leftmost() = node_t::minimum(root());
             rightmost() = node_t::maximum(root());
             node_count = x.node_count;
         } else {
-            root() = nullptr;
+            set_root(nullptr);
             leftmost() = header;
             rightmost() = header;
         }
@@ -596,36 +752,13 @@ operator==(const rb_tree& x) {
     return *this;
 }
 
-template<class Key, class Value, class KeyOfValue, 
-         class Compare, class Alloc>
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>&
-rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-operator==(rb_tree&& x) {
-    if(&x != this) {
-        clear();
-        node_count = 0;
-        key_comp = x.key_comp;
-        if(x.root()) {
-            header = x.header;
-            node_count = x.node_count;
-        } else {
-            root() = nullptr;
-            leftmost() = header;
-            rightmost() = header;
-        }
-        x.node_count = 0;
-        x.header = nullptr;
-    }
-    return *this;
-}
-
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
 typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
 rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
 copy(node_ptr_t x, node_ptr_t p) {
     node_ptr_t top = clone_node(x);
-    top->parent = p;
+    top->set_parent(p);
 
     try {
         // copy right child recursively
@@ -639,7 +772,7 @@ copy(node_ptr_t x, node_ptr_t p) {
         while(x) {
             node_ptr_t y = clone_node(x);
             p->left = y;
-            y->parent = p;
+            y->set_parent(p);
             if(x->right)
                 y->right = copy(x->right, y);
             p = y;
@@ -656,101 +789,178 @@ copy(node_ptr_t x, node_ptr_t p) {
 
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
-void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>:: rb_tree_rotate_left(node_ptr_t x, node_ptr_t& root) {
+template <class ForwardIt>
+bool rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+sorted_range(ForwardIt first, ForwardIt last, bool unique, size_type& n) const {
+    n = 0;
+    if(first == last)
+        return true;
+    ForwardIt prev = first;
+    for(++first, n = 1;first != last;++first, ++prev, ++n) {
+        if(unique ? !key_comp(KeyOfValue()(*prev), KeyOfValue()(*first))
+                  : key_comp(KeyOfValue()(*first), KeyOfValue()(*prev)))
+            return false;
+    }
+    return true;
+}
+
+// the middle value is the root, the halves are built the same way, so
+// the depths of the leaves differ by at most one. Levels above the
+// deepest one are full and black, nodes on the deepest level are red:
+// every path has the same black height and red nodes are leaves
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+template <class ForwardIt>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+build_sorted(ForwardIt first, size_type n) {
+    if(n == 0)
+        return;
+    // levels 0 .. red_depth - 1 are full
+    int red_depth = 0;
+    while((static_cast<size_type>(2) << red_depth) <= n + 1)
+        ++red_depth;
+    set_root(build_subtree(first, n, 0, red_depth));
+    root()->set_parent(header);
+    leftmost() = node_t::minimum(root());
+    rightmost() = node_t::maximum(root());
+    node_count = n;
+}
+
+// nodes are created in order, first is advanced past the subtree
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+template <class ForwardIt>
+typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
+rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
+build_subtree(ForwardIt& first, size_type n, int depth, int red_depth) {
+    if(n == 0)
+        return nullptr;
+    node_ptr_t l = build_subtree(first, (n - 1) / 2, depth + 1, red_depth);
+    node_ptr_t x = nullptr;
+    try {
+        x = create_node(*first);
+    } catch(std::exception&) {
+        erase(l);
+        throw;
+    }
+    ++first;
+    x->set_parent_color(nullptr, depth == red_depth ? rb_tree_red : rb_tree_black);
+    x->left = l;
+    x->right = nullptr;
+    if(l)
+        l->set_parent(x);
+
+    try {
+        x->right = build_subtree(first, n - 1 - (n - 1) / 2, depth + 1, red_depth);
+    } catch(std::exception&) {
+        erase(x);
+        throw;
+    }
+    if(x->right)
+        x->right->set_parent(x);
+    return x;
+}
+
+template<class Key, class Value, class KeyOfValue, 
+         class Compare, class Alloc>
+void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::rb_tree_rotate_left(node_ptr_t x) {
     node_ptr_t y = x->right;
     x->right = y->left;
     if(y->left)
-        y->left->parent = x;
-    y->parent = x->parent;
+        y->left->set_parent(x);
+    y->set_parent(x->get_parent());
 
-    if(x == root)
-        root = y;
-    else if(x == x->parent->left)
-        x->parent->left = y;
+    if(x == root())
+        set_root(y);
+    else if(x == x->get_parent()->left)
+        x->get_parent()->left = y;
     else
-        x->parent->right = y;
+        x->get_parent()->right = y;
     y->left = x;
-    x->parent = y;
+    x->set_parent(y);
 }
 
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
 void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-rb_tree_rotate_right(node_ptr_t x, node_ptr_t& root) {
+rb_tree_rotate_right(node_ptr_t x) {
     node_ptr_t y = x->left;
     x->left = y->right;
     if(y->right)
-        y->right->parent = x;
-    y->parent = x->parent;
+        y->right->set_parent(x);
+    y->set_parent(x->get_parent());
 
-    if(x == root)
-        root = y;
-    else if(x == x->parent->left)
-        x->parent->left = y;
+    if(x == root())
+        set_root(y);
+    else if(x == x->get_parent()->left)
+        x->get_parent()->left = y;
     else
-        x->parent->right = y;
+        x->get_parent()->right = y;
     y->right = x;
-    x->parent = y;
+    x->set_parent(y);
 }
 
 // rebalance until root tree obey invariants
 template<class Key, class Value, class KeyOfValue, 
          class Compare, class Alloc>
 void rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-rb_tree_rebalance(node_ptr_t x, node_ptr_t& root) {
-    x->color = rb_tree_red;
-    while(x != root && x->parent->color == rb_tree_red) {
-        if(x->parent == x->parent->parent->left) {
+rb_tree_rebalance(node_ptr_t x) {
+    while(x != root() && x->get_parent()->get_color() == rb_tree_red) {
+        node_ptr_t p = x->get_parent();
+        node_ptr_t g = p->get_parent();
+        if(p == g->left) {
             // father is grandfather's left
-            node_ptr_t y = x->parent->parent->right;
-            if(y && y->color == rb_tree_red) {
+            node_ptr_t y = g->right;
+            if(y && y->get_color() == rb_tree_red) {
                 // case1 : uncle is red
                 // set father and uncle black, set grandfather red
                 // change x to grandparent for further adjust
                 // prevent the case: after adjust, grantparent
                 // and grantgrantparent are both red, the we
                 // must adjust upward
-                x->parent->color = rb_tree_black;
-                y->color = rb_tree_black;
-                x->parent->parent->color = rb_tree_red;
-                x = x->parent->parent;
+                p->set_color(rb_tree_black);
+                y->set_color(rb_tree_black);
+                g->set_color(rb_tree_red);
+                x = g;
             } else {
                 // case 2 : uncle is black or null
-                if(x == x->parent->right) {
+                if(x == p->right) {
                     // case 2.1: insert pos is inside
                     // first rorate left, turn to case2.2
-                    x = x->parent;
-                    rb_tree_rotate_left(x, root);
+                    x = p;
+                    rb_tree_rotate_left(x);
+                    p = x->get_parent();
                 } 
                 // case 2.2: insert pos is outside
                 // set father black, set grandfather red;
                 // then rotate right
-                x->parent->color = rb_tree_black;
-                x->parent->parent->color = rb_tree_red;
-                rb_tree_rotate_right(x->parent->parent, root);
+                p->set_color(rb_tree_black);
+                g->set_color(rb_tree_red);
+                rb_tree_rotate_right(g);
             }
         } else {
             // father is grandfather's right
-            node_ptr_t y = x->parent->parent->left;
-            if(y && y->color == rb_tree_red) {
+            node_ptr_t y = g->left;
+            if(y && y->get_color() == rb_tree_red) {
                 // symmetrical case1:
-                x->parent->color = rb_tree_black;
-                y->color = rb_tree_black;
-                x->parent->parent->color = rb_tree_red;
-                x = x->parent->parent;
+                p->set_color(rb_tree_black);
+                y->set_color(rb_tree_black);
+                g->set_color(rb_tree_red);
+                x = g;
             } else{
                 // symmetrical case2:
-                if(x == x->parent->left) {
-                    x = x->parent;
-                    rb_tree_rotate_right(x, root);
+                if(x == p->left) {
+                    x = p;
+                    rb_tree_rotate_right(x);
+                    p = x->get_parent();
                 }
-                x->parent->color = rb_tree_black;
-                x->parent->parent->color = rb_tree_red;
-                rb_tree_rotate_left(x->parent->parent, root);
+                p->set_color(rb_tree_black);
+                g->set_color(rb_tree_red);
+                rb_tree_rotate_left(g);
             }
         }
     }
-    root->color = rb_tree_black;
+    root()->set_color(rb_tree_black);
 }
 
 
@@ -758,8 +968,7 @@ template<class Key, class Value, class KeyOfValue,
          class Compare, class Alloc>
 typename rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::node_ptr_t
 rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
-rb_tree_rebalance_for_erase(node_ptr_t z, node_ptr_t& root, 
-                node_ptr_t& leftmost, node_ptr_t& rightmost) {
+rb_tree_rebalance_for_erase(node_ptr_t z) {
     node_ptr_t y = z;
     node_ptr_t x = nullptr; // x one of y's child, may be null
     node_ptr_t x_parent = nullptr; 
@@ -776,126 +985,130 @@ rb_tree_rebalance_for_erase(node_ptr_t z, node_ptr_t& root,
         x = y->right; // x may be null
     
     if(y != z) { // z has successor y, relink y in place of z
-        z->left->parent = y;
+        z->left->set_parent(y);
         y->left = z->left;
         if(y == z->right)
             x_parent = y;
         else { // y is not right of z directly
-            x_parent = y->parent; 
+            x_parent = y->get_parent(); 
             if(x)
-                x->parent = y->parent; // set x's parent = y's parent
-            x->parent->left = x; // y is y's parent 's left
+                x->set_parent(x_parent); // set x's parent = y's parent
+            x_parent->left = x; // y is y's parent 's left
             y->right = z->right;
-            z->right->parent = y;
+            z->right->set_parent(y);
         }
 
         // revise parent
-        if(root == z)
-            root = y;
-        else if(z->parent->left == z)
-            z->parent->left = y;
+        if(root() == z)
+            set_root(y);
+        else if(z->get_parent()->left == z)
+            z->get_parent()->left = y;
         else
-            z->parent->right = y;
+            z->get_parent()->right = y;
 
-        y->parent = z->parent;
-        swap(y->color, z->color);
+        y->set_parent(z->get_parent());
+        color_t c = y->get_color();
+        y->set_color(z->get_color());
+        z->set_color(c);
         y = z; // y now points to node to be actually deleted
     } else { // y == z, z has no successor
-        x_parent = y->parent;
+        x_parent = y->get_parent();
         if(x)
-            x->parent = y->parent;
+            x->set_parent(x_parent);
         
-        if(root == z)
-            root = x; // set root be x, one of child of z
-        else if(z->parent->left == z)
-            z->parent->left = x;
+        if(root() == z)
+            set_root(x); // set root be x, one of child of z
+        else if(z->get_parent()->left == z)
+            z->get_parent()->left = x;
         else 
-            z->parent->right = x;
+            z->get_parent()->right = x;
 
-        if(leftmost == z) {
+        if(leftmost() == z) {
             if(z->right) // x is z's right, set leftmost min(x)
-                leftmost = node_t::minimum(x);
+                leftmost() = node_t::minimum(x);
             else   // z has no child
-                leftmost = z->parent; // set leftmost z->parent
+                leftmost() = z->get_parent(); // set leftmost z->parent
         }
-        if(rightmost == z) {
+        if(rightmost() == z) {
             if(z->left)
-                rightmost = node_t::maximum(x);
+                rightmost() = node_t::maximum(x);
             else
-                rightmost = z->parent;
+                rightmost() = z->get_parent();
         }
     }
 
     // now y has replaced z, x has replaced previous y
     // we must adjust x and x's parent
-    if(y->color != rb_tree_red) {
-        while(x != root && (x == nullptr || x->color == rb_tree_black)) {
+    if(y->get_color() != rb_tree_red) {
+        while(x != root() && (x == nullptr || x->get_color() == rb_tree_black)) {
             if(x == x_parent->left) {
                 node_ptr_t w = x_parent->right;
-                if(w->color == rb_tree_red) {
-                    w->color = rb_tree_black;
-                    x_parent->color = rb_tree_red;
-                    rb_tree_rotate_left(x_parent, root);
-                    w = x->parent->right;
+                if(w->get_color() == rb_tree_red) {
+                    w->set_color(rb_tree_black);
+                    x_parent->set_color(rb_tree_red);
+                    rb_tree_rotate_left(x_parent);
+                    w = x_parent->right;
                 }
 
                 if((w->left == nullptr || 
-                    w->left->color == rb_tree_black) && 
+                    w->left->get_color() == rb_tree_black) && 
                    (w->right == nullptr || 
-                    w->right->color == rb_tree_black)) {
-                    w->color = rb_tree_red;
+                    w->right->get_color() == rb_tree_black)) {
+                    w->set_color(rb_tree_red);
                     x = x_parent;
-                    x_parent = x_parent->parent;    
+                    x_parent = x_parent->get_parent();    
                 } else {
                     if(w->right == nullptr ||
-                       w->right->color == rb_tree_black) {
-                        w->color = rb_tree_red;
-                        rb_tree_rotate_right(w, root);
+                       w->right->get_color() == rb_tree_black) {
+                        if(w->left)
+                            w->left->set_color(rb_tree_black);
+                        w->set_color(rb_tree_red);
+                        rb_tree_rotate_right(w);
                         w = x_parent->right;
                     }
-                    w->color = x_parent->color;
-                    x_parent->color = rb_tree_black;
+                    w->set_color(x_parent->get_color());
+                    x_parent->set_color(rb_tree_black);
                     if(w->right)
-                        w->right->color = rb_tree_black;
-                        rb_tree_rotate_left(x_parent, root);
+                        w->right->set_color(rb_tree_black);
+                    rb_tree_rotate_left(x_parent);
                     break;
                 }
             } else { // x = x_parent's right
                 node_ptr_t w = x_parent->left;
-                if (w->color == rb_tree_red) {
-                    w->color = rb_tree_black;
-                    x_parent->color = rb_tree_red;
-                    rb_tree_rotate_right(x_parent,root);
+                if (w->get_color() == rb_tree_red) {
+                    w->set_color(rb_tree_black);
+                    x_parent->set_color(rb_tree_red);
+                    rb_tree_rotate_right(x_parent);
                     w = x_parent->left;
                 }
 
                 if ((w->right == 0 || 
-                     w->right->color == rb_tree_black) &&
+                     w->right->get_color() == rb_tree_black) &&
                     (w->left == 0 || 
-                     w->left->color == rb_tree_black)) {
-                    w->color = rb_tree_red;
+                     w->left->get_color() == rb_tree_black)) {
+                    w->set_color(rb_tree_red);
                     x = x_parent;
-                    x_parent = x_parent->parent;
+                    x_parent = x_parent->get_parent();
                 } else {
                     if (w->left == 0 || 
-                        w->left->color == rb_tree_black) {
+                        w->left->get_color() == rb_tree_black) {
                         if (w->right)
-                            w->right->color = rb_tree_black;
-                        w->color = rb_tree_red;
-                        rb_tree_rotate_left(w, root);
+                            w->right->set_color(rb_tree_black);
+                        w->set_color(rb_tree_red);
+                        rb_tree_rotate_left(w);
                         w = x_parent->left;
                     }
-                    w->color = x_parent->color;
-                    x_parent->color = rb_tree_black;
+                    w->set_color(x_parent->get_color());
+                    x_parent->set_color(rb_tree_black);
                     if (w->left) 
-                        w->left->color = rb_tree_black;
-                    rb_tree_rotate_right(x_parent, root);
+                        w->left->set_color(rb_tree_black);
+                    rb_tree_rotate_right(x_parent);
                     break;
                 } 
             }
-            if(x)
-                x->color = rb_tree_black;
         }
+        if(x)
+            x->set_color(rb_tree_black);
     }
     return y;
 }
@@ -912,7 +1125,7 @@ insert(node_ptr_t x, node_ptr_t y, const Value& val) {
         y->left = z; // if y = header, set leftmost = z;
 
         if(y == header) {
-            root() = z;
+            set_root(z);
             rightmost() = z;
         } else if(y == leftmost()) 
             leftmost() = z;
@@ -921,10 +1134,10 @@ insert(node_ptr_t x, node_ptr_t y, const Value& val) {
         if(y == rightmost())
             rightmost() = z;
     }
-    z->parent = y;
+    z->set_parent_color(y, rb_tree_red);
     z->left = nullptr;
     z->right = nullptr;
-    rb_tree_rebalance(z, root());
+    rb_tree_rebalance(z);
     ++node_count;
     return iterator(z);
 }
@@ -940,7 +1153,7 @@ insert(node_ptr_t x, node_ptr_t y, Value&& val) {
         y->left = z;
 
         if(y == header) {
-            root() = z;
+            set_root(z);
             rightmost() = z;
         } else if(y == leftmost()) 
             leftmost() = z;
@@ -949,10 +1162,10 @@ insert(node_ptr_t x, node_ptr_t y, Value&& val) {
         if(y == rightmost())
             rightmost() = z;
     }
-    z->parent = y;
+    z->set_parent_color(y, rb_tree_red);
     z->left = nullptr;
     z->right = nullptr;
-    rb_tree_rebalance(z, root());
+    rb_tree_rebalance(z);
     ++node_count;
     return iterator(z);
 }
@@ -977,16 +1190,16 @@ insert_unique(const Value& val) {
     if(comp) { // val < y, new node will at left tree
         if(i == begin()) 
         // case1: y is leftmost, insert new leftmost
-            return make_pair(insert(x, y, val), true);
+            return MiniSTL::make_pair(insert(x, y, val), true);
         else
             --i; // check the prev
     }
     // case2: val >= y and y < val, not equal
     // case3: prev(y) < val < y , not equal
     if(key_comp(key(i.node), KeyOfValue()(val)))
-        return make_pair(insert(x, y, val), true);
+        return MiniSTL::make_pair(insert(x, y, val), true);
     // get there, val equals to y or --y;
-    return make_pair(i, false);
+    return MiniSTL::make_pair(i, false);
 }
 
 template <class Key, class Value, class KeyOfValue, 
@@ -1006,13 +1219,13 @@ rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(Value&& val) {
     iterator i(y);
     if(comp) {
         if(i == begin())
-            return make_pair(insert(x, y, std::move(val)), true);
+            return MiniSTL::make_pair(insert(x, y, std::move(val)), true);
         else
             --i;
     }
     if(key_comp(key(i.node), KeyOfValue()(val)))
-        return make_pair(insert(x, y, std::move(val)), true);
-    return make_pair(i, false);
+        return MiniSTL::make_pair(insert(x, y, std::move(val)), true);
+    return MiniSTL::make_pair(i, false);
 }
 
 // inserts value in the pos as close as possible, 
@@ -1029,12 +1242,12 @@ insert_unique(iterator pos, const Value& val) {
            // header's key has no meaning
            return insert(pos.node, pos.node, val);
         else
-            insert_unique(val).first;
+            return insert_unique(val).first;
     } else if(pos.node == header) { // case2: pos = end()
         if(key_comp(key(rightmost()), KeyOfValue()(val)))
             return insert(nullptr, rightmost(), val);
         else
-            insert_unique(val).first;
+            return insert_unique(val).first;
     } else {
         iterator prev = pos;
         --prev;
@@ -1060,12 +1273,12 @@ insert_unique(iterator pos, Value&& val) {
            key_comp(KeyOfValue()(val), key(pos.node)))
            return insert(pos.node, pos.node, std::move(val));
         else
-            insert_unique(std::move(val)).first;
+            return insert_unique(std::move(val)).first;
     } else if(pos.node == header) {
         if(key_comp(key(rightmost()), KeyOfValue()(val)))
             return insert(nullptr, rightmost(), std::move(val));
         else
-            insert_unique(std::move(val)).first;
+            return insert_unique(std::move(val)).first;
     } else {
         iterator prev = pos;
         --prev;
@@ -1119,19 +1332,19 @@ rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
 insert_equal(iterator pos, const Value& val) {
     if(pos.node == leftmost()) { // case1: pos = begin()
         if(size() > 0 && 
-           !key_comp(key(pos.node)), KeyOfValue()(val))
+           !key_comp(key(pos.node), KeyOfValue()(val)))
            // case: pos >= val
            // need size() > 0 because pos may be header
            // header's key has no meaning
            return insert(pos.node, pos.node, val);
         else
-            insert_equal(val);
+            return insert_equal(val);
     } else if(pos.node == header) { // case2: pos = end()
-        if(!key_comp(KeyOfValue()(val)), key(rightmost()))
+        if(!key_comp(KeyOfValue()(val), key(rightmost())))
             // case: val >= rightmost
             return insert(nullptr, rightmost(), val);
         else
-            insert_equal(val);
+            return insert_equal(val);
     } else {
         iterator prev = pos;
         --prev;
@@ -1143,7 +1356,7 @@ insert_equal(iterator pos, const Value& val) {
             else
                 return insert(nullptr, prev.node, val);
         } else
-            return insert_equal(val).first;
+            return insert_equal(val);
     }
 }
 
@@ -1154,15 +1367,15 @@ rb_tree<Key, Value, KeyOfValue, Compare, Alloc>::
 insert_equal(iterator pos, Value&& val) {
     if(pos.node == leftmost()) {
         if(size() > 0 && 
-           !key_comp(key(pos.node)), KeyOfValue()(val))
+           !key_comp(key(pos.node), KeyOfValue()(val)))
            return insert(pos.node, pos.node, std::move(val));
         else
-            insert_equal(std::move(val));
+            return insert_equal(std::move(val));
     } else if(pos.node == header) {
-        if(!key_comp(KeyOfValue()(val)), key(rightmost()))
+        if(!key_comp(KeyOfValue()(val), key(rightmost())))
             return insert(nullptr, rightmost(), std::move(val));
         else
-            insert_equal(std::move(val));
+            return insert_equal(std::move(val));
     } else {
         iterator prev = pos;
         --prev;
@@ -1173,7 +1386,7 @@ insert_equal(iterator pos, Value&& val) {
             else
                 return insert(nullptr, prev.node, std::move(val));
         } else
-            return insert_equal(std::move(val)).first;
+            return insert_equal(std::move(val));
     }
 }
 
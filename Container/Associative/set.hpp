@@ -39,29 +39,33 @@ public:
 
 public:
     // construct/copy/destroy:
-    explicit set(const Compare& comp = Compare()) : impl(comp) {}
+    explicit set(const Compare& comp = Compare(),
+                 const allocator_type& a = allocator_type())
+        : impl(comp, a) {}
 
     template <class InputIt>
-    set(InputIt first, InputIt last, const Compare& comp = Compare()) 
-        : impl(comp) { impl.insert_unique(first, last); }
+    set(InputIt first, InputIt last, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(first, last); }
     
     set(const set& x) : impl(x.impl) {}
-    set(set&& x) : impl(std::move(impl)) {}
-    set(std::initializer_list<value_type> ilist, const Compare& comp = Compare())
-        : impl(comp) { impl.insert_unique(ilist.begin(), ilist.end()); }
+    set(set&& x) : impl(std::move(x.impl)) {}
+    set(std::initializer_list<value_type> ilist, const Compare& comp = Compare(),
+        const allocator_type& a = allocator_type())
+        : impl(comp, a) { impl.insert_unique(ilist.begin(), ilist.end()); }
     
     ~set() {}
     
     // assign
     set& operator=(const set& x) { impl = x.impl; return *this; }
-    set& operator=(set&& x) { impl = std::move(impl); return *this; }
+    set& operator=(set&& x) { impl = std::move(x.impl); return *this; }
     set& operator=(std::initializer_list<value_type> ilist) {
         impl.clear();
         impl.insert_unique(ilist.begin(), ilist.end());
         return *this;
     }
 
-    allocator_type get_allocator() const noexcept { return allocator_type(); }
+    allocator_type get_allocator() const noexcept { return impl.get_allocator(); }
  
     // iterators:
     iterator        begin() noexcept { return impl.begin(); }
@@ -145,6 +149,38 @@ public:
     pair<const_iterator, const_iterator> 
     equal_range(const key_type& x) const 
         { return impl.equal_range(x); }
+
+    // heterogeneous lookup, only if Compare declares is_transparent
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> find(const K& x) { return impl.find(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> find(const K& x) const
+        { return impl.find(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, size_type> count(const K& x) const
+        { return impl.count(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> lower_bound(const K& x)
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> lower_bound(const K& x) const
+        { return impl.lower_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, iterator> upper_bound(const K& x)
+        { return impl.upper_bound(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, const_iterator> upper_bound(const K& x) const
+        { return impl.upper_bound(x); }
+
+    template <class K, class C = Compare>
+    transparent_t<C, pair<iterator, iterator>> equal_range(const K& x)
+        { return impl.equal_range(x); }
+    template <class K, class C = Compare>
+    transparent_t<C, pair<const_iterator, const_iterator>>
+    equal_range(const K& x) const
+        { return impl.equal_range(x); }
 };
 
 template <class Key, class Compare, class Alloc>
@@ -174,7 +210,7 @@ bool operator<=(const set<Key,Compare,Alloc>& x, const set<Key,Compare,Alloc>& y
 
 template <class Key, class Compare, class Alloc>
 void swap(set<Key,Compare,Alloc>& x, set<Key,Compare,Alloc>& y) {
-    x.impl(y.impl);
+    x.swap(y);
 }
 
 
@@ -0,0 +1,83 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+#include "Container/Associative/concurrent_hash_map.hpp"
+
+/*  build: g++ -std=c++11 -O2 -pthread -I. Container/Associative/test_concurrent_spread.cpp
+ *  run:   ./a.out, exits with 1 if a check fails
+ *
+ *  bucket spread of concurrent_hash_map under each bucket policy, for
+ *  sequential, strided and random keys. The bits which pick a segment
+ *  must not be the ones the policy picks a bucket with, or the keys of a
+ *  segment crowd into a few of its buckets. Checks that at least 80% of
+ *  the buckets expected for uniform hashing are used, and no chain is
+ *  longer than 12.
+ */
+
+using namespace MiniSTL;
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if(!ok) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+const size_t KEYS = 20000;
+
+// splitmix64
+uint64_t random_key(uint64_t i) {
+    uint64_t z = (i + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+template <class Policy>
+void test_spread(const char* policy, const char* keys, uint64_t (*key)(uint64_t)) {
+    concurrent_hash_map<unsigned long, int, hash<unsigned long>,
+                        equal_to<unsigned long>,
+                        simple_alloc<pair<const unsigned long, int>, thread_alloc>,
+                        Policy> m;
+    for(size_t i = 0;i < KEYS;++i)
+        m.insert(static_cast<unsigned long>(key(i)), static_cast<int>(i));
+
+    const size_t n = m.bucket_count();
+    size_t used = 0, longest = 0;
+    for(size_t b = 0;b < n;++b) {
+        const size_t len = m.elems_in_bucket(b);
+        used += len != 0;
+        longest = len > longest ? len : longest;
+    }
+    const double expected = n * (1.0 - std::exp(-static_cast<double>(KEYS) / n));
+    printf("%-10s %-10s %6zu of %6zu buckets used(%6.0f expected), longest chain %zu\n",
+           policy, keys, used, n, expected, longest);
+    check(m.size() == KEYS, "all keys inserted");
+    check(used >= 0.8 * expected, "buckets used");
+    check(longest <= 12, "longest chain");
+    int v = -1;
+    check(m.find(static_cast<unsigned long>(key(KEYS / 2)), v) && v == KEYS / 2,
+          "key found");
+}
+
+uint64_t sequential_key(uint64_t i) { return i; }
+uint64_t strided_key(uint64_t i) { return i << 12; }
+
+template <class Policy>
+void test_policy(const char* policy) {
+    test_spread<Policy>(policy, "sequential", sequential_key);
+    test_spread<Policy>(policy, "strided", strided_key);
+    test_spread<Policy>(policy, "random", random_key);
+}
+
+int main() {
+    test_policy<prime_bucket_policy>("prime");
+    test_policy<pow2_bucket_policy>("pow2");
+    test_policy<fastrange_bucket_policy>("fastrange");
+    if(failures == 0)
+        printf("ok\n");
+    return failures != 0;
+}
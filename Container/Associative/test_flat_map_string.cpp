@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <algorithm>
+#include <string>
+
+#include "Container/Associative/flat_map.hpp"
+#include "Container/Associative/flat_set.hpp"
+
+/*  build: g++ -std=c++17 -O2 -I. Container/Associative/test_flat_map_string.cpp
+ *  run:   ./a.out, exits with 1 if a check fails
+ *
+ *  range insert into flat_map and flat_set with std::string values.
+ *  The range is sorted and merged by MiniSTL::sort, stable_sort,
+ *  inplace_merge and unique; with <algorithm> included and under
+ *  C++17 an unqualified call in them is ambiguous with std:: and the
+ *  test does not compile.
+ */
+
+using namespace MiniSTL;
+
+using map_t = flat_map<std::string, std::string>;
+using set_t = flat_set<std::string>;
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if(!ok) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// zero padded, so the strings sort as the numbers do
+std::string key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "k%06d", i);
+    return buf;
+}
+
+// m maps key(i) to key(value(i)) for i in [0, n), in order
+template <class Value>
+bool holds(const map_t& m, int n, Value value) {
+    if(m.size() != static_cast<size_t>(n))
+        return false;
+    int i = 0;
+    for(map_t::const_iterator it = m.begin();it != m.end();++it, ++i) {
+        if(it->first != key(i) || it->second != key(value(i)))
+            return false;
+    }
+    return true;
+}
+
+void test_map() {
+    const int n = 1000;
+    pair<std::string, std::string> v[n];
+    // every key once, out of order
+    for(int i = 0;i < n;++i) {
+        int k = (i * 7919) % n;
+        v[i] = pair<std::string, std::string>(key(k), key(k));
+    }
+    map_t m;
+    m.insert(v, v + n / 2);
+    check(m.size() == n / 2, "range insert into an empty map");
+    m.insert(v + n / 2, v + n);
+    check(holds(m, n, [](int i) { return i; }), "range insert into a map");
+
+    // keys already in are kept with their old value
+    for(int i = 0;i < n;++i)
+        v[i].second = key(-1);
+    m.insert(v, v + n);
+    check(holds(m, n, [](int i) { return i; }), "range insert keeps the old values");
+
+    // of equivalent keys in the range the first is kept
+    map_t d;
+    for(int i = 0;i < n;++i)
+        v[i] = pair<std::string, std::string>(key(i / 4), key(i));
+    d.insert(v, v + n);
+    check(holds(d, n / 4, [](int i) { return 4 * i; }),
+          "range insert keeps the first of equal keys");
+
+    map_t c(v, v + n);
+    check(c.size() == n / 4 && c.find(key(3))->second == key(12),
+          "range constructor");
+}
+
+void test_set() {
+    const int n = 500;
+    std::string v[n];
+    for(int i = 0;i < n;++i)
+        v[i] = key((i * 131) % (n / 2));
+    set_t s;
+    s.insert(v, v + n);
+    check(s.size() == n / 2, "set range insert drops duplicates");
+    int i = 0;
+    bool sorted = true;
+    for(set_t::const_iterator it = s.begin();it != s.end();++it, ++i)
+        sorted = sorted && *it == key(i);
+    check(sorted, "set range insert sorts");
+    check(s.count(key(7)) == 1 && s.find(key(n)) == s.end(), "set lookup");
+}
+
+int main() {
+    test_map();
+    test_set();
+    if(failures == 0)
+        printf("ok\n");
+    return failures != 0;
+}
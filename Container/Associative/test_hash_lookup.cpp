@@ -0,0 +1,99 @@
+#include <cstdio>
+#include <string>
+
+#include "Container/Associative/hash_map.hpp"
+#include "Container/Associative/hash_multimap.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/test_hash_lookup.cpp
+ *  run:   ./a.out, exits with 1 if a check fails
+ *
+ *  heterogeneous lookup of std::string keys by const char* through
+ *  string_hash and equal_to<>, in hash_map and hash_multimap, with hash
+ *  codes cached in the nodes(string_hash) and without(plain_string_hash).
+ */
+
+using namespace MiniSTL;
+
+// string_hash without the hash code cache
+struct plain_string_hash : string_hash {};
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if(!ok) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+const char* const words[] = {
+    "", "a", "ab", "abc", "hash", "lookup", "transparent",
+    "a key longer than sixteen bytes", "another key longer than sixteen bytes",
+};
+const int n_words = sizeof(words) / sizeof(words[0]);
+
+template <class Hash>
+void test_map(const char* what) {
+    using map_t = hash_map<std::string, int, Hash, equal_to<>>;
+    map_t m;
+    for(int i = 0;i < n_words;++i)
+        m[words[i]] = i;
+    // grows the table, hash codes come from the cache or the hasher
+    for(int i = 0;i < 500;++i)
+        m[std::to_string(i)] = n_words + i;
+
+    const map_t& cm = m;
+    for(int i = 0;i < n_words;++i) {
+        const char* key = words[i];
+        typename map_t::iterator it = m.find(key);
+        check(it != m.end() && it->second == i, what);
+        check(cm.find(key) == it, what);
+        check(m.count(key) == 1, what);
+        pair<typename map_t::iterator, typename map_t::iterator> r = m.equal_range(key);
+        check(r.first == it && ++r.first == r.second, what);
+        pair<typename map_t::const_iterator, typename map_t::const_iterator> cr =
+            cm.equal_range(key);
+        check(cr.first == it && cr.second == r.second, what);
+    }
+    check(m.find("absent") == m.end() && m.count("absent") == 0, what);
+    check(m.equal_range("absent").first == m.end(), what);
+    check(m.find(std::string("hash"))->second == 4, what);
+}
+
+template <class Hash>
+void test_multimap(const char* what) {
+    using map_t = hash_multimap<std::string, int, Hash, equal_to<>>;
+    map_t m;
+    for(int i = 0;i < n_words;++i) {
+        for(int k = 0;k <= i;++k)
+            m.insert(typename map_t::value_type(words[i], k));
+    }
+    for(int i = 0;i < 300;++i)
+        m.insert(typename map_t::value_type(std::to_string(i), i));
+
+    const map_t& cm = m;
+    for(int i = 0;i < n_words;++i) {
+        const char* key = words[i];
+        check(m.count(key) == static_cast<size_t>(i + 1), what);
+        check(m.find(key) != m.end() && m.find(key)->first == key, what);
+        size_t n = 0;
+        pair<typename map_t::const_iterator, typename map_t::const_iterator> r =
+            cm.equal_range(key);
+        for(;r.first != r.second;++r.first, ++n)
+            check(r.first->first == key, what);
+        check(n == static_cast<size_t>(i + 1), what);
+    }
+    check(m.count("absent") == 0 && m.equal_range("absent").first == m.end(), what);
+}
+
+int main() {
+    check(string_hash()("lookup") == string_hash()(std::string("lookup")),
+          "string_hash hashes a C string and a std::string alike");
+    test_map<string_hash>("hash_map, cached hash codes");
+    test_map<plain_string_hash>("hash_map, no cached hash codes");
+    test_multimap<string_hash>("hash_multimap, cached hash codes");
+    test_multimap<plain_string_hash>("hash_multimap, no cached hash codes");
+    if(failures == 0)
+        printf("ok\n");
+    return failures != 0;
+}
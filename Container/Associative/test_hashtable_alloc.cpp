@@ -0,0 +1,151 @@
+#include <cstdio>
+
+#include "Container/Associative/hash_map.hpp"
+#include "Allocator/test_alloc.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Associative/test_hashtable_alloc.cpp
+ *  run:   ./a.out, exits with 1 if a check fails
+ *
+ *  hash_map with a stateful allocator which propagates on copy
+ *  assignment, move assignment and swap. Tables are copied, moved and
+ *  swapped, the moved-from ones iterated and filled again. test_alloc
+ *  aborts if a block is freed by an allocator other than its own, and
+ *  every block must be freed at the end.
+ */
+
+using namespace MiniSTL;
+
+using tagged_alloc = test_alloc<pair<const int, int>>;
+using map_t = hash_map<int, int, hash<int>, equal_to<int>, tagged_alloc>;
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if(!ok) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+void fill(map_t& m, int first, int n) {
+    for(int i = first;i < first + n;++i)
+        m[i] = 2 * i;
+}
+
+// m holds exactly the keys [first, first + n)
+bool holds(const map_t& m, int first, int n) {
+    if(m.size() != static_cast<size_t>(n))
+        return false;
+    size_t seen = 0;
+    for(map_t::const_iterator it = m.begin();it != m.end();++it, ++seen) {
+        if(it->first < first || it->first >= first + n || it->second != 2 * it->first)
+            return false;
+    }
+    for(int i = first;i < first + n;++i) {
+        if(m.count(i) != 1)
+            return false;
+    }
+    return seen == m.size();
+}
+
+// a moved-from table is empty and takes inserts again
+void reuse(map_t& m, const char* what) {
+    check(m.empty() && m.begin() == m.end(), what);
+    check(m.find(7) == m.end() && m.count(7) == 0 && m.erase(7) == 0, what);
+    check(m.equal_range(7).first == m.end(), what);
+    m.clear();
+    fill(m, 5000, 300);
+    check(holds(m, 5000, 300), what);
+}
+
+void test_move_assign() {
+    map_t a(100, hash<int>(), equal_to<int>(), tagged_alloc(1));
+    map_t b(100, hash<int>(), equal_to<int>(), tagged_alloc(2));
+    fill(a, 0, 1000);
+    fill(b, 2000, 10);
+    b = std::move(a);
+    check(b.get_allocator().id == 1, "move assignment takes the allocator");
+    check(holds(b, 0, 1000), "move assignment takes the elements");
+    check(tagged_alloc::blocks(2) == 0, "move assignment frees the old buckets");
+    reuse(a, "moved-from table after move assignment");
+}
+
+void test_move_assign_rehashing() {
+    map_t a(100, hash<int>(), equal_to<int>(), tagged_alloc(1));
+    map_t b(100, hash<int>(), equal_to<int>(), tagged_alloc(2));
+    a.set_rehash_step(1);
+    fill(a, 0, 1000);
+    check(a.rehashing(), "incremental rehash runs");
+    b = std::move(a);
+    check(holds(b, 0, 1000), "move assignment during a rehash");
+    fill(b, 1000, 1000);
+    check(holds(b, 0, 2000), "inserts after move assignment during a rehash");
+    reuse(a, "moved-from table after a rehash");
+}
+
+void test_move_construct() {
+    map_t a(100, hash<int>(), equal_to<int>(), tagged_alloc(3));
+    fill(a, 0, 500);
+    const size_t blocks = tagged_alloc::blocks(3);
+    map_t b(std::move(a));
+    check(tagged_alloc::blocks(3) == blocks, "move constructor allocates nothing");
+    check(a.bucket_count() == 0 && a.load_factor() == 0.0f,
+          "moved-from table has no buckets");
+    check(holds(b, 0, 500), "move constructor takes the elements");
+    reuse(a, "moved-from table after move construction");
+    a.insert_noresize(map_t::value_type(1, 2));
+    check(a.count(1) == 1, "insert_noresize after move construction");
+    map_t c(std::move(a));
+    map_t d(std::move(a));
+    check(d.empty(), "move constructor from a table without buckets");
+    d = std::move(a);
+    check(d.empty() && a.empty(), "move assignment from a table without buckets");
+    d = c;
+    check(d.size() == c.size(), "copy assignment into a table without buckets");
+}
+
+void test_copy_assign() {
+    map_t a(100, hash<int>(), equal_to<int>(), tagged_alloc(1));
+    map_t b(100, hash<int>(), equal_to<int>(), tagged_alloc(4));
+    fill(a, 0, 700);
+    fill(b, 0, 50);
+    b = a;
+    check(b.get_allocator().id == 1, "copy assignment takes the allocator");
+    check(tagged_alloc::blocks(4) == 0, "copy assignment frees the old buckets");
+    check(holds(a, 0, 700) && holds(b, 0, 700), "copy assignment copies");
+    b.clear();
+    fill(b, 0, 2000);
+    check(holds(b, 0, 2000) && holds(a, 0, 700), "copies are independent");
+}
+
+void test_swap() {
+    map_t a(100, hash<int>(), equal_to<int>(), tagged_alloc(1));
+    map_t b(100, hash<int>(), equal_to<int>(), tagged_alloc(2));
+    fill(a, 0, 300);
+    fill(b, 1000, 20);
+    a.swap(b);
+    check(a.get_allocator().id == 2 && b.get_allocator().id == 1,
+          "swap swaps the allocators");
+    check(holds(a, 1000, 20) && holds(b, 0, 300), "swap swaps the elements");
+    fill(a, 2000, 500);
+    b.clear();
+    check(holds(a, 1000, 20) == false && a.size() == 520, "insert after swap");
+}
+
+int main() {
+    test_move_assign();
+    test_move_assign_rehashing();
+    test_move_construct();
+    test_copy_assign();
+    test_swap();
+    for(int i = 0;i < tagged_alloc::MAX_ID;++i) {
+        if(tagged_alloc::blocks(i) != 0) {
+            printf("FAILED: %zu blocks of allocator %d leaked\n",
+                   tagged_alloc::blocks(i), i);
+            ++failures;
+        }
+    }
+    if(failures == 0)
+        printf("ok\n");
+    return failures != 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Traits/type_traits.hpp"
+
+namespace MiniSTL {
+
+// tree_node_packed_t: whether rb_tree and avl_tree nodes keep their
+// color or balance factor in the low bits of the parent pointer, which
+// are always 0 as nodes are aligned to pointers. It saves the padded
+// word before the links, 8 bytes of each node on 64-bit targets, at the
+// cost of a mask whenever the parent is read. Define
+// USE_PACKED_TREE_NODE to pack them.
+#ifdef USE_PACKED_TREE_NODE
+using tree_node_packed_t = true_type;
+#else
+using tree_node_packed_t = false_type;
+#endif
+
+} // MiniSTL
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+#include "Container/Sequence/small_vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Sequence/bench_small_vector.cpp
+ *
+ *  ROUNDS times build a vector of 0..MAX_ELEMS ints, copy it, move the
+ *  copy away and destroy all of them, with vector and small_vector<int, 8>
+ *  on the same allocator. reports allocate calls and ns per round for
+ *  every element count.
+ */
+
+using namespace MiniSTL;
+
+const int ROUNDS = 1000000;
+const int MAX_ELEMS = 16;
+
+// SGI-style allocator counting calls to alloc_t
+struct counting_alloc {
+    static size_t allocs;
+
+    static void* allocate(size_t sz) {
+        ++allocs;
+        return alloc_t::allocate(sz);
+    }
+
+    static void deallocate(void* p, size_t sz) {
+        alloc_t::deallocate(p, sz);
+    }
+
+    static void* reallocate(void* p, size_t old_sz, size_t new_sz) {
+        ++allocs;
+        return alloc_t::reallocate(p, old_sz, new_sz);
+    }
+};
+
+size_t counting_alloc::allocs = 0;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so vectors are not optimized away
+volatile size_t sink = 0;
+
+template <class Vector>
+void bench(const char* name, int elems) {
+    counting_alloc::allocs = 0;
+    auto begin = bench_clock::now();
+    for(int r = 0;r < ROUNDS;++r) {
+        Vector v;
+        for(int i = 0;i < elems;++i)
+            v.push_back(r + i);
+        Vector copy(v);
+        Vector moved(std::move(copy));
+        sink = sink + v.size() + moved.size() + copy.size();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+    std::cout << std::setw(14) << name << std::setw(8) << elems
+              << std::setw(12) << static_cast<double>(counting_alloc::allocs) / ROUNDS
+              << std::setw(12) << ns / ROUNDS << std::endl;
+}
+
+int main() {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(14) << "container" << std::setw(8) << "elems"
+              << std::setw(12) << "allocs" << std::setw(12) << "ns/round" << std::endl;
+    for(int elems = 0;elems <= MAX_ELEMS;elems += 2) {
+        bench<vector<int, simple_alloc<int, counting_alloc>>>("vector", elems);
+        bench<small_vector<int, 8, simple_alloc<int, counting_alloc>>>("small_vector", elems);
+    }
+    return 0;
+}
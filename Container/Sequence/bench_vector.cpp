@@ -0,0 +1,151 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Sequence/bench_vector.cpp
+ *  run:   ./a.out [max_elems], max_elems defaults to 1e8
+ *
+ *  push_back n ints for n = 1e3, 1e4, ..., max_elems, with every growth
+ *  policy, once into an empty vector and once after reserve(n).
+ *  reports ns per push_back, number of reallocations and unused capacity
+ *  at the end. Small n is repeated so every row pushes about 1e7 ints.
+ *
+ *  then push_back RECORDS string-like records, each owning a heap buffer,
+ *  to see what reallocation costs when elements are copied, moved or
+ *  relocated by memcpy.
+ */
+
+using namespace MiniSTL;
+
+const size_t WORK = 10000000;
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so vectors are not optimized away
+volatile size_t sink = 0;
+
+template <class Vector>
+void bench(const char* name, size_t n, bool reserve) {
+    const size_t rounds = n < WORK ? WORK / n : 1;
+    size_t reallocs = 0;
+    size_t slack = 0;
+    auto begin = bench_clock::now();
+    for(size_t r = 0;r < rounds;++r) {
+        Vector v;
+        if(reserve)
+            v.reserve(n);
+        size_t cap = v.capacity();
+        for(size_t i = 0;i < n;++i) {
+            v.push_back(static_cast<int>(i));
+            if(v.capacity() != cap) {
+                cap = v.capacity();
+                ++reallocs;
+            }
+        }
+        slack = v.capacity() - v.size();
+        sink = sink + v.size();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+    std::cout << std::setw(12) << name << std::setw(12) << n
+              << std::setw(10) << (reserve ? "yes" : "no")
+              << std::setw(10) << ns / (rounds * n)
+              << std::setw(10) << reallocs / rounds
+              << std::setw(10) << 100.0 * slack / n << "%" << std::endl;
+}
+
+template <class Vector>
+void bench_policy(const char* name, size_t max_elems) {
+    for(size_t n = 1000;n <= max_elems;n *= 10) {
+        bench<Vector>(name, n, false);
+        bench<Vector>(name, n, true);
+    }
+}
+
+const size_t RECORDS = 1000000;
+
+// owns a heap copy of a short string, copy only
+struct copy_record {
+    char* str;
+
+    copy_record() : str(nullptr) {}
+    explicit copy_record(size_t i) : str(new char[32]) {
+        snprintf(str, 32, "record-%zu", i);
+    }
+    copy_record(const copy_record& x) : str(new char[32]) {
+        memcpy(str, x.str, 32);
+    }
+    ~copy_record() { delete[] str; }
+
+    copy_record& operator=(const copy_record& x) {
+        if(str == nullptr)
+            str = new char[32];
+        memcpy(str, x.str, 32);
+        return *this;
+    }
+};
+
+// adds a noexcept move
+struct move_record : copy_record {
+    explicit move_record(size_t i) : copy_record(i) {}
+    move_record(const move_record& x) : copy_record(x) {}
+    move_record(move_record&& x) noexcept {
+        MiniSTL::swap(str, x.str);
+    }
+
+    move_record& operator=(const move_record& x) {
+        copy_record::operator=(x);
+        return *this;
+    }
+    move_record& operator=(move_record&& x) noexcept {
+        MiniSTL::swap(str, x.str);
+        return *this;
+    }
+};
+
+// a move_record which also opts in to relocation
+struct reloc_record : move_record {
+    explicit reloc_record(size_t i) : move_record(i) {}
+};
+
+namespace MiniSTL {
+template <>
+struct is_relocatable<reloc_record> {
+    using relocatable = true_type;
+};
+}
+
+template <class Record>
+void bench_record(const char* name) {
+    auto begin = bench_clock::now();
+    {
+        vector<Record> v;
+        for(size_t i = 0;i < RECORDS;++i)
+            v.push_back(Record(i));
+        sink = sink + v.size();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(bench_clock::now() - begin).count();
+    std::cout << std::setw(12) << name << std::setw(12) << RECORDS
+              << std::setw(10) << ns / RECORDS << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_elems = argc > 1 ? static_cast<size_t>(atof(argv[1])) : 100000000;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(12) << "growth" << std::setw(12) << "elems"
+              << std::setw(10) << "reserve" << std::setw(10) << "ns/push"
+              << std::setw(10) << "reallocs" << std::setw(11) << "slack" << std::endl;
+    bench_policy<vector<int, simple_alloc<int>, growth_factor_2>>("2x", max_elems);
+    bench_policy<vector<int, simple_alloc<int>, growth_factor_1_5>>("1.5x", max_elems);
+    bench_policy<vector<int, simple_alloc<int>, size_class_growth<>>>("size_class", max_elems);
+
+    std::cout << std::endl << std::setw(12) << "record" << std::setw(12) << "elems"
+              << std::setw(10) << "ns/push" << std::endl;
+    bench_record<copy_record>("copy");
+    bench_record<move_record>("move");
+    bench_record<reloc_record>("relocate");
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+
+#include "Container/Sequence/vector.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Sequence/bench_vector_realloc.cpp
+ *  run:   ./a.out [max_bytes], max_bytes defaults to 1 GiB
+ *
+ *  grow a vector of bytes from 4 KiB to max_bytes, doubling capacity by
+ *  reserve and filling the new half by resize after every step.
+ *      1. char is relocatable, so reserve goes through reallocate of
+ *      the allocator, which extends big buffers in place or by mremap
+ *      2. byte is not, so reserve allocates a new buffer, moves every
+ *      element over and frees the old one, as vector always did
+ *  reports time spent in reserve and in total.
+ */
+
+using namespace MiniSTL;
+
+// a char which vector does not know to be relocatable
+struct byte {
+    char c;
+
+    byte() : c(0) {}
+    byte(char x) : c(x) {}
+};
+
+using bench_clock = std::chrono::steady_clock;
+
+// volatile sink so buffers are not optimized away
+volatile size_t sink = 0;
+
+template <class Byte, class Alloc>
+void bench(const char* name, size_t max_bytes) {
+    double reserve_ms = 0;
+    auto begin = bench_clock::now();
+    {
+        vector<Byte, Alloc> v;
+        for(size_t cap = 4096;cap <= max_bytes;cap *= 2) {
+            auto t = bench_clock::now();
+            v.reserve(cap);
+            reserve_ms += std::chrono::duration<double, std::milli>(bench_clock::now() - t).count();
+            v.resize(cap, Byte(1));
+        }
+        sink = sink + v.size();
+    }
+    const double total_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count();
+    std::cout << std::setw(16) << name << std::setw(14) << max_bytes
+              << std::setw(14) << reserve_ms << std::setw(14) << total_ms << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_bytes = argc > 1 ? static_cast<size_t>(atof(argv[1])) : size_t(1) << 30;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(16) << "vector" << std::setw(14) << "bytes"
+              << std::setw(14) << "reserve(ms)" << std::setw(14) << "total(ms)" << std::endl;
+    bench<byte, simple_alloc<byte>>("copy", max_bytes);
+    bench<char, simple_alloc<char>>("realloc", max_bytes);
+    bench<byte, simple_alloc<byte, malloc_alloc>>("copy/malloc", max_bytes);
+    bench<char, simple_alloc<char, malloc_alloc>>("realloc/malloc", max_bytes);
+    return 0;
+}
@@ -40,6 +40,7 @@
 #include <initializer_list>
 #include <utility>
 #include <exception>
+#include <stdexcept>
 
 namespace MiniSTL {
 
@@ -80,6 +81,7 @@ struct deque_iterator {
     // ! ctor a const_iterator from iterator
 	deque_iterator(const iterator& i) 
         : cur(i.cur), first(i.first), last(i.last), node(i.node) {}
+    deque_iterator& operator=(const deque_iterator&) = default;
 
 	void set_node(map_pointer new_node) {
 		node = new_node;
@@ -134,7 +136,7 @@ struct deque_iterator {
 		return *this;
 	}
 
-	self operator+(difference_type n) {
+	self operator+(difference_type n) const {
 		self temp = *this;
 		return temp += n;
 	}
@@ -143,12 +145,12 @@ struct deque_iterator {
 		return *this += -n;
 	}
 
-	self operator-(difference_type n) {
+	self operator-(difference_type n) const {
 		self temp = *this;
 		return temp -= n;
 	}
 
-	reference operator[](difference_type n) {
+	reference operator[](difference_type n) const {
 		return *(*this + n);
 	}
 
@@ -167,21 +169,23 @@ operator+(ptrdiff_t n, const deque_iterator<T, Ref, Ptr>& x) {
 	return x + n;
 }
 
-// distance between x, y, that is x - y
-template<class T, class Ref, class Ptr>
-inline typename deque_iterator<T, Ref, Ptr>::difference_type
-operator-(const deque_iterator<T, Ref, Ptr>& x, 
-          const deque_iterator<T, Ref, Ptr>& y){
-	return typename deque_iterator<T, Ref, Ptr>::difference_type(
-        deque_iterator<T, Ref, Ptr>::buf_size() * (x.node - y.node -1) 
-        + (x.cur - x.first) + (y.last - y.cur));
+// distance between x, y, that is x - y, iterator and const_iterator mixed
+template<class T, class RefX, class PtrX, class RefY, class PtrY>
+inline ptrdiff_t
+operator-(const deque_iterator<T, RefX, PtrX>& x, 
+          const deque_iterator<T, RefY, PtrY>& y){
+	return static_cast<ptrdiff_t>(deque_iterator<T, RefX, PtrX>::buf_size()) * 
+        (x.node - y.node - 1) + (x.cur - x.first) + (y.last - y.cur);
 }
 
 
 
 
 template <class T, class Allocator = simple_alloc<T> >
-class deque {
+class deque : protected alloc_base<T, Allocator> {
+private:
+    using base = alloc_base<T, Allocator>;
+
 public:
     // types:
     using value_type = T;
@@ -199,8 +203,13 @@ public:
 
 protected:
     using map_pointer = T**;
-    using node_alloc = simple_alloc<T>;
-    using map_alloc = simple_alloc<T*>;
+
+    // map comes from a copy of the allocator rebound to T*
+    struct map_alloc : alloc_base<T*, Allocator> {
+        explicit map_alloc(const Allocator& a) : alloc_base<T*, Allocator>(a) {}
+        using alloc_base<T*, Allocator>::allocate_n;
+        using alloc_base<T*, Allocator>::deallocate_n;
+    };
 
     // data member:
     iterator start;
@@ -213,12 +222,12 @@ protected:
 
     static size_type buf_size() { return iterator::buf_size(); }
 
-    allocator_type get_allocator() const noexcept 
-        { return node_alloc(); }
- 
+    static iterator mutable_iterator(const_iterator pos) 
+        { return iterator(pos.cur, pos.node); }
+
     // node related dynamic alloc
-    T* allocate_node() { return node_alloc::allocate(buf_size()); }
-    void deallocate_node(T* p) { return node_alloc::deallocate(p, buf_size()); }
+    T* allocate_node() { return this->allocate_n(buf_size()); }
+    void deallocate_node(T* p) { this->deallocate_n(p, buf_size()); }
     void create_nodes(T** nstart, T** nfinish);
     void destroy_nodes(T** nstart, T** nfinish) {
         for(T** cur = nstart;cur != nfinish;cur++)
@@ -226,8 +235,10 @@ protected:
     }
 
     // map related dynamic alloc
-    T** allocate_map(size_type n) { return map_alloc::allocate(n); }
-    void deallocate_map(T** p, size_type n) { return map_alloc::deallocate(p, n); }
+    T** allocate_map(size_type n) 
+        { return map_alloc(this->get_allocator()).allocate_n(n); }
+    void deallocate_map(T** p, size_type n) 
+        { map_alloc(this->get_allocator()).deallocate_n(p, n); }
     void initialize_map(size_type n);
     void reallocate_map(size_type n, bool add_at_front);
     void reserve_map_at_front(size_type n = 1) {
@@ -245,16 +256,25 @@ protected:
     void new_elements_at_front(size_type n);
     void new_elements_at_back(size_type n);
 
+public:
+    allocator_type get_allocator() const noexcept 
+        { return base::get_allocator(); }
+
 public:
     // construct/copy/destroy:
     explicit deque() 
         : start(), finish(), map(nullptr), map_size(0)
         { initialize_map(0);}
-    explicit deque(size_type n) 
-        : start(), finish(), map(nullptr), map_size(0)
-        { initialize_map(n); }
-    deque(size_type n, const T& val) 
-        : start(), finish(), map(nullptr), map_size(0) {
+    explicit deque(const allocator_type& a) 
+        : base(a), start(), finish(), map(nullptr), map_size(0)
+        { initialize_map(0);}
+    explicit deque(size_type n, const allocator_type& a = allocator_type()) 
+        : base(a), start(), finish(), map(nullptr), map_size(0) {
+        initialize_map(n);
+        fill_initialize(T());
+    }
+    deque(size_type n, const T& val, const allocator_type& a = allocator_type()) 
+        : base(a), start(), finish(), map(nullptr), map_size(0) {
         initialize_map(n);
         fill_initialize(val);
     }
@@ -262,45 +282,33 @@ public:
     // we cannot get distance [first, last) now, so initialized 
     // map until know the category of iterator
     template <class InputIt>
-    deque(InputIt first, InputIt last)
-        : start(), finish(), map(nullptr), map_size(0)
+    deque(InputIt first, InputIt last, const allocator_type& a = allocator_type())
+        : base(a), start(), finish(), map(nullptr), map_size(0)
         { initialize_dispatch(first, last, integral<InputIt>());}
     deque(const deque& x) 
-        : start(), finish(), map(nullptr), map_size(0) { 
+        : base(x.get_allocator()), start(), finish(), map(nullptr), map_size(0) { 
         initialize_map(x.size());
-        uninitialized_copy(x.begin(), x.end(), start);
+        MiniSTL::uninitialized_copy(x.begin(), x.end(), start);
     }
 
-    // ? move semantics:
+    // x is left with an empty map, so it can still be used
     deque(deque&& x)
-        : start(x.start), finish(x.finish), map(x.map), map_size(x.map_size) {
-        x.start = iterator();
-        x.finish = iterator();
-        x.map = nullptr;
-        x.map_size = static_cast<size_type>(0);
-        // initialize_map(0);
-        // swap(x);
+        : base(x.get_allocator()), start(), finish(), map(nullptr), map_size(0) {
+        initialize_map(0);
+        take_storage(x);
     }
-    deque(std::initializer_list<T> ilist) 
-        : start(), finish(), map(nullptr), map_size(0) {
+    deque(std::initializer_list<T> ilist, const allocator_type& a = allocator_type()) 
+        : base(a), start(), finish(), map(nullptr), map_size(0) {
         range_initialize(ilist.begin(), ilist.end(),
                          forward_iterator_tag()); 
     }
  
-    ~deque() {
-        destroy(start, finish);
-        if(map) {
-            destroy_nodes(start.node, finish.node + 1);
-            deallocate_map(map, map_size);
-        }
-    }
+    ~deque() { destroy_and_deallocate(); }
 
     deque& operator=(const deque& x);
     deque& operator=(deque&& x) {
-        if(&x != this) {
-            clear();
-            swap(x);
-        }
+        if(&x != this)
+            move_assign(x, typename base::propagate_on_move());
         return *this;
     }
     deque& operator=(std::initializer_list<T> ilist) {
@@ -308,13 +316,65 @@ public:
         return *this;
     }
 
+protected:
+    void destroy_and_deallocate() {
+        MiniSTL::destroy(start, finish);
+        if(map) {
+            destroy_nodes(start.node, finish.node + 1);
+            deallocate_map(map, map_size);
+        }
+    }
+
+    // map and nodes belong to the allocator, so they are rebuilt when
+    // an unequal allocator takes over
+    void replace_alloc(const deque& x) {
+        if(!this->alloc_equal(x)) {
+            destroy_and_deallocate();
+            map = nullptr;
+            map_size = 0;
+            this->copy_alloc(x, true_type());
+            initialize_map(0);
+        } else {
+            this->copy_alloc(x, true_type());
+        }
+    }
+
+    void copy_assign_alloc(const deque& x, true_type) { replace_alloc(x); }
+
+    void copy_assign_alloc(const deque&, false_type) {}
+
+    void take_storage(deque& x) {
+        MiniSTL::swap(start, x.start);
+        MiniSTL::swap(finish, x.finish);
+        MiniSTL::swap(map, x.map);
+        MiniSTL::swap(map_size, x.map_size);
+    }
+
+    void move_assign(deque& x, true_type) {
+        clear();
+        replace_alloc(x);
+        take_storage(x);
+    }
+
+    // buffers can only be taken from an equal allocator, 
+    // otherwise elements are copied into our own buffers
+    void move_assign(deque& x, false_type) {
+        if(this->alloc_equal(x)) {
+            clear();
+            take_storage(x);
+        } else {
+            *this = x;
+            x.clear();
+        }
+    }
+
 protected:
     // precondition: must initialize map first
     void fill_initialize(const T& val);
     template <class Integer>
     void initialize_dispatch(Integer n, Integer val, true_type) {
         initialize_map(static_cast<size_type>(n));
-        fill_intialize(static_cast<T>(val));
+        fill_initialize(static_cast<T>(val));
     }
 
     template <class InputIt>
@@ -376,8 +436,8 @@ public:
     const_reverse_iterator  rend() const noexcept
         { return const_reverse_iterator(start); }
  
-    const_iterator          cbegin() noexcept { return start; }
-    const_iterator          cend() noexcept { return finish; }
+    const_iterator          cbegin() const noexcept { return start; }
+    const_iterator          cend() const noexcept { return finish; }
     const_reverse_iterator  crbegin() const noexcept 
         { return const_reverse_iterator(finish); }
     const_reverse_iterator  crend() const noexcept
@@ -394,8 +454,8 @@ public:
     bool empty() const noexcept { return start == finish; }
 
 protected:
-    void range_check(size_type n) {
-        if(n > size())
+    void range_check(size_type n) const {
+        if(n >= size())
             throw std::out_of_range("deque index out of range");
     }
 
@@ -443,7 +503,7 @@ public:
     }
     template <class... Args> 
     iterator emplace(const_iterator pos, Args&&... args) {
-        insert(pos, std::move(T(args...)));
+        return insert(pos, std::move(T(args...)));
     }
  
     void push_front(const T& val) {
@@ -455,10 +515,10 @@ public:
     }
     void push_front(T&& val) {
         if(start.cur != start.first) {
-            construct(start.cur - 1, std::forward(val));
+            construct(start.cur - 1, std::forward<T>(val));
             --start.cur;
         } else 
-            push_front_aux(std::forward(val));
+            push_front_aux(std::forward<T>(val));
     }
     void push_back(const T& val) {
         if(finish.cur != finish.last - 1) {
@@ -469,22 +529,22 @@ public:
     }
     void push_back(T&& val) {
         if(finish.cur != finish.last - 1) {
-            construct(finish.cur, std::forward(val));
+            construct(finish.cur, std::forward<T>(val));
             ++finish.cur;
         } else 
-            push_back_aux(std::forward(val));
+            push_back_aux(std::forward<T>(val));
     }
     void pop_front() {
         if(start.cur != start.last - 1) {
-            destroy(start.cur);
+            MiniSTL::destroy(start.cur);
             ++start.cur;
         } else
             pop_front_aux();
     }
     void pop_back() {
-        if(finish.cur != finish.start) {
+        if(finish.cur != finish.first) {
             --finish.cur;
-            destroy(finish.cur);
+            MiniSTL::destroy(finish.cur);
         } else
             pop_back_aux();
     }
@@ -548,10 +608,8 @@ public:
     iterator erase(const_iterator first, const_iterator last);
 
     void     swap(deque& x) {
-        MiniSTL::swap(start, x.start);
-        MiniSTL::swap(finish, x.finish);
-        MiniSTL::swap(map, x.map);
-        MiniSTL::swap(map_size, x.map_size);
+        this->swap_alloc(x, typename base::propagate_on_swap());
+        take_storage(x);
     }
 
     void     clear() noexcept;
@@ -561,13 +619,13 @@ public:
 template <class T, class Alloc>
 bool operator==(const deque<T,Alloc>& x, const deque<T,Alloc>& y) {
     return x.size() == y.size() && 
-        equal(x.begin(), x.end(), y.begin());
+        MiniSTL::equal(x.begin(), x.end(), y.begin());
 }
 
 template <class T, class Alloc>
 bool operator<(const deque<T,Alloc>& x, const deque<T,Alloc>& y) {
-    return lexicographical_compare(x.begin(), x.end(),
-                                   y.being(), y.end());
+    return MiniSTL::lexicographical_compare(x.begin(), x.end(),
+                                            y.begin(), y.end());
 }
 
 template <class T, class Alloc>
@@ -644,18 +702,18 @@ void deque<T, Alloc>::reallocate_map(size_type n, bool add_at_front) {
         new_start = map + (map_size - new_num_nodes) / 2 +
                     (add_at_front ? n : 0);
         if(new_start < start.node)
-            copy(start.node, finish.node + 1, new_start);
+            MiniSTL::copy(start.node, finish.node + 1, new_start);
         else 
-            copy_backward(start.node, finish.node + 1,
-                          new_start + new_num_nodes);
+            MiniSTL::copy_backward(start.node, finish.node + 1,
+                                   new_start + old_num_nodes);
     } else {
         // not enough space, reallocate map
-        size_type new_map_size = map_size + max(map_size, n) + 2;
+        size_type new_map_size = map_size + MiniSTL::max(map_size, n) + 2;
         map_pointer new_map = allocate_map(new_map_size);
-        new_start = new_map_size + 
+        new_start = new_map + 
                     (new_map_size - new_num_nodes) / 2 +
                     (add_at_front ? n : 0);
-        copy(start.node, finish.node + 1, new_start);
+        MiniSTL::copy(start.node, finish.node + 1, new_start);
         deallocate_map(map, map_size);
         map = new_map;
         map_size = new_map_size;
@@ -694,7 +752,7 @@ void deque<T, Alloc>::new_elements_at_front(size_type n) {
             *(start.node - i) = allocate_node();
     } catch(std::exception&) {
         for(size_type j = 1;j < i;++j)
-            deallocate_node(*(start - j));
+            deallocate_node(*(start.node - j));
         throw;
     }
 }
@@ -717,15 +775,17 @@ void deque<T, Alloc>::new_elements_at_back(size_type n) {
 template <class T, class Alloc>
 deque<T, Alloc>& deque<T, Alloc>::operator=(const deque& x) {
     if(&x != this) {
+        copy_assign_alloc(x, typename base::propagate_on_copy());
         if(size() >= x.size()) {
-            erase(copy(x.begin(), x.end(), start), finish);
+            erase(MiniSTL::copy(x.begin(), x.end(), start), finish);
         } else {
             const_iterator mid = x.begin() +                
                 static_cast<difference_type>(size());
-            copy(x.begin(), mid, start);
-            insert(finish, mid, end());
+            MiniSTL::copy(x.begin(), mid, start);
+            insert(finish, mid, x.end());
         }
     }
+    return *this;
 }
 
 template <class T, class Alloc>
@@ -734,12 +794,12 @@ void deque<T, Alloc>::fill_initialize(const T& val) {
     try {
         // fill every node before finish
         for(cur = start.node;cur != finish.node;++cur)
-            uninitialized_fill(*cur, *cur + buf_size(), val);
+            MiniSTL::uninitialized_fill(*cur, *cur + buf_size(), val);
         // fill finish
-        uninitialized_fill(finish.start, finish.cur, val);
+        MiniSTL::uninitialized_fill(finish.first, finish.cur, val);
     } catch(std::exception&) {
         // not clear(), because clear destroy [start, finish)
-        destroy(start, iterator(*cur, cur));
+        MiniSTL::destroy(start, iterator(*cur, cur));
         throw;
     }
 }
@@ -764,20 +824,20 @@ template <class T, class Alloc>
 template <class ForwardIt>
 void deque<T, Alloc>::range_initialize(ForwardIt first, ForwardIt last, 
                                        forward_iterator_tag) {
-    size_type n = distance(first, last);
+    size_type n = MiniSTL::distance(first, last);
     initialize_map(n);
 
     T** cur;
     try {
         for(cur = start.node; cur != finish.node;++cur) {
             ForwardIt mid = first;
-            advance(mid, buf_size());
-            uninitialized_copy(first, mid, *cur);
+            MiniSTL::advance(mid, buf_size());
+            MiniSTL::uninitialized_copy(first, mid, *cur);
             first = mid;
         }
-        uninitialized_copy(first, last, finish.first);
+        MiniSTL::uninitialized_copy(first, last, finish.first);
     } catch(std::exception&) {
-        destroy(start, iterator(*cur, cur));
+        MiniSTL::destroy(start, iterator(*cur, cur));
         throw;
     }
 }
@@ -786,11 +846,11 @@ void deque<T, Alloc>::range_initialize(ForwardIt first, ForwardIt last,
 template <class T, class Alloc>
 void deque<T, Alloc>::fill_assign(size_type n, const T& val) {
     if(n > size()) {
-        fill(begin(), end(), val);
+        MiniSTL::fill(begin(), end(), val);
         insert(end(), n - size(), val);
     } else {
-        erase(begin() + n, end());
-        fill(begin(), end(), val);
+        erase(begin() + static_cast<difference_type>(n), end());
+        MiniSTL::fill(begin(), end(), val);
     }
 }
 
@@ -812,14 +872,14 @@ template <class T, class Alloc>
 template <class ForwardIt>
 void deque<T, Alloc>::assign_aux(ForwardIt first, ForwardIt last,
                                  forward_iterator_tag) {
-    size_type len = distance(first, last);
+    size_type len = MiniSTL::distance(first, last);
     if(len > size()) {
         ForwardIt mid = first;
-        advance(mid, len);
-        copy(first, mid, begin());
+        MiniSTL::advance(mid, size());
+        MiniSTL::copy(first, mid, begin());
         insert(end(), mid, last);
     } else {
-        erase(copy(first, last, begin()), end());
+        erase(MiniSTL::copy(first, last, begin()), end());
     }
 }
 
@@ -833,17 +893,22 @@ void deque<T, Alloc>::resize(size_type sz, const T& val) {
 
 template <class T, class Alloc>
 void deque<T, Alloc>::shrink_to_fit() {
-    if(empty()) {
-        clear();
-    } else {
-        T** cur;
-        for(cur = map;cur != start.node;++cur)
-            deallocate_node(*cur);
-        for(cur = finish.node + 1;cur != map + map_size;++cur)
-            deallocate_node(*cur);
-        map = start.node;
-        map_size = finish.node - start.node + 1;
-    }
+    // only [start.node, finish.node] hold buffers, the map is
+    // reallocated to just fit them
+    const size_type num_nodes = finish.node - start.node + 1;
+    if(num_nodes == map_size)
+        return;
+    map_pointer new_map = allocate_map(num_nodes);
+    MiniSTL::copy(start.node, finish.node + 1, new_map);
+    deallocate_map(map, map_size);
+    map = new_map;
+    map_size = num_nodes;
+    T* start_cur = start.cur;
+    T* finish_cur = finish.cur;
+    start.set_node(new_map);
+    start.cur = start_cur;
+    finish.set_node(new_map + num_nodes - 1);
+    finish.cur = finish_cur;
 }
 
 template <class T, class Alloc>
@@ -869,7 +934,7 @@ void deque<T, Alloc>::push_front_aux(T&& val) {
     try {
         start.set_node(start.node - 1);
         start.cur = start.last - 1;
-        new (start.cur) T(std::forward(val));
+        new (start.cur) T(std::forward<T>(val));
     } catch(std::exception&) {
         ++start;
         deallocate_node(*(start.node - 1));
@@ -884,10 +949,10 @@ void deque<T, Alloc>::push_back_aux(const T& val) {
     *(finish.node + 1) = allocate_node();
     try {
         construct(finish.cur, x_copy);
-        finish.set_node(finish + 1);
+        finish.set_node(finish.node + 1);
         finish.cur = finish.first;
     } catch(std::exception&) {
-        deallocate_node(*(finish.node - 1));
+        deallocate_node(*(finish.node + 1));
         // if exception happens, it can only occur in construct,
         // at time ++finish not happened yet, so don't need below
         // --finish;
@@ -901,17 +966,17 @@ void deque<T, Alloc>::push_back_aux(T&& val) {
     *(finish.node + 1) = allocate_node();
     try {
         new (finish.cur) T(std::move(val));
-        finish.set_node(finish + 1);
+        finish.set_node(finish.node + 1);
         finish.cur = finish.first;
     } catch(std::exception&) {
-        deallocate_node(*(finish.node - 1));
+        deallocate_node(*(finish.node + 1));
         throw;
     }
 }
 
 template <class T, class Alloc>
 void deque<T, Alloc>::pop_front_aux() {
-    destroy(start.cur);
+    MiniSTL::destroy(start.cur);
     deallocate_node(*(start.node));
     start.set_node(start.node + 1);
     start.cur = start.first;
@@ -922,7 +987,7 @@ void deque<T, Alloc>::pop_back_aux() {
     deallocate_node(*(finish.node));
     finish.set_node(finish.node - 1);
     finish.cur = finish.last - 1;
-    destroy(finish.cur);
+    MiniSTL::destroy(finish.cur);
 }
 
 template <class T, class Alloc>
@@ -945,15 +1010,15 @@ template <class T, class Alloc>
 typename deque<T, Alloc>::iterator
 deque<T, Alloc>::insert(const_iterator pos, T&& val) {
     if(pos.cur == start.cur) {
-        push_front(std::forward(val));
+        push_front(std::forward<T>(val));
         return start;
     } else if(pos.cur == finish.cur) {
-        push_back(std::forward(val));
+        push_back(std::forward<T>(val));
         iterator tmp = finish;
         --tmp;
         return tmp;
     } else {
-        return insert_aux(pos, std::forward(val));
+        return insert_aux(pos, std::forward<T>(val));
     }
 }
 
@@ -962,17 +1027,18 @@ typename deque<T, Alloc>::iterator
 deque<T, Alloc>::insert_aux(const_iterator pos, const T& val) {
     difference_type idx = pos - start;
     T x_copy = val;
+    iterator p;
     if(static_cast<size_type>(idx) < size() / 2) {
         // insert at front half part, copy front
         push_front(front());
         iterator front1 = start;
         ++front1;
-        iterator front2 = front2;
+        iterator front2 = front1;
         ++front2;
-        pos = start + idx;
-        iterator pos1 = pos;
+        p = start + idx;
+        iterator pos1 = p;
         ++pos1;
-        copy(front2, pos1, front1);
+        MiniSTL::copy(front2, pos1, front1);
     } else {
         // insert at back half part, copy back
         push_back(back());
@@ -980,28 +1046,29 @@ deque<T, Alloc>::insert_aux(const_iterator pos, const T& val) {
         --back1;
         iterator back2 = back1;
         --back2;
-        pos = start + idx;
-        copy_backward(pos, back2, back1);
+        p = start + idx;
+        MiniSTL::copy_backward(p, back2, back1);
     }
-    *pos = x_copy;
-    return pos;
+    *p = x_copy;
+    return p;
 }
 
 template <class T, class Alloc>
 typename deque<T, Alloc>::iterator
 deque<T, Alloc>::insert_aux(const_iterator pos, T&& val) {
     difference_type idx = pos - start;
+    iterator p;
     if(static_cast<size_type>(idx) < size() / 2) {
         // insert at front half part, copy front
         push_front(front());
         iterator front1 = start;
         ++front1;
-        iterator front2 = front2;
+        iterator front2 = front1;
         ++front2;
-        pos = start + idx;
-        iterator pos1 = pos;
+        p = start + idx;
+        iterator pos1 = p;
         ++pos1;
-        copy(front2, pos1, front1);
+        MiniSTL::copy(front2, pos1, front1);
     } else {
         // insert at back half part, copy back
         push_back(back());
@@ -1009,25 +1076,25 @@ deque<T, Alloc>::insert_aux(const_iterator pos, T&& val) {
         --back1;
         iterator back2 = back1;
         --back2;
-        pos = start + idx;
-        copy_backward(pos, back2, back1);
+        p = start + idx;
+        MiniSTL::copy_backward(p, back2, back1);
     }
-    *pos = std::forward(val); // move assign
-    return pos;
+    *p = std::forward<T>(val); // move assign
+    return p;
 }
 
 template <class T, class Alloc>
 typename deque<T, Alloc>::iterator 
 deque<T, Alloc>::fill_insert(const_iterator pos, size_type n,
                              const T& val) {
+    iterator res = mutable_iterator(pos);
     if(n == 0)
-        return pos;
+        return res;
     
-    iterator res = pos;
     if(pos.cur == start.cur) {
         iterator new_start = reserve_element_at_front(n);
         try {
-            uninitialized_fill(new_start, start, val);
+            MiniSTL::uninitialized_fill(new_start, start, val);
             start = new_start;
             res = new_start;
         } catch(std::exception&) {
@@ -1037,7 +1104,7 @@ deque<T, Alloc>::fill_insert(const_iterator pos, size_type n,
     } else if(pos.cur == finish.cur) {
         iterator new_finish = reserve_element_at_back(n);
         try {
-            uninitialized_fill(finish, new_finish, val);
+            MiniSTL::uninitialized_fill(finish, new_finish, val);
             res = finish;
             finish = new_finish;
         } catch(std::exception&) {
@@ -1054,53 +1121,58 @@ template <class T, class Alloc>
 typename deque<T, Alloc>::iterator 
 deque<T, Alloc>::fill_insert_aux(const_iterator pos, size_type n, const T& val) {
     if(n == 0)
-        return pos;
+        return mutable_iterator(pos);
     
-    iterator res = pos;
-    difference_type elems_before = pos - start;
-    difference_type n1 = static_cast<difference_type>(n);
-    if(elems_before < size() / 2) {
+    // reserving may move the map, so positions are kept as indices
+    iterator res;
+    const difference_type elems_before = pos - start;
+    const difference_type n1 = static_cast<difference_type>(n);
+    T x_copy = val;
+    if(static_cast<size_type>(elems_before) < size() / 2) {
         iterator new_start = reserve_element_at_front(n);
         iterator old_start = start;
-        pos = start + elems_before;
+        iterator p = start + elems_before;
         try {
             if(elems_before >= n1) {
                 iterator start_n = start + n1;
-                uninitialized_copy(start, start_n, new_start);
+                MiniSTL::uninitialized_copy(start, start_n, new_start);
                 start = new_start;
-                copy(start_n, pos, old_start);
-                fill(pos - n1, pos, val);
+                MiniSTL::copy(start_n, p, old_start);
+                MiniSTL::fill(p - n1, p, x_copy);
             } else {
-                uninitialized_copy(start, pos, new_start);
-                uninitialized_fill(new_start + elems_before, start, val);
+                MiniSTL::uninitialized_copy(start, p, new_start);
+                MiniSTL::uninitialized_fill(new_start + elems_before, start, x_copy);
                 start = new_start;
-                fill(old_start, pos, val);
+                MiniSTL::fill(old_start, p, x_copy);
             }
             res = new_start + elems_before;
         } catch(std::exception&) {
             destroy_nodes(new_start.node, start.node);
+            throw;
         }
     } else {
         iterator new_finish = reserve_element_at_back(n);
         iterator old_finish = finish;
-        difference_type elems_after = finish - pos;
-        pos = finish - elems_after;
+        const difference_type elems_after = 
+            static_cast<difference_type>(size()) - elems_before;
+        iterator p = finish - elems_after;
         try {
-            if(elems_after > n) {
+            if(elems_after > n1) {
                 iterator finish_n = finish - n1;
-                uninitialized_copy(finish_n, finish, finish);
+                MiniSTL::uninitialized_copy(finish_n, finish, finish);
                 finish = new_finish;
-                copy_backward(pos, finish_n, old_finish);
-                fill(pos, finish_n, val);
+                MiniSTL::copy_backward(p, finish_n, old_finish);
+                MiniSTL::fill(p, p + n1, x_copy);
             } else {
-                uninitialized_fill(finish, pos + n1, val);
-                uninitialized_copy(pos, finish, pos + n1);
+                MiniSTL::uninitialized_fill(finish, p + n1, x_copy);
+                MiniSTL::uninitialized_copy(p, finish, p + n1);
                 finish = new_finish;
-                fill(pos, old_finish, val);
+                MiniSTL::fill(p, old_finish, x_copy);
             }
-            res = pos;
+            res = p;
         } catch(std::exception&) {
-            deallocate_node(finish.node + 1, new_finish.node + 1);
+            destroy_nodes(finish.node + 1, new_finish.node + 1);
+            throw;
         }
     }
     return res;
@@ -1113,60 +1185,64 @@ typename deque<T, Alloc>::iterator
 deque<T, Alloc>::range_insert_aux(const_iterator pos, ForwardIt first, 
                                   ForwardIt last, size_type n) {
     if(first == last)
-        return pos;
+        return mutable_iterator(pos);
 
-    iterator res = pos;
-    difference_type elems_before = pos - start;
-    difference_type n1 = static_cast<difference_type>(n);
-    if(elems_before < size() / 2) {
+    // reserving may move the map, so positions are kept as indices
+    iterator res;
+    const difference_type elems_before = pos - start;
+    const difference_type n1 = static_cast<difference_type>(n);
+    if(static_cast<size_type>(elems_before) < size() / 2) {
         iterator new_start = reserve_element_at_front(n);
         iterator old_start = start;
-        pos = start + elems_before;
+        iterator p = start + elems_before;
         try {
             if(elems_before >= n1) {
                 iterator start_n = start + n1;
-                uninitialized_copy(start, start_n, new_start);
+                MiniSTL::uninitialized_copy(start, start_n, new_start);
                 start = new_start;
-                copy(start_n, pos, old_start);
-                copy(first, last, pos - n1);
+                MiniSTL::copy(start_n, p, old_start);
+                MiniSTL::copy(first, last, p - n1);
             } else {
                 ForwardIt mid = first;
-                advance(mid, n1 - elems_before);
-                uninitialized_copy(start, pos, new_start);
-                uninitialized_copy(first, mid, new_start + elems_before);
+                MiniSTL::advance(mid, n1 - elems_before);
+                MiniSTL::uninitialized_copy(start, p, new_start);
+                MiniSTL::uninitialized_copy(first, mid, new_start + elems_before);
                 start = new_start;
-                copy(mid, last, old_start);
+                MiniSTL::copy(mid, last, old_start);
             }
             res = new_start + elems_before;
         } catch(std::exception&) {
             destroy_nodes(new_start.node, start.node);
+            throw;
         }
     } else {
         iterator new_finish = reserve_element_at_back(n);
         iterator old_finish = finish;
-        difference_type elems_after = finish - pos;
-        pos = finish - elems_after;
+        const difference_type elems_after = 
+            static_cast<difference_type>(size()) - elems_before;
+        iterator p = finish - elems_after;
         try {
             if(elems_after > n1) {
                 iterator finish_n = finish - n1;
-                uninitialized_copy(finish_n, finish, finish);
+                MiniSTL::uninitialized_copy(finish_n, finish, finish);
                 finish = new_finish;
-                copy_backward(pos, finish_n, old_finish);
-                copy(first, last, pos);
+                MiniSTL::copy_backward(p, finish_n, old_finish);
+                MiniSTL::copy(first, last, p);
             } else {
                 ForwardIt mid = first;
-                advance(mid, elems_after);
-                uninitialized_copy(mid, last, finish);
-                uninitialized_copy(pos, finish, pos + n1);
+                MiniSTL::advance(mid, elems_after);
+                MiniSTL::uninitialized_copy(mid, last, finish);
+                MiniSTL::uninitialized_copy(p, finish, p + n1);
                 finish = new_finish;
-                copy(first, mid, pos);
+                MiniSTL::copy(first, mid, p);
             }
-            res = pos;
+            res = p;
         } catch(std::exception&) {
-            deallocate_node(finish.node + 1, new_finish.node + 1);
+            destroy_nodes(finish.node + 1, new_finish.node + 1);
+            throw;
         }
     }
-    return pos;
+    return res;
 }
 
 template <class T, class Alloc>
@@ -1174,8 +1250,11 @@ template <class InputIt>
 typename deque<T, Alloc>::iterator
 deque<T, Alloc>::range_insert(const_iterator pos, InputIt first, 
                               InputIt last, input_iterator_tag) {
-    // use insert iter simple code
-    copy(first, last, inserter(*this, pos));
+    const difference_type idx = pos - start;
+    iterator p = mutable_iterator(pos);
+    for(;first != last;++first, ++p)
+        p = insert(p, *first);
+    return start + idx;
 }
 
 template <class T, class Alloc>
@@ -1183,15 +1262,15 @@ template <class ForwardIt>
 typename deque<T, Alloc>::iterator
 deque<T, Alloc>::range_insert(const_iterator pos, ForwardIt first, 
                               ForwardIt last, forward_iterator_tag) {
+    iterator res = mutable_iterator(pos);
     if(first == last)
-        return pos;
+        return res;
     
-    size_type n = distance(first, last);
-    iterator res = pos;
+    size_type n = MiniSTL::distance(first, last);
     if(pos.cur == start.cur) {
         iterator new_start = reserve_element_at_front(n);
         try {
-            uninitialized_copy(first, last, new_start);
+            MiniSTL::uninitialized_copy(first, last, new_start);
             start = new_start;
             res = new_start;
         } catch(std::exception&) {
@@ -1201,7 +1280,7 @@ deque<T, Alloc>::range_insert(const_iterator pos, ForwardIt first,
     } else if(pos.cur == finish.cur) {
         iterator new_finish = reserve_element_at_back(n);
         try {
-            uninitialized_copy(first, last, finish);
+            MiniSTL::uninitialized_copy(first, last, finish);
             res = finish;
             finish = new_finish;
         } catch(std::exception&) {
@@ -1218,14 +1297,15 @@ deque<T, Alloc>::range_insert(const_iterator pos, ForwardIt first,
 template <class T, class Alloc>
 typename deque<T, Alloc>::iterator 
 deque<T, Alloc>::erase(const_iterator pos) {
-    iterator next = pos;
+    iterator p = mutable_iterator(pos);
+    iterator next = p;
     ++next;
     difference_type idx = pos - start;
     if(static_cast<size_type>(idx) < size() / 2) {
-        copy_backward(start, pos, next);
+        MiniSTL::copy_backward(start, p, next);
         pop_front();
     } else {
-        copy(next, finish, pos);
+        MiniSTL::copy(next, finish, p);
         pop_back();
     }
     return start + idx;
@@ -1235,23 +1315,25 @@ deque<T, Alloc>::erase(const_iterator pos) {
 template <class T, class Alloc>
 typename deque<T, Alloc>::iterator 
 deque<T, Alloc>::erase(const_iterator first, const_iterator last) {
-    if(first == start && first == finish) {
+    if(first == start && last == finish) {
         clear();
         return finish;
     } else {
+        iterator f = mutable_iterator(first);
+        iterator l = mutable_iterator(last);
         difference_type n = last - first;
         difference_type elems_before = first - start;
-        if(elems_before < static_cast<difference_type>(size() - n) / 2) {
-            copy_backward(start, first, last);
+        if(elems_before < (static_cast<difference_type>(size()) - n) / 2) {
+            MiniSTL::copy_backward(start, f, l);
             iterator new_start = start + n;
-            destroy(start, new_start);
+            MiniSTL::destroy(start, new_start);
             destroy_nodes(start.node, new_start.node);
             start = new_start;
         } else {
-            copy(last, finish, first);
+            MiniSTL::copy(l, finish, f);
             iterator new_finish = finish - n;
-            destroy(new_finish, finish);
-            destroy_nodes(new_finish.node - 1, finish.node - 1);
+            MiniSTL::destroy(new_finish, finish);
+            destroy_nodes(new_finish.node + 1, finish.node + 1);
             finish = new_finish;
         }
         return start + elems_before;
@@ -1263,21 +1345,21 @@ deque<T, Alloc>::erase(const_iterator first, const_iterator last) {
 template <class T, class Alloc>
 void deque<T, Alloc>::clear() noexcept {
     // destroy nodes [start + 1, finish - 1]
-    for(T** cur = start.node + 1;cur != finish.node;++cur) {
-        destroy(*cur, *cur + buf_size());
+    for(T** cur = start.node + 1;cur < finish.node;++cur) {
+        MiniSTL::destroy(*cur, *cur + buf_size());
         deallocate_node(*cur);
     }
     if(start.node != finish.node) {
         // start and finish are not same node
         // destroy elements and dealloc finish
-        destroy(start.cur, start.last);
-        destroy(finish.first, finish.cur);
+        MiniSTL::destroy(start.cur, start.last);
+        MiniSTL::destroy(finish.first, finish.cur);
         deallocate_node(*(finish.node));
-        finish = start;
     } else {
         // same node, just destroy elements
-        destroy(start.cur, finish.cur);
+        MiniSTL::destroy(start.cur, finish.cur);
     }
+    finish = start;
 }
 
 } // MiniSTL
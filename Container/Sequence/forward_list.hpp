@@ -127,6 +127,7 @@ struct forward_list_iterator : public forward_list_iterator_base {
         : forward_list_iterator_base(static_cast<node_base*>(x)) {}
     forward_list_iterator(const iterator& x) 
         : forward_list_iterator_base(x.node)  {}
+    forward_list_iterator& operator=(const forward_list_iterator&) = default;
 
     reference operator*() const 
         { return static_cast<node_t*>(node)->data; }
@@ -147,7 +148,10 @@ struct forward_list_iterator : public forward_list_iterator_base {
 
 
 template <class T, class Allocator = simple_alloc<T>>
-class forward_list {
+class forward_list : protected alloc_base<forward_list_node<T>, Allocator> {
+private:
+    using base = alloc_base<forward_list_node<T>, Allocator>;
+
 public:
     // types alias
     using size_type = size_t;
@@ -162,16 +166,15 @@ public:
     using allocator_type = Allocator;
  
 protected:
-    using node_alloc = simple_alloc<forward_list_node<T>>;
     using node_t = forward_list_node<T>;
     using node_base = forward_list_node_base;
     
     // head does not need a data member
     forward_list_node_base head;
     
-    node_t* get_node() { return node_alloc::allocate(1); }
+    node_t* get_node() { return this->allocate_n(1); }
 
-    void put_node(node_t* p) { node_alloc::deallocate(p); }
+    void put_node(node_t* p) { this->deallocate_n(p, 1); }
 
     node_t* create_node(const T& val) {
         node_t* p = get_node();
@@ -187,7 +190,7 @@ protected:
     node_t* create_node(T&& val)  {
         node_t* p = get_node();
         try {
-            new (&p->data) T(std::forward(val));
+            new (&p->data) T(std::forward<T>(val));
         } catch(std::exception&) {
             put_node(p);
             throw;
@@ -196,34 +199,40 @@ protected:
     }
 
 public:
-    allocator_type get_allocator() const noexcept { return allocator_type(); }
+    allocator_type get_allocator() const noexcept { return base::get_allocator(); }
 
 public:
     // construct/copy/destroy:
     forward_list() { head.next = nullptr; }
 
-    explicit forward_list(size_type n) {
+    explicit forward_list(const allocator_type& a) : base(a) { head.next = nullptr; }
+
+    explicit forward_list(size_type n, const allocator_type& a = allocator_type()) 
+        : base(a) {
         head.next = nullptr;
-        insert_after_fill(static_cast<node_base*>(&head), n, T());
+        insert_after_fill(before_begin(), n, T());
     }
-    forward_list(size_type n, const T& val) {
+    forward_list(size_type n, const T& val, const allocator_type& a = allocator_type()) 
+        : base(a) {
         head.next = nullptr;
-        insert_after_fill(static_cast<node_base*>(&head), n, T());
+        insert_after_fill(before_begin(), n, val);
     }
     template <class InputIt>
-    forward_list(InputIt first, InputIt last) {
+    forward_list(InputIt first, InputIt last, const allocator_type& a = allocator_type()) 
+        : base(a) {
         head.next = nullptr;
-        insert_after_range(static_cast<node_base*>(&head), first, last);
+        insert_after_range(before_begin(), first, last);
     }
-    forward_list(const forward_list& x) {
+    forward_list(const forward_list& x) : base(x.get_allocator()) {
         head.next = nullptr;
-        insert_after_range(static_cast<node_base*>(&head), x.begin(), x.end());
+        insert_after_range(before_begin(), x.begin(), x.end());
     }
-    forward_list(forward_list&& x) {
+    forward_list(forward_list&& x) : base(x.get_allocator()) {
         head = x.head;
         x.head.next = nullptr;
     }
-    forward_list(std::initializer_list<T> ilist) {
+    forward_list(std::initializer_list<T> ilist, const allocator_type& a = allocator_type()) 
+        : base(a) {
         head.next = nullptr;
         insert_after_range(before_begin(), ilist.begin(), ilist.end());
     }
@@ -234,16 +243,42 @@ public:
 
     forward_list& operator=(const forward_list& x);
     forward_list& operator=(forward_list&& x) {
-        if(&x != this) {
-            clear();
-            swap(x);
-        }
+        if(&x != this)
+            move_assign(x, typename base::propagate_on_move());
         return *this;
-
     }
 
     forward_list& operator=(std::initializer_list<T>);
 
+protected:
+    // head lives in the list itself, so an allocator can be
+    // replaced as soon as all nodes are gone
+    void copy_assign_alloc(const forward_list& x, true_type) {
+        if(!this->alloc_equal(x))
+            clear();
+        this->copy_alloc(x, true_type());
+    }
+
+    void copy_assign_alloc(const forward_list&, false_type) {}
+
+    void move_assign(forward_list& x, true_type) {
+        clear();
+        this->copy_alloc(x, true_type());
+        MiniSTL::swap(head.next, x.head.next);
+    }
+
+    // nodes can only be taken from an equal allocator, 
+    // otherwise elements are copied into our own nodes
+    void move_assign(forward_list& x, false_type) {
+        if(this->alloc_equal(x)) {
+            clear();
+            MiniSTL::swap(head.next, x.head.next);
+        } else {
+            *this = x;
+            x.clear();
+        }
+    }
+
 public:
     //assign
     template <class InputIt>
@@ -274,9 +309,8 @@ public:
         return iterator(static_cast<node_t*>(&head));
     }
     const_iterator  before_begin() const noexcept {
-        // wrong : const_iterator(static_cast<node_t*>(&head))
-        // because &head is const node_base*, cannot cast away const qualifier
-        const_iterator(before_begin());
+        // &head is const node_base*, the const_iterator takes a node_t*
+        return const_iterator(static_cast<node_t*>(const_cast<node_base*>(&head)));
     }
     iterator        begin() noexcept {
         return iterator(static_cast<node_t*>(head.next));
@@ -330,7 +364,7 @@ public:
         insert_after(before_begin(), val);
     }
     void push_front(T&& val) {
-        insert_after(before_begin(), std::forward(val));
+        insert_after(before_begin(), std::forward<T>(val));
     }
     void pop_front() {
         erase_after(before_begin());
@@ -349,7 +383,7 @@ public:
     iterator insert_after(const_iterator pos, T&& val) {
         return iterator(static_cast<node_t*>(__make_link(
            static_cast<node_base*>(pos.node), 
-           create_node(std::forward(val)))));
+           create_node(std::forward<T>(val)))));
     }
  
     iterator insert_after(const_iterator pos, size_type n, const T& val) {
@@ -358,7 +392,7 @@ public:
 
     // return iterator pointing to the last element inserted
     template <class InputIt>
-    iterator insert_after_range(iterator pos, 
+    iterator insert_after_range(const_iterator pos, 
                             InputIt first, InputIt last) {
         return insert_after_range(pos, first, last,            
                                   integral<InputIt>());
@@ -371,10 +405,10 @@ public:
     }
 
 protected:
-    iterator insert_after_fill(iterator pos,
+    iterator insert_after_fill(const_iterator pos,
                            size_type n, const value_type& val) {
         if(n == 0)
-            return pos;
+            return iterator(static_cast<node_t*>(pos.node));
         node_base* cur = static_cast<node_base*>(pos.node);
         for(size_type i = 0; i < n; ++i)
             cur = __make_link(cur, create_node(val));
@@ -382,17 +416,17 @@ protected:
     }
 
     template <class Integer>
-    iterator insert_after_range(iterator pos, Integer n, 
+    iterator insert_after_range(const_iterator pos, Integer n, 
                                 Integer val, true_type) {
         return insert_after_fill(pos, static_cast<size_type>(n), 
                                  static_cast<T>(val));
     }
 
     template <class InputIt>
-    iterator insert_after_range(iterator pos, InputIt first, 
+    iterator insert_after_range(const_iterator pos, InputIt first, 
                                 InputIt last, false_type) {
         if(first == last)
-            return pos;
+            return iterator(static_cast<node_t*>(pos.node));
         node_base* cur = static_cast<node_base*>(pos.node);
         while (first != last) {
             cur = __make_link(cur, create_node(*first));
@@ -411,10 +445,10 @@ public:
         prev->next = cur->next;
         destroy(&(static_cast<node_t*>(cur)->data));
         put_node(static_cast<node_t*>(cur));
-        return iterator(prev->next);
+        return iterator(static_cast<node_t*>(prev->next));
     }
 
-    iterator erase_after(const_iterator pos, iterator last) {
+    iterator erase_after(const_iterator pos, const_iterator last) {
         node_base* prev = static_cast<node_base*>(pos.node);
         node_base* cur = prev->next;
         node_base* last1 = static_cast<node_base*>(last.node);
@@ -424,10 +458,11 @@ public:
             put_node(static_cast<node_t*>(cur));
             cur = prev->next;
         }
-        return last;
+        return iterator(static_cast<node_t*>(last1));
     }
 
     void swap(forward_list& x) {
+        this->swap_alloc(x, typename base::propagate_on_swap());
         MiniSTL::swap(head.next, x.head.next);
     }
 
@@ -566,6 +601,7 @@ forward_list<T, Alloc>& forward_list<T, Alloc>::operator=(const forward_list& x)
         // forward_list tmp(x);
         // this->swap(tmp);
 
+        copy_assign_alloc(x, typename base::propagate_on_copy());
         // prev for erase_after and insert_after
         iterator prev = before_begin(); 
         iterator first1 = begin();
@@ -577,7 +613,7 @@ forward_list<T, Alloc>& forward_list<T, Alloc>::operator=(const forward_list& x)
             *first1++ = *first2++;
         }
         if(first2 == last2)
-            erase_after(prev, last2);
+            erase_after(prev, end());
         else
             insert_after_range(prev, first2, last2);
     }
@@ -588,15 +624,15 @@ template <class T, class Alloc>
 forward_list<T, Alloc>& forward_list<T, Alloc>::operator=(std::initializer_list<T> ilist) {
     iterator prev = before_begin();
     iterator first1 = begin();
-    const_iterator first2 = ilist.begin();
+    const T* first2 = ilist.begin();
     iterator last1 = end();
-    const_iterator last2 = ilist.end();
+    const T* last2 = ilist.end();
     while(first1 != last1 && first2 != last2) {
         prev = first1;
         *first1++ = *first2++;
     }
     if(first2 == last2)
-        erase_after(prev, last2);
+        erase_after(prev, end());
     else
         insert_after_range(prev, first2, last2);
     return *this;
@@ -835,7 +871,8 @@ void forward_list<T, Alloc>::sort() {
 
     for (int i = 1; i < fill; ++i) 
         counter[i].merge(counter[i-1]);
-    swap(counter[fill-1]);
+    // splice rather than swap, nodes stay with the allocator of this list
+    splice_after(before_begin(), counter[fill-1]);
 }
     
 template <class T, class Alloc>
@@ -861,7 +898,7 @@ void forward_list<T, Alloc>::sort(Compare comp) {
 
     for (int i = 1; i < fill; ++i) 
         counter[i].merge(counter[i-1], comp);
-    swap(counter[fill-1]);
+    splice_after(before_begin(), counter[fill-1]);
 }
  
 template <class T, class Alloc>
@@ -116,7 +116,10 @@ struct const_list_iterator {
 };
 
 template <class T, class Allocator = simple_alloc<T>>
-class list {
+class list : protected alloc_base<list_node<T>, Allocator> {
+private:
+    using base = alloc_base<list_node<T>, Allocator>;
+
 public:
     // types alias
     using size_type = size_t;
@@ -133,7 +136,6 @@ public:
     using allocator_type = Allocator;
 
 protected:
-    using node_alloc = simple_alloc<list_node<T>>;
     using node_t = list_node<T>;
     node_t* dummy;
 
@@ -143,9 +145,9 @@ protected:
         dummy->next = dummy;
     }
 
-    node_t* get_node() { return node_alloc::allocate(1); }
+    node_t* get_node() { return this->allocate_n(1); }
 
-	void put_node(node_t* p) { node_alloc::deallocate(p); }
+	void put_node(node_t* p) { this->deallocate_n(p, 1); }
 
 	node_t* create_node(const T& val) {
         node_t* p = get_node();
@@ -161,7 +163,7 @@ protected:
     node_t* create_node(T&& val)  {
         node_t* p = get_node();
         try {
-            new (&p->data) T(std::forward(val));
+            new (&p->data) T(std::forward<T>(val));
         } catch(std::exception&) {
             put_node(p);
             throw;
@@ -170,24 +172,29 @@ protected:
     }
     
 public:
-    allocator_type get_allocator() const noexcept { return allocator_type(); }
+    allocator_type get_allocator() const noexcept { return base::get_allocator(); }
 
 public:
     // construct/copy/destroy:
     list() { initialize(); }
 
-    explicit list(size_type n) {
+    explicit list(const allocator_type& a) : base(a) { initialize(); }
+
+    explicit list(size_type n, const allocator_type& a = allocator_type()) 
+        : base(a) {
         initialize();
         insert(begin(), n, T());
     }
 
-    list(size_type n, const T& val) {
+    list(size_type n, const T& val, const allocator_type& a = allocator_type()) 
+        : base(a) {
         initialize();
         insert(begin(), n, val);
     }
 
     template <class InputIt>
-    list(InputIt first, InputIt last) {
+    list(InputIt first, InputIt last, const allocator_type& a = allocator_type()) 
+        : base(a) {
         initialize();
         // no need for dispatch here, insert does all of that anyway
         insert(begin(), first, last);
@@ -195,19 +202,20 @@ public:
 
     // ? move semantic for container:
     // ? after move, x is empty initialized or x is null
-    list(list&& x) {
+    list(list&& x) : base(x.get_allocator()) {
         initialize();
-        swap(x);
+        MiniSTL::swap(dummy, x.dummy);
         // dummy = x.dummy;
         // x.dummy = nullptr;
     }
 
-    list(const list& x) {
+    list(const list& x) : base(x.get_allocator()) {
         initialize();
         insert(begin(), x.begin(), x.end());
     }
 
-    list(std::initializer_list<T> ilist) {
+    list(std::initializer_list<T> ilist, const allocator_type& a = allocator_type()) 
+        : base(a) {
         initialize();
         insert(begin(), ilist.begin(), ilist.end());
     }
@@ -220,15 +228,49 @@ public:
     list& operator=(const list& x);
 
     list& operator=(list&& x) {
-        if(&x != this) {
-            clear();
-            swap(x);
-        }
+        if(&x != this)
+            move_assign(x, typename base::propagate_on_move());
         return *this;
     }
 
     list& operator=(std::initializer_list<T> ilist);
 
+protected:
+    // dummy belongs to the allocator, so it is rebuilt when
+    // an unequal allocator takes over
+    void replace_alloc(const list& x) {
+        if(!this->alloc_equal(x)) {
+            clear();
+            put_node(dummy);
+            this->copy_alloc(x, true_type());
+            initialize();
+        } else {
+            this->copy_alloc(x, true_type());
+        }
+    }
+
+    void copy_assign_alloc(const list& x, true_type) { replace_alloc(x); }
+
+    void copy_assign_alloc(const list&, false_type) {}
+
+    void move_assign(list& x, true_type) {
+        clear();
+        replace_alloc(x);
+        MiniSTL::swap(dummy, x.dummy);
+    }
+
+    // nodes can only be taken from an equal allocator, 
+    // otherwise elements are copied into our own nodes
+    void move_assign(list& x, false_type) {
+        if(this->alloc_equal(x)) {
+            clear();
+            MiniSTL::swap(dummy, x.dummy);
+        } else {
+            *this = x;
+            x.clear();
+        }
+    }
+
 public:
     template <class InputIt>
     void assign(InputIt first, InputIt last) {
@@ -327,10 +369,10 @@ public:
     }
 
     void push_front(const T& val) { insert(begin(), val); }
-    void push_front(T&& val) { insert(begin(), std::forward(val)); }
+    void push_front(T&& val) { insert(begin(), std::forward<T>(val)); }
 
     void push_back(const T& val) { insert(end(), val); }
-    void push_back(T&& val) { insert(end(), std::forward(val)); }
+    void push_back(T&& val) { insert(end(), std::forward<T>(val)); }
     void pop_back() { erase(--end()); }
  
     template <class... Args> 
@@ -343,7 +385,10 @@ public:
     iterator erase(const_iterator pos);
     iterator erase(const_iterator first, const_iterator last);
 
-    void swap(list& y){ MiniSTL::swap(dummy, y.dummy); }
+    void swap(list& y){ 
+        this->swap_alloc(y, typename base::propagate_on_swap());
+        MiniSTL::swap(dummy, y.dummy); 
+    }
 
     void clear() noexcept;
 
@@ -490,6 +535,7 @@ list<T, Alloc>& list<T, Alloc>::operator=(const list& x) {
     if(&x != this) {
         // list tmp(x);
         // this->swap(tmp);
+        copy_assign_alloc(x, typename base::propagate_on_copy());
         iterator first1 = begin();
         const_iterator first2 = x.begin();
         iterator last1 = end();
@@ -497,7 +543,7 @@ list<T, Alloc>& list<T, Alloc>::operator=(const list& x) {
         while(first1 != last1 && first2 != last2)
             *first1++ = *first2++;
         if(first2 == last2)
-            erase(first1, last2);
+            erase(first1, last1);
         else
             insert(last1, first2, last2);
     }
@@ -507,13 +553,13 @@ list<T, Alloc>& list<T, Alloc>::operator=(const list& x) {
 template <class T, class Alloc>
 list<T, Alloc>& list<T, Alloc>::operator=(std::initializer_list<T> ilist) {
     iterator first1 = begin();
-    iterator first2 = ilist.begin();
+    const T* first2 = ilist.begin();
     iterator last1 = end();
-    iterator last2 = ilist.end();
+    const T* last2 = ilist.end();
     while(first1 != last1 && first2 != last2)
         *first1++ = *first2++;
     if(first2 == last2)
-        erase(first1, last2);
+        erase(first1, last1);
     else
         insert(last1, first2, last2);
     return *this;
@@ -559,7 +605,7 @@ list<T, Alloc>::erase(const_iterator pos) {
     node_t* next = pos.node->next;
     prev->next = next;
     next->prev = prev;
-    destory(&pos.node->data);
+    destroy(&pos.node->data);
     put_node(pos.node);
     return iterator(next);
 }
@@ -569,7 +615,7 @@ typename list<T, Alloc>::iterator
 list<T, Alloc>::erase(const_iterator first, const_iterator last) {
     while(first != last)
         erase(first++);
-    return iterator(last);
+    return iterator(last.node);
 }
 
 template <class T, class Alloc>
@@ -579,7 +625,7 @@ void list<T, Alloc>::clear() noexcept {
         node_t* tmp = cur;
         cur = cur->next;
         destroy(&tmp->data);
-        put_node(cur);
+        put_node(tmp);
     }
     dummy->next = dummy->prev = dummy;
 }
@@ -598,7 +644,7 @@ list<T, Alloc>::insert(const_iterator pos, const T& val) {
 template <class T, class Alloc>
 typename list<T, Alloc>::iterator 
 list<T, Alloc>::insert(const_iterator pos, T&& val) {
-    node_t* tmp = create_node(std::forward(val));
+    node_t* tmp = create_node(std::forward<T>(val));
     tmp->next = pos.node;
     tmp->prev = pos.node->prev;
     pos.node->prev = tmp;
@@ -832,7 +878,8 @@ void list<T, Alloc>::sort() {
 
     for (int i = 1; i < fill; ++i) 
         counter[i].merge(counter[i-1]);
-    swap(counter[fill-1]);
+    // splice rather than swap, each dummy stays with its own list
+    splice(end(), counter[fill-1]);
 }
     
 template <class T, class Alloc>
@@ -858,7 +905,7 @@ void list<T, Alloc>::sort(Compare comp) {
 
     for (int i = 1; i < fill; ++i) 
         counter[i].merge(counter[i-1], comp);
-    swap(counter[fill-1]);
+    splice(end(), counter[fill-1]);
 }
  
 template <class T, class Alloc>
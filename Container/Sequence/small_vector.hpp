@@ -0,0 +1,288 @@
+#pragma once
+
+#include "Container/Sequence/vector.hpp"
+
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+
+namespace MiniSTL {
+
+// Allocator of small_vector, holds a pointer to the inline buffer of
+// its small_vector and forwards everything else to Allocator.
+// Implementation properties:
+//      1. It never hands the inline buffer out, small_vector keeps its
+//      capacity >= N so vector only asks for buffers bigger than N.
+//      2. deallocate ignores the inline buffer, and reallocate out of it
+//      copies into a new buffer from Allocator, so vector may free or
+//      grow its storage as usual.
+//      3. Two of them compare equal only for the same buffer, so they
+//      never propagate.
+template <class T, size_t N, class Allocator>
+class small_buffer_alloc : private alloc_base<T, Allocator> {
+    template <class U, size_t M, class A> friend class small_buffer_alloc;
+
+private:
+    using base = alloc_base<T, Allocator>;
+
+    T* buf;
+
+public:
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+
+    using propagate_on_container_copy_assignment = false_type;
+    using propagate_on_container_move_assignment = false_type;
+    using propagate_on_container_swap = false_type;
+
+    template <class U> struct rebind {
+        typedef small_buffer_alloc<U, N, Allocator> other;
+    };
+
+    small_buffer_alloc(T* b, const Allocator& a) : base(a), buf(b) {}
+    small_buffer_alloc(const small_buffer_alloc& x) : base(x.upstream()), buf(x.buf) {}
+    template <class U>
+    small_buffer_alloc(const small_buffer_alloc<U, N, Allocator>& x)
+        : base(x.upstream()), buf(nullptr) {}
+
+    small_buffer_alloc& operator=(const small_buffer_alloc& x) {
+        buf = x.buf;
+        return *this;
+    }
+
+    T* allocate(size_type n, const void* = 0) {
+        return this->allocate_n(n);
+    }
+
+    void deallocate(pointer p, size_type n) {
+        if(p != buf)
+            this->deallocate_n(p, n);
+    }
+
+    // moves bytes, so only for relocatable T
+    T* reallocate(pointer p, size_type old_n, size_type new_n) {
+        if(p != buf)
+            return this->reallocate_n(p, old_n, new_n);
+        T* res = this->allocate_n(new_n);
+        memcpy(static_cast<void*>(res), static_cast<const void*>(p),
+               (old_n < new_n ? old_n : new_n) * sizeof(T));
+        return res;
+    }
+
+    size_type max_size() const noexcept {
+        return size_t(-1) / sizeof(T);
+    }
+
+    Allocator upstream() const { return base::get_allocator(); }
+
+    // buffers from x may be freed by us
+    bool same_upstream(const small_buffer_alloc& x) const {
+        return this->alloc_equal(x);
+    }
+
+    bool operator==(const small_buffer_alloc& x) const noexcept {
+        return buf == x.buf;
+    }
+
+    bool operator!=(const small_buffer_alloc& x) const noexcept {
+        return buf != x.buf;
+    }
+};
+
+
+// vector which keeps up to N elements inline and spills to Allocator
+// beyond that
+// Implementation properties:
+//      1. It is a vector whose storage starts as the inline buffer with
+//      capacity N, every algorithm of vector works on it unchanged. The
+//      first growth past N moves elements to a heap buffer, later ones
+//      grow that buffer as vector does.
+//      2. Capacity never drops below N. shrink_to_fit and clear of a
+//      spilled small_vector keep the heap buffer, except that
+//      shrink_to_fit with size() <= N moves back to the inline buffer.
+//      3. Moving a spilled small_vector steals its heap buffer, moving an
+//      inline one moves at most N elements. Either way the source ends
+//      empty and inline.
+// A small_vector points into itself and must not be relocatable.
+template <class T, size_t N, class Allocator = simple_alloc<T>,
+          class Growth = growth_factor_2>
+class small_vector
+    : public vector<T, small_buffer_alloc<T, N, Allocator>, Growth> {
+    static_assert(N > 0, "small_vector needs an inline capacity");
+
+private:
+    using base = vector<T, small_buffer_alloc<T, N, Allocator>, Growth>;
+    using buffer_alloc = small_buffer_alloc<T, N, Allocator>;
+
+public:
+    using allocator_type = Allocator;
+    using size_type = typename base::size_type;
+    using iterator = typename base::iterator;
+    using const_iterator = typename base::const_iterator;
+
+    static constexpr size_type inline_capacity() { return N; }
+
+private:
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage;
+
+    T* inline_buf() noexcept { return reinterpret_cast<T*>(&storage); }
+    const T* inline_buf() const noexcept {
+        return reinterpret_cast<const T*>(&storage);
+    }
+
+    // storage of base is the empty inline buffer
+    void reset_inline() noexcept {
+        this->start = this->finish = inline_buf();
+        this->end_of_storage = inline_buf() + N;
+    }
+
+    // move elements of x into our empty storage, x ends empty
+    void move_elements(small_vector& x) {
+        this->reserve(x.size());
+        for(iterator it = x.begin();it != x.end();++it)
+            this->push_back(std::move(*it));
+        x.clear();
+    }
+
+    // take over x's heap buffer if we can free it, else its elements
+    void move_from(small_vector& x) {
+        if(x.is_inline() || !this->get_node_allocator().same_upstream(x.get_node_allocator())) {
+            move_elements(x);
+        } else {
+            this->start = x.start;
+            this->finish = x.finish;
+            this->end_of_storage = x.end_of_storage;
+            x.reset_inline();
+        }
+    }
+
+public:
+    allocator_type get_allocator() const {
+        return this->get_node_allocator().upstream();
+    }
+
+    // elements are in the inline buffer
+    bool is_inline() const noexcept { return this->start == inline_buf(); }
+
+public:
+// ctor and dtor
+    small_vector() : base(buffer_alloc(inline_buf(), allocator_type())) {
+        reset_inline();
+    }
+
+    explicit small_vector(const allocator_type& a)
+        : base(buffer_alloc(inline_buf(), a)) {
+        reset_inline();
+    }
+
+    small_vector(size_type count, const T& val,
+                 const allocator_type& a = allocator_type())
+        : base(buffer_alloc(inline_buf(), a)) {
+        reset_inline();
+        this->assign(count, val);
+    }
+
+    explicit small_vector(size_type count,
+                          const allocator_type& a = allocator_type())
+        : base(buffer_alloc(inline_buf(), a)) {
+        reset_inline();
+        this->resize(count);
+    }
+
+    template <class InputIt>
+    small_vector(InputIt first, InputIt last,
+                 const allocator_type& a = allocator_type())
+        : base(buffer_alloc(inline_buf(), a)) {
+        reset_inline();
+        this->assign(first, last);
+    }
+
+    small_vector(std::initializer_list<T> ilist,
+                 const allocator_type& a = allocator_type())
+        : base(buffer_alloc(inline_buf(), a)) {
+        reset_inline();
+        this->assign(ilist);
+    }
+
+    small_vector(const small_vector& x)
+        : base(buffer_alloc(inline_buf(), x.get_allocator())) {
+        reset_inline();
+        this->insert(this->end(), x.begin(), x.end());
+    }
+
+    small_vector(small_vector&& x)
+        noexcept(std::is_nothrow_move_constructible<T>::value)
+        : base(buffer_alloc(inline_buf(), x.get_allocator())) {
+        reset_inline();
+        move_from(x);
+    }
+
+    // base destructor frees a heap buffer and ignores the inline one
+
+    small_vector& operator=(const small_vector& x) {
+        base::operator=(x);
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& x) {
+        if(&x != this) {
+            this->destroy_and_deallocate();
+            reset_inline();
+            move_from(x);
+        }
+        return *this;
+    }
+
+    small_vector& operator=(std::initializer_list<T> ilist) {
+        this->assign(ilist);
+        return *this;
+    }
+
+public:
+    void shrink_to_fit() {
+        if(is_inline())
+            return;
+        if(this->size() <= N) {
+            T* old_start = this->start;
+            T* old_finish = this->finish;
+            const size_type old_cap = this->capacity();
+            T* new_finish = MiniSTL::uninitialized_relocate(old_start, old_finish, inline_buf());
+            destroy_relocated(old_start, old_finish);
+            this->deallocate_n(old_start, old_cap);
+            reset_inline();
+            this->finish = new_finish;
+        } else {
+            base::shrink_to_fit();
+        }
+    }
+
+    void swap(small_vector& x) {
+        if(&x == this)
+            return;
+        if(!is_inline() && !x.is_inline()
+           && this->get_node_allocator().same_upstream(x.get_node_allocator())) {
+            MiniSTL::swap(this->start, x.start);
+            MiniSTL::swap(this->finish, x.finish);
+            MiniSTL::swap(this->end_of_storage, x.end_of_storage);
+        } else {
+            small_vector tmp(std::move(x));
+            x = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+};
+
+template <class T, size_t N, class Alloc, class Growth>
+inline void swap(small_vector<T, N, Alloc, Growth>& lhs,
+                 small_vector<T, N, Alloc, Growth>& rhs) {
+    lhs.swap(rhs);
+}
+
+} // MiniSTL
@@ -0,0 +1,157 @@
+#include <cstdio>
+
+#include "Container/Sequence/forward_list.hpp"
+#include "Allocator/test_alloc.hpp"
+
+/*  build: g++ -std=c++11 -O2 -I. Container/Sequence/test_forward_list.cpp
+ *  run:   ./a.out, exits with 1 if a check fails
+ *
+ *  copy, move and swap of forward_list with stateful allocators, one
+ *  which propagates on copy assignment, move assignment and swap and
+ *  one which does not. test_alloc aborts if a node is freed by an
+ *  allocator other than its own, and every node must be freed at the end.
+ */
+
+using namespace MiniSTL;
+
+using pocs_alloc = test_alloc<int, true_type>;
+using fixed_alloc = test_alloc<int, false_type>;
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if(!ok) {
+        printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// l holds first, first + 1, ... first + n - 1 in order
+template <class List>
+bool holds(const List& l, int first, int n) {
+    typename List::const_iterator it = l.begin();
+    for(int i = 0;i < n;++i, ++it) {
+        if(it == l.end() || *it != first + i)
+            return false;
+    }
+    return it == l.end();
+}
+
+template <class List>
+void fill(List& l, int first, int n) {
+    l.clear();
+    for(int i = first + n;i-- > first;)
+        l.push_front(i);
+}
+
+// propagates: Alloc propagates on copy and move assignment
+template <class Alloc, bool propagates>
+void test_copy() {
+    using list_t = forward_list<int, Alloc>;
+    list_t a{Alloc(1)};
+    fill(a, 0, 100);
+    list_t b(a);
+    check(b.get_allocator() == a.get_allocator(), "copy constructor copies the allocator");
+    check(holds(a, 0, 100) && holds(b, 0, 100), "copy constructor");
+
+    // assignment from a longer, a shorter and an empty list
+    list_t c{Alloc(2)};
+    fill(c, 50, 10);
+    c = a;
+    check(holds(c, 0, 100), "copy assignment from a longer list");
+    list_t d{Alloc(2)};
+    fill(d, 50, 300);
+    d = a;
+    check(holds(d, 0, 100), "copy assignment from a shorter list");
+    list_t e{Alloc(2)};
+    d = e;
+    check(d.empty(), "copy assignment from an empty list");
+    check((c.get_allocator() == a.get_allocator())
+          == propagates,
+          "copy assignment propagates as the allocator says");
+    a = a;
+    check(holds(a, 0, 100), "self copy assignment");
+    c.push_front(-1);
+    check(holds(a, 0, 100), "copies are independent");
+
+    a = {1, 2, 3};
+    check(holds(a, 1, 3), "assignment from a shorter initializer_list");
+    a = {0, 1, 2, 3, 4};
+    check(holds(a, 0, 5), "assignment from a longer initializer_list");
+}
+
+template <class Alloc, bool propagates>
+void test_move() {
+    using list_t = forward_list<int, Alloc>;
+    list_t a{Alloc(3)};
+    fill(a, 0, 100);
+    list_t b(std::move(a));
+    check(a.empty() && holds(b, 0, 100), "move constructor");
+    fill(a, 7, 3);
+    check(holds(a, 7, 3), "moved-from list takes inserts");
+
+    // equal allocators, nodes are taken
+    list_t c{Alloc(3)};
+    fill(c, 0, 5);
+    c = std::move(b);
+    check(b.empty() && holds(c, 0, 100), "move assignment, equal allocators");
+
+    // unequal allocators, taken if they propagate, copied otherwise
+    list_t d{Alloc(4)};
+    fill(d, 0, 5);
+    d = std::move(c);
+    check(holds(d, 0, 100) && c.empty(), "move assignment, unequal allocators");
+    check((d.get_allocator() == Alloc(3))
+          == propagates,
+          "move assignment propagates as the allocator says");
+    fill(c, 1, 2);
+    check(holds(c, 1, 2), "moved-from list takes inserts after move assignment");
+}
+
+void test_swap() {
+    using list_t = forward_list<int, pocs_alloc>;
+    list_t a{pocs_alloc(5)};
+    list_t b{pocs_alloc(6)};
+    fill(a, 0, 100);
+    fill(b, 200, 3);
+    a.swap(b);
+    check(holds(a, 200, 3) && holds(b, 0, 100), "swap swaps the elements");
+    check(a.get_allocator().id == 6 && b.get_allocator().id == 5,
+          "swap swaps the allocators");
+    swap(a, b);
+    fill(a, 0, 10);
+    fill(b, 0, 20);
+    check(holds(a, 0, 10) && holds(b, 0, 20), "inserts after swap");
+
+    // equal allocators which do not propagate
+    forward_list<int, fixed_alloc> c{fixed_alloc(5)};
+    forward_list<int, fixed_alloc> d{fixed_alloc(5)};
+    fill(c, 0, 4);
+    c.swap(d);
+    check(c.empty() && holds(d, 0, 4), "swap, equal allocators");
+}
+
+template <class Alloc>
+bool leaked() {
+    bool result = false;
+    for(int i = 0;i < Alloc::MAX_ID;++i) {
+        if(Alloc::blocks(i) != 0) {
+            printf("FAILED: %zu nodes of allocator %d leaked\n", Alloc::blocks(i), i);
+            result = true;
+        }
+    }
+    return result;
+}
+
+int main() {
+    test_copy<pocs_alloc, true>();
+    test_copy<fixed_alloc, false>();
+    test_move<pocs_alloc, true>();
+    test_move<fixed_alloc, false>();
+    test_swap();
+    if(leaked<pocs_alloc>() || leaked<fixed_alloc>())
+        ++failures;
+    if(failures == 0)
+        printf("ok\n");
+    return failures != 0;
+}
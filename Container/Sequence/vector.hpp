@@ -9,15 +9,75 @@
 #include <initializer_list>
 #include <utility>
 #include <exception>
+#include <stdexcept>
 
 
 namespace MiniSTL {
 
-// use standard-conforming allocator that has no alloc member
-// so use static class function
-template <class T, class Allocator = simple_alloc<T>>
-class vector {
+// Growth policies of vector
+// When a vector of capacity cap must hold n > cap elements of sz bytes,
+// it reallocates to next_capacity(cap, n, sz) elements, which is >= n.
+// A bigger factor means fewer reallocations and more unused capacity.
+
+// capacity doubles
+struct growth_factor_2 {
+    static size_t next_capacity(size_t cap, size_t n, size_t /* sz */) {
+        const size_t grown = cap != 0 ? 2 * cap : 1;
+        return grown > n ? grown : n;
+    }
+};
+
+// capacity grows by half, so at most 1/3 of a buffer is unused
+struct growth_factor_1_5 {
+    static size_t next_capacity(size_t cap, size_t n, size_t /* sz */) {
+        const size_t grown = cap + cap / 2 + 1;
+        return grown > n ? grown : n;
+    }
+};
+
+// capacity given by Growth, then rounded up to fill the block which
+// the allocator hands out anyway:
+//      1. buffer up to SizeClass::MAX_BYTES: its class size of default_alloc
+//      2. buffer from malloc heap: a whole malloc chunk, header excluded
+//      3. buffer above mmap threshold of malloc: whole pages, header excluded
+// Malloc numbers are those of glibc, other mallocs just get a bit more.
+template <class Growth = growth_factor_2, class SizeClass = default_size_class>
+struct size_class_growth {
+    enum {
+        MALLOC_ALIGN = 2 * sizeof(size_t),
+        MALLOC_HEADER = sizeof(size_t),
+        MMAP_HEADER = 2 * sizeof(size_t),
+        MMAP_THRESHOLD = 128 * 1024,
+        PAGE = 4096
+    };
+
+    static size_t round_up(size_t bytes, size_t align) {
+        return (bytes + align - 1) & ~(align - 1);
+    }
+
+    static size_t next_capacity(size_t cap, size_t n, size_t sz) {
+        size_t bytes = Growth::next_capacity(cap, n, sz) * sz;
+        if(bytes <= static_cast<size_t>(SizeClass::MAX_BYTES))
+            bytes = SizeClass::size(SizeClass::index(bytes));
+        else if(bytes < MMAP_THRESHOLD)
+            bytes = round_up(bytes + MALLOC_HEADER, MALLOC_ALIGN) - MALLOC_HEADER;
+        else
+            bytes = round_up(bytes + MMAP_HEADER, PAGE) - MMAP_HEADER;
+        return bytes / sz;
+    }
+};
+
+// allocator is held by alloc_base, an instanceless allocator
+// takes no space and is called through static functions.
+// Growth decides capacity on reallocation, see growth policies above.
+template <class T, class Allocator = simple_alloc<T>, 
+          class Growth = growth_factor_2>
+class vector : protected alloc_base<T, Allocator> {
+private:
+    using base = alloc_base<T, Allocator>;
+
 public:
+    using growth_policy = Growth;
     using value_type = T;
     using allocator_type = Allocator;
     using size_type	= size_t;
@@ -36,42 +96,47 @@ protected:
     T* finish;
     T* end_of_storage;
 
-protected:
-    using alloc = Allocator;
-    
 public:
-    allocator_type get_allocator() const { return allocator_type(); }
+    allocator_type get_allocator() const { return base::get_allocator(); }
 
 public: 
 // ctor and dtor
     vector() : start(nullptr), finish(nullptr), end_of_storage(nullptr) {}
 
-    vector(size_type count, const T& val) {
-        allocate_and_fill(start, count, val);
+    explicit vector(const allocator_type& a) 
+        : base(a), start(nullptr), finish(nullptr), end_of_storage(nullptr) {}
+
+    vector(size_type count, const T& val, 
+           const allocator_type& a = allocator_type()) : base(a) {
+        allocate_and_fill(count, val);
     }
 
-    explicit vector(size_type count) {
-        allocate_and_fill(start, count, T());
+    explicit vector(size_type count, 
+                    const allocator_type& a = allocator_type()) : base(a) {
+        allocate_and_fill(count, T());
     }
 
-    vector(const vector& other) {
-        start = allocate_and_copy(other.begin(), other.end());
+    vector(const vector& other) : base(other.get_allocator()) {
+        start = allocate_and_copy(other.size(), other.begin(), other.end());
         finish = end_of_storage = start + other.size();
     }
 
     template <class InputIt>
-    vector(InputIt first, InputIt last) {
+    vector(InputIt first, InputIt last, 
+           const allocator_type& a = allocator_type()) 
+        : base(a), start(nullptr), finish(nullptr), end_of_storage(nullptr) {
         initialize_aux(first, last, integral<InputIt>());
     }
     
-    vector(vector&& other) noexcept {
+    vector(vector&& other) noexcept : base(other.get_allocator()) {
         start = other.start;
         finish = other.finish;
         end_of_storage = other.end_of_storage;
         other.start = other.finish = other.end_of_storage = nullptr;
     }
 
-    vector(std::initializer_list<T> ilist) {
+    vector(std::initializer_list<T> ilist, 
+           const allocator_type& a = allocator_type()) : base(a) {
         start = allocate_and_copy(ilist.size(), ilist.begin(), ilist.end());
         finish = end_of_storage = start + ilist.size();
     }
@@ -81,37 +146,128 @@ public:
     }
 
 
-    vector& operator=(vector&);
+    vector& operator=(const vector&);
 
-    vector& operator=(vector&&) noexcept;
+    vector& operator=(vector&&);
 
     vector& operator=(std::initializer_list<T> ilist);
 
 protected:
 
     void allocate_and_fill(size_type n, const T& val) {
-        start = alloc::allocate(n);
+        start = this->allocate_n(n);
         end_of_storage = start + static_cast<difference_type>(n);
-        finish = uninitialized_fill_n(start, n, val);
+        finish = MiniSTL::uninitialized_fill_n(start, n, val);
     }
 
     template <class ForwardIt>
     iterator allocate_and_copy(size_type n, ForwardIt first, ForwardIt last) {
-        iterator result = alloc::allocate(n);
-        uninitialized_copy(first, last, result);
+        iterator result = this->allocate_n(n);
+        MiniSTL::uninitialized_copy(first, last, result);
         return result;
     }
 
     void destroy_and_deallocate() noexcept {
-        destroy(start, end_of_storage);
-        alloc::deallocate(start, end_of_storage - start);
+        MiniSTL::destroy(start, finish);
+        this->deallocate_n(start, end_of_storage - start);
+    }
+
+    // capacity to hold n more elements, given by growth policy
+    size_type grow_capacity(size_type n) const {
+        return Growth::next_capacity(capacity(), size() + n, sizeof(T));
+    }
+
+    // resize storage to new_cap >= size() elements
+    // Relocatable elements may move bitwise, so storage is resized by
+    // reallocate of allocator, which can grow a buffer in place(e.g.
+    // glibc realloc, by mremap for huge buffers) instead of copying it.
+    void reallocate_storage(size_type new_cap) {
+        reallocate_storage_aux(new_cap, relocatable_t<T>());
+    }
+
+    void reallocate_storage_aux(size_type new_cap, true_type) {
+        const size_type sz = size();
+        start = this->reallocate_n(start, capacity(), new_cap);
+        finish = start + sz;
+        end_of_storage = start + new_cap;
+    }
+
+    void reallocate_storage_aux(size_type new_cap, false_type) {
+        relocate_storage(this->allocate_n(new_cap), new_cap, finish, 0);
+    }
+
+    // appending to relocatable elements grows storage by reallocate_storage
+    static bool realloc_growth(true_type) { return true; }
+    static bool realloc_growth(false_type) { return false; }
+
+    // move elements to new_start, a new buffer of new_cap elements,
+    // leaving a hole of n elements at pos which caller has filled already,
+    // then release old storage.
+    // Elements are relocated, see uninitialized_relocate. If that throws,
+    // the hole is destroyed, new_start freed and old storage kept.
+    void relocate_storage(iterator new_start, size_type new_cap, 
+                          iterator pos, size_type n) {
+        iterator hole = new_start + (pos - start);
+        iterator new_finish = new_start;
+        try {
+            new_finish = MiniSTL::uninitialized_relocate(start, pos, new_start);
+            new_finish = MiniSTL::uninitialized_relocate(pos, finish, hole + n);
+        } catch(std::exception&) {
+            MiniSTL::destroy(new_start, new_finish);
+            MiniSTL::destroy(hole, hole + n);
+            this->deallocate_n(new_start, new_cap);
+            throw;
+        }
+        destroy_relocated(start, finish);
+        this->deallocate_n(start, end_of_storage - start);
+        start = new_start;
+        finish = new_finish;
+        end_of_storage = new_start + new_cap;
+    }
+
+    // take the storage of x, x becomes empty
+    void take_storage(vector& x) noexcept {
+        start = x.start;
+        finish = x.finish;
+        end_of_storage = x.end_of_storage;
+        x.start = x.finish = x.end_of_storage = nullptr;
+    }
+
+    // allocator of x replaces ours on copy assignment if it propagates,
+    // storage got from our allocator must go first
+    void copy_assign_alloc(const vector& x, true_type) {
+        if(!this->alloc_equal(x)) {
+            destroy_and_deallocate();
+            start = finish = end_of_storage = nullptr;
+        }
+        this->copy_alloc(x, true_type());
+    }
+
+    void copy_assign_alloc(const vector&, false_type) {}
+
+    void move_assign(vector& x, true_type) {
+        destroy_and_deallocate();
+        this->copy_alloc(x, true_type());
+        take_storage(x);
+    }
+
+    // storage can only be taken from an equal allocator, 
+    // otherwise elements are copied into our own storage
+    void move_assign(vector& x, false_type) {
+        if(this->alloc_equal(x)) {
+            destroy_and_deallocate();
+            take_storage(x);
+        } else {
+            *this = x;
+            x.clear();
+        }
     }
 
     template <class Integer>
     void initialize_aux(Integer n, Integer val, true_type) {
-        start = alloc::allocate(n);
+        start = this->allocate_n(n);
         end_of_storage = start + n; 
-        finish = uninitialized_fill_n(start, n, val);
+        finish = MiniSTL::uninitialized_fill_n(start, n, val);
     }
 
     template <class InputIt>
@@ -127,11 +283,10 @@ protected:
 
     template <class ForwardIt>
     void range_initialize(ForwardIt first, ForwardIt last, forward_iterator_tag) {
-        size_type n = 0;
-        distance(first, last, n);
-        start = alloc::allocate(n);
+        const size_type n = MiniSTL::distance(first, last);
+        start = this->allocate_n(n);
         end_of_storage = start + n;
-        finish = uninitialized_copy(first, last, start);
+        finish = MiniSTL::uninitialized_copy(first, last, start);
     }
 
 public:
@@ -231,7 +386,13 @@ public:
         return UINT_MAX / sizeof(T);
     }
 
-    void reserve(size_type new_cap) {}
+    // capacity becomes exactly new_cap if it was less
+    void reserve(size_type new_cap) {
+        if(new_cap > max_size())
+            throw std::length_error("vector::reserve");
+        if(new_cap > capacity())
+            reallocate_storage(new_cap);
+    }
     
     size_type capacity() const noexcept {
         return static_cast<size_type>(end_of_storage - start);
@@ -239,8 +400,12 @@ public:
 
     void shrink_to_fit() {
         if(capacity() > size()) {
-            alloc::deallocate(finish, end_of_storage - finish);
-            end_of_storage = finish;
+            if(empty()) {
+                destroy_and_deallocate();
+                start = finish = end_of_storage = nullptr;
+            } else {
+                reallocate_storage(size());
+            }
         }
     }
 
@@ -256,18 +421,20 @@ public:
     }
     
     iterator erase(const_iterator pos) {
-        if(pos + 1 != end()) 
-            copy(pos + 1, finish, pos);
+        iterator p = start + (pos - cbegin());
+        if(p + 1 != end()) 
+            MiniSTL::copy(p + 1, finish, p);
         --finish;
-        destroy(finish);
-        return pos;
+        MiniSTL::destroy(finish);
+        return p;
     }
 
     iterator erase(const_iterator first, const_iterator last) {
-        iterator tmp = copy(last, finish, first);
-        destroy(tmp, finish);
-        finish -= (last - first);
-        return first;
+        iterator p = start + (first - cbegin());
+        iterator tmp = MiniSTL::copy(start + (last - cbegin()), finish, p);
+        MiniSTL::destroy(tmp, finish);
+        finish = tmp;
+        return p;
     }
 
     void push_back(const T& val) {
@@ -282,10 +449,10 @@ public:
     void push_back(T&& val) {
         if(finish != end_of_storage) {
             // construct(finish, val);
-            new (static_cast<void*>(finish)) T(std::forward(val));
+            new (static_cast<void*>(finish)) T(std::forward<T>(val));
             ++finish;
         } else {
-            insert_aux(finish, std::forward(val));
+            insert_aux(finish, std::forward<T>(val));
         }
     }
 
@@ -302,7 +469,7 @@ public:
 
     void pop_back() {
         --finish;
-        destroy(finish);
+        MiniSTL::destroy(finish);
     } 
 
     void resize(size_type new_sz) {
@@ -317,6 +484,7 @@ public:
     }
 
     void swap(vector& x) {
+        this->swap_alloc(x, typename base::propagate_on_swap());
         MiniSTL::swap(start, x.start);
         MiniSTL::swap(finish, x.finish);
         MiniSTL::swap(end_of_storage, x.end_of_storage);
@@ -329,27 +497,40 @@ public:
             construct(finish, val);
             ++finish;
         } else {
-            insert_aux(pos, val);
+            insert_aux(start + n, val);
         }
         return begin() + n;
     }
     	
     iterator insert(const_iterator pos, size_type n, const T& val) {
-        return fill_insert(pos, n, val);
+        const size_type off = pos - cbegin();
+        fill_insert(start + off, n, val);
+        return begin() + off;
     }
 
     template <class InputIt>
     iterator insert(const_iterator pos, InputIt first, InputIt last) {
-        insert_dispatch(pos, first, last, integral<InputIt>());
+        const size_type off = pos - cbegin();
+        insert_dispatch(start + off, first, last, integral<InputIt>());
+        return begin() + off;
     }
     
     iterator insert(const_iterator pos, T&& val) {
-        insert_aux(pos, std::forward(val));
+        const size_type off = pos - cbegin();
+        if(pos == end() && finish != end_of_storage) {
+            new (static_cast<void*>(finish)) T(std::move(val));
+            ++finish;
+        } else {
+            insert_aux(start + off, std::move(val));
+        }
+        return begin() + off;
     }
 
     iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
-        range_insert(pos, ilist.begin(), ilist.end(), 
+        const size_type off = pos - cbegin();
+        range_insert(start + off, ilist.begin(), ilist.end(), 
                         forward_iterator_tag());
+        return begin() + off;
     }
 
 protected:
@@ -379,109 +560,105 @@ protected:
 
 
 
-template<class T, class Alloc>
-inline bool operator==(const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs) {
+template <class T, class Alloc, class Growth>
+inline bool operator==(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs) {
     return lhs.size() == rhs.size() &&
-            equal(lhs.begin(), lhs.end(), rhs.begin());
+            MiniSTL::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template<class T, class Alloc>
-inline bool operator!=(const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs){
+template <class T, class Alloc, class Growth>
+inline bool operator!=(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs){
     return !(lhs == rhs);
 }
 
-template<class T, class Alloc>
-inline bool operator<(const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs) {
-    return lexicographical_compare(lhs.begin(), lhs.end(),
+template <class T, class Alloc, class Growth>
+inline bool operator<(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs) {
+    return MiniSTL::lexicographical_compare(lhs.begin(), lhs.end(),
                                    rhs.begin(), rhs.end());
 }
 
-template<class T, class Alloc>
-inline bool operator<=(const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs) {
+template <class T, class Alloc, class Growth>
+inline bool operator<=(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs) {
     return !(rhs < lhs);
 }
 
-template<class T, class Alloc>
-inline bool operator>(const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs) {
+template <class T, class Alloc, class Growth>
+inline bool operator>(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs) {
     return rhs < lhs;
 }
 
-template<class T, class Alloc>
-inline bool operator>=(const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs) {
+template <class T, class Alloc, class Growth>
+inline bool operator>=(const vector<T, Alloc, Growth>& lhs, const vector<T, Alloc, Growth>& rhs) {
     return !(lhs < rhs);
 }
-template< class T, class Alloc >
-inline void swap(vector<T,Alloc>& lhs, vector<T,Alloc>& rhs) {
+template <class T, class Alloc, class Growth>
+inline void swap(vector<T, Alloc, Growth>& lhs, vector<T, Alloc, Growth>& rhs) {
     lhs.swap(rhs);
 }
 
-template<class T, class Alloc>
-vector<T, Alloc>& vector<T, Alloc>::operator=(vector& x) {
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(const vector& x) {
     if(&x != this) {
+        copy_assign_alloc(x, typename base::propagate_on_copy());
         const size_type xlen = x.size();
         if(xlen > capacity()) {
             destroy_and_deallocate();
             start = allocate_and_copy(xlen, x.begin(), x.end());
             end_of_storage = start + xlen;
         } else if(size() >= xlen) {
-            iterator tmp = copy(x.begin(), x.end(), start);
-            destroy(tmp, finish);
+            iterator tmp = MiniSTL::copy(x.begin(), x.end(), start);
+            MiniSTL::destroy(tmp, finish);
         } else {
-            copy(x.begin(), x.begin() + size(), start);
-            uninitialized_copy(x.begin() + size(), x.end(), finish);
+            MiniSTL::copy(x.begin(), x.begin() + size(), start);
+            MiniSTL::uninitialized_copy(x.begin() + size(), x.end(), finish);
         }
         finish = start + xlen;
     }
     return *this;
 }
 
-template<class T, class Alloc>
-vector<T, Alloc>& vector<T, Alloc>::operator=(vector<T, Alloc>&& x) noexcept {
-    if(&x != this) {
-        destroy_and_deallocate();
-        start = x.start;
-        finish = x.finish;
-        end_of_storage = x.end_of_storage;
-        x.start = x.finish = x.end_of_storage = nullptr;
-    }
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(vector<T, Alloc, Growth>&& x) {
+    if(&x != this)
+        move_assign(x, typename base::propagate_on_move());
     return *this;
 }
 
-template<class T, class Alloc>
-vector<T, Alloc>& vector<T, Alloc>::operator=(std::initializer_list<T> ilist) {
+template <class T, class Alloc, class Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(std::initializer_list<T> ilist) {
     const size_type len = ilist.size();
     if(len > capacity()) {
         destroy_and_deallocate();
         start = allocate_and_copy(len, ilist.begin(), ilist.end());
         end_of_storage = start + len;
     } else if(size() >= len) {
-        iterator tmp = copy(ilist.begin(), ilist.end(), start);
-        destroy(tmp, finish);
+        iterator tmp = MiniSTL::copy(ilist.begin(), ilist.end(), start);
+        MiniSTL::destroy(tmp, finish);
     } else {
-        copy(ilist.begin(), ilist.begin() + size(), start);
-        uninitialized_copy(ilist.begin() + size(), ilist.end(), finish);
+        MiniSTL::copy(ilist.begin(), ilist.begin() + size(), start);
+        MiniSTL::uninitialized_copy(ilist.begin() + size(), ilist.end(), finish);
     }
     finish = start + len;
     return *this;
 }
 
 
-template<class T, class Alloc>
-void vector<T, Alloc>::fill_assign(size_type n, const T& val) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::fill_assign(size_type n, const T& val) {
     if(n > capacity()) {
-        vector tmp(n, val);
+        vector tmp(n, val, get_allocator());
         this->swap(tmp);
     } else if(n > size()) {
-        fill(start, finish, val);
-        finish = uninitialized_fill_n(finish, n - size(), val);
+        MiniSTL::fill(start, finish, val);
+        finish = MiniSTL::uninitialized_fill_n(finish, n - size(), val);
     } else {
-        erase(fill_n(start, n, val), finish);
+        erase(MiniSTL::fill_n(start, n, val), finish);
     }
 }
 
-template<class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class InputIt>
-void vector<T, Alloc>::assign_aux(InputIt first, InputIt last, 
+void vector<T, Alloc, Growth>::assign_aux(InputIt first, InputIt last, 
                                   input_iterator_tag) {
     iterator cur = begin();
     for(;first != last && cur != end();++cur, ++first)
@@ -492,11 +669,11 @@ void vector<T, Alloc>::assign_aux(InputIt first, InputIt last,
         insert(end(), first, last);
 }
 
-template<class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class ForwardIt>
-void vector<T, Alloc>::assign_aux(ForwardIt first, ForwardIt last, 
+void vector<T, Alloc, Growth>::assign_aux(ForwardIt first, ForwardIt last, 
                                   forward_iterator_tag) {
-    size_type len = distance(first, last);
+    size_type len = MiniSTL::distance(first, last);
 
     if(len > capacity()) {
         // in case first, last come from vector itself
@@ -505,123 +682,118 @@ void vector<T, Alloc>::assign_aux(ForwardIt first, ForwardIt last,
         start = tmp;
         end_of_storage = finish = start + len;
     } else if(size() >= len) {
-        iterator new_finish = copy(first, last, start);
-        destroy(new_finish, finish);
+        iterator new_finish = MiniSTL::copy(first, last, start);
+        MiniSTL::destroy(new_finish, finish);
         finish = new_finish;
     } else {
         ForwardIt mid = first;
-        advance(mid, size());
-        copy(first, mid, start);
-        finish = uninitialized_copy(mid, last, finish);
+        MiniSTL::advance(mid, size());
+        MiniSTL::copy(first, mid, start);
+        finish = MiniSTL::uninitialized_copy(mid, last, finish);
     }
 }
 
-template<class T, class Alloc>
-void vector<T, Alloc>::insert_aux(iterator pos, const T& val) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::insert_aux(iterator pos, const T& val) {
     if(finish != end_of_storage) {
         construct(finish, *(finish - 1));
         ++finish;
         T x_copy = val; // prevent move assign?
-        copy_backward(pos, finish - 2, finish - 1);
+        MiniSTL::copy_backward(pos, finish - 2, finish - 1);
         *pos = x_copy;
     } else {
-        const size_type old_sz = size();
-        const size_type new_sz = old_sz != 0 ? 2 * old_sz : 1;
-        iterator new_start = alloc::allocate(new_sz);
-        iterator new_finish = new_start;
+        const size_type new_sz = grow_capacity(1);
+        if(pos == finish && realloc_growth(relocatable_t<T>())) {
+            T x_copy = val; // val may be one of ours
+            reallocate_storage(new_sz);
+            construct(finish, x_copy);
+            ++finish;
+            return;
+        }
+        iterator new_start = this->allocate_n(new_sz);
+        // new element goes first, val may be one of ours
         try {
-            new_finish = uninitialized_copy(start, pos, new_start);
-            construct(new_finish, val);
-            ++new_finish;
-            new_finish = uninitialized_copy(pos, finish, new_finish);
+            construct(new_start + (pos - start), val);
         } catch(std::exception&) {
-            destroy(new_start, new_finish);
-            alloc::deallocate(new_start, new_sz);
+            this->deallocate_n(new_start, new_sz);
             throw;
         }
-        destroy_and_deallocate();
-        start = new_start;
-        finish = new_finish;
-        end_of_storage = new_start + new_sz;
+        relocate_storage(new_start, new_sz, pos, 1);
     }
 }
 
-template<class T, class Alloc>
-void vector<T, Alloc>::insert_aux(iterator pos, T&& val) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::insert_aux(iterator pos, T&& val) {
     if(finish != end_of_storage) {
         construct(finish, *(finish - 1));
         ++finish;
-        copy_backward(pos, finish - 2, finish - 1);
-        *pos = std::forward(val);
+        MiniSTL::copy_backward(pos, finish - 2, finish - 1);
+        *pos = std::forward<T>(val);
     } else {
-        const size_type old_sz = size();
-        const size_type new_sz = old_sz != 0 ? 2 * old_sz : 1;
-        iterator new_start = alloc::allocate(new_sz);
-        iterator new_finish = new_start;
+        const size_type new_sz = grow_capacity(1);
+        if(pos == finish && realloc_growth(relocatable_t<T>())) {
+            T x_copy = std::forward<T>(val);
+            reallocate_storage(new_sz);
+            new (static_cast<void*>(finish)) T(std::move(x_copy));
+            ++finish;
+            return;
+        }
+        iterator new_start = this->allocate_n(new_sz);
         try {
-            new_finish = uninitialized_copy(start, pos, new_start);
-            // construct(new_finish, val);
-            new (static_cast<void*>(new_finish)) T(std::forward(val));
-            ++new_finish;
-            new_finish = uninitialized_copy(pos, finish, new_finish);
+            // construct(new_start + (pos - start), val);
+            new (static_cast<void*>(new_start + (pos - start))) T(std::forward<T>(val));
         } catch(std::exception&) {
-            destroy(new_start, new_finish);
-            alloc::deallocate(new_start, new_sz);
+            this->deallocate_n(new_start, new_sz);
             throw;
         }
-        destroy_and_deallocate();
-        start = new_start;
-        finish = new_finish;
-        end_of_storage = new_start + new_sz;
+        relocate_storage(new_start, new_sz, pos, 1);
     }
 }
 
-template <class T, class Alloc>
-void vector<T, Alloc>::fill_insert(iterator pos, size_type n, const T& val) {
+template <class T, class Alloc, class Growth>
+void vector<T, Alloc, Growth>::fill_insert(iterator pos, size_type n, const T& val) {
     if(n != 0) {
         // case 1: enough space
         if(capacity() - size() >= n) {
             T x_copy = val;
             const size_type size_after = static_cast<size_type>(finish - pos);
             if(size_after > n) {
-                uninitialized_copy(finish - n, finish, finish);
-                copy_backward(pos, finish - n, finish);
+                MiniSTL::uninitialized_copy(finish - n, finish, finish);
+                MiniSTL::copy_backward(pos, finish - n, finish);
                 finish += n;
-                fill(pos, pos + n, x_copy);
+                MiniSTL::fill(pos, pos + n, x_copy);
             } else {
                 iterator old_finish = finish;
-                uninitialized_copy(finish, n - size_after, x_copy);
+                MiniSTL::uninitialized_fill_n(finish, n - size_after, x_copy);
                 finish += n - size_after;
-                uninitialized_copy(pos, old_finish, finish);
+                MiniSTL::uninitialized_copy(pos, old_finish, finish);
                 finish += size_after;
-                fill(pos, old_finish, x_copy);
+                MiniSTL::fill(pos, old_finish, x_copy);
             }
         } else {
             // case2: expand
-            const size_type old_sz = size();
-            const size_type new_sz = old_sz + max(old_sz, n);
-            iterator new_start = alloc::allocate(new_sz);
-            iterator new_finish = new_start;
+            const size_type new_sz = grow_capacity(n);
+            if(pos == finish && realloc_growth(relocatable_t<T>())) {
+                T x_copy = val;
+                reallocate_storage(new_sz);
+                finish = MiniSTL::uninitialized_fill_n(finish, n, x_copy);
+                return;
+            }
+            iterator new_start = this->allocate_n(new_sz);
             try {
-                new_finish = uninitialized_copy(start, pos, new_start);
-                new_finish = uninitialized_fill_n(new_finish, n, val);
-                new_finish = uninitialized_copy(pos, finish, new_finish);
+                MiniSTL::uninitialized_fill_n(new_start + (pos - start), n, val);
             } catch(std::exception&) {
-                destroy(new_start, new_finish);
-                alloc::deallocate(new_start, new_sz);
+                this->deallocate_n(new_start, new_sz);
                 throw;
             }
-            destroy_and_deallocate();
-            start = new_start;
-            finish = new_finish;
-            end_of_storage = new_start + new_sz;
+            relocate_storage(new_start, new_sz, pos, n);
         }
     }
 }
 
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class InputIt>
-void vector<T, Alloc>::range_insert(iterator pos, InputIt first, 
+void vector<T, Alloc, Growth>::range_insert(iterator pos, InputIt first, 
                                     InputIt last, input_iterator_tag) {
     for(;first != last;++first) {
         pos = insert(pos, *first);
@@ -629,48 +801,45 @@ void vector<T, Alloc>::range_insert(iterator pos, InputIt first,
     }
 }
 
-template <class T, class Alloc>
+template <class T, class Alloc, class Growth>
 template <class ForwardIt>
-void vector<T, Alloc>::range_insert(iterator pos, ForwardIt first, 
+void vector<T, Alloc, Growth>::range_insert(iterator pos, ForwardIt first, 
                                     ForwardIt last, forward_iterator_tag) {
     if(first != last) {
-        size_type n = distance(first, last);
+        size_type n = MiniSTL::distance(first, last);
         // case 1: enough space
         if(capacity() - size() >= n) {
             const size_type size_after = static_cast<size_type>(finish - pos);
             if(size_after > n) {
-                uninitialized_copy(finish - n, finish, finish);
-                copy_backward(pos, finish - n, finish);
+                MiniSTL::uninitialized_copy(finish - n, finish, finish);
+                MiniSTL::copy_backward(pos, finish - n, finish);
                 finish += n;
-                copy(first, last, pos);
+                MiniSTL::copy(first, last, pos);
             } else {
                 ForwardIt mid = first;
-                advance(mid, size_after);
-                uninitialized_copy(mid, last, finish);
+                MiniSTL::advance(mid, size_after);
+                MiniSTL::uninitialized_copy(mid, last, finish);
                 finish += n - size_after;
-                uninitialized_copy(pos, finish - (n - size_after), finish);
+                MiniSTL::uninitialized_copy(pos, finish - (n - size_after), finish);
                 finish += size_after;
-                copy(first, mid, pos);
+                MiniSTL::copy(first, mid, pos);
             }
         } else {
             // case2: expand
-            const size_type old_sz = size();
-            const size_type new_sz = old_sz + max(old_sz, n);
-            iterator new_start = alloc::allocate(new_sz);
-            iterator new_finish = new_start;
+            const size_type new_sz = grow_capacity(n);
+            if(pos == finish && realloc_growth(relocatable_t<T>())) {
+                reallocate_storage(new_sz);
+                finish = MiniSTL::uninitialized_copy(first, last, finish);
+                return;
+            }
+            iterator new_start = this->allocate_n(new_sz);
             try {
-                new_finish = uninitialized_copy(start, pos, new_start);
-                new_finish = uninitialized_copy(first, last, new_finish);
-                new_finish = uninitialized_copy(pos, finish, new_finish);
+                MiniSTL::uninitialized_copy(first, last, new_start + (pos - start));
             } catch(std::exception&) {
-                destroy(new_start, new_finish);
-                alloc::deallocate(new_start, new_sz);
+                this->deallocate_n(new_start, new_sz);
                 throw;
             }
-            destroy_and_deallocate();
-            start = new_start;
-            finish = new_finish;
-            end_of_storage = new_start + new_sz;
+            relocate_storage(new_start, new_sz, pos, n);
         }
     }
 }
@@ -71,7 +71,7 @@ struct modulus : public binary_function<T, T, T> {
 
 template <class T>
 struct negate : public unary_function<T, T> {
-    T operator()(const T& x) {
+    T operator()(const T& x) const {
         return -x;
     }
 };
@@ -94,44 +94,75 @@ inline T identity_element(multiplies<T>) {
 }
 
 // 6 relational functor
-template <class T>
+template <class T = void>
 struct equal_to : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x == y;
     }
 };
 
 template <class T>
 struct not_equal_to : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x != y;
     }
 };
 
 template <class T>
 struct greater : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x > y;
     }
 };
 
-template <class T>
+template <class T = void>
 struct less : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x < y;
     }
 };
 
+// transparent functors: compare arguments of any types, so containers
+// can look up keys of other types than key_type(heterogeneous lookup),
+// e.g. set<string, less<>>::find("abc") builds no string
+template <>
+struct equal_to<void> {
+    using is_transparent = void;
+    template <class T, class U>
+    bool operator()(const T& x, const U& y) const {
+        return x == y;
+    }
+};
+
+template <>
+struct less<void> {
+    using is_transparent = void;
+    template <class T, class U>
+    bool operator()(const T& x, const U& y) const {
+        return x < y;
+    }
+};
+
+// T if functor F declares is_transparent, otherwise no type, so a
+// lookup member taking any key type drops out of overload resolution
+template <class Tag, class T>
+struct __transparent_type {
+    using type = T;
+};
+
+template <class F, class T>
+using transparent_t = typename __transparent_type<typename F::is_transparent, T>::type;
+
 template <class T>
 struct greater_equal : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x >= y;
     }
 };
 
 template <class T>
 struct less_equal : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x == y;
     }
 };
@@ -139,21 +170,21 @@ struct less_equal : public binary_function<T, T, bool> {
 // 3 logical functor
 template <class T>
 struct logical_and : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x && y;
     }
 };
 
 template <class T>
 struct logical_or : public binary_function<T, T, bool> {
-    bool operator()(const T& x, const T& y) {
+    bool operator()(const T& x, const T& y) const {
         return x || y;
     }
 };
 
 template <class T>
 struct logicla_not : public unary_function<T, bool> {
-    bool operator()(const T& x) {
+    bool operator()(const T& x) const {
         return !x;
     }
 };
@@ -171,14 +202,14 @@ struct identity : public unary_function<T, T> {
 // select used in map: KeyofValue = select1st<pair<Key, T> >
 template <class Pair>
 struct select1st : public unary_function<Pair, typename Pair::first_type> {
-    const typename Pair::first_type& operator()(const Pair& x) {
+    const typename Pair::first_type& operator()(const Pair& x) const {
         return x.first;
     }
 };
  
 template <class Pair>
 struct select2nd : public unary_function<Pair, typename Pair::second_type> {
-    const typename Pair::second_type& operator()(const Pair& x) {
+    const typename Pair::second_type& operator()(const Pair& x) const {
         return x.second;
     }
 };
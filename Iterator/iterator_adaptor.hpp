@@ -19,7 +19,7 @@ public:
     using pointer = void;
     using reference = void;
 
-    explicit back_insert_iterator(Container& c) : container(c) {}
+    explicit back_insert_iterator(Container& c) : container(&c) {}
 
     // assign a value v to back_insert_iterator
     // = push_back v to container
@@ -55,7 +55,7 @@ public:
     using pointer = void;
     using reference = void;
 
-    explicit front_insert_iterator(Container& c) : container(c) {}
+    explicit front_insert_iterator(Container& c) : container(&c) {}
 
     // assign a value v to front_insert_iterator
     // = push_front v to container
@@ -93,7 +93,7 @@ public:
     using reference = void;
 
     insert_iterator(Container& c, iterator_type i) 
-        : container(c), iter(i) {}
+        : container(&c), iter(i) {}
 
     // assign a value v to insert_iterator
     // = insert v to pos pointerd by iter in container
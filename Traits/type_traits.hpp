@@ -225,6 +225,24 @@ struct type_traits<T*> {
 //     using is_POD_type = true_type;
 // };
 
+// relocatable: an object can be moved to other memory by memcpy and the
+// old bytes dropped without calling its destructor, which is what vector
+// does with its elements on reallocation.
+// POD types are relocatable. So are most classes which own resources
+// through pointers(e.g. a string holding a heap buffer), but not those
+// pointing into themselves, so a class must opt in by specialization:
+//      template <>
+//      struct is_relocatable<my_string> {
+//          using relocatable = true_type;
+//      };
+template <class T>
+struct is_relocatable {
+    using relocatable = typename type_traits<T>::is_POD_type;
+};
+
+template <class T>
+using relocatable_t = typename is_relocatable<T>::relocatable;
+
 template <class T>
 struct is_integer {
     using integral = false_type;
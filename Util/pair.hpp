@@ -1,5 +1,6 @@
 #pragma once
 #include <utility>
+#include <type_traits>
 
 namespace MiniSTL {
 
@@ -18,7 +19,9 @@ struct pair {
     pair(const pair<U1, U2>& p) : first(p.first), second(p.second) {}
 
     pair(const pair& p) : first(p.first), second(p.second) {}
-    pair(pair&& p) : first(std::move(p.first)), second(std::move(p.second)) {}
+    pair(pair&& p) noexcept(std::is_nothrow_move_constructible<T1>::value &&
+                            std::is_nothrow_move_constructible<T2>::value)
+        : first(std::move(p.first)), second(std::move(p.second)) {}
 
     pair& operator=(const pair& p) {
         if(&p != this) {
@@ -29,7 +29,7 @@ __get_temporary_buffer(ptrdiff_t len, T*) {
 
 template <class T>
 inline pair<T*, ptrdiff_t> get_temporary_buffer(ptrdiff_t len) {
-    return __get_temporary_buffer(len, reinterpret_cast<T*>(nullptr));
+    return MiniSTL::__get_temporary_buffer(len, reinterpret_cast<T*>(nullptr));
 }
 
 
@@ -62,7 +62,7 @@ private:
 
     void initialize_buffer(const T&, true_type) {}
     void initialize_buffer(const T& val, false_type) {
-        uninitialized_fill_n(buffer, len, val);
+        MiniSTL::uninitialized_fill_n(buffer, len, val);
     }
 
 public:
@@ -74,11 +74,10 @@ public:
 
     Temporary_Buffer(ForwardIt first, ForwardIt last) {
         try {
-            len = 0;
-            distance(first, last, len);
+            len = MiniSTL::distance(first, last);
             allocate_buffer();
             if(len > 0)
-                initialize_buffer(*first, is_POD_type_t<ForwardIt>());
+                initialize_buffer(*first, is_POD_type_t<T>());
         } catch(std::exception&) {
             free(buffer); 
             buffer = nullptr;
@@ -87,7 +86,7 @@ public:
     }
     
     ~Temporary_Buffer() {  
-        destroy(buffer, buffer + len);
+        MiniSTL::destroy(buffer, buffer + len);
         free(buffer);
     }
 